@@ -0,0 +1,575 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "./zdx_util.h"
+#include "./ast_cache.h"
+
+// ------------------------------------ KEY ------------------------------------
+
+static inline uint64_t ast_cache_mix(uint64_t h)
+{
+  // splitmix64 finalizer
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+
+  return h;
+}
+
+// hashes 8 bytes per step instead of the byte at a time djb2/fnv1 used by zdx_hashtable.h
+// as this runs over the whole file on every invocation
+static uint64_t ast_cache_hash(uint64_t seed, const char *buf, const size_t length)
+{
+  uint64_t h = seed ^ (length * 0x9e3779b97f4a7c15ULL);
+  size_t i = 0;
+
+  for (; i + 8 <= length; i += 8) {
+    uint64_t word;
+    memcpy(&word, &buf[i], sizeof(word));
+    h = (h ^ ast_cache_mix(word)) * 0x9e3779b97f4a7c15ULL;
+  }
+
+  uint64_t tail = 0;
+  memcpy(&tail, &buf[i], length - i);
+
+  return ast_cache_mix(h ^ ast_cache_mix(tail));
+}
+
+uint64_t ast_cache_key(const char source[const static 1], const size_t source_length, const parser_opts_t opts[const static 1],
+                       const bool table_driven)
+{
+  static const char version[] = INTERPRETER_VERSION;
+  uint64_t seed = ast_cache_hash(AST_CACHE_FORMAT_VERSION, version, sizeof(version) - 1);
+  // the options that change the tree, e.g., a lazy parse leaves the bodies out and a lower depth fails deep input
+  const uint64_t parse[2] = {
+    opts->max_expr_depth ? opts->max_expr_depth : PARSER_DEFAULT_MAX_EXPR_DEPTH,
+    (uint64_t)opts->hash_cons | (uint64_t)opts->lazy_bodies << 1 | (uint64_t)opts->recursive_exprs << 2 | (uint64_t)table_driven << 3,
+  };
+
+  seed = ast_cache_hash(seed, (const char *)parse, sizeof(parse));
+
+  return ast_cache_hash(seed, source, source_length);
+}
+
+// ------------------------------------ PATH ------------------------------------
+
+static bool ast_cache_ensure_dir(const char path[const static 1])
+{
+  if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+    return false;
+  }
+
+  return true;
+}
+
+// Returns NULL if no usable cache directory could be found or created
+const char *ast_cache_path(arena_t arena[const static 1], const uint64_t key)
+{
+  const char *dir = getenv(AST_CACHE_DIR_ENV);
+  const char *xdg_cache = getenv("XDG_CACHE_HOME");
+  const char *home = getenv("HOME");
+  size_t dir_length = 0;
+  char *cache_dir = NULL;
+
+  if (dir && *dir) {
+    dir_length = strlen(dir);
+    cache_dir = arena_calloc(arena, dir_length + 1, sizeof(*cache_dir));
+    assertm(!arena->err, "Expected: cache dir alloc to succeed, Received: %s", arena->err);
+    memcpy(cache_dir, dir, dir_length);
+  } else if (xdg_cache && *xdg_cache) {
+    dir_length = strlen(xdg_cache) + sizeof("/c-interpreter") - 1;
+    cache_dir = arena_calloc(arena, dir_length + 1, sizeof(*cache_dir));
+    assertm(!arena->err, "Expected: cache dir alloc to succeed, Received: %s", arena->err);
+    snprintf(cache_dir, dir_length + 1, "%s/c-interpreter", xdg_cache);
+  } else if (home && *home) {
+    dir_length = strlen(home) + sizeof("/.cache/c-interpreter") - 1;
+    cache_dir = arena_calloc(arena, dir_length + 1, sizeof(*cache_dir));
+    assertm(!arena->err, "Expected: cache dir alloc to succeed, Received: %s", arena->err);
+    snprintf(cache_dir, dir_length + 1, "%s/.cache", home);
+
+    if (!ast_cache_ensure_dir(cache_dir)) {
+      return NULL;
+    }
+
+    snprintf(cache_dir, dir_length + 1, "%s/.cache/c-interpreter", home);
+  } else {
+    return NULL;
+  }
+
+  if (!ast_cache_ensure_dir(cache_dir)) {
+    return NULL;
+  }
+
+  // <dir>/<16 hex digits>.ast
+  const size_t path_length = dir_length + 1 + 16 + sizeof(".ast") - 1;
+  char *path = arena_calloc(arena, path_length + 1, sizeof(*path));
+  assertm(!arena->err, "Expected: cache path alloc to succeed, Received: %s", arena->err);
+  snprintf(path, path_length + 1, "%s/%016llx.ast", cache_dir, (unsigned long long)key);
+
+  return path;
+}
+
+// ------------------------------------ READ ------------------------------------
+
+ast_cache_t ast_cache_open(const char path[const static 1], const uint64_t key,
+                           const char source[const static 1], const size_t source_length)
+{
+  ast_cache_t cache = { .source = source };
+  int fd = open(path, O_RDONLY);
+
+  if (fd < 0) {
+    cache.err = strerror(errno);
+    return cache;
+  }
+
+  struct stat s;
+
+  if (fstat(fd, &s) != 0) {
+    cache.err = strerror(errno);
+    close(fd);
+    return cache;
+  }
+
+  const size_t size = (size_t)s.st_size;
+
+  if (size < sizeof(ast_cache_header_t)) {
+    cache.err = "Cache file is truncated";
+    close(fd);
+    return cache;
+  }
+
+  void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping keeps the file referenced
+
+  if (mapping == MAP_FAILED) {
+    cache.err = strerror(errno);
+    return cache;
+  }
+
+  cache.mapping = mapping;
+  cache.mapping_size = size;
+
+  const ast_cache_header_t *header = mapping;
+
+  if (memcmp(header->magic, AST_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->format_version != AST_CACHE_FORMAT_VERSION) {
+    cache.err = "Cache file has an unknown format";
+  } else if (header->key != key || header->source_length != source_length) {
+    cache.err = "Cache file belongs to different source";
+  } else if (size != ast_cache_size(header) || header->root >= header->node_count) {
+    cache.err = "Cache file is corrupt";
+  }
+
+  if (cache.err) {
+    munmap(mapping, size);
+    cache.mapping = NULL;
+    cache.mapping_size = 0;
+    return cache;
+  }
+
+  cache.header = header;
+  cache.nodes = (const ast_cache_node_t *)(header + 1);
+  cache.types = (const ast_cache_type_t *)(cache.nodes + header->node_count);
+
+  return cache;
+}
+
+void ast_cache_close(ast_cache_t cache[const static 1])
+{
+  if (cache->mapping) {
+    munmap(cache->mapping, cache->mapping_size);
+  }
+
+  *cache = (ast_cache_t){0};
+}
+
+// ------------------------------------ WRITE ------------------------------------
+
+typedef struct {
+  ast_cache_node_t *nodes;
+  uint32_t length;
+  const char *source;
+  size_t source_length;
+  // types are interned so the address of a type identifies it, type_slots maps it to its index
+  ast_cache_type_t *types;
+  uint32_t type_length;
+  const type_t **type_slots;
+  uint32_t *type_slot_idx;
+  size_t type_slots_capacity;
+  const type_table_t *node_types; // what the ids of the node types refer to, NULL if they aren't written
+} ast_cache_serializer_t;
+
+// type_count is an upper bound as types shared between declarations are counted once per declaration
+static bool ast_cache_count_nodes(const ast_node_t node, uint32_t count[const static 1], uint32_t type_count[const static 1])
+{
+  *count += 1;
+
+  switch(node.kind) {
+    case AST_NODE_KIND_LIST: {
+      for (size_t i = 0; node.children && i < node.children->length; i++) {
+        if (!ast_cache_count_nodes(node.children->items[i], count, type_count)) {
+          return false;
+        }
+      }
+    } break;
+    case AST_NODE_KIND_UNARY_OP: return ast_cache_count_nodes(*node.unary_op.expr, count, type_count);
+    case AST_NODE_KIND_BINARY_OP: return ast_cache_count_nodes(*node.binary_op.lhs, count, type_count) &&
+                                         ast_cache_count_nodes(*node.binary_op.rhs, count, type_count);
+    case AST_NODE_KIND_TERNARY: return ast_cache_count_nodes(*node.ternary.cond, count, type_count) &&
+                                       ast_cache_count_nodes(*node.ternary.then_expr, count, type_count) &&
+                                       ast_cache_count_nodes(*node.ternary.else_expr, count, type_count);
+    case AST_NODE_KIND_CALL: {
+      if (!ast_cache_count_nodes(*node.call.callee, count, type_count)) {
+        return false;
+      }
+
+      for (size_t i = 0; node.call.args && i < node.call.args->length; i++) {
+        if (!ast_cache_count_nodes(node.call.args->items[i], count, type_count)) {
+          return false;
+        }
+      }
+    } break;
+    case AST_NODE_KIND_DECLARATION: {
+      *count += 1; // name symbol
+
+      for (const type_t *type = node.declaration.type; type; type = type->pointee) {
+        *type_count += 1;
+      }
+
+      if (node.declaration.init) {
+        return ast_cache_count_nodes(*node.declaration.init, count, type_count);
+      }
+    } break;
+    case AST_NODE_KIND_FUNCTION: {
+      const ast_function_t *function = node.function;
+      *count += 1; // name symbol
+
+      for (const type_t *type = function->type; type; type = type->pointee) {
+        *type_count += 1;
+      }
+
+      if (!ast_cache_count_nodes((ast_node_t){ .kind = AST_NODE_KIND_LIST, .children = function->params }, count, type_count)) {
+        return false;
+      }
+
+      if (function->body_source.length) {
+        // a lazy body is a single list node
+        return ast_cache_count_nodes((ast_node_t){ .kind = AST_NODE_KIND_LIST, .children = function->body }, count, type_count);
+      }
+    } break;
+    case AST_NODE_KIND_RETURN: {
+      if (node.ret.expr) {
+        return ast_cache_count_nodes(*node.ret.expr, count, type_count);
+      }
+    } break;
+    case AST_NODE_KIND_LITERAL:
+    case AST_NODE_KIND_SYMBOL: break;
+    default: return false; // error and unknown nodes are never cached
+  }
+
+  return true;
+}
+
+static inline uint32_t ast_cache_reserve(ast_cache_serializer_t s[const static 1], const uint32_t count)
+{
+  uint32_t idx = s->length;
+  s->length += count;
+
+  return idx;
+}
+
+static void ast_cache_source_span(const ast_cache_serializer_t s[const static 1], const sv_t value,
+                                  ast_cache_node_t out[const static 1])
+{
+  assertm(value.buf >= s->source && value.buf + value.length <= s->source + s->source_length,
+          "Expected: literal or symbol to point into the source, Received: %p", (void *)value.buf);
+
+  out->a = (uint32_t)(value.buf - s->source);
+  out->b = (uint32_t)value.length;
+}
+
+static uint32_t ast_cache_type_index(ast_cache_serializer_t s[const static 1], const type_t type[const static 1])
+{
+  const size_t mask = s->type_slots_capacity - 1;
+  size_t slot = (size_t)(((uintptr_t)type >> 4) * 0x9e3779b97f4a7c15ULL) & mask;
+
+  while (s->type_slots[slot]) {
+    if (s->type_slots[slot] == type) {
+      return s->type_slot_idx[slot];
+    }
+
+    slot = (slot + 1) & mask;
+  }
+
+  ast_cache_type_t out = {
+    .kind = type->kind,
+    .qualifiers = type->qualifiers,
+    .storage = type->storage,
+    .specifiers = type->specifiers,
+  };
+
+  if (type->kind == TYPE_KIND_POINTER) {
+    // pointees are written first so that an index always refers to an earlier type
+    out.a = ast_cache_type_index(s, type->pointee);
+  } else if (type->specifiers & TYPE_SPEC_NAMED) {
+    out.a = (uint32_t)(type->name.buf - s->source);
+    out.b = (uint32_t)type->name.length;
+  }
+
+  const uint32_t idx = s->type_length++;
+  s->types[idx] = out;
+  s->type_slots[slot] = type;
+  s->type_slot_idx[slot] = idx;
+
+  return idx;
+}
+
+static void ast_cache_serialize(ast_cache_serializer_t s[const static 1], const ast_node_t node, const uint32_t idx)
+{
+  // s->nodes is sized upfront so this pointer stays valid across the recursive calls below
+  ast_cache_node_t *out = &s->nodes[idx];
+  out->kind = (uint8_t)node.kind;
+
+  if (s->node_types && node.type != TYPE_NO_ID) {
+    const type_t *type = type_by_id(s->node_types, node.type);
+
+    if (type->kind != TYPE_KIND_UNKNOWN) {
+      const uint32_t type_idx = ast_cache_type_index(s, type);
+      assertm(type_idx < UINT16_MAX, "Expected: less than %d cached types, Received: %u", UINT16_MAX, type_idx);
+      out->type = (uint16_t)(type_idx + 1);
+    }
+  }
+
+  switch(node.kind) {
+    case AST_NODE_KIND_LIST: {
+      const uint32_t count = node.children ? (uint32_t)node.children->length : 0;
+      const uint32_t first = ast_cache_reserve(s, count);
+
+      out->a = count ? first : AST_CACHE_NO_NODE;
+      out->b = count;
+
+      for (uint32_t i = 0; i < count; i++) {
+        ast_cache_serialize(s, node.children->items[i], first + i);
+      }
+    } break;
+
+    case AST_NODE_KIND_LITERAL: {
+      out->op = (uint8_t)node.literal.kind;
+
+      // a folded value was never spelled out in the source
+      if (node.literal.folded) {
+        out->op |= AST_CACHE_LITERAL_FOLDED;
+        out->a = (uint32_t)node.literal.integer;
+        out->b = (uint32_t)(node.literal.integer >> 32);
+      } else {
+        ast_cache_source_span(s, node.literal.value, out);
+      }
+    } break;
+
+    case AST_NODE_KIND_SYMBOL: {
+      ast_cache_source_span(s, node.symbol.name, out);
+      out->op = node.symbol.binding;
+      out->c = node.symbol.slot;
+    } break;
+
+    case AST_NODE_KIND_UNARY_OP: {
+      out->op = (uint8_t)node.unary_op.kind;
+      out->a = ast_cache_reserve(s, 1);
+      ast_cache_serialize(s, *node.unary_op.expr, out->a);
+    } break;
+
+    case AST_NODE_KIND_BINARY_OP: {
+      out->op = (uint8_t)node.binary_op.kind;
+      out->a = ast_cache_reserve(s, 1);
+      out->b = ast_cache_reserve(s, 1);
+      ast_cache_serialize(s, *node.binary_op.lhs, out->a);
+      ast_cache_serialize(s, *node.binary_op.rhs, out->b);
+    } break;
+
+    case AST_NODE_KIND_TERNARY: {
+      out->a = ast_cache_reserve(s, 1);
+      out->b = ast_cache_reserve(s, 1);
+      out->c = ast_cache_reserve(s, 1);
+      ast_cache_serialize(s, *node.ternary.cond, out->a);
+      ast_cache_serialize(s, *node.ternary.then_expr, out->b);
+      ast_cache_serialize(s, *node.ternary.else_expr, out->c);
+    } break;
+
+    case AST_NODE_KIND_CALL: {
+      const uint32_t count = node.call.args ? (uint32_t)node.call.args->length : 0;
+
+      out->a = ast_cache_reserve(s, 1);
+      out->b = count ? ast_cache_reserve(s, count) : AST_CACHE_NO_NODE;
+      out->c = count;
+      ast_cache_serialize(s, *node.call.callee, out->a);
+
+      for (uint32_t i = 0; i < count; i++) {
+        ast_cache_serialize(s, node.call.args->items[i], out->b + i);
+      }
+    } break;
+
+    case AST_NODE_KIND_DECLARATION: {
+      out->a = ast_cache_type_index(s, node.declaration.type);
+      out->b = ast_cache_reserve(s, 1);
+      out->c = node.declaration.init ? ast_cache_reserve(s, 1) : AST_CACHE_NO_NODE;
+      ast_cache_serialize(s, (ast_node_t){ .kind = AST_NODE_KIND_SYMBOL, .symbol = { .name = node.declaration.name } }, out->b);
+
+      if (node.declaration.init) {
+        ast_cache_serialize(s, *node.declaration.init, out->c);
+      }
+    } break;
+
+    case AST_NODE_KIND_FUNCTION: {
+      const ast_function_t *function = node.function;
+      const bool has_body = function->body_source.length > 0;
+
+      out->a = ast_cache_type_index(s, function->type);
+      out->b = ast_cache_reserve(s, 2);
+      out->c = has_body ? ast_cache_reserve(s, 1) : AST_CACHE_NO_NODE;
+      ast_cache_serialize(s, (ast_node_t){ .kind = AST_NODE_KIND_SYMBOL, .symbol = { .name = function->name } }, out->b);
+      ast_cache_serialize(s, (ast_node_t){ .kind = AST_NODE_KIND_LIST, .children = function->params }, out->b + 1);
+
+      if (has_body && function->body == NULL) {
+        ast_cache_node_t *body = &s->nodes[out->c];
+        body->kind = AST_NODE_KIND_LIST;
+        body->op = AST_CACHE_LIST_LAZY;
+        ast_cache_source_span(s, function->body_source, body);
+      } else if (has_body) {
+        ast_cache_serialize(s, (ast_node_t){ .kind = AST_NODE_KIND_LIST, .children = function->body }, out->c);
+      }
+    } break;
+
+    case AST_NODE_KIND_RETURN: {
+      out->a = node.ret.expr ? ast_cache_reserve(s, 1) : AST_CACHE_NO_NODE;
+
+      if (node.ret.expr) {
+        ast_cache_serialize(s, *node.ret.expr, out->a);
+      }
+    } break;
+
+    default: assertm(false, "Unexpected ast node of kind %s (%d) while serializing", node_kind_name(node.kind), node.kind);
+  }
+}
+
+// Programs with parse errors can't be encoded, the reason is in .err
+ast_cache_t ast_cache_encode(arena_t arena[const static 1], const uint64_t key, const ast_node_t program,
+                             const char source[const static 1], const size_t source_length, const type_table_t *node_types)
+{
+  check_program(program);
+  ast_cache_t cache = { .source = source };
+
+  if (source_length > UINT32_MAX) {
+    cache.err = "Source too large to cache";
+    return cache;
+  }
+
+  uint32_t node_count = 0;
+  uint32_t max_type_count = 0;
+
+  if (!ast_cache_count_nodes(program, &node_count, &max_type_count)) {
+    cache.err = "Not caching a program with parse errors";
+    return cache;
+  }
+
+  // every node type is a type of the table, written once however many nodes have it
+  if (node_types) {
+    max_type_count += (uint32_t)node_types->length;
+  }
+
+  const size_t max_size = sizeof(ast_cache_header_t) + node_count * sizeof(ast_cache_node_t) +
+    max_type_count * sizeof(ast_cache_type_t);
+  char *buf = arena_calloc(arena, max_size, sizeof(*buf));
+
+  if (!buf) {
+    cache.err = arena->err;
+    return cache;
+  }
+
+  // at most half full
+  size_t type_slots_capacity = 16;
+
+  while (type_slots_capacity < 2 * (size_t)max_type_count) {
+    type_slots_capacity *= 2;
+  }
+
+  const type_t **type_slots = arena_calloc(arena, type_slots_capacity, sizeof(*type_slots));
+  uint32_t *type_slot_idx = arena_calloc(arena, type_slots_capacity, sizeof(*type_slot_idx));
+
+  if (!type_slots || !type_slot_idx) {
+    cache.err = arena->err;
+    return cache;
+  }
+
+  ast_cache_header_t *header = (ast_cache_header_t *)buf;
+  memcpy(header->magic, AST_CACHE_MAGIC, sizeof(header->magic));
+  header->format_version = AST_CACHE_FORMAT_VERSION;
+  header->key = key;
+  header->source_length = source_length;
+  header->node_count = node_count;
+  header->root = 0;
+
+  ast_cache_serializer_t s = {
+    .nodes = (ast_cache_node_t *)(header + 1),
+    .source = source,
+    .source_length = source_length,
+    .types = (ast_cache_type_t *)((ast_cache_node_t *)(header + 1) + node_count),
+    .type_slots = type_slots,
+    .type_slot_idx = type_slot_idx,
+    .type_slots_capacity = type_slots_capacity,
+    .node_types = node_types,
+  };
+  ast_cache_serialize(&s, program, ast_cache_reserve(&s, 1));
+  assertm(s.length == node_count, "Expected: %u nodes to be serialized, Received: %u", node_count, s.length);
+
+  // the unused tail of the types upper bound is left behind in the arena
+  header->type_count = s.type_length;
+
+  cache.header = header;
+  cache.nodes = s.nodes;
+  cache.types = s.types;
+
+  return cache;
+}
+
+// Returns NULL on success and the reason otherwise
+const char *ast_cache_write(arena_t arena[const static 1], const char path[const static 1], const ast_cache_t cache[const static 1])
+{
+  assertm(cache->header, "Expected: an opened or encoded cache, Received: %s", cache->err ? cache->err : "no header");
+  const size_t size = ast_cache_size(cache->header);
+
+  // write to a temporary file and rename it into place so concurrent runs never see a partial cache
+  const size_t tmp_path_length = strlen(path) + sizeof(".tmp.") - 1 + 20;
+  char *tmp_path = arena_calloc(arena, tmp_path_length + 1, sizeof(*tmp_path));
+
+  if (!tmp_path) {
+    return arena->err;
+  }
+
+  snprintf(tmp_path, tmp_path_length + 1, "%s.tmp.%ld", path, (long)getpid());
+
+  FILE *f = fopen(tmp_path, "wb");
+
+  if (f == NULL) {
+    return strerror(errno);
+  }
+
+  const size_t written = fwrite(cache->header, sizeof(char), size, f);
+  const bool failed = written != size || fflush(f) != 0;
+  fclose(f);
+
+  if (failed || rename(tmp_path, path) != 0) {
+    const char *err = failed ? "Writing cache file failed" : strerror(errno);
+    unlink(tmp_path);
+    return err;
+  }
+
+  return NULL;
+}
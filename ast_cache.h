@@ -0,0 +1,140 @@
+#ifndef AST_CACHE_H_
+#define AST_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "./parser2.h"
+
+#include "./zdx_simple_arena.h"
+
+// bump this whenever the parser starts producing a different AST for the same input
+#define INTERPRETER_VERSION "0.5.0"
+// bump this whenever the layout of ast_cache_header_t or ast_cache_node_t changes
+#define AST_CACHE_FORMAT_VERSION 6
+#define AST_CACHE_MAGIC "CIAC"
+#define AST_CACHE_DIR_ENV "C_INTERPRETER_CACHE_DIR"
+#define AST_CACHE_NO_NODE UINT32_MAX
+#define AST_CACHE_NO_TYPE UINT32_MAX
+// op of the body list of a function that was only scanned by the lazy mode
+#define AST_CACHE_LIST_LAZY 1
+// bit set in the op of a literal folded by the fold pass of fold.h
+#define AST_CACHE_LITERAL_FOLDED 0x80
+
+/**
+ * On-disk layout:
+ *
+ * [ast_cache_header_t][ast_cache_node_t * node_count][ast_cache_type_t * type_count]
+ *
+ * Nodes never point at each other or at the source. Children are referred to by their index
+ * in the nodes array and literal/symbol values by their (offset, length) in the source file
+ * that produced the cache. As the cache is keyed by the hash of that source, the source bytes
+ * we hash on every run are the string table. This makes the file usable straight out of mmap.
+ */
+typedef struct {
+  char magic[4];
+  uint32_t format_version;
+  uint64_t key;
+  uint64_t source_length;
+  uint32_t node_count;
+  uint32_t root;
+  uint32_t type_count;
+  uint32_t reserved;
+} ast_cache_header_t;
+
+typedef struct {
+  uint8_t kind;  // ast_node_kind_t
+  uint8_t op;    // literal_kind_t, symbol_binding_t, unary_op_kind_t or binary_op_kind_t depending on kind
+  uint16_t type; // type index + 1 of the type the type checker gave an expression, 0 if it has none
+  // AST_NODE_KIND_LIST: a = first child index, b = child count (children are contiguous)
+  //   or with op = AST_CACHE_LIST_LAZY, a = source offset, b = length of an unparsed function body
+  // AST_NODE_KIND_LITERAL: a = source offset, b = length
+  //   or with AST_CACHE_LITERAL_FOLDED in op, a = low and b = high 32 bits of its value in the type of the node
+  // AST_NODE_KIND_SYMBOL: a = source offset, b = length, c = slot of its binding
+  // AST_NODE_KIND_UNARY_OP: a = expr index
+  // AST_NODE_KIND_BINARY_OP: a = lhs index, b = rhs index
+  // AST_NODE_KIND_TERNARY: a = cond index, b = then index, c = else index
+  // AST_NODE_KIND_CALL: a = callee index, b = first arg index, c = arg count (args are contiguous)
+  // AST_NODE_KIND_DECLARATION: a = type index, b = name symbol index, c = init index or AST_CACHE_NO_NODE
+  // AST_NODE_KIND_FUNCTION: a = return type index, b = name symbol index followed by the params list index,
+  //   c = body list index or AST_CACHE_NO_NODE for prototypes
+  // AST_NODE_KIND_RETURN: a = expr index or AST_CACHE_NO_NODE
+  uint32_t a;
+  uint32_t b;
+  uint32_t c;
+} ast_cache_node_t;
+
+// interned types are written once no matter how many declarations refer to them
+typedef struct {
+  uint8_t kind; // type_kind_t
+  uint8_t qualifiers;
+  uint8_t storage;
+  uint8_t reserved;
+  uint16_t specifiers;
+  uint16_t reserved2;
+  // TYPE_KIND_BASE: a = typedef name source offset, b = length
+  // TYPE_KIND_POINTER: a = pointee type index
+  uint32_t a;
+  uint32_t b;
+} ast_cache_type_t;
+
+_Static_assert(sizeof(ast_cache_header_t) == 40, "Expected ast cache header to be 40 bytes");
+_Static_assert(sizeof(ast_cache_node_t) == 16, "Expected ast cache node to be 16 bytes");
+_Static_assert(sizeof(ast_cache_type_t) == 16, "Expected ast cache type to be 16 bytes");
+
+// either mapped from a cache file by ast_cache_open() or encoded in memory by ast_cache_encode()
+typedef struct {
+  const ast_cache_header_t *header;
+  const ast_cache_node_t *nodes;
+  const ast_cache_type_t *types;
+  const char *source;
+  void *mapping; // NULL for encoded caches
+  size_t mapping_size;
+  const char *err;
+} ast_cache_t;
+
+// of the source as parsed with opts, by ll1_parse() if table_driven, as the parsers and options build different trees
+uint64_t ast_cache_key(const char source[const static 1], const size_t source_length, const parser_opts_t opts[const static 1],
+                       const bool table_driven);
+const char *ast_cache_path(arena_t arena[const static 1], const uint64_t key);
+ast_cache_t ast_cache_open(const char path[const static 1], const uint64_t key,
+                           const char source[const static 1], const size_t source_length);
+// node_types is the table of the type checker that typed the program, NULL to leave the node types out
+ast_cache_t ast_cache_encode(arena_t arena[const static 1], const uint64_t key, const ast_node_t program,
+                             const char source[const static 1], const size_t source_length, const type_table_t *node_types);
+const char *ast_cache_write(arena_t arena[const static 1], const char path[const static 1], const ast_cache_t cache[const static 1]);
+void ast_cache_close(ast_cache_t cache[const static 1]);
+
+static inline size_t ast_cache_size(const ast_cache_header_t header[const static 1])
+{
+  return sizeof(*header) + (size_t)header->node_count * sizeof(ast_cache_node_t) +
+    (size_t)header->type_count * sizeof(ast_cache_type_t);
+}
+
+static inline const ast_cache_node_t *ast_cache_node(const ast_cache_t cache[const static 1], const uint32_t idx)
+{
+  return &cache->nodes[idx];
+}
+
+static inline sv_t ast_cache_node_value(const ast_cache_t cache[const static 1], const ast_cache_node_t node[const static 1])
+{
+  return sv_from_buf(cache->source + node->a, node->b);
+}
+
+static inline bool ast_cache_is_folded_literal(const ast_cache_node_t node[const static 1])
+{
+  return node->kind == AST_NODE_KIND_LITERAL && (node->op & AST_CACHE_LITERAL_FOLDED);
+}
+
+static inline uint64_t ast_cache_folded_value(const ast_cache_node_t node[const static 1])
+{
+  return (uint64_t)node->b << 32 | node->a;
+}
+
+// lazy bodies are spans of the source so cached functions go through parse_function_body() the same way
+static inline bool ast_cache_is_lazy_body(const ast_cache_node_t node[const static 1])
+{
+  return node->kind == AST_NODE_KIND_LIST && node->op == AST_CACHE_LIST_LAZY;
+}
+
+#endif // AST_CACHE_H_
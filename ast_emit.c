@@ -0,0 +1,600 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "./zdx_util.h"
+#include "./ast_emit.h"
+
+const char *ast_emit_format_name(const ast_emit_format_t format)
+{
+  static const char *format_to_str[] = {
+    "text",
+    "json",
+    "binary",
+  };
+
+  _Static_assert(zdx_arr_len(format_to_str) == AST_EMIT_FORMAT_COUNT,
+                 "Some ast emit formats are missing their corresponding strings in format to string map");
+
+  assertm(format < AST_EMIT_FORMAT_COUNT, "Invalid ast emit format %d", format);
+
+  return format_to_str[format];
+}
+
+ast_emit_format_t ast_emit_format_from_cstr(const char name[const static 1])
+{
+  for (ast_emit_format_t format = 0; format < AST_EMIT_FORMAT_COUNT; format++) {
+    if (strcmp(name, ast_emit_format_name(format)) == 0) {
+      return format;
+    }
+  }
+
+  return AST_EMIT_FORMAT_COUNT;
+}
+
+// ------------------------------------ BUFFER ------------------------------------
+
+typedef struct {
+  int fd;
+  char *buf;
+  size_t length;
+  size_t capacity;
+  const char *err; // first write error, everything after it is dropped
+} ast_emitter_t;
+
+static void emit_write_all(ast_emitter_t e[const static 1], const char *buf, size_t length)
+{
+  while (length > 0 && !e->err) {
+    const ssize_t written = write(e->fd, buf, length);
+
+    if (written < 0) {
+      if (errno != EINTR) {
+        e->err = strerror(errno);
+      }
+      continue;
+    }
+
+    buf += written;
+    length -= (size_t)written;
+  }
+}
+
+static void emit_flush(ast_emitter_t e[const static 1])
+{
+  emit_write_all(e, e->buf, e->length);
+  e->length = 0;
+}
+
+// returns space for at least length bytes or NULL if that is more than the whole buffer
+static inline char *emit_reserve(ast_emitter_t e[const static 1], const size_t length)
+{
+  if (e->length + length > e->capacity) {
+    emit_flush(e);
+  }
+
+  return length <= e->capacity ? e->buf + e->length : NULL;
+}
+
+static void emit_bytes(ast_emitter_t e[const static 1], const char *buf, const size_t length)
+{
+  char *dst = emit_reserve(e, length);
+
+  if (dst == NULL) {
+    // too large to be worth copying, e.g., the binary format or a huge string literal
+    emit_write_all(e, buf, length);
+    return;
+  }
+
+  memcpy(dst, buf, length);
+  e->length += length;
+}
+
+#define emit_cstr(e, cstr) emit_bytes((e), (cstr), strlen(cstr))
+#define emit_sv(e, sv) emit_bytes((e), (sv).buf, (sv).length)
+
+__attribute__((format(printf, 2, 3)))
+static void emit_fmt(ast_emitter_t e[const static 1], const char *fmt, ...)
+{
+  va_list args;
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    va_start(args, fmt);
+    const int length = vsnprintf(e->buf + e->length, e->capacity - e->length, fmt, args);
+    va_end(args);
+
+    assertm(length >= 0, "Expected: '%s' to be formatted", fmt);
+
+    if ((size_t)length < e->capacity - e->length) {
+      e->length += (size_t)length;
+      return;
+    }
+
+    emit_flush(e);
+  }
+
+  assertm(false, "Expected: formatted '%s' to fit in the %zu bytes emit buffer", fmt, e->capacity);
+}
+
+static void emit_indent(ast_emitter_t e[const static 1], const size_t depth)
+{
+  const size_t length = depth * 3;
+  char *dst = emit_reserve(e, length);
+
+  if (dst == NULL) {
+    for (size_t i = 0; i < depth; i++) emit_bytes(e, "   ", 3);
+    return;
+  }
+
+  memset(dst, ' ', length);
+  e->length += length;
+}
+
+// mirrors write_type() in types.c for the interned types of the cache file
+static bool write_cache_type(type_writer_t w[const static 1], const ast_cache_t cache[const static 1],
+                             const uint32_t idx, const uint8_t storage)
+{
+  const ast_cache_type_t *type = &cache->types[idx];
+
+  if (type->kind == TYPE_KIND_POINTER) {
+    write_type_pointer(w, type->qualifiers, write_cache_type(w, cache, type->a, storage));
+    return type->qualifiers != 0;
+  }
+
+  const sv_t name = type->specifiers & TYPE_SPEC_NAMED ? sv_from_buf(cache->source + type->a, type->b) : (sv_t){0};
+  write_type_base(w, storage, type->qualifiers, type->specifiers, name);
+
+  return true;
+}
+
+// type spellings contain no characters that need escaping in json
+static void emit_type(ast_emitter_t e[const static 1], const ast_cache_t cache[const static 1], const uint32_t idx)
+{
+  const uint8_t storage = cache->types[idx].storage;
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    type_writer_t w = { .buf = e->buf + e->length, .size = e->capacity - e->length };
+    write_cache_type(&w, cache, idx, storage);
+
+    if (w.length <= w.size) {
+      e->length += w.length;
+      return;
+    }
+
+    emit_flush(e);
+  }
+
+  assertm(false, "Expected: type spelling to fit in the %zu bytes emit buffer", e->capacity);
+}
+
+// folded literals have no source, their value is spelled in the signedness of their type
+static void emit_folded_value(ast_emitter_t e[const static 1], const ast_cache_t cache[const static 1],
+                              const ast_cache_node_t node[const static 1])
+{
+  const uint64_t value = ast_cache_folded_value(node);
+
+  if (node->type && type_is_unsigned(cache->types[node->type - 1u].specifiers)) {
+    emit_fmt(e, "%llu", (unsigned long long)value);
+  } else {
+    emit_fmt(e, "%lld", (long long)value);
+  }
+}
+
+static void emit_json_string(ast_emitter_t e[const static 1], const sv_t sv)
+{
+  static const char hex[] = "0123456789abcdef";
+  size_t start = 0;
+
+  emit_bytes(e, "\"", 1);
+
+  for (size_t i = 0; i < sv.length; i++) {
+    const unsigned char c = (unsigned char)sv.buf[i];
+
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+
+    emit_bytes(e, sv.buf + start, i - start);
+    start = i + 1;
+
+    switch(c) {
+      case '"': emit_bytes(e, "\\\"", 2); break;
+      case '\\': emit_bytes(e, "\\\\", 2); break;
+      case '\n': emit_bytes(e, "\\n", 2); break;
+      case '\t': emit_bytes(e, "\\t", 2); break;
+      case '\r': emit_bytes(e, "\\r", 2); break;
+      default: emit_bytes(e, (char[]){'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]}, 6);
+    }
+  }
+
+  emit_bytes(e, sv.buf + start, sv.length - start);
+  emit_bytes(e, "\"", 1);
+}
+
+// ------------------------------------ TREE WALK ------------------------------------
+
+/**
+ * Every node kind is visited as: open, then for each child "before child i" and the child itself,
+ * then close. Each format only says what to write at those points and the walk below keeps the
+ * pending nodes on an arena backed stack instead of the C stack.
+ */
+typedef struct {
+  uint32_t idx;
+  uint32_t next_child;
+  size_t depth;
+} emit_frame_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  emit_frame_t *items;
+} emit_frames_t;
+
+#define EMIT_FRAMES_MIN_CAP 64
+
+static inline void push_emit_frame(arena_t arena[const static 1], emit_frames_t frames[const static 1], const emit_frame_t frame)
+{
+  if (frames->length == frames->capacity) {
+    const size_t capacity = zdx_max(frames->capacity * 2, EMIT_FRAMES_MIN_CAP);
+
+    frames->items = arena_realloc(arena, frames->items, frames->capacity * sizeof(*frames->items), capacity * sizeof(*frames->items));
+    assertm(!arena->err, "Expected: emit frames resize to be successful, Received: %s", arena->err);
+    frames->capacity = capacity;
+  }
+
+  frames->items[frames->length++] = frame;
+}
+
+static uint32_t cache_child_count(const ast_cache_node_t node[const static 1])
+{
+  switch(node->kind) {
+    case AST_NODE_KIND_LIST: return ast_cache_is_lazy_body(node) ? 0 : node->b;
+    case AST_NODE_KIND_UNARY_OP: return 1;
+    case AST_NODE_KIND_BINARY_OP: return 2;
+    case AST_NODE_KIND_TERNARY: return 3;
+    case AST_NODE_KIND_CALL: return 1 + node->c;
+    case AST_NODE_KIND_DECLARATION: return node->c != AST_CACHE_NO_NODE;
+    case AST_NODE_KIND_FUNCTION: return node->c != AST_CACHE_NO_NODE ? 2 : 1;
+    case AST_NODE_KIND_RETURN: return node->a != AST_CACHE_NO_NODE;
+    default: return 0;
+  }
+}
+
+static uint32_t cache_child(const ast_cache_node_t node[const static 1], const uint32_t i)
+{
+  switch(node->kind) {
+    case AST_NODE_KIND_LIST: return node->a + i;
+    case AST_NODE_KIND_TERNARY: return i == 0 ? node->a : i == 1 ? node->b : node->c;
+    case AST_NODE_KIND_CALL: return i == 0 ? node->a : node->b + i - 1;
+    case AST_NODE_KIND_DECLARATION: return node->c;
+    case AST_NODE_KIND_FUNCTION: return i == 0 ? node->b + 1 : node->c; // params then body
+    default: return i == 0 ? node->a : node->b;
+  }
+}
+
+static sv_t cache_declaration_name(const ast_cache_t cache[const static 1], const ast_cache_node_t node[const static 1])
+{
+  return ast_cache_node_value(cache, ast_cache_node(cache, node->b));
+}
+
+// ------------------------------------ TEXT ------------------------------------
+
+static void text_open(ast_emitter_t e[const static 1], const ast_cache_t cache[const static 1],
+                      const ast_cache_node_t node[const static 1], const size_t depth)
+{
+  emit_indent(e, depth);
+  emit_fmt(e, "Node kind: %s\n", node_kind_name(node->kind));
+
+  if (node->type) {
+    emit_indent(e, depth);
+    emit_cstr(e, "Value type: ");
+    emit_type(e, cache, node->type - 1u);
+    emit_bytes(e, "\n", 1);
+  }
+
+  switch(node->kind) {
+    case AST_NODE_KIND_LITERAL: {
+      emit_indent(e, depth);
+      const bool folded = ast_cache_is_folded_literal(node);
+
+      emit_fmt(e, "Literal kind: %s%s\n", literal_kind_name(node->op & ~AST_CACHE_LITERAL_FOLDED), folded ? " (folded)" : "");
+      emit_indent(e, depth);
+      emit_cstr(e, "Value: ");
+
+      if (folded) {
+        emit_folded_value(e, cache, node);
+      } else {
+        emit_sv(e, ast_cache_node_value(cache, node));
+      }
+
+      emit_bytes(e, "\n", 1);
+    } break;
+
+    case AST_NODE_KIND_SYMBOL: {
+      emit_indent(e, depth);
+      emit_cstr(e, "Value: ");
+      emit_sv(e, ast_cache_node_value(cache, node));
+      emit_bytes(e, "\n", 1);
+
+      if (node->op != SYMBOL_BINDING_NONE) {
+        emit_indent(e, depth);
+        emit_fmt(e, "Binding: %s, Slot: %u\n", symbol_binding_name(node->op), node->c);
+      }
+    } break;
+
+    case AST_NODE_KIND_UNARY_OP: {
+      emit_indent(e, depth);
+      emit_fmt(e, "Op: %s\n", unary_kind_name(node->op));
+    } break;
+
+    case AST_NODE_KIND_BINARY_OP: {
+      emit_indent(e, depth);
+      emit_fmt(e, "Op: %s\n", binary_kind_name(node->op));
+    } break;
+
+    case AST_NODE_KIND_DECLARATION: {
+      emit_indent(e, depth);
+      emit_cstr(e, "Type: ");
+      emit_type(e, cache, node->a);
+      emit_bytes(e, "\n", 1);
+      emit_indent(e, depth);
+      emit_cstr(e, "Name: ");
+      emit_sv(e, cache_declaration_name(cache, node));
+      emit_bytes(e, "\n", 1);
+
+      if (node->c == AST_CACHE_NO_NODE) {
+        emit_indent(e, depth);
+        emit_cstr(e, "Init: None\n");
+      }
+    } break;
+
+    case AST_NODE_KIND_FUNCTION: {
+      emit_indent(e, depth);
+      emit_cstr(e, "Return type: ");
+      emit_type(e, cache, node->a);
+      emit_bytes(e, "\n", 1);
+      emit_indent(e, depth);
+      emit_cstr(e, "Name: ");
+      emit_sv(e, cache_declaration_name(cache, node));
+      emit_bytes(e, "\n", 1);
+    } break;
+
+    case AST_NODE_KIND_LIST: {
+      emit_indent(e, depth);
+
+      if (ast_cache_is_lazy_body(node)) {
+        emit_fmt(e, "Children: Not parsed yet (%u bytes)\n", node->b);
+      } else if (node->b) {
+        emit_fmt(e, "Children: (length = %u)\n", node->b);
+      } else {
+        emit_cstr(e, "Children: None\n");
+      }
+    } break;
+
+    case AST_NODE_KIND_TERNARY:
+    case AST_NODE_KIND_CALL:
+    case AST_NODE_KIND_RETURN: break;
+
+    default: assertm(false, "Missing case of cached ast node of kind %d", node->kind);
+  }
+}
+
+static void text_before_child(ast_emitter_t e[const static 1], const ast_cache_node_t node[const static 1],
+                              const uint32_t i, const size_t depth)
+{
+  static const char *const binary_labels[] = { "Left:\n", "Right:\n" };
+  static const char *const ternary_labels[] = { "Cond:\n", "Then:\n", "Else:\n" };
+
+  switch(node->kind) {
+    case AST_NODE_KIND_UNARY_OP: emit_indent(e, depth); emit_cstr(e, "Expr:\n"); break;
+    case AST_NODE_KIND_BINARY_OP: emit_indent(e, depth); emit_cstr(e, binary_labels[i]); break;
+    case AST_NODE_KIND_TERNARY: emit_indent(e, depth); emit_cstr(e, ternary_labels[i]); break;
+    case AST_NODE_KIND_DECLARATION: emit_indent(e, depth); emit_cstr(e, "Init:\n"); break;
+    case AST_NODE_KIND_FUNCTION: emit_indent(e, depth); emit_cstr(e, i == 0 ? "Params:\n" : "Body:\n"); break;
+    case AST_NODE_KIND_RETURN: emit_indent(e, depth); emit_cstr(e, "Expr:\n"); break;
+    case AST_NODE_KIND_CALL: {
+      if (i == 0) {
+        emit_indent(e, depth);
+        emit_cstr(e, "Callee:\n");
+      } else if (i == 1) {
+        emit_indent(e, depth);
+        emit_fmt(e, "Args: (length = %u)\n", node->c);
+      }
+    } break;
+    default: break;
+  }
+}
+
+static void text_close(ast_emitter_t e[const static 1], const ast_cache_node_t node[const static 1], const size_t depth)
+{
+  if (node->kind == AST_NODE_KIND_CALL && node->c == 0) {
+    emit_indent(e, depth);
+    emit_cstr(e, "Args: None\n");
+  } else if (node->kind == AST_NODE_KIND_FUNCTION && node->c == AST_CACHE_NO_NODE) {
+    emit_indent(e, depth);
+    emit_cstr(e, "Body: None\n");
+  } else if (node->kind == AST_NODE_KIND_RETURN && node->a == AST_CACHE_NO_NODE) {
+    emit_indent(e, depth);
+    emit_cstr(e, "Expr: None\n");
+  }
+
+  if (depth == 0) {
+    emit_cstr(e, "--------------------\n");
+  }
+}
+
+// ------------------------------------ JSON ------------------------------------
+
+static void json_open(ast_emitter_t e[const static 1], const ast_cache_t cache[const static 1],
+                      const ast_cache_node_t node[const static 1])
+{
+  emit_fmt(e, "{\"kind\":\"%s\"", node_kind_name(node->kind));
+
+  if (node->type) {
+    emit_cstr(e, ",\"value_type\":\"");
+    emit_type(e, cache, node->type - 1u);
+    emit_bytes(e, "\"", 1);
+  }
+
+  switch(node->kind) {
+    case AST_NODE_KIND_LITERAL: {
+      emit_fmt(e, ",\"literal_kind\":\"%s\",\"value\":", literal_kind_name(node->op & ~AST_CACHE_LITERAL_FOLDED));
+
+      // a folded value is spelled like the number it'd be in the source
+      if (ast_cache_is_folded_literal(node)) {
+        emit_bytes(e, "\"", 1);
+        emit_folded_value(e, cache, node);
+        emit_cstr(e, "\",\"folded\":true");
+      } else {
+        emit_json_string(e, ast_cache_node_value(cache, node));
+      }
+    } break;
+
+    case AST_NODE_KIND_SYMBOL: {
+      emit_cstr(e, ",\"name\":");
+      emit_json_string(e, ast_cache_node_value(cache, node));
+
+      if (node->op != SYMBOL_BINDING_NONE) {
+        emit_fmt(e, ",\"binding\":\"%s\",\"slot\":%u", symbol_binding_name(node->op), node->c);
+      }
+    } break;
+
+    case AST_NODE_KIND_UNARY_OP: emit_fmt(e, ",\"op\":\"%s\"", unary_kind_name(node->op)); break;
+    case AST_NODE_KIND_BINARY_OP: emit_fmt(e, ",\"op\":\"%s\"", binary_kind_name(node->op)); break;
+
+    case AST_NODE_KIND_DECLARATION: {
+      emit_cstr(e, ",\"type\":\"");
+      emit_type(e, cache, node->a);
+      emit_cstr(e, "\",\"name\":");
+      emit_json_string(e, cache_declaration_name(cache, node));
+      emit_cstr(e, node->c == AST_CACHE_NO_NODE ? ",\"init\":null" : ",\"init\":");
+    } break;
+
+    case AST_NODE_KIND_FUNCTION: {
+      emit_cstr(e, ",\"type\":\"");
+      emit_type(e, cache, node->a);
+      emit_cstr(e, "\",\"name\":");
+      emit_json_string(e, cache_declaration_name(cache, node));
+    } break;
+
+    case AST_NODE_KIND_RETURN: emit_cstr(e, node->a == AST_CACHE_NO_NODE ? ",\"expr\":null" : ",\"expr\":"); break;
+
+    case AST_NODE_KIND_LIST: {
+      if (ast_cache_is_lazy_body(node)) {
+        emit_fmt(e, ",\"children\":null,\"lazy_source_bytes\":%u", node->b);
+      } else {
+        emit_cstr(e, ",\"children\":[");
+      }
+    } break;
+
+    case AST_NODE_KIND_TERNARY:
+    case AST_NODE_KIND_CALL: break;
+
+    default: assertm(false, "Missing case of cached ast node of kind %d", node->kind);
+  }
+}
+
+static void json_before_child(ast_emitter_t e[const static 1], const ast_cache_node_t node[const static 1], const uint32_t i)
+{
+  static const char *const binary_keys[] = { ",\"lhs\":", ",\"rhs\":" };
+  static const char *const ternary_keys[] = { ",\"cond\":", ",\"then\":", ",\"else\":" };
+
+  switch(node->kind) {
+    case AST_NODE_KIND_UNARY_OP: emit_cstr(e, ",\"expr\":"); break;
+    case AST_NODE_KIND_BINARY_OP: emit_cstr(e, binary_keys[i]); break;
+    case AST_NODE_KIND_TERNARY: emit_cstr(e, ternary_keys[i]); break;
+    case AST_NODE_KIND_LIST: if (i > 0) emit_bytes(e, ",", 1); break;
+    case AST_NODE_KIND_CALL: emit_cstr(e, i == 0 ? ",\"callee\":" : i == 1 ? ",\"args\":[" : ","); break;
+    case AST_NODE_KIND_FUNCTION: emit_cstr(e, i == 0 ? ",\"params\":" : ",\"body\":"); break;
+    default: break;
+  }
+}
+
+static void json_close(ast_emitter_t e[const static 1], const ast_cache_node_t node[const static 1], const size_t depth)
+{
+  if (node->kind == AST_NODE_KIND_LIST && !ast_cache_is_lazy_body(node)) {
+    emit_bytes(e, "]", 1);
+  } else if (node->kind == AST_NODE_KIND_CALL) {
+    emit_cstr(e, node->c ? "]" : ",\"args\":[]");
+  } else if (node->kind == AST_NODE_KIND_FUNCTION && node->c == AST_CACHE_NO_NODE) {
+    emit_cstr(e, ",\"body\":null");
+  }
+
+  emit_cstr(e, depth == 0 ? "}\n" : "}");
+}
+
+// ------------------------------------ EMIT ------------------------------------
+
+static void emit_open(ast_emitter_t e[const static 1], const ast_emit_format_t format, const ast_cache_t cache[const static 1],
+                      const ast_cache_node_t node[const static 1], const size_t depth)
+{
+  if (format == AST_EMIT_FORMAT_TEXT) {
+    text_open(e, cache, node, depth);
+  } else {
+    json_open(e, cache, node);
+  }
+}
+
+const char *ast_emit(arena_t arena[const static 1], const int fd, const ast_emit_format_t format,
+                     const ast_cache_t cache[const static 1])
+{
+  assertm(cache->header, "Expected: an opened or encoded cache, Received: %s", cache->err ? cache->err : "no header");
+  assertm(format < AST_EMIT_FORMAT_COUNT, "Invalid ast emit format %d", format);
+
+  ast_emitter_t e = {
+    .fd = fd,
+    .capacity = AST_EMIT_BUFFER_SIZE,
+  };
+  e.buf = arena_alloc(arena, e.capacity);
+
+  if (!e.buf) {
+    return arena->err;
+  }
+
+  if (format == AST_EMIT_FORMAT_BINARY) {
+    emit_bytes(&e, (const char *)cache->header, ast_cache_size(cache->header));
+    emit_flush(&e);
+    return e.err;
+  }
+
+  emit_frames_t frames = {0};
+  const uint32_t root = cache->header->root;
+
+  emit_open(&e, format, cache, ast_cache_node(cache, root), 0);
+  push_emit_frame(arena, &frames, (emit_frame_t){ .idx = root });
+
+  while (frames.length > 0 && !e.err) {
+    emit_frame_t *frame = &frames.items[frames.length - 1];
+    const ast_cache_node_t *node = ast_cache_node(cache, frame->idx);
+
+    if (frame->next_child == cache_child_count(node)) {
+      if (format == AST_EMIT_FORMAT_TEXT) {
+        text_close(&e, node, frame->depth);
+      } else {
+        json_close(&e, node, frame->depth);
+      }
+
+      frames.length--;
+      continue;
+    }
+
+    const uint32_t i = frame->next_child++;
+    const uint32_t child = cache_child(node, i);
+    const size_t depth = frame->depth;
+
+    if (format == AST_EMIT_FORMAT_TEXT) {
+      text_before_child(&e, node, i, depth);
+    } else {
+      json_before_child(&e, node, i);
+    }
+
+    emit_open(&e, format, cache, ast_cache_node(cache, child), depth + 1);
+    // frame is invalidated by the push as it may move the frames
+    push_emit_frame(arena, &frames, (emit_frame_t){ .idx = child, .depth = depth + 1 });
+  }
+
+  emit_flush(&e);
+
+  return e.err;
+}
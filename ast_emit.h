@@ -0,0 +1,33 @@
+#ifndef AST_EMIT_H_
+#define AST_EMIT_H_
+
+#include <stddef.h>
+
+#include "./ast_cache.h"
+
+#include "./zdx_simple_arena.h"
+
+// output is collected in a buffer of this size taken from the arena and written out whenever it fills up
+#define AST_EMIT_BUFFER_SIZE (64 KB)
+
+typedef enum {
+  AST_EMIT_FORMAT_TEXT, // the indented "Node kind: ..." dump
+  AST_EMIT_FORMAT_JSON, // one object per node, children nested under named keys
+  AST_EMIT_FORMAT_BINARY, // the ast cache file layout of ast_cache.h, readable with ast_cache_open()
+  AST_EMIT_FORMAT_COUNT,
+} ast_emit_format_t;
+
+const char *ast_emit_format_name(const ast_emit_format_t format);
+// returns AST_EMIT_FORMAT_COUNT for unknown names
+ast_emit_format_t ast_emit_format_from_cstr(const char name[const static 1]);
+
+/**
+ * Dumps an opened or encoded ast cache to fd. Emitting from the flat cache nodes means freshly parsed
+ * and cached programs are dumped by the same code and the tree is walked without recursion.
+ *
+ * Returns NULL on success and the reason otherwise.
+ */
+const char *ast_emit(arena_t arena[const static 1], const int fd, const ast_emit_format_t format,
+                     const ast_cache_t cache[const static 1]);
+
+#endif // AST_EMIT_H_
@@ -0,0 +1,603 @@
+#include <stdint.h>
+
+#include "./zdx_util.h"
+#include "./fold.h"
+
+// ------------------------------------ VALUES ------------------------------------
+
+// integer type of an expression, NULL if it has another type or none
+static const type_t *integer_type(const folder_t f[const static 1], const ast_node_t node[const static 1])
+{
+  if (node->type == TYPE_NO_ID) {
+    return NULL;
+  }
+
+  const type_t *type = type_by_id(f->types, node->type);
+
+  return type_is_integer(type) ? type : NULL;
+}
+
+static bool constant(const folder_t f[const static 1], const ast_node_t node[const static 1], uint64_t value[const static 1])
+{
+  if (node->kind != AST_NODE_KIND_LITERAL || node->literal.kind != LITERAL_KIND_NUMBER || integer_type(f, node) == NULL) {
+    return false;
+  }
+
+  *value = node->literal.integer;
+  return true;
+}
+
+// constants are truncated to the width of their type and sign extended if it's signed, so that a signed
+// value reads the same as an int64_t whatever its width
+uint64_t fold_normalize(const uint16_t specifiers, const uint64_t value)
+{
+  const unsigned width = type_integer_width(specifiers);
+
+  if (specifiers & TYPE_SPEC_BOOL) {
+    return value != 0;
+  }
+
+  if (width == 64) {
+    return value;
+  }
+
+  const uint64_t bits = value & ((UINT64_C(1) << width) - 1);
+
+  if (type_is_unsigned(specifiers)) {
+    return bits;
+  }
+
+  const uint64_t sign = UINT64_C(1) << (width - 1);
+
+  return (bits ^ sign) - sign;
+}
+
+static inline bool fits(const uint16_t specifiers, const int64_t value)
+{
+  return fold_normalize(specifiers, (uint64_t)value) == (uint64_t)value;
+}
+
+// ------------------------------------ EVALUATION ------------------------------------
+
+// the operand has the type of the operation but for !, which gives an int. False when it's undefined
+bool fold_evaluate_unary(const unary_op_kind_t op, const uint16_t specifiers, const uint64_t v, uint64_t result[const static 1])
+{
+  switch(op) {
+    case UNARY_OP_NOT: *result = v == 0; return true;
+    case UNARY_OP_POSITIVE: *result = v; return true;
+    case UNARY_OP_BIT_NOT: *result = fold_normalize(specifiers, ~v); return true;
+
+    case UNARY_OP_NEGATE: {
+      if (type_is_unsigned(specifiers)) {
+        *result = fold_normalize(specifiers, -v);
+        return true;
+      }
+
+      const int64_t a = (int64_t)v;
+
+      if (a == INT64_MIN || !fits(specifiers, -a)) {
+        return false;
+      }
+
+      *result = (uint64_t)-a;
+      return true;
+    }
+
+    default: return false;
+  }
+}
+
+/**
+ * The operands have the type the operation is done in, ls, but for the rhs of a shift, which is promoted
+ * on its own. False when the operation is undefined for the operands, which is then left for the runtime
+ * to run into like it would without folding.
+ */
+bool fold_evaluate_binary(const binary_op_kind_t op, const uint16_t ls, const uint16_t rs, const uint64_t l, const uint64_t r,
+                          uint64_t result[const static 1])
+{
+  const bool is_unsigned = type_is_unsigned(ls);
+  const unsigned width = type_integer_width(ls);
+  const int64_t a = (int64_t)l;
+  const int64_t b = (int64_t)r;
+  int64_t v = 0;
+
+  switch(op) {
+    case BINARY_OP_LSHIFT:
+    case BINARY_OP_RSHIFT: {
+      if ((!type_is_unsigned(rs) && b < 0) || r >= width) {
+        return false;
+      }
+
+      if (is_unsigned) {
+        *result = fold_normalize(ls, op == BINARY_OP_LSHIFT ? l << r : l >> r);
+        return true;
+      }
+
+      // gcc shifts negative values arithmetically
+      if (op == BINARY_OP_RSHIFT) {
+        *result = (uint64_t)(a >> r);
+        return true;
+      }
+
+      // a signed lhs has to be non-negative and stay below the sign bit
+      if (a < 0 || (a >> (width - 1 - r)) != 0) {
+        return false;
+      }
+
+      *result = (uint64_t)a << r;
+      return true;
+    }
+
+    case BINARY_OP_BIT_AND: *result = l & r; return true;
+    case BINARY_OP_BIT_XOR: *result = l ^ r; return true;
+    case BINARY_OP_BIT_OR: *result = l | r; return true;
+    case BINARY_OP_EQ: *result = l == r; return true;
+    case BINARY_OP_NEQ: *result = l != r; return true;
+    case BINARY_OP_LT: *result = is_unsigned ? l < r : a < b; return true;
+    case BINARY_OP_LTE: *result = is_unsigned ? l <= r : a <= b; return true;
+    case BINARY_OP_GT: *result = is_unsigned ? l > r : a > b; return true;
+    case BINARY_OP_GTE: *result = is_unsigned ? l >= r : a >= b; return true;
+    default: break;
+  }
+
+  if (is_unsigned) {
+    switch(op) {
+      case BINARY_OP_ADD: *result = fold_normalize(ls, l + r); return true;
+      case BINARY_OP_SUB: *result = fold_normalize(ls, l - r); return true;
+      case BINARY_OP_MULT: *result = fold_normalize(ls, l * r); return true;
+      case BINARY_OP_DIV: *result = l / r; return r != 0;
+      case BINARY_OP_MOD: *result = r ? l % r : 0; return r != 0;
+      default: return false;
+    }
+  }
+
+  switch(op) {
+    case BINARY_OP_ADD: {
+      if (__builtin_add_overflow(a, b, &v)) {
+        return false;
+      }
+    } break;
+
+    case BINARY_OP_SUB: {
+      if (__builtin_sub_overflow(a, b, &v)) {
+        return false;
+      }
+    } break;
+
+    case BINARY_OP_MULT: {
+      if (__builtin_mul_overflow(a, b, &v)) {
+        return false;
+      }
+    } break;
+
+    // both are undefined when the quotient doesn't fit, e.g., INT_MIN / -1
+    case BINARY_OP_DIV:
+    case BINARY_OP_MOD: {
+      if (b == 0 || (a == INT64_MIN && b == -1) || !fits(ls, a / b)) {
+        return false;
+      }
+
+      v = op == BINARY_OP_DIV ? a / b : a % b;
+    } break;
+
+    default: return false;
+  }
+
+  if (!fits(ls, v)) {
+    return false;
+  }
+
+  *result = (uint64_t)v;
+  return true;
+}
+
+// ------------------------------------ FOLDING ------------------------------------
+
+typedef enum {
+  FOLD_NONE,
+  FOLD_LITERAL, // the expression is value
+  FOLD_OPERAND, // the expression is operand
+} fold_kind_t;
+
+typedef struct {
+  fold_kind_t kind;
+  uint64_t value;
+  ast_node_t *operand;
+} fold_t;
+
+static inline fold_t fold_literal(const uint64_t value)
+{
+  return (fold_t){ .kind = FOLD_LITERAL, .value = value };
+}
+
+// an operand is only the result if it has the type of the expression
+static inline fold_t fold_operand(const ast_node_t node[const static 1], ast_node_t operand[const static 1])
+{
+  return operand->type == node->type ? (fold_t){ .kind = FOLD_OPERAND, .operand = operand } : (fold_t){0};
+}
+
+// Types have the same layout in every table, so a type name is measured in the table of the parser. String
+// literals are char arrays, which are typed as the pointer they decay to until arrays are parsed, so their
+// size is left for later
+static fold_t fold_layout(const folder_t f[const static 1], const ast_node_t node[const static 1])
+{
+  const ast_node_t *operand = ast_ungroup(node->unary_op.expr);
+  const bool is_string = operand->kind == AST_NODE_KIND_LITERAL && operand->literal.kind == LITERAL_KIND_STRING;
+  type_layout_t layout = {0};
+
+  if (operand->kind == AST_NODE_KIND_DECLARATION) {
+    layout = type_layout(operand->declaration.type);
+  } else if (operand->type != TYPE_NO_ID && !is_string) {
+    layout = type_layout(type_by_id(f->types, operand->type));
+  }
+
+  if (layout.align == 0) {
+    return (fold_t){0};
+  }
+
+  return fold_literal(node->unary_op.kind == UNARY_OP_SIZEOF ? layout.size : layout.align);
+}
+
+static fold_t fold_unary_op(const folder_t f[const static 1], const ast_node_t node[const static 1])
+{
+  const type_t *type = integer_type(f, node);
+  uint64_t v = 0;
+  uint64_t result = 0;
+
+  if (type && (node->unary_op.kind == UNARY_OP_SIZEOF || node->unary_op.kind == UNARY_OP_ALIGNOF)) {
+    return fold_layout(f, node);
+  }
+
+  if (type == NULL || !constant(f, node->unary_op.expr, &v)) {
+    return (fold_t){0};
+  }
+
+  if (node->unary_op.kind == UNARY_OP_CONVERT) {
+    return fold_literal(fold_normalize(type->specifiers, v));
+  }
+
+  return fold_evaluate_unary(node->unary_op.kind, type->specifiers, v, &result) ? fold_literal(result) : (fold_t){0};
+}
+
+// operations that give back one of their operands when the other one is the identity of the operation
+static fold_t fold_identity(const ast_node_t node[const static 1], const uint16_t specifiers, const bool lc, const uint64_t l,
+                            const bool rc, const uint64_t r)
+{
+  ast_node_t *lhs = node->binary_op.lhs;
+  ast_node_t *rhs = node->binary_op.rhs;
+  const uint64_t ones = fold_normalize(specifiers, UINT64_MAX);
+
+  switch(node->binary_op.kind) {
+    case BINARY_OP_ADD:
+    case BINARY_OP_BIT_OR:
+    case BINARY_OP_BIT_XOR: {
+      if (rc && r == 0) return fold_operand(node, lhs);
+      if (lc && l == 0) return fold_operand(node, rhs);
+    } break;
+
+    case BINARY_OP_SUB:
+    case BINARY_OP_LSHIFT:
+    case BINARY_OP_RSHIFT: {
+      if (rc && r == 0) return fold_operand(node, lhs);
+    } break;
+
+    case BINARY_OP_MULT: {
+      if (rc && r == 1) return fold_operand(node, lhs);
+      if (lc && l == 1) return fold_operand(node, rhs);
+    } break;
+
+    case BINARY_OP_DIV: {
+      if (rc && r == 1) return fold_operand(node, lhs);
+    } break;
+
+    case BINARY_OP_BIT_AND: {
+      if (rc && r == ones) return fold_operand(node, lhs);
+      if (lc && l == ones) return fold_operand(node, rhs);
+    } break;
+
+    default: break;
+  }
+
+  return (fold_t){0};
+}
+
+static fold_t fold_binary_op(const folder_t f[const static 1], const ast_node_t node[const static 1])
+{
+  const binary_op_kind_t op = node->binary_op.kind;
+  ast_node_t *lhs = node->binary_op.lhs;
+  ast_node_t *rhs = node->binary_op.rhs;
+  uint64_t l = 0;
+  uint64_t r = 0;
+  uint64_t result = 0;
+  const bool lc = constant(f, lhs, &l);
+  const bool rc = constant(f, rhs, &r);
+
+  switch(op) {
+    // the rhs isn't evaluated once the lhs decides the result
+    case BINARY_OP_LOGICAL_AND:
+    case BINARY_OP_LOGICAL_OR: {
+      if (lc && (op == BINARY_OP_LOGICAL_AND ? l == 0 : l != 0)) {
+        return fold_literal(op == BINARY_OP_LOGICAL_OR);
+      }
+
+      return lc && rc ? fold_literal(r != 0) : (fold_t){0};
+    }
+
+    case BINARY_OP_COMMA: return lc ? fold_operand(node, rhs) : (fold_t){0};
+    default: break;
+  }
+
+  const type_t *type = integer_type(f, node);
+
+  if (type == NULL) {
+    const bool pointer = node->type != TYPE_NO_ID && type_by_id(f->types, node->type)->kind == TYPE_KIND_POINTER;
+
+    // an offset of 0 gives back the pointer
+    if (pointer && (op == BINARY_OP_ADD || op == BINARY_OP_SUB) && rc && r == 0) {
+      return fold_operand(node, lhs);
+    }
+
+    if (pointer && op == BINARY_OP_ADD && lc && l == 0) {
+      return fold_operand(node, rhs);
+    }
+
+    return (fold_t){0};
+  }
+
+  if (lc && rc) {
+    // comparisons are done in the type of their operands, which is the type of the lhs
+    const uint16_t ls = type_by_id(f->types, lhs->type)->specifiers;
+    const uint16_t rs = type_by_id(f->types, rhs->type)->specifiers;
+
+    return fold_evaluate_binary(op, ls, rs, l, r, &result) ? fold_literal(result) : (fold_t){0};
+  }
+
+  return fold_identity(node, type->specifiers, lc, l, rc, r);
+}
+
+static fold_t fold_ternary(const folder_t f[const static 1], const ast_node_t node[const static 1])
+{
+  uint64_t cond = 0;
+
+  if (!constant(f, node->ternary.cond, &cond)) {
+    return (fold_t){0};
+  }
+
+  return fold_operand(node, cond ? node->ternary.then_expr : node->ternary.else_expr);
+}
+
+// the expressions of a group before the last one have no effect if they are constants, so the group is its last one
+static fold_t fold_group(const folder_t f[const static 1], const ast_node_t node[const static 1])
+{
+  const ast_node_list_t *items = node->children;
+  uint64_t v = 0;
+
+  if (items == NULL || items->length == 0) {
+    return (fold_t){0};
+  }
+
+  for (size_t i = 0; i + 1 < items->length; i++) {
+    if (!constant(f, &items->items[i], &v)) {
+      return (fold_t){0};
+    }
+  }
+
+  return (fold_t){ .kind = FOLD_OPERAND, .operand = &items->items[items->length - 1] };
+}
+
+static fold_t fold(const folder_t f[const static 1], const ast_node_t node[const static 1])
+{
+  switch(node->kind) {
+    case AST_NODE_KIND_LIST: return fold_group(f, node);
+    case AST_NODE_KIND_UNARY_OP: return fold_unary_op(f, node);
+    case AST_NODE_KIND_BINARY_OP: return fold_binary_op(f, node);
+    case AST_NODE_KIND_TERNARY: return fold_ternary(f, node);
+    default: return (fold_t){0};
+  }
+}
+
+// first and last token of the expression, the parens around a subexpression aren't a part of it
+static sv_t edge_token(const ast_node_t *node, const bool first)
+{
+  for (;;) {
+    switch(node->kind) {
+      case AST_NODE_KIND_LITERAL: return node->literal.value;
+      case AST_NODE_KIND_SYMBOL: return node->symbol.name;
+      case AST_NODE_KIND_DECLARATION: return node->declaration.name; // of a type name, where its name would be
+      case AST_NODE_KIND_UNARY_OP: node = node->unary_op.expr; break;
+      case AST_NODE_KIND_BINARY_OP: node = first ? node->binary_op.lhs : node->binary_op.rhs; break;
+      case AST_NODE_KIND_TERNARY: node = first ? node->ternary.cond : node->ternary.else_expr; break;
+      case AST_NODE_KIND_LIST: {
+        if (node->children == NULL || node->children->length == 0) {
+          return (sv_t){0};
+        }
+
+        node = &node->children->items[first ? 0 : node->children->length - 1];
+      } break;
+      default: return (sv_t){0};
+    }
+  }
+}
+
+// the value of a folded literal is the source of its expression so that it can still be pointed at
+static ast_node_t folded_literal(const ast_node_t node[const static 1], const uint64_t value)
+{
+  const sv_t first = edge_token(node, true);
+  const sv_t last = edge_token(node, false);
+
+  return (ast_node_t){
+    .kind = AST_NODE_KIND_LITERAL,
+    .type = node->type,
+    .literal = {
+      .kind = LITERAL_KIND_NUMBER,
+      .folded = true,
+      .value = first.buf && last.buf >= first.buf ? sv_from_buf(first.buf, (size_t)(last.buf + last.length - first.buf)) : first,
+      .integer = value,
+    },
+  };
+}
+
+// a node of a single parent is replaced in place
+static void fold_in_place(folder_t f[const static 1], ast_node_t node[const static 1])
+{
+  const fold_t result = fold(f, node);
+
+  if (result.kind == FOLD_NONE) {
+    return;
+  }
+
+  *node = result.kind == FOLD_LITERAL ? folded_literal(node, result.value) : *result.operand;
+  node->shared = false;
+  f->folded++;
+}
+
+static void fold_child(folder_t f[const static 1], ast_node_t *child[const static 1], const bool shared);
+
+// the checker converts children after they were visited, so the operand of a conversion is folded with it
+static void fold_conversion(folder_t f[const static 1], ast_node_t node[const static 1])
+{
+  if (node->kind == AST_NODE_KIND_UNARY_OP && node->unary_op.kind == UNARY_OP_CONVERT) {
+    fold_child(f, &node->unary_op.expr, node->shared);
+  }
+}
+
+// a shared node has other parents, so the parent points to its replacement instead, which is what every
+// parent would replace it with. The new literal is reached once per parent of the parent, so it's shared
+// when the parent is
+static void fold_child(folder_t f[const static 1], ast_node_t *child[const static 1], const bool shared)
+{
+  fold_conversion(f, *child);
+
+  if (!(*child)->shared) {
+    fold_in_place(f, *child);
+    return;
+  }
+
+  const fold_t result = fold(f, *child);
+
+  if (result.kind == FOLD_NONE) {
+    return;
+  }
+
+  if (result.kind == FOLD_OPERAND) {
+    *child = result.operand;
+  } else {
+    ast_node_t *literal = arena_alloc(f->arena, sizeof(*literal));
+    assertm(!f->arena->err, "Expected: folded literal alloc to succeed, Received: %s", f->arena->err);
+    *literal = folded_literal(*child, result.value);
+    literal->shared = shared;
+    *child = literal;
+  }
+
+  f->folded++;
+}
+
+static inline bool is_not(const ast_node_t node[const static 1])
+{
+  return node->kind == AST_NODE_KIND_UNARY_OP && node->unary_op.kind == UNARY_OP_NOT;
+}
+
+// !!x has the truth of x, which is all an operand that is only tested needs
+static void fold_truth(folder_t f[const static 1], ast_node_t *operand[const static 1])
+{
+  while (is_not(*operand) && is_not((*operand)->unary_op.expr)) {
+    *operand = (*operand)->unary_op.expr->unary_op.expr;
+    f->folded++;
+  }
+}
+
+// ------------------------------------ CALLBACKS ------------------------------------
+
+// children are folded again by their parent as the checker may have wrapped them in conversions since
+static void fold_unary_op_node(void *ctx, ast_node_t node[const static 1])
+{
+  folder_t *f = ctx;
+
+  fold_child(f, &node->unary_op.expr, node->shared);
+
+  if (node->unary_op.kind == UNARY_OP_NOT) {
+    fold_truth(f, &node->unary_op.expr);
+  }
+
+  if (!node->shared) {
+    fold_in_place(f, node);
+  }
+}
+
+static void fold_binary_op_node(void *ctx, ast_node_t node[const static 1])
+{
+  folder_t *f = ctx;
+
+  fold_child(f, &node->binary_op.lhs, node->shared);
+  fold_child(f, &node->binary_op.rhs, node->shared);
+
+  if (node->binary_op.kind == BINARY_OP_LOGICAL_AND || node->binary_op.kind == BINARY_OP_LOGICAL_OR) {
+    fold_truth(f, &node->binary_op.lhs);
+    fold_truth(f, &node->binary_op.rhs);
+  }
+
+  if (!node->shared) {
+    fold_in_place(f, node);
+  }
+}
+
+static void fold_ternary_node(void *ctx, ast_node_t node[const static 1])
+{
+  folder_t *f = ctx;
+
+  fold_child(f, &node->ternary.cond, node->shared);
+  fold_child(f, &node->ternary.then_expr, node->shared);
+  fold_child(f, &node->ternary.else_expr, node->shared);
+  fold_truth(f, &node->ternary.cond);
+
+  if (!node->shared) {
+    fold_in_place(f, node);
+  }
+}
+
+// args are values in the list of the call, so they are only ever replaced in place
+static void fold_call_node(void *ctx, ast_node_t node[const static 1])
+{
+  folder_t *f = ctx;
+
+  for (size_t i = 0; node->call.args && i < node->call.args->length; i++) {
+    fold_conversion(f, &node->call.args->items[i]);
+    fold_in_place(f, &node->call.args->items[i]);
+  }
+}
+
+static void fold_declaration_node(void *ctx, ast_node_t node[const static 1])
+{
+  folder_t *f = ctx;
+
+  if (node->declaration.init) {
+    fold_child(f, &node->declaration.init, false);
+  }
+}
+
+static void fold_return_node(void *ctx, ast_node_t node[const static 1])
+{
+  folder_t *f = ctx;
+
+  if (node->ret.expr) {
+    fold_child(f, &node->ret.expr, false);
+  }
+}
+
+pass_t fold_pass(folder_t folder[const static 1])
+{
+  assertm(folder->arena && folder->types, "Expected: the folder to have an arena and the type table of the checker");
+
+  return (pass_t){
+    .name = "fold",
+    .ctx = folder,
+    .post = {
+      [AST_NODE_KIND_UNARY_OP] = fold_unary_op_node,
+      [AST_NODE_KIND_BINARY_OP] = fold_binary_op_node,
+      [AST_NODE_KIND_TERNARY] = fold_ternary_node,
+      [AST_NODE_KIND_CALL] = fold_call_node,
+      [AST_NODE_KIND_DECLARATION] = fold_declaration_node,
+      [AST_NODE_KIND_RETURN] = fold_return_node,
+    },
+  };
+}
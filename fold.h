@@ -0,0 +1,49 @@
+#ifndef FOLD_H_
+#define FOLD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "./parser2.h"
+#include "./passes.h"
+#include "./types.h"
+
+#include "./zdx_simple_arena.h"
+
+typedef struct {
+  // the fields to set before registering the pass
+  arena_t *arena;
+  const type_table_t *types; // of the type checker, which the node types are ids in
+
+  size_t folded; // expressions replaced by a literal or by one of their operands so far
+} folder_t;
+
+/**
+ * Pass that evaluates the integer expressions whose operands are all constants while compiling, e.g.,
+ * 100 + 10 becomes a literal 110, so that an interpreter doesn't redo them every time they are run. The
+ * value is computed in the type the checker gave the expression, with its width and signedness, and an
+ * expression whose behavior is undefined, e.g., a signed overflow, a division by zero or a shift by more
+ * than the width, is left for the runtime. Floating expressions aren't folded. sizeof and _Alignof become the
+ * size and alignment of their operand's type (see type_layout()) if it has a known one, the operand is dropped
+ * without being evaluated like the standard says.
+ *
+ * Integer operations with an identity operand become the other operand (x + 0, x * 1, x << 0, etc.),
+ * the unevaluated operand of && and || with a constant lhs and the unselected branch of a ternary with a
+ * constant condition are dropped, and !!x is x where only its truth matters, i.e., as a condition, an
+ * operand of &&, || or !. Parens around an expression are dropped as well.
+ *
+ * Nodes are typed by the checker, so it has to be registered before the folder. A folded node of a single
+ * parent is replaced in place and every parent of a shared node points to its replacement instead.
+ */
+pass_t fold_pass(folder_t folder[const static 1]);
+
+// The arithmetic of the folder, for optimizations that evaluate integer operations of constants too, e.g., the
+// constant propagation of ir_opt.h. Signed values are kept sign extended to 64 bits, the evaluations return false
+// when the operation is undefined for the operands and the caller should leave it for the runtime.
+uint64_t fold_normalize(const uint16_t specifiers, const uint64_t value);
+bool fold_evaluate_unary(const unary_op_kind_t op, const uint16_t specifiers, const uint64_t v, uint64_t result[const static 1]);
+// ls are the specifiers of the type the operation is done in, rs of the rhs, which only differ for shifts
+bool fold_evaluate_binary(const binary_op_kind_t op, const uint16_t ls, const uint16_t rs, const uint64_t l, const uint64_t r,
+                          uint64_t result[const static 1]);
+
+#endif // FOLD_H_
@@ -0,0 +1,500 @@
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "./zdx_util.h"
+#include "./format.h"
+
+// ------------------------------------ COMPILING ------------------------------------
+
+// the length of s up to its nul character or max, strnlen() isn't c17
+static size_t length_within(const char s[const static 1], const size_t max)
+{
+  const char *nul = memchr(s, '\0', max);
+
+  return nul ? (size_t)(nul - s) : max;
+}
+
+typedef struct {
+  format_plan_t plan;
+  const char *format;
+  size_t length;
+  size_t cursor;
+} compiler_t;
+
+static void add_literal(compiler_t c[const static 1], const char text[const static 1], const size_t length)
+{
+  format_plan_t *plan = &c->plan;
+  format_step_t *last = plan->step_count ? &plan->steps[plan->step_count - 1] : NULL;
+
+  // runs of text and %% are one step, as their text is contiguous
+  if (last == NULL || last->kind != FORMAT_STEP_LITERAL || last->offset + last->text_length != plan->text_length) {
+    plan->steps[plan->step_count++] = (format_step_t){ .kind = FORMAT_STEP_LITERAL, .offset = plan->text_length };
+    last = &plan->steps[plan->step_count - 1];
+  }
+
+  memcpy(&plan->text[plan->text_length], text, length);
+  plan->text_length += (uint32_t)length;
+  last->text_length += (uint32_t)length;
+}
+
+// a width or a precision, of digits or a *
+static bool parse_number(compiler_t c[const static 1], int32_t number[const static 1])
+{
+  if (c->cursor < c->length && c->format[c->cursor] == '*') {
+    c->cursor++;
+    c->plan.args[c->plan.arg_count++] = FORMAT_ARG_INT;
+    *number = FORMAT_FROM_ARG;
+    return true;
+  }
+
+  int64_t value = 0;
+
+  for (; c->cursor < c->length && c->format[c->cursor] >= '0' && c->format[c->cursor] <= '9'; c->cursor++) {
+    value = value * 10 + (c->format[c->cursor] - '0');
+
+    if (value > INT32_MAX) {
+      c->plan.err = "Width or precision is too large";
+      return false;
+    }
+  }
+
+  *number = (int32_t)value;
+  return true;
+}
+
+static format_length_t parse_length(compiler_t c[const static 1])
+{
+  const char *at = &c->format[c->cursor];
+  const size_t left = c->length - c->cursor;
+  format_length_t length = FORMAT_LENGTH_NONE;
+
+  switch(left > 0 ? at[0] : 0) {
+    case 'h': length = left > 1 && at[1] == 'h' ? FORMAT_LENGTH_HH : FORMAT_LENGTH_H; break;
+    case 'l': length = left > 1 && at[1] == 'l' ? FORMAT_LENGTH_LL : FORMAT_LENGTH_L; break;
+    case 'j': length = FORMAT_LENGTH_J; break;
+    case 'z': length = FORMAT_LENGTH_Z; break;
+    case 't': length = FORMAT_LENGTH_T; break;
+    case 'L': length = FORMAT_LENGTH_LONG_DOUBLE; break;
+    default: return FORMAT_LENGTH_NONE;
+  }
+
+  c->cursor += length == FORMAT_LENGTH_HH || length == FORMAT_LENGTH_LL ? 2 : 1;
+  return length;
+}
+
+// the kind of step of a conversion and what its arg has to be, false if the length doesn't go with it
+static bool conversion(const char spec, const format_length_t length, format_step_kind_t kind[const static 1],
+                       format_arg_t arg[const static 1])
+{
+  const bool integer_length = length != FORMAT_LENGTH_LONG_DOUBLE;
+  const format_arg_t integer = length == FORMAT_LENGTH_NONE || length == FORMAT_LENGTH_HH || length == FORMAT_LENGTH_H ?
+    FORMAT_ARG_INT : FORMAT_ARG_LONG;
+
+  switch(spec) {
+    case 'd':
+    case 'i': *kind = FORMAT_STEP_SIGNED; *arg = integer; return integer_length;
+    case 'u': *kind = FORMAT_STEP_UNSIGNED; *arg = integer; return integer_length;
+    case 'o': *kind = FORMAT_STEP_OCTAL; *arg = integer; return integer_length;
+    case 'x':
+    case 'X': *kind = FORMAT_STEP_HEX; *arg = integer; return integer_length;
+    case 'c': *kind = FORMAT_STEP_CHAR; *arg = FORMAT_ARG_INT; return length == FORMAT_LENGTH_NONE;
+    case 's': *kind = FORMAT_STEP_STRING; *arg = FORMAT_ARG_STRING; return length == FORMAT_LENGTH_NONE;
+    case 'p': *kind = FORMAT_STEP_POINTER; *arg = FORMAT_ARG_POINTER; return length == FORMAT_LENGTH_NONE;
+
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A': {
+      *kind = FORMAT_STEP_FLOATING;
+      *arg = length == FORMAT_LENGTH_LONG_DOUBLE ? FORMAT_ARG_LONG_DOUBLE : FORMAT_ARG_DOUBLE;
+      return length == FORMAT_LENGTH_NONE || length == FORMAT_LENGTH_L || length == FORMAT_LENGTH_LONG_DOUBLE;
+    }
+
+    default: return false;
+  }
+}
+
+// the printf spec a floating step is written with, its width and precision are always passed as args
+static void add_floating_spec(compiler_t c[const static 1], format_step_t step[const static 1])
+{
+  static const struct { uint8_t flag; char c; } flags[] = {
+    { FORMAT_FLAG_LEFT, '-' },
+    { FORMAT_FLAG_PLUS, '+' },
+    { FORMAT_FLAG_SPACE, ' ' },
+    { FORMAT_FLAG_ALT, '#' },
+    { FORMAT_FLAG_ZERO, '0' },
+  };
+  format_plan_t *plan = &c->plan;
+
+  step->offset = plan->text_length;
+  plan->text[plan->text_length++] = '%';
+
+  for (size_t i = 0; i < zdx_arr_len(flags); i++) {
+    if (step->flags & flags[i].flag) {
+      plan->text[plan->text_length++] = flags[i].c;
+    }
+  }
+
+  memcpy(&plan->text[plan->text_length], "*.*", 3);
+  plan->text_length += 3;
+
+  if (step->length == FORMAT_LENGTH_LONG_DOUBLE) {
+    plan->text[plan->text_length++] = 'L';
+  }
+
+  plan->text[plan->text_length++] = step->spec;
+  plan->text[plan->text_length++] = '\0';
+  step->text_length = plan->text_length - step->offset - 1;
+}
+
+static bool parse_conversion(compiler_t c[const static 1])
+{
+  static const char flag_chars[] = "-+ #0";
+  format_step_t step = { .width = FORMAT_NONE, .precision = FORMAT_NONE };
+  const char *flag = NULL;
+
+  while (c->cursor < c->length && c->format[c->cursor] && (flag = strchr(flag_chars, c->format[c->cursor]))) {
+    step.flags |= (uint8_t)(1 << (flag - flag_chars));
+    c->cursor++;
+  }
+
+  if (c->cursor < c->length && (c->format[c->cursor] == '*' || (c->format[c->cursor] >= '0' && c->format[c->cursor] <= '9')) &&
+      !parse_number(c, &step.width)) {
+    return false;
+  }
+
+  if (c->cursor < c->length && c->format[c->cursor] == '.') {
+    c->cursor++;
+
+    if (!parse_number(c, &step.precision)) {
+      return false;
+    }
+  }
+
+  step.length = (uint8_t)parse_length(c);
+
+  if (c->cursor == c->length) {
+    c->plan.err = "Incomplete conversion specifier at the end of the format";
+    return false;
+  }
+
+  step.spec = c->format[c->cursor++];
+
+  if (step.spec == 'n') {
+    c->plan.err = "The %n conversion isn't supported";
+    return false;
+  }
+
+  format_step_kind_t kind = FORMAT_STEP_LITERAL;
+  format_arg_t arg = FORMAT_ARG_INT;
+
+  if (!conversion(step.spec, step.length, &kind, &arg)) {
+    c->plan.err = "Invalid conversion specifier or length modifier";
+    return false;
+  }
+
+  step.kind = (uint8_t)kind;
+  c->plan.args[c->plan.arg_count++] = (uint8_t)arg;
+
+  if (kind == FORMAT_STEP_FLOATING) {
+    add_floating_spec(c, &step);
+  }
+
+  c->plan.steps[c->plan.step_count++] = step;
+  return true;
+}
+
+format_plan_t format_compile(arena_t arena[const static 1], const char text[const static 1], const size_t length)
+{
+  // a conversion takes at least 2 characters and has at most 2 args and a floating spec of at most 12 characters
+  const size_t capacity = length + 1;
+  compiler_t c = {
+    .plan = {
+      .steps = arena_calloc(arena, capacity, sizeof(*c.plan.steps)),
+      .args = arena_calloc(arena, capacity, sizeof(*c.plan.args)),
+      .text = arena_calloc(arena, capacity * 7, sizeof(*c.plan.text)),
+    },
+    .format = text,
+    // like printf, the format ends at a nul character
+    .length = length_within(text, length),
+  };
+
+  assertm(!arena->err, "Expected: format plan alloc to succeed, Received: %s", arena->err);
+
+  while (c.cursor < c.length && !c.plan.err) {
+    const char *percent = memchr(&c.format[c.cursor], '%', c.length - c.cursor);
+    const size_t run = percent ? (size_t)(percent - &c.format[c.cursor]) : c.length - c.cursor;
+
+    if (run > 0) {
+      add_literal(&c, &c.format[c.cursor], run);
+      c.cursor += run;
+      continue;
+    }
+
+    c.cursor++;
+
+    if (c.cursor < c.length && c.format[c.cursor] == '%') {
+      add_literal(&c, "%", 1);
+      c.cursor++;
+    } else {
+      parse_conversion(&c);
+    }
+  }
+
+  return c.plan;
+}
+
+const ast_node_t *format_literal(const ast_node_list_t *args)
+{
+  if (args == NULL || args->length == 0) {
+    return NULL;
+  }
+
+  const ast_node_t *format = ast_ungroup(&args->items[0]);
+
+  return format->kind == AST_NODE_KIND_LITERAL && format->literal.kind == LITERAL_KIND_STRING ? format : NULL;
+}
+
+const char *format_arg_name(const format_arg_t arg)
+{
+  static const char *format_arg_to_str[] = {
+    "int",
+    "long",
+    "double",
+    "long double",
+    "char *",
+    "void *",
+  };
+
+  _Static_assert(zdx_arr_len(format_arg_to_str) == FORMAT_ARG_COUNT, "Some format args are missing their names");
+  assertm(arg < FORMAT_ARG_COUNT, "Invalid format arg %d", arg);
+
+  return format_arg_to_str[arg];
+}
+
+// ------------------------------------ PRINTING ------------------------------------
+
+#define FORMAT_BUFFER_SIZE 512
+
+// output is gathered here and written to the file in blocks
+typedef struct {
+  FILE *out;
+  char buf[FORMAT_BUFFER_SIZE];
+  size_t length;
+  size_t written;
+  bool err;
+} printer_t;
+
+static void flush(printer_t p[const static 1])
+{
+  if (p->length > 0 && fwrite(p->buf, 1, p->length, p->out) != p->length) {
+    p->err = true;
+  }
+
+  p->length = 0;
+}
+
+static void put(printer_t p[const static 1], const char *text, size_t length)
+{
+  p->written += length;
+
+  while (length > 0) {
+    const size_t n = zdx_min(length, FORMAT_BUFFER_SIZE - p->length);
+
+    memcpy(&p->buf[p->length], text, n);
+    p->length += n;
+    text += n;
+    length -= n;
+
+    if (p->length == FORMAT_BUFFER_SIZE) {
+      flush(p);
+    }
+  }
+}
+
+static void pad(printer_t p[const static 1], const char c, size_t count)
+{
+  char chunk[32];
+
+  memset(chunk, c, sizeof(chunk));
+
+  for (; count > 0; count -= zdx_min(count, sizeof(chunk))) {
+    put(p, chunk, zdx_min(count, sizeof(chunk)));
+  }
+}
+
+// text with a prefix, e.g., a sign or 0x, padded to the width on the side and with the character the flags say
+static void put_padded(printer_t p[const static 1], const format_step_t step[const static 1], const int32_t width,
+                       const char *prefix, const size_t zeros, const char *text, const size_t length)
+{
+  const size_t prefix_length = strlen(prefix);
+  const size_t total = prefix_length + zeros + length;
+  const size_t padding = width > 0 && (size_t)width > total ? (size_t)width - total : 0;
+  const bool left = step->flags & FORMAT_FLAG_LEFT;
+  // the 0 flag pads with zeros between the prefix and the digits, unless there is a precision or a -
+  const bool zero = (step->flags & FORMAT_FLAG_ZERO) && !left && step->precision == FORMAT_NONE && step->kind != FORMAT_STEP_STRING &&
+    step->kind != FORMAT_STEP_CHAR;
+
+  if (!left && !zero) {
+    pad(p, ' ', padding);
+  }
+
+  put(p, prefix, prefix_length);
+  pad(p, '0', zeros + (zero ? padding : 0));
+  put(p, text, length);
+
+  if (left) {
+    pad(p, ' ', padding);
+  }
+}
+
+// digits of value in base, written backwards to the character before end, returns where they start
+static char *digits_of(uint64_t value, const unsigned base, const bool upper, char *end)
+{
+  const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  char *at = end;
+
+  do {
+    *--at = digits[value % base];
+    value /= base;
+  } while (value > 0);
+
+  return at;
+}
+
+// the arg of an integer step converted to the type its length says, as the magnitude and whether it's negative
+static uint64_t integer_arg(const format_step_t step[const static 1], const uint64_t arg, bool negative[const static 1])
+{
+  int64_t value = 0;
+
+  *negative = false;
+
+  if (step->kind != FORMAT_STEP_SIGNED) {
+    switch(step->length) {
+      case FORMAT_LENGTH_NONE: return (unsigned)arg;
+      case FORMAT_LENGTH_HH: return (unsigned char)arg;
+      case FORMAT_LENGTH_H: return (unsigned short)arg;
+      default: return arg;
+    }
+  }
+
+  switch(step->length) {
+    case FORMAT_LENGTH_NONE: value = (int)arg; break;
+    case FORMAT_LENGTH_HH: value = (signed char)arg; break;
+    case FORMAT_LENGTH_H: value = (short)arg; break;
+    default: value = (int64_t)arg; break;
+  }
+
+  *negative = value < 0;
+  return value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+}
+
+static void print_integer(printer_t p[const static 1], const format_step_t step[const static 1], const int32_t width,
+                          const int32_t precision, const uint64_t arg)
+{
+  char buf[32];
+  bool negative = false;
+  const uint64_t value = integer_arg(step, arg, &negative);
+  const unsigned base = step->kind == FORMAT_STEP_OCTAL ? 8 : step->kind == FORMAT_STEP_HEX ? 16 : 10;
+  char *end = &buf[sizeof(buf)];
+  char *digits = digits_of(value, base, step->spec == 'X', end);
+  size_t length = (size_t)(end - digits);
+  const char *prefix = "";
+
+  // a precision of 0 writes no digits for 0
+  if (precision == 0 && value == 0) {
+    length = 0;
+  }
+
+  size_t zeros = precision > 0 && (size_t)precision > length ? (size_t)precision - length : 0;
+
+  if (step->kind == FORMAT_STEP_SIGNED) {
+    prefix = negative ? "-" : step->flags & FORMAT_FLAG_PLUS ? "+" : step->flags & FORMAT_FLAG_SPACE ? " " : "";
+  } else if (step->kind == FORMAT_STEP_HEX && (step->flags & FORMAT_FLAG_ALT) && value != 0) {
+    prefix = step->spec == 'X' ? "0X" : "0x";
+  } else if (step->kind == FORMAT_STEP_OCTAL && (step->flags & FORMAT_FLAG_ALT) && zeros == 0 && (length == 0 || digits[0] != '0')) {
+    zeros = 1;
+  }
+
+  put_padded(p, step, width, prefix, zeros, digits, length);
+}
+
+int format_print(FILE *out, const format_plan_t plan[const static 1], const format_value_t args[])
+{
+  assertm(plan->err == NULL, "Expected: a valid format plan, Received: %s", plan->err);
+
+  printer_t p = { .out = out };
+  size_t next = 0;
+
+  for (uint32_t i = 0; i < plan->step_count; i++) {
+    const format_step_t *step = &plan->steps[i];
+    int32_t width = step->width == FORMAT_FROM_ARG ? (int32_t)(int)args[next++].integer : step->width;
+    int32_t precision = step->precision == FORMAT_FROM_ARG ? (int32_t)(int)args[next++].integer : step->precision;
+    format_step_t from_args = *step;
+    // floating steps are written by printf with their spec, which takes a negative width as the - flag itself
+    const int32_t spec_width = width < 0 && step->width != FORMAT_FROM_ARG ? 0 : width;
+
+    // a negative width from an arg is the - flag and a negative precision none, like printf takes them
+    if (width < 0 && step->width == FORMAT_FROM_ARG) {
+      from_args.flags |= FORMAT_FLAG_LEFT;
+      width = width == INT32_MIN ? INT32_MAX : -width;
+    }
+
+    precision = precision < 0 ? FORMAT_NONE : precision;
+    from_args.precision = precision;
+
+    switch(step->kind) {
+      case FORMAT_STEP_LITERAL: put(&p, &plan->text[step->offset], step->text_length); break;
+
+      case FORMAT_STEP_SIGNED:
+      case FORMAT_STEP_UNSIGNED:
+      case FORMAT_STEP_OCTAL:
+      case FORMAT_STEP_HEX: print_integer(&p, &from_args, width, precision, args[next++].integer); break;
+
+      case FORMAT_STEP_CHAR: {
+        const char c = (char)(unsigned char)args[next++].integer;
+        put_padded(&p, &from_args, width, "", 0, &c, 1);
+      } break;
+
+      case FORMAT_STEP_STRING: {
+        const char *s = args[next++].string;
+        s = s ? s : "(null)";
+        put_padded(&p, &from_args, width, "", 0, s, precision >= 0 ? length_within(s, (size_t)precision) : strlen(s));
+      } break;
+
+      case FORMAT_STEP_POINTER: {
+        const void *pointer = args[next++].pointer;
+        char buf[32];
+        char *end = &buf[sizeof(buf)];
+        char *digits = digits_of((uint64_t)(uintptr_t)pointer, 16, false, end);
+
+        if (pointer == NULL) {
+          put_padded(&p, &from_args, width, "", 0, "(nil)", 5);
+        } else {
+          put_padded(&p, &from_args, width, "0x", 0, digits, (size_t)(end - digits));
+        }
+      } break;
+
+      case FORMAT_STEP_FLOATING: {
+        const format_value_t value = args[next++];
+        const int n = step->length == FORMAT_LENGTH_LONG_DOUBLE ?
+          (flush(&p), fprintf(out, &plan->text[step->offset], spec_width, precision, value.long_floating)) :
+          (flush(&p), fprintf(out, &plan->text[step->offset], spec_width, precision, value.floating));
+
+        p.err = p.err || n < 0;
+        p.written += n < 0 ? 0 : (size_t)n;
+      } break;
+
+      default: assertm(false, "Invalid format step %d", step->kind);
+    }
+  }
+
+  flush(&p);
+
+  return p.err ? -1 : (int)zdx_min(p.written, (size_t)INT_MAX);
+}
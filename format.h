@@ -0,0 +1,112 @@
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "./parser2.h"
+
+#include "./zdx_simple_arena.h"
+
+// the extern whose calls with a string literal format are compiled, the output path of scripts
+#define FORMAT_PRINTF "printf"
+// width or precision of a step that has none
+#define FORMAT_NONE -1
+// width or precision of a step that takes it from an int arg, as in %*d
+#define FORMAT_FROM_ARG -2
+
+typedef enum {
+  FORMAT_STEP_LITERAL, // text of the plan from offset to offset + text_length, written as is, %% included
+  FORMAT_STEP_SIGNED, // d and i
+  FORMAT_STEP_UNSIGNED, // u
+  FORMAT_STEP_OCTAL, // o
+  FORMAT_STEP_HEX, // x and X, spec tells which
+  FORMAT_STEP_CHAR, // c
+  FORMAT_STEP_STRING, // s
+  FORMAT_STEP_POINTER, // p
+  FORMAT_STEP_FLOATING, // f, F, e, E, g, G, a and A, text is the printf spec it's written with, see format_print()
+  FORMAT_STEP_COUNT,
+} format_step_kind_t;
+
+typedef enum {
+  FORMAT_FLAG_LEFT  = 1 << 0, // -
+  FORMAT_FLAG_PLUS  = 1 << 1, // +
+  FORMAT_FLAG_SPACE = 1 << 2, // ' '
+  FORMAT_FLAG_ALT   = 1 << 3, // #
+  FORMAT_FLAG_ZERO  = 1 << 4, // 0
+} format_flag_t;
+
+typedef enum {
+  FORMAT_LENGTH_NONE,
+  FORMAT_LENGTH_HH,
+  FORMAT_LENGTH_H,
+  FORMAT_LENGTH_L,
+  FORMAT_LENGTH_LL,
+  FORMAT_LENGTH_J,
+  FORMAT_LENGTH_Z,
+  FORMAT_LENGTH_T,
+  FORMAT_LENGTH_LONG_DOUBLE, // L
+  FORMAT_LENGTH_COUNT,
+} format_length_t;
+
+// what a data arg has to be after the default argument promotions, by the step that consumes it
+typedef enum {
+  FORMAT_ARG_INT, // int or unsigned, of a * width or precision, c and the integers without a length, hh or h
+  FORMAT_ARG_LONG, // long or unsigned long, of the integers with l, ll, j, z or t
+  FORMAT_ARG_DOUBLE,
+  FORMAT_ARG_LONG_DOUBLE,
+  FORMAT_ARG_STRING, // pointer to a char type
+  FORMAT_ARG_POINTER, // pointer to anything
+  FORMAT_ARG_COUNT,
+} format_arg_t;
+
+typedef struct {
+  uint8_t kind; // format_step_kind_t
+  uint8_t flags; // format_flag_t
+  uint8_t length; // format_length_t
+  char spec; // the conversion character, e.g., x or g
+  int32_t width; // FORMAT_NONE, FORMAT_FROM_ARG or the minimum number of characters
+  int32_t precision; // FORMAT_NONE, FORMAT_FROM_ARG or the precision
+  uint32_t offset; // in format_plan_t.text
+  uint32_t text_length;
+} format_step_t;
+
+/**
+ * A printf format compiled into the steps that write it: runs of literal text, with %% turned into %, and
+ * conversions with their flags, width, precision and length already parsed, so that writing it never looks at a
+ * % again. args says what each data arg has to be, in order.
+ */
+typedef struct {
+  format_step_t *steps;
+  uint32_t step_count;
+  uint8_t *args; // format_arg_t of each data arg
+  uint32_t arg_count;
+  char *text;
+  uint32_t text_length;
+  const char *err; // why the format is invalid, NULL if it isn't
+} format_plan_t;
+
+// the value of a data arg, integers are passed as their 64 bit value, which a step converts to its own type
+typedef union {
+  uint64_t integer;
+  double floating;
+  long double long_floating;
+  const char *string;
+  const void *pointer;
+} format_value_t;
+
+// compiles the decoded text of a string literal, see string_pool.h, into a plan
+format_plan_t format_compile(arena_t arena[const static 1], const char text[const static 1], const size_t length);
+// the string literal a call passes as its format, the first arg, NULL if it has no literal one
+const ast_node_t *format_literal(const ast_node_list_t *args);
+const char *format_arg_name(const format_arg_t arg);
+/**
+ * The runtime of a compiled printf: writes the steps of a valid plan to out with the data args, which have to be
+ * at least plan->arg_count and of the kinds of plan->args. Integers, chars, strings and pointers are written
+ * without the C library, floating values with the printf spec their step keeps. Returns the number of characters
+ * written, or a negative value on an output error, like printf.
+ */
+int format_print(FILE *out, const format_plan_t plan[const static 1], const format_value_t args[]);
+
+#endif // FORMAT_H_
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./format.h"
+
+#include "./zdx_util.h"
+
+#define ZDX_SIMPLE_ARENA_IMPLEMENTATION
+#include "./zdx_simple_arena.h"
+
+// the data args of a plan, e.g., VALUES({ .integer = 42 }, { .floating = 1.5 })
+#define VALUES(...) ((format_value_t[]){ __VA_ARGS__, { 0 } })
+
+// format_print() of format with values has to write what snprintf() does with the same args
+#define CHECK(format, values, ...)                                                \
+  do {                                                                            \
+    char expected[256];                                                           \
+    const int expected_n = snprintf(expected, sizeof(expected), format, __VA_ARGS__); \
+    failed += !check(&arena, format, values, expected, expected_n);               \
+  } while (0)
+
+static bool check(arena_t arena[const static 1], const char format[const static 1], const format_value_t values[],
+                  const char expected[const static 1], const int expected_n)
+{
+  const format_plan_t plan = format_compile(arena, format, strlen(format));
+
+  if (plan.err) {
+    printf("FAIL \"%s\": %s\n", format, plan.err);
+    return false;
+  }
+
+  char *received = NULL;
+  size_t received_length = 0;
+  FILE *out = open_memstream(&received, &received_length);
+  assertm(out, "Expected: open_memstream to succeed");
+
+  const int n = format_print(out, &plan, values);
+  fclose(out);
+
+  const bool ok = n == expected_n && strcmp(received, expected) == 0;
+
+  if (!ok) {
+    printf("FAIL \"%s\": Expected: \"%s\" (%d), Received: \"%s\" (%d)\n", format, expected, expected_n, received, n);
+  }
+
+  free(received);
+  return ok;
+}
+
+// gcc -O2 -g -std=c17 -D_DEFAULT_SOURCE -Wall -Wextra -o format_test format_test.c format.c lexer.c parser2.c types.c && ./format_test
+int main(void)
+{
+  arena_t arena = arena_create(1 MB);
+  size_t failed = 0;
+
+  // literal text and %%, which is written as %
+  CHECK("100%% of %d%%", VALUES({ .integer = 7 }), 7);
+
+  // integers with each flag, width and precision
+  CHECK("[%d] [%i] [%u]", VALUES({ .integer = (uint64_t)-42 }, { .integer = 42 }, { .integer = 42 }), -42, 42, 42u);
+  CHECK("[%5d] [%-5d] [%05d] [%+d] [% d] [%+05d]",
+        VALUES({ .integer = 42 }, { .integer = 42 }, { .integer = (uint64_t)-42 }, { .integer = 42 }, { .integer = 42 },
+               { .integer = 42 }),
+        42, 42, -42, 42, 42, 42);
+  CHECK("[%.5d] [%8.3d] [%-8.3d] [%+8.3d] [%.0d] [%5.0d]",
+        VALUES({ .integer = 42 }, { .integer = (uint64_t)-42 }, { .integer = 42 }, { .integer = 42 }, { .integer = 0 },
+               { .integer = 0 }),
+        42, -42, 42, 42, 0, 0);
+  CHECK("[%o] [%#o] [%#.0o] [%x] [%X] [%#x] [%#X] [%#08x] [%#x]",
+        VALUES({ .integer = 8 }, { .integer = 8 }, { .integer = 0 }, { .integer = 255 }, { .integer = 255 },
+               { .integer = 255 }, { .integer = 255 }, { .integer = 255 }, { .integer = 0 }),
+        8u, 8u, 0u, 255u, 255u, 255u, 255u, 255u, 0u);
+  CHECK("[%hhd] [%hd] [%hhu] [%hu]",
+        VALUES({ .integer = 300 }, { .integer = 70000 }, { .integer = (uint64_t)-1 }, { .integer = (uint64_t)-1 }),
+        300, 70000, -1, -1);
+  CHECK("[%ld] [%lld] [%lu] [%llx] [%zu] [%jd] [%td]",
+        VALUES({ .integer = (uint64_t)INT64_MIN }, { .integer = (uint64_t)INT64_MAX }, { .integer = UINT64_MAX },
+               { .integer = UINT64_MAX }, { .integer = 12 }, { .integer = (uint64_t)-12 }, { .integer = 12 }),
+        (long)INT64_MIN, (long long)INT64_MAX, (unsigned long)UINT64_MAX, (unsigned long long)UINT64_MAX, (size_t)12,
+        (intmax_t)-12, (ptrdiff_t)12);
+  CHECK("[%d] [%d]", VALUES({ .integer = (uint64_t)INT32_MIN }, { .integer = INT32_MAX }), INT32_MIN, INT32_MAX);
+
+  // * width, a negative one is the - flag, and * precision, a negative one is none
+  CHECK("[%*d] [%*d] [%-*d] [%0*d]",
+        VALUES({ .integer = 6 }, { .integer = 42 }, { .integer = (uint64_t)-6 }, { .integer = 42 },
+               { .integer = (uint64_t)-6 }, { .integer = 42 }, { .integer = (uint64_t)-6 }, { .integer = 42 }),
+        6, 42, -6, 42, -6, 42, -6, 42);
+  CHECK("[%.*d] [%.*d] [%*.*d] [%*.*x]",
+        VALUES({ .integer = 4 }, { .integer = 42 }, { .integer = (uint64_t)-1 }, { .integer = 42 },
+               { .integer = (uint64_t)-8 }, { .integer = 4 }, { .integer = 42 }, { .integer = 8 }, { .integer = 0 },
+               { .integer = 0 }),
+        4, 42, -1, 42, -8, 4, 42, 8, 0, 0u);
+
+  // chars and strings
+  CHECK("[%c] [%3c] [%-3c]", VALUES({ .integer = 'a' }, { .integer = 'b' }, { .integer = 'c' }), 'a', 'b', 'c');
+  CHECK("[%s] [%8s] [%-8s] [%.2s] [%8.2s] [%.0s]",
+        VALUES({ .string = "hello" }, { .string = "hello" }, { .string = "hello" }, { .string = "hello" },
+               { .string = "hello" }, { .string = "hello" }),
+        "hello", "hello", "hello", "hello", "hello", "hello");
+  CHECK("[%*s] [%*s] [%.*s] [%.*s]",
+        VALUES({ .integer = 7 }, { .string = "abc" }, { .integer = (uint64_t)-7 }, { .string = "abc" },
+               { .integer = 1 }, { .string = "abc" }, { .integer = (uint64_t)-1 }, { .string = "abc" }),
+        7, "abc", -7, "abc", 1, "abc", -1, "abc");
+
+  // pointers
+  CHECK("[%p] [%20p] [%-20p] [%p]",
+        VALUES({ .pointer = &arena }, { .pointer = &arena }, { .pointer = &arena }, { .pointer = NULL }),
+        (void *)&arena, (void *)&arena, (void *)&arena, (void *)NULL);
+
+  // floating values, with their flags, width and precision
+  CHECK("[%f] [%F] [%e] [%E] [%g] [%G] [%a] [%A]",
+        VALUES({ .floating = 1.5 }, { .floating = -1.5 }, { .floating = 12345.678 }, { .floating = 0.000123 },
+               { .floating = 100000.0 }, { .floating = 1e-10 }, { .floating = 1.0 }, { .floating = -0.5 }),
+        1.5, -1.5, 12345.678, 0.000123, 100000.0, 1e-10, 1.0, -0.5);
+  CHECK("[%10f] [%-10f] [%010.2f] [%+.3e] [% g] [%#g] [%#.0f] [%+-12.4e]",
+        VALUES({ .floating = 1.5 }, { .floating = 1.5 }, { .floating = -2.25 }, { .floating = 2.5 },
+               { .floating = 3.0 }, { .floating = 3.0 }, { .floating = 3.0 }, { .floating = 42.0 }),
+        1.5, 1.5, -2.25, 2.5, 3.0, 3.0, 3.0, 42.0);
+  CHECK("[%*f] [%*f] [%-*f] [%0*.1f] [%.*f] [%.*f] [%*.*g]",
+        VALUES({ .integer = 10 }, { .floating = 1.5 }, { .integer = (uint64_t)-10 }, { .floating = 1.5 },
+               { .integer = (uint64_t)-10 }, { .floating = 1.5 }, { .integer = (uint64_t)-8 }, { .floating = -2.25 },
+               { .integer = 2 }, { .floating = 3.14159 }, { .integer = (uint64_t)-1 }, { .floating = 3.14159 },
+               { .integer = (uint64_t)-12 }, { .integer = 3 }, { .floating = 3.14159 }),
+        10, 1.5, -10, 1.5, -10, 1.5, -8, -2.25, 2, 3.14159, -1, 3.14159, -12, 3, 3.14159);
+  CHECK("[%Lf] [%-*Le] [%.*Lg]",
+        VALUES({ .long_floating = 1.25L }, { .integer = (uint64_t)-14 }, { .long_floating = -1.25L },
+               { .integer = 3 }, { .long_floating = 1.25L }),
+        1.25L, -14, -1.25L, 3, 1.25L);
+
+  // steps mixed with literal text around them
+  CHECK("%s: %d of %5.1f%% done, %-4c|",
+        VALUES({ .string = "copy" }, { .integer = 3 }, { .floating = 42.25 }, { .integer = 'x' }),
+        "copy", 3, 42.25, 'x');
+
+  arena_free(&arena);
+
+  if (failed > 0) {
+    printf("%zu failed\n", failed);
+    return 1;
+  }
+
+  printf("All passed\n");
+  return 0;
+}
@@ -1,7 +1,21 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "./parser2.h"
+#include "./ast_cache.h"
+#include "./ast_emit.h"
+#include "./passes.h"
+#include "./pipeline.h"
+#include "./resolve.h"
+#include "./typecheck.h"
+#include "./fold.h"
+#include "./ir.h"
+#include "./ir_opt.h"
 
 #include "./zdx_util.h"
 
@@ -14,45 +28,410 @@
 #define FL_FREE(...)
 #include "./zdx_file.h"
 
+// what the arena gets for each byte of the source file, on top of 1 MB
+#define ARENA_BYTES_PER_SOURCE_BYTE 1024
 
-// gcc -O2 -g -std=c17 -Wall -Wdeprecated -Wpedantic -Wextra -o interpreter interpreter.c lexer.c parser2.c && ./interpreter
+// registers the analyses in the order they depend on each other, the passes keep pointers to their state
+static void register_passes(pass_manager_t passes[const static 1], resolver_t resolver[const static 1],
+                            type_checker_t checker[const static 1], folder_t folder[const static 1])
+{
+  pass_register(passes, resolve_pass(resolver));
+  pass_register(passes, typecheck_pass(checker));
+  pass_register(passes, fold_pass(folder));
+}
+
+// a function defined at file scope that a lazy parse may have skipped the body of
+typedef struct {
+  sv_t name;
+  ast_function_t *function;
+  bool needed;
+} lazy_definition_t;
+
+static int compare_definitions(const void *a, const void *b)
+{
+  const sv_t x = ((const lazy_definition_t *)a)->name;
+  const sv_t y = ((const lazy_definition_t *)b)->name;
+  const int order = memcmp(x.buf, y.buf, zdx_min(x.length, y.length));
+
+  return order ? order : (x.length > y.length) - (x.length < y.length);
+}
+
+// marks the definitions of name as needed and queues them, there can be more than one in an invalid program
+static void need_definitions(lazy_definition_t definitions[const static 1], const size_t length, const sv_t name,
+                             ast_function_t *queue[const static 1], size_t queued[const static 1])
+{
+  const lazy_definition_t key = { .name = name };
+  lazy_definition_t *found = bsearch(&key, definitions, length, sizeof(*definitions), compare_definitions);
+
+  if (found == NULL) {
+    return;
+  }
+
+  while (found > definitions && compare_definitions(found - 1, &key) == 0) {
+    found--;
+  }
+
+  for (; found < definitions + length && compare_definitions(found, &key) == 0; found++) {
+    if (!found->needed) {
+      found->needed = true;
+      queue[(*queued)++] = found->function;
+    }
+  }
+}
+
+// queues the definitions of the names node refers to, by name as they are needed before the passes bind them
+static void need_referenced(arena_t arena[const static 1], lazy_definition_t definitions[const static 1], const size_t length,
+                            ast_node_t node[const static 1], ast_function_t *queue[const static 1], size_t queued[const static 1])
+{
+  size_t capacity = 64;
+  size_t depth = 0;
+  ast_node_t **stack = arena_alloc(arena, capacity * sizeof(*stack));
+  assertm(!arena->err, "Expected: reference walk alloc to succeed, Received: %s", arena->err);
+
+  stack[depth++] = node;
+
+  while (depth > 0) {
+    ast_node_t *next = stack[--depth];
+
+    if (next->kind == AST_NODE_KIND_SYMBOL) {
+      need_definitions(definitions, length, next->symbol.name, queue, queued);
+    }
+
+    const size_t children = ast_child_count(next);
+
+    if (depth + children > capacity) {
+      const size_t grown = zdx_max(capacity * 2, depth + children);
+
+      stack = arena_realloc(arena, stack, capacity * sizeof(*stack), grown * sizeof(*stack));
+      assertm(!arena->err, "Expected: reference walk resize to be successful, Received: %s", arena->err);
+      capacity = grown;
+    }
+
+    for (size_t i = 0; i < children; i++) {
+      stack[depth++] = ast_child(next, i);
+    }
+  }
+}
+
+// A lazy parse skips the bodies of functions, which are parsed here before the passes run so that they get the same
+// tree an eager parse would have given them. With all, that's every body in source order, e.g., for the reports on
+// the IR, otherwise the ones main and the initializers of globals reach. Returns the first body that doesn't parse
+// as an error node, or the program if they all did
+static ast_node_t parse_lazy_bodies(arena_t arena[const static 1], const fl_content_t fc[const static 1],
+                                    const parser_opts_t opts[const static 1], const ast_node_t program, const bool all)
+{
+  const ast_node_list_t *statements = program.children;
+  lazy_definition_t *definitions = arena_calloc(arena, statements->length, sizeof(*definitions));
+  ast_function_t **queue = arena_calloc(arena, statements->length, sizeof(*queue));
+  assertm(!arena->err, "Expected: lazy body lists alloc to succeed, Received: %s", arena->err);
+  size_t length = 0;
+  size_t queued = 0;
+
+  for (size_t i = 0; i < statements->length; i++) {
+    const ast_node_t *statement = &statements->items[i];
+
+    if (statement->kind == AST_NODE_KIND_FUNCTION && statement->function->body_source.length > 0) {
+      definitions[length++] = (lazy_definition_t){ .name = statement->function->name, .function = statement->function };
+    }
+  }
+
+  if (all) {
+    for (size_t i = 0; i < length; i++) {
+      queue[queued++] = definitions[i].function;
+    }
+  } else {
+    qsort(definitions, length, sizeof(*definitions), compare_definitions);
+    need_definitions(definitions, length, sv_from_cstr("main"), queue, &queued);
+
+    for (size_t i = 0; i < statements->length; i++) {
+      if (statements->items[i].kind != AST_NODE_KIND_FUNCTION) {
+        need_referenced(arena, definitions, length, &statements->items[i], queue, &queued);
+      }
+    }
+  }
+
+  // the queue grows as the parsed bodies need more of them
+  for (size_t i = 0; i < queued; i++) {
+    ast_node_t body = parse_function_body(arena, fc->contents, fc->size, queue[i], opts);
+
+    if (has_err(body)) {
+      return body;
+    }
+
+    if (!all) {
+      need_referenced(arena, definitions, length, &body, queue, &queued);
+    }
+  }
+
+  return program;
+}
+
+// gcc -o ll1_gen ll1_gen.c && ./ll1_gen grammar.ll1 ll1_tables.h &&
+// gcc -O2 -g -std=c17 -Wall -Wdeprecated -Wpedantic -Wextra -pthread -o interpreter interpreter.c lexer.c parser2.c types.c ast_cache.c ast_emit.c passes.c resolve.c typecheck.c fold.c string_pool.c format.c ir.c ir_opt.c ll1_parser.c pipeline.c && ./interpreter
 int main(int argc, char *argv[])
 {
-  if (argc < 2) {
-    bail("Usage: ./interpreter <path to file to interpret>");
+  const char *path = NULL;
+  const char *emit_path = NULL;
+  bool use_cache = true;
+  ast_emit_format_t emit_format = AST_EMIT_FORMAT_TEXT;
+  parser_opts_t parser_opts = {0};
+  pass_manager_t passes = {0};
+  bool pass_report = false;
+  bool use_pipeline = false;
+  bool dump_ir = false;
+  bool inline_report = false;
+  uint32_t ir_opts = IR_OPT_ALL;
+  int status = 0; // 1 when the AST could not be encoded or emitted
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--no-cache") == 0) {
+      use_cache = false;
+    } else if (strcmp(argv[i], "--hash-cons") == 0) {
+      parser_opts.hash_cons = true;
+    } else if (strcmp(argv[i], "--pass-timing") == 0) {
+      pass_report = true;
+      passes.timing = true;
+    } else if (strcmp(argv[i], "--pipeline") == 0) {
+      use_pipeline = true;
+    } else if (strcmp(argv[i], "--dump-ir") == 0) {
+      dump_ir = true;
+    } else if (strcmp(argv[i], "--inline-report") == 0) {
+      inline_report = true;
+    } else if (strcmp(argv[i], "--lazy-bodies") == 0) {
+      parser_opts.lazy_bodies = true;
+    } else if (strncmp(argv[i], "--emit=", strlen("--emit=")) == 0) {
+      emit_format = ast_emit_format_from_cstr(argv[i] + strlen("--emit="));
+
+      if (emit_format == AST_EMIT_FORMAT_COUNT) {
+        bail("Unknown ast format %s, expected one of text, json or binary", argv[i] + strlen("--emit="));
+      }
+    } else if (strncmp(argv[i], "--no-opt=", strlen("--no-opt=")) == 0) {
+      const ir_opt_t opt = ir_opt_from_cstr(argv[i] + strlen("--no-opt="));
+
+      if (opt == IR_OPT_COUNT) {
+        bail("Unknown ir optimization %s, expected one of sccp, copy-propagation, strength-reduction, cse, dse, dce, inline, "
+             "tail-calls or bounds-checks", argv[i] + strlen("--no-opt="));
+      }
+
+      ir_opts &= ~IR_OPT_BIT(opt);
+    } else if (strncmp(argv[i], "--emit-out=", strlen("--emit-out=")) == 0) {
+      emit_path = argv[i] + strlen("--emit-out=");
+    } else if (strncmp(argv[i], "--max-expr-depth=", strlen("--max-expr-depth=")) == 0) {
+      parser_opts.max_expr_depth = strtoull(argv[i] + strlen("--max-expr-depth="), NULL, 10);
+    } else {
+      path = argv[i];
+    }
   }
-  // this will allocate 1 MB + extra bytes to align to page size boundary (4096 on Intel, 16384 on M1)
-  arena_t arena = arena_create(1 MB);
+
+  if (path == NULL) {
+    bail("Usage: ./interpreter [--no-cache] [--hash-cons] [--lazy-bodies] [--pass-timing] [--pipeline] [--dump-ir] [--inline-report] [--no-opt=NAME] [--max-expr-depth=N] [--emit=text|json|binary] [--emit-out=PATH] "
+         "<path to file to interpret>");
+  }
+  // The parse, the passes and the IR use a few hundred bytes for each byte of the source, so the arena is sized by
+  // the file on top of 1 MB. mmap only maps the pages that get touched, so this is cheap even when it's too much.
+  // It's aligned to the page size boundary (4096 on Intel, 16384 on M1)
+  struct stat path_stat = {0};
+  const size_t source_bytes = stat(path, &path_stat) == 0 ? (size_t)path_stat.st_size : 0;
+  arena_t arena = arena_create(1 MB + source_bytes * ARENA_BYTES_PER_SOURCE_BYTE);
   assertm(!arena.err, "Expected: arena creation to succeed, Received: %s", arena.err);
   size_t arena_used_bytes = arena.offset ? arena.offset - 1: 0;
   log(L_INFO, "Arena size = %zu KB, used = %zu bytes", arena.size / 1024, arena_used_bytes);
 
-  fl_content_t fc = fl_read_file(&arena, argv[1], "r");
+  fl_content_t fc = fl_read_file(&arena, path, "r");
 
   if (fc.err) {
     log(L_ERROR, "Error: %s", fc.err);
     return 1;
   }
 
-  log(L_INFO, "File size = %zu bytes, path: %s, contents: \n%s", fc.size, argv[1], (char *)fc.contents);
-
-  // parse
-  ast_node_t program = parse(&arena, fc.contents, fc.size);
-  check_program(program);
-  ast_node_t last_node = program.children->items[program.children->length - 1];
-
-  // the parser stops collection statements when an error occurs and
-  // therefore, if there was a parse error, it'll be the last node
-  // in the program statement list aka program.children
-  if (has_err(last_node)) {
-    char char_at_cursor[2] = {((char *)fc.contents)[last_node.err.cursor], 0};
-    fprintf(stderr, "%s:%zu:%zu: Error: %s -> '%s'\n",
-            fc.path, last_node.err.line + 1, last_node.err.cursor - last_node.err.bol + 1, last_node.err.msg,
-            char_at_cursor[0] == '\n' ? "\\n" : char_at_cursor);
+  log(L_INFO, "File size = %zu bytes, path: %s, contents: \n%s", fc.size, path, (char *)fc.contents);
+
+  // the cache is keyed by the file contents so it's always checked after reading the file
+  const uint64_t cache_key = ast_cache_key(fc.contents, fc.size, &parser_opts, use_pipeline);
+  const char *cache_path = use_cache ? ast_cache_path(&arena, cache_key) : NULL;
+  ast_cache_t cache = {0};
+  pipeline_t pipeline = {0};
+  type_table_t types = {0}; // of the type checker, the parser may be on another thread with its own
+  pass_errors_t pass_errors = {0};
+  type_table_t parser_types = {0};
+  typedef_names_t typedef_names = {0};
+
+  // the bodies a lazy parse skipped are parsed into the tables of the parse, which know its typedefs
+  if (parser_opts.lazy_bodies) {
+    parser_opts.types = &parser_types;
+    parser_opts.typedef_names = &typedef_names;
+  }
+
+  resolver_t resolver = { .arena = &arena, .errors = &pass_errors };
+  string_pool_t strings = {0}; // of the checker, the data segment of the lowered program
+  type_checker_t checker = { .arena = &arena, .types = &types, .resolver = &resolver, .errors = &pass_errors, .strings = &strings };
+  folder_t folder = { .arena = &arena, .types = &types };
+
+  // the cache only has the AST, the IR and the reports of the passes need a fresh parse, which still refreshes it
+  const bool reports = dump_ir || inline_report || pass_report;
+
+  if (cache_path && !reports) {
+    cache = ast_cache_open(cache_path, cache_key, fc.contents, fc.size);
+  } else if (use_cache && !cache_path) {
+    log(L_WARN, "No usable cache directory found. Set "AST_CACHE_DIR_ENV" to enable the AST cache");
+  }
+
+  if (cache.header) {
+    log(L_INFO, "Using cached AST from %s", cache_path);
   } else {
-    print_ast(program);
+    // parse, the pipeline also runs the passes on the statements while the rest of the file is parsed
+    ast_node_t program = {0};
+    register_passes(&passes, &resolver, &checker, &folder);
+
+    if (use_pipeline) {
+      pipeline = pipeline_run(&arena, fc.contents, fc.size, &parser_opts, &passes);
+
+      if (pipeline.err) {
+        log(L_ERROR, "Could not run the pipeline: %s", pipeline.err);
+        pipeline_free(&pipeline);
+        return 1;
+      }
+
+      program = pipeline.program;
+      log(L_INFO, "Pipeline: %zu tokens, %zu statements in %.3f ms, waits: lexer = %zu, parser = %zu, passes = %zu",
+          pipeline.stats.tokens, pipeline.stats.statements, (double)pipeline.stats.ns / 1e6,
+          pipeline.stats.lexer_waits, pipeline.stats.parser_waits, pipeline.stats.pass_waits);
+    } else {
+      program = parse_with_opts(&arena, fc.contents, fc.size, &parser_opts);
+    }
+
+    check_program(program);
+    ast_node_t last_node = program.children->items[program.children->length - 1];
+
+    // the syntax errors of the bodies a lazy parse skipped come before the one it stopped at, if any
+    if (parser_opts.lazy_bodies && !use_pipeline) {
+      const ast_node_t body = parse_lazy_bodies(&arena, &fc, &parser_opts, program, reports || has_err(last_node));
+
+      last_node = has_err(body) ? body : last_node;
+    }
+
+    // the parser stops collection statements when an error occurs and
+    // therefore, if there was a parse error, it'll be the last node
+    // in the program statement list aka program.children
+    if (has_err(last_node)) {
+      char char_at_cursor[2] = {((char *)fc.contents)[last_node.err.cursor], 0};
+      fprintf(stderr, "%s:%zu:%zu: Error: %s -> '%s'\n",
+              fc.path, last_node.err.line + 1, last_node.err.cursor - last_node.err.bol + 1, last_node.err.msg,
+              char_at_cursor[0] == '\n' ? "\\n" : char_at_cursor);
+    } else {
+      // analyses register themselves here and run fused over the tree before it's encoded,
+      // so a cached program is the already analyzed one
+      if (!use_pipeline) {
+        pass_manager_run(&arena, &passes, &program);
+      }
+
+      // a hash-consed node has the position of its first occurrence, so the errors of a program are found again in
+      // a tree of nodes of their own, which has each where it is. Valid programs keep the shared one
+      if (pass_errors.length > 0 && parser_opts.hash_cons && !use_pipeline) {
+        parser_opts.hash_cons = false;
+        typedef_names = (typedef_names_t){0};
+        types = (type_table_t){0};
+        strings = (string_pool_t){0};
+        pass_errors = (pass_errors_t){0};
+        resolver = (resolver_t){ .arena = &arena, .errors = &pass_errors };
+        checker = (type_checker_t){ .arena = &arena, .types = &types, .resolver = &resolver, .errors = &pass_errors, .strings = &strings };
+        folder = (folder_t){ .arena = &arena, .types = &types };
+        passes = (pass_manager_t){ .timing = passes.timing };
+        register_passes(&passes, &resolver, &checker, &folder);
+
+        program = parse_with_opts(&arena, fc.contents, fc.size, &parser_opts);
+        check_program(program);
+        ast_node_t reparsed = program.children->items[program.children->length - 1];
+
+        if (parser_opts.lazy_bodies && !has_err(reparsed)) {
+          reparsed = parse_lazy_bodies(&arena, &fc, &parser_opts, program, reports);
+        }
+
+        assertm(!has_err(reparsed), "Expected: the program to parse without hash-consing like it did with it");
+        pass_manager_run(&arena, &passes, &program);
+      }
+
+      if (pass_report) {
+        pass_manager_report(&passes);
+        log(L_INFO, "Folded %zu expressions", folder.folded);
+      }
+
+      // reported before anything runs, the program is still emitted to show what the passes made of it
+      pass_errors_report(&pass_errors, fc.path, fc.contents);
+
+      // the functions are lowered to the IR the interpreter is going to run once the program is known to be valid
+      if (pass_errors.length == 0) {
+        ir_program_t ir = ir_lower(&arena, &types, &resolver, &strings, &program);
+        ir_opt_stats_t ir_stats[IR_OPT_COUNT] = {0};
+        ir_inline_sites_t inline_sites = {0};
+
+        ir_optimize(&arena, &ir, ir_opts, ir_stats, &inline_sites);
+
+        if (pass_report) {
+          log(L_INFO, "Kept %zu of %zu locals in memory", ir.memory_local_count, ir.local_count);
+          log(L_INFO, "Lowered %zu comparison chains to switches, with %zu jump tables", ir.switch_count, ir.jump_table_count);
+          log(L_INFO, "Found %zu tail calls", ir.tail_call_count);
+          log(L_INFO, "Reduced the strength of %zu operations and removed %zu common subexpressions", ir.reduced_count,
+              ir.common_count);
+          log(L_INFO, "Removed %zu bounds checks of loads and stores and kept %zu", ir.checks_removed, ir.checks_kept);
+          log(L_INFO, "Compiled %zu printf formats", ir.format_count);
+          log(L_INFO, "Pooled %zu string literal spellings as %zu strings, %zu bytes read-only", strings.spelling_count,
+              strings.string_count, strings.length);
+          ir_opt_report(ir_stats);
+        }
+
+        if (inline_report) {
+          ir_inline_report(&ir, &inline_sites);
+        }
+
+        if (dump_ir) {
+          ir_print(&ir, stderr);
+        }
+      }
+
+      // the emitter and the cache file both work off the flat encoding of the program. A hit skips the passes,
+      // so a program they found errors in isn't cached, or the next run would not report them. Neither is a lazy
+      // one with every body parsed for the reports, which the next run of the same key wouldn't have
+      cache = ast_cache_encode(&arena, cache_key, program, fc.contents, fc.size, &types);
+
+      if (cache.err) {
+        // the AST is dumped from the encoding, so a run that can't encode it fails rather than printing nothing
+        fprintf(stderr, "%s: Error: Could not encode AST: %s\n", fc.path, cache.err);
+        status = 1;
+      } else if (cache_path && pass_errors.length == 0 && !(parser_opts.lazy_bodies && reports)) {
+        const char *cache_err = ast_cache_write(&arena, cache_path, &cache);
+
+        if (cache_err) {
+          log(L_WARN, "Could not write AST cache to %s: %s", cache_path, cache_err);
+        }
+      }
+    }
+  }
+
+  if (cache.header) {
+    const int emit_fd = emit_path ? open(emit_path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : STDERR_FILENO;
+
+    if (emit_fd < 0) {
+      fprintf(stderr, "%s: Error: Could not open for writing: %s\n", emit_path, strerror(errno));
+      status = 1;
+    } else {
+      const char *emit_err = ast_emit(&arena, emit_fd, emit_format, &cache);
+
+      if (emit_err) {
+        fprintf(stderr, "%s: Error: Could not emit AST as %s: %s\n", fc.path, ast_emit_format_name(emit_format), emit_err);
+        status = 1;
+      }
+
+      if (emit_path) {
+        close(emit_fd);
+      }
+    }
   }
 
+  ast_cache_close(&cache);
+  pipeline_free(&pipeline);
+  string_pool_free(&strings);
+
   // walk ast and interpret
   // TODO: interpret(program);
 
@@ -63,5 +442,5 @@ int main(int argc, char *argv[])
   // don't really need to deinit as the arena that'd holding the file bytes is freed next anyway
   fc_deinit(&fc);
   arena_free(&arena);
-  return 0;
+  return status;
 }
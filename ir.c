@@ -0,0 +1,1601 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "./zdx_util.h"
+#include "./ir.h"
+
+// ------------------------------------ INSTRUCTIONS ------------------------------------
+
+const char *ir_op_name(const ir_op_t op)
+{
+  static const char *ir_op_to_str[] = {
+    "nop",
+    "const",
+    "undef",
+    "param",
+    "phi",
+    "copy",
+    "unary",
+    "binary",
+    "function",
+    "extern",
+    "addr_local",
+    "addr_global",
+    "string",
+    "load_local",
+    "load_global",
+    "load",
+    "store_local",
+    "store_global",
+    "store",
+    "call",
+    "expr",
+    "jump",
+    "branch",
+    "switch",
+    "return",
+    "tail_call",
+  };
+
+  _Static_assert(zdx_arr_len(ir_op_to_str) == IR_OP_COUNT, "Some ir ops are missing their names");
+  assertm(op < IR_OP_COUNT, "Invalid ir op %d", op);
+
+  return ir_op_to_str[op];
+}
+
+uint32_t *ir_operands(ir_function_t f[const static 1], ir_inst_t inst[const static 1], size_t count[const static 1])
+{
+  switch(inst->op) {
+    case IR_OP_PHI: *count = f->blocks.items[inst->block].pred_count; break;
+    case IR_OP_BINARY:
+    case IR_OP_STORE: *count = 2; break;
+    case IR_OP_COPY:
+    case IR_OP_UNARY:
+    case IR_OP_LOAD:
+    case IR_OP_STORE_LOCAL:
+    case IR_OP_STORE_GLOBAL:
+    case IR_OP_BRANCH:
+    case IR_OP_SWITCH: *count = 1; break;
+    case IR_OP_RETURN: *count = inst->args[0] != IR_NO_VALUE; break;
+    case IR_OP_CALL:
+    case IR_OP_TAIL_CALL: *count = inst->args[1]; return &f->operands.items[inst->args[0]];
+    default: *count = 0; break;
+  }
+
+  return inst->args;
+}
+
+uint32_t *ir_succs(ir_function_t f[const static 1], ir_block_t block[const static 1], size_t count[const static 1])
+{
+  const ir_inst_t *last = block->length > 0 ? &f->insts.items[block->first + block->length - 1] : NULL;
+
+  if (last && last->op == IR_OP_SWITCH) {
+    const ir_switch_t *sw = &f->switches.items[last->imm];
+
+    *count = sw->succ_count;
+    return &f->operands.items[sw->operands];
+  }
+
+  *count = block->succ_count;
+  return block->succs;
+}
+
+uint32_t ir_switch_target(const ir_function_t f[const static 1], const ir_switch_t sw[const static 1], const bool is_signed,
+                          const uint64_t value)
+{
+  const ir_case_range_t *ranges = &f->ranges.items[sw->first_range];
+  const uint32_t *operands = &f->operands.items[sw->operands];
+  size_t lo = 0, hi = sw->range_count;
+
+  // the first range that starts after value, the one before it is the only one value may be in
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    const bool after = is_signed ? (int64_t)ranges[mid].low > (int64_t)value : ranges[mid].low > value;
+
+    if (after) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+
+  if (lo == 0) {
+    return operands[0];
+  }
+
+  const ir_case_range_t *range = &ranges[lo - 1];
+  const bool within = is_signed ? (int64_t)value <= (int64_t)range->high : value <= range->high;
+
+  return operands[within ? operands[range->table + (value - range->low)] : 0];
+}
+
+size_t ir_function_size(const ir_function_t f[const static 1])
+{
+  size_t size = 0;
+
+  for (size_t i = 0; i < f->insts.length; i++) {
+    size += f->insts.items[i].op != IR_OP_NOP;
+  }
+
+  return size;
+}
+
+size_t ir_program_size(const ir_program_t program[const static 1])
+{
+  size_t size = 0;
+
+  for (size_t i = 0; i < program->length; i++) {
+    size += ir_function_size(&program->items[i]);
+  }
+
+  return size;
+}
+
+// ------------------------------------ LOWERING ------------------------------------
+
+typedef struct {
+  arena_t *arena;
+  type_table_t *types;
+  const resolver_t *resolver;
+  string_pool_t *strings;
+  ir_function_t *f;
+  uint32_t block; // being added to, always the last one
+  uint32_t *defs; // current value of each promoted local by slot
+  uint16_t *slot_types; // value type of each slot
+  bool *in_frame; // by slot, locals that are loaded and stored instead of promoted
+  bool *addressed; // by slot, locals that are promoted only if their address doesn't escape
+  uint32_t next_slot; // of the next local declaration, they get their slots in order like resolve.h gives them
+  ir_operands_t stack; // saved defs of the branches being lowered and the args of the calls being lowered
+  uint16_t int_type;
+} ir_lowerer_t;
+
+static inline const type_t *import(ir_lowerer_t l[const static 1], const type_t type[const static 1])
+{
+  return type_import(l->arena, l->types, type);
+}
+
+// id of the type of the values of type, which have no qualifiers or storage class
+static uint16_t value_type(ir_lowerer_t l[const static 1], const type_t type[const static 1])
+{
+  type_t t = *import(l, type);
+
+  t.qualifiers = 0;
+  t.storage = 0;
+
+  return type_intern(l->arena, l->types, t)->id;
+}
+
+static inline uint16_t unqualified(ir_lowerer_t l[const static 1], const uint16_t id)
+{
+  return id == TYPE_NO_ID ? id : value_type(l, type_by_id(l->types, id));
+}
+
+static inline const type_t *type_of(const ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  const uint16_t id = ast_ungroup(node)->type;
+
+  return id == TYPE_NO_ID ? NULL : type_by_id(l->types, id);
+}
+
+static inline bool is_pointer(const ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  const type_t *type = type_of(l, node);
+
+  return type && type->kind == TYPE_KIND_POINTER;
+}
+
+static inline bool is_void(const ir_lowerer_t l[const static 1], const uint16_t id)
+{
+  const type_t *type = id == TYPE_NO_ID ? NULL : type_by_id(l->types, id);
+
+  return type == NULL || (type->kind == TYPE_KIND_BASE && (type->specifiers & TYPE_SPEC_VOID));
+}
+
+static inline bool is_function(const ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  const uint32_t declaration = node->symbol.declaration;
+
+  return declaration != 0 && l->resolver->declarations.items[declaration - 1].function != NULL;
+}
+
+static uint32_t emit(ir_lowerer_t l[const static 1], ir_inst_t inst)
+{
+  ir_function_t *f = l->f;
+  ir_block_t *block = &f->blocks.items[l->block];
+
+  assertm(block->first + block->length == f->insts.length, "Expected: instructions to be added to the last block");
+  inst.block = l->block;
+  ir_push(l->arena, &f->insts, inst);
+  block->length++;
+
+  return (uint32_t)(f->insts.length - 1);
+}
+
+static inline uint32_t constant(ir_lowerer_t l[const static 1], const uint64_t value, const uint16_t type)
+{
+  return emit(l, (ir_inst_t){ .op = IR_OP_CONST, .type = type, .imm = value });
+}
+
+static uint32_t convert(ir_lowerer_t l[const static 1], const uint32_t value, const uint16_t type)
+{
+  if (value == IR_NO_VALUE || unqualified(l, l->f->insts.items[value].type) == unqualified(l, type)) {
+    return value;
+  }
+
+  return emit(l, (ir_inst_t){ .op = IR_OP_UNARY, .sub = UNARY_OP_CONVERT, .type = type, .args = { value } });
+}
+
+static void start_block(ir_lowerer_t l[const static 1])
+{
+  ir_push(l->arena, &l->f->blocks, ((ir_block_t){ .first = (uint32_t)l->f->insts.length }));
+  l->block = (uint32_t)(l->f->blocks.length - 1);
+}
+
+// ends the current block, returns it so that it can be linked to its successors once they exist
+static uint32_t terminate(ir_lowerer_t l[const static 1], const ir_op_t op, const uint32_t value)
+{
+  emit(l, (ir_inst_t){ .op = op, .args = { value } });
+  return l->block;
+}
+
+static void link_blocks(ir_lowerer_t l[const static 1], const uint32_t from, const size_t succ, const uint32_t to)
+{
+  ir_block_t *pred = &l->f->blocks.items[from];
+  ir_block_t *block = &l->f->blocks.items[to];
+
+  assertm(block->pred_count < zdx_arr_len(block->preds), "Expected: a block to merge at most two paths");
+  pred->succs[succ] = to;
+  pred->succ_count = (uint8_t)zdx_max(pred->succ_count, succ + 1);
+  block->preds[block->pred_count++] = from;
+}
+
+// the defs of a path are saved on the stack while the other one is lowered
+static size_t save_defs(ir_lowerer_t l[const static 1])
+{
+  const size_t at = l->stack.length;
+
+  for (uint32_t slot = 0; slot < l->f->ast->frame_size; slot++) {
+    ir_push(l->arena, &l->stack, l->defs[slot]);
+  }
+
+  return at;
+}
+
+/**
+ * Merges the defs saved at the stack index other, of the path coming in from preds[0] of the current block,
+ * with the current ones, of the path from preds[1], and drops them from the stack. Locals assigned on either
+ * path get a phi.
+ */
+static void merge_defs(ir_lowerer_t l[const static 1], const size_t other)
+{
+  const uint32_t *saved = &l->stack.items[other];
+
+  for (uint32_t slot = 0; slot < l->f->ast->frame_size; slot++) {
+    if (saved[slot] == l->defs[slot] || saved[slot] == IR_NO_VALUE || l->defs[slot] == IR_NO_VALUE) {
+      continue;
+    }
+
+    l->defs[slot] = emit(l, (ir_inst_t){ .op = IR_OP_PHI, .type = l->slot_types[slot], .args = { saved[slot], l->defs[slot] } });
+  }
+
+  l->stack.length = other;
+}
+
+static uint32_t expr(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  ir_push(l->arena, &l->f->exprs, node);
+  return emit(l, (ir_inst_t){ .op = IR_OP_EXPR, .type = node->type, .imm = l->f->exprs.length - 1 });
+}
+
+// what an lvalue refers to, a promoted local is a value to replace rather than a location
+typedef enum {
+  LVALUE_NONE, // e.g., a member, which the IR can't address yet
+  LVALUE_PROMOTED,
+  LVALUE_LOCAL,
+  LVALUE_GLOBAL,
+  LVALUE_ADDRESS,
+} lvalue_kind_t;
+
+typedef struct {
+  lvalue_kind_t kind;
+  uint32_t slot;
+  uint32_t address;
+  uint16_t type; // of the values stored to it
+} lvalue_t;
+
+static lvalue_kind_t location_of(const ir_lowerer_t l[const static 1], const ast_node_t *node)
+{
+  node = ast_ungroup(node);
+
+  switch(node->kind) {
+    case AST_NODE_KIND_SYMBOL: {
+      if (node->symbol.binding == SYMBOL_BINDING_LOCAL) {
+        return l->in_frame[node->symbol.slot] ? LVALUE_LOCAL : LVALUE_PROMOTED;
+      }
+
+      return node->symbol.binding == SYMBOL_BINDING_GLOBAL && !is_function(l, node) ? LVALUE_GLOBAL : LVALUE_NONE;
+    }
+
+    case AST_NODE_KIND_UNARY_OP: return node->unary_op.kind == UNARY_OP_DEREF ? LVALUE_ADDRESS : LVALUE_NONE;
+
+    case AST_NODE_KIND_BINARY_OP: {
+      const bool pointer = is_pointer(l, node->binary_op.lhs) || is_pointer(l, node->binary_op.rhs);
+
+      return node->binary_op.kind == BINARY_OP_INDEX && pointer ? LVALUE_ADDRESS : LVALUE_NONE;
+    }
+
+    default: return LVALUE_NONE;
+  }
+}
+
+static inline bool is_assignment(const binary_op_kind_t kind)
+{
+  return kind == BINARY_OP_ASSIGNMENT || (kind >= BINARY_OP_MULT_ASSIGNMENT && kind <= BINARY_OP_BIT_OR_ASSIGNMENT);
+}
+
+static inline bool is_inc_dec(const unary_op_kind_t kind)
+{
+  return kind >= UNARY_OP_PRE_INC && kind <= UNARY_OP_POST_DEC;
+}
+
+/**
+ * Expressions the IR has no operations for, which are kept as ast nodes: members, whose structs aren't parsed
+ * yet, and what is assigned to or addressed through them, indexing without a pointer to go by, sizeof and
+ * _Alignof the folder couldn't measure, string literals and symbols that don't refer to a variable.
+ */
+static bool is_opaque(const ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  switch(node->kind) {
+    case AST_NODE_KIND_LIST: return node->children == NULL || node->children->length == 0; // ()
+    case AST_NODE_KIND_TERNARY:
+    case AST_NODE_KIND_CALL: return false;
+
+    case AST_NODE_KIND_LITERAL: {
+      const type_t *type = type_of(l, node);
+
+      return node->literal.kind != LITERAL_KIND_STRING && (type == NULL || !type_is_integer(type));
+    }
+
+    case AST_NODE_KIND_SYMBOL: {
+      const symbol_binding_t binding = node->symbol.binding;
+
+      return binding != SYMBOL_BINDING_LOCAL && binding != SYMBOL_BINDING_GLOBAL && binding != SYMBOL_BINDING_EXTERN;
+    }
+
+    case AST_NODE_KIND_UNARY_OP: {
+      const unary_op_kind_t kind = node->unary_op.kind;
+      const ast_node_t *operand = ast_ungroup(node->unary_op.expr);
+
+      if (kind == UNARY_OP_ADDR_OF) {
+        const bool callable = operand->kind == AST_NODE_KIND_SYMBOL &&
+          (operand->symbol.binding == SYMBOL_BINDING_EXTERN || is_function(l, operand));
+
+        return !callable && location_of(l, operand) == LVALUE_NONE;
+      }
+
+      return kind == UNARY_OP_SIZEOF || kind == UNARY_OP_ALIGNOF || (is_inc_dec(kind) && location_of(l, operand) == LVALUE_NONE);
+    }
+
+    case AST_NODE_KIND_BINARY_OP: {
+      const binary_op_kind_t kind = node->binary_op.kind;
+
+      if (kind == BINARY_OP_MEMBER || kind == BINARY_OP_PTR_MEMBER) {
+        return true;
+      }
+
+      if (kind == BINARY_OP_INDEX) {
+        return location_of(l, node) == LVALUE_NONE;
+      }
+
+      return is_assignment(kind) && location_of(l, node->binary_op.lhs) == LVALUE_NONE;
+    }
+
+    default: return true;
+  }
+}
+
+static uint32_t lower_expr(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1]);
+
+// the expressions of a group before the one that gives its value are only lowered for their effects
+static const ast_node_t *lower_group(ir_lowerer_t l[const static 1], const ast_node_t *node)
+{
+  while (node->kind == AST_NODE_KIND_LIST && node->children && node->children->length > 0) {
+    for (size_t i = 0; i + 1 < node->children->length; i++) {
+      lower_expr(l, &node->children->items[i]);
+    }
+
+    node = &node->children->items[node->children->length - 1];
+  }
+
+  return node;
+}
+
+// p[i] is *(p + i) and i[p] is *(p + i) too
+static uint32_t lower_index_address(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  const bool pointer_lhs = is_pointer(l, node->binary_op.lhs);
+  const uint32_t lhs = lower_expr(l, node->binary_op.lhs);
+  const uint32_t rhs = lower_expr(l, node->binary_op.rhs);
+  const ast_node_t *pointer = pointer_lhs ? node->binary_op.lhs : node->binary_op.rhs;
+
+  return emit(l, (ir_inst_t){
+      .op = IR_OP_BINARY,
+      .sub = BINARY_OP_ADD,
+      .type = unqualified(l, ast_ungroup(pointer)->type),
+      .args = { pointer_lhs ? lhs : rhs, pointer_lhs ? rhs : lhs },
+    });
+}
+
+// lowers what is needed to find the location, e.g., the pointer of a dereference, but doesn't read it
+// the local an address is of, through the copies and pointer conversions of it, or IR_NO_VALUE
+static uint32_t addressed_slot(const ir_lowerer_t l[const static 1], uint32_t value)
+{
+  for (;;) {
+    const ir_inst_t *inst = &l->f->insts.items[value];
+
+    if (inst->op == IR_OP_ADDR_LOCAL) {
+      return (uint32_t)inst->imm;
+    }
+
+    const bool pointer_conversion = inst->op == IR_OP_UNARY && inst->sub == UNARY_OP_CONVERT &&
+      type_by_id(l->types, inst->type)->kind == TYPE_KIND_POINTER;
+
+    if (inst->op != IR_OP_COPY && !pointer_conversion) {
+      return IR_NO_VALUE;
+    }
+
+    value = inst->args[0];
+  }
+}
+
+static lvalue_t lower_lvalue(ir_lowerer_t l[const static 1], const ast_node_t *node)
+{
+  node = lower_group(l, node);
+
+  lvalue_t lvalue = { .kind = location_of(l, node), .type = unqualified(l, node->type) };
+
+  switch(lvalue.kind) {
+    case LVALUE_PROMOTED:
+    case LVALUE_LOCAL:
+    case LVALUE_GLOBAL: lvalue.slot = node->symbol.slot; break;
+
+    case LVALUE_ADDRESS: {
+      lvalue.address = node->kind == AST_NODE_KIND_UNARY_OP ? lower_expr(l, node->unary_op.expr) : lower_index_address(l, node);
+
+      // a dereference of the address of a local that doesn't escape is the local
+      const uint32_t slot = addressed_slot(l, lvalue.address);
+
+      if (slot != IR_NO_VALUE && !l->in_frame[slot]) {
+        lvalue = (lvalue_t){ .kind = LVALUE_PROMOTED, .slot = slot, .type = l->slot_types[slot] };
+      }
+    } break;
+
+    default: assertm(false, "Expected: an lvalue the IR can address, Received: %s", node_kind_name(node->kind));
+  }
+
+  return lvalue;
+}
+
+static uint32_t load(ir_lowerer_t l[const static 1], const lvalue_t lvalue)
+{
+  switch(lvalue.kind) {
+    case LVALUE_PROMOTED: return l->defs[lvalue.slot];
+    case LVALUE_LOCAL: return emit(l, (ir_inst_t){ .op = IR_OP_LOAD_LOCAL, .type = lvalue.type, .imm = lvalue.slot });
+    case LVALUE_GLOBAL: return emit(l, (ir_inst_t){ .op = IR_OP_LOAD_GLOBAL, .type = lvalue.type, .imm = lvalue.slot });
+    case LVALUE_ADDRESS:
+      return emit(l, (ir_inst_t){ .op = IR_OP_LOAD, .sub = IR_ACCESS_CHECKED, .type = lvalue.type, .args = { lvalue.address } });
+    default: assertm(false, "Expected: a location to load from");
+  }
+
+  return IR_NO_VALUE;
+}
+
+// returns the value of the assignment, the stored value
+static uint32_t store(ir_lowerer_t l[const static 1], const lvalue_t lvalue, const uint32_t value)
+{
+  switch(lvalue.kind) {
+    case LVALUE_PROMOTED: {
+      l->defs[lvalue.slot] = emit(l, (ir_inst_t){ .op = IR_OP_COPY, .type = lvalue.type, .args = { value } });
+      return l->defs[lvalue.slot];
+    }
+    case LVALUE_LOCAL: emit(l, (ir_inst_t){ .op = IR_OP_STORE_LOCAL, .args = { value }, .imm = lvalue.slot }); break;
+    case LVALUE_GLOBAL: emit(l, (ir_inst_t){ .op = IR_OP_STORE_GLOBAL, .args = { value }, .imm = lvalue.slot }); break;
+    case LVALUE_ADDRESS: emit(l, (ir_inst_t){ .op = IR_OP_STORE, .sub = IR_ACCESS_CHECKED, .args = { lvalue.address, value } }); break;
+    default: assertm(false, "Expected: a location to store to");
+  }
+
+  return value;
+}
+
+// x op= y is x = x op y where x is converted to the type of the converted y, but for pointers and shifts
+static uint32_t lower_compound_assignment(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1],
+                                          const binary_op_kind_t op)
+{
+  const lvalue_t lvalue = lower_lvalue(l, node->binary_op.lhs);
+  const uint32_t old = load(l, lvalue);
+  const uint32_t rhs = lower_expr(l, node->binary_op.rhs);
+  uint16_t type = unqualified(l, ast_ungroup(node->binary_op.rhs)->type);
+
+  if (is_pointer(l, node->binary_op.lhs)) {
+    type = lvalue.type;
+  } else if (op == BINARY_OP_LSHIFT || op == BINARY_OP_RSHIFT) {
+    const type_t *target = type_by_id(l->types, lvalue.type);
+
+    type = type_is_integer(target) ? type_intern(l->arena, l->types, (type_t){
+        .kind = TYPE_KIND_BASE,
+        .specifiers = type_promote(target->specifiers),
+      })->id : lvalue.type;
+  }
+
+  const uint32_t result = emit(l, (ir_inst_t){ .op = IR_OP_BINARY, .sub = op, .type = type, .args = { convert(l, old, type), rhs } });
+
+  return store(l, lvalue, convert(l, result, lvalue.type));
+}
+
+static const binary_op_kind_t compound_ops[BINARY_OP_COUNT] = {
+  [BINARY_OP_MULT_ASSIGNMENT] = BINARY_OP_MULT,
+  [BINARY_OP_DIV_ASSIGNMENT] = BINARY_OP_DIV,
+  [BINARY_OP_MOD_ASSIGNMENT] = BINARY_OP_MOD,
+  [BINARY_OP_ADD_ASSIGNMENT] = BINARY_OP_ADD,
+  [BINARY_OP_SUB_ASSIGNMENT] = BINARY_OP_SUB,
+  [BINARY_OP_LSHIFT_ASSIGNMENT] = BINARY_OP_LSHIFT,
+  [BINARY_OP_RSHIFT_ASSIGNMENT] = BINARY_OP_RSHIFT,
+  [BINARY_OP_BIT_AND_ASSIGNMENT] = BINARY_OP_BIT_AND,
+  [BINARY_OP_BIT_XOR_ASSIGNMENT] = BINARY_OP_BIT_XOR,
+  [BINARY_OP_BIT_OR_ASSIGNMENT] = BINARY_OP_BIT_OR,
+};
+
+// x++ adds 1 of the type of x, or an int to a pointer
+static uint32_t lower_inc_dec(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  const unary_op_kind_t kind = node->unary_op.kind;
+  const lvalue_t lvalue = lower_lvalue(l, node->unary_op.expr);
+  const uint32_t old = load(l, lvalue);
+  const bool pointer = type_by_id(l->types, lvalue.type)->kind == TYPE_KIND_POINTER;
+  const uint32_t one = constant(l, 1, l->int_type);
+  const uint32_t result = emit(l, (ir_inst_t){
+      .op = IR_OP_BINARY,
+      .sub = kind == UNARY_OP_PRE_INC || kind == UNARY_OP_POST_INC ? BINARY_OP_ADD : BINARY_OP_SUB,
+      .type = lvalue.type,
+      .args = { old, pointer ? one : convert(l, one, lvalue.type) },
+    });
+  const uint32_t stored = store(l, lvalue, result);
+
+  return kind == UNARY_OP_PRE_INC || kind == UNARY_OP_PRE_DEC ? stored : old;
+}
+
+static uint32_t lower_address(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  const ast_node_t *operand = ast_ungroup(node->unary_op.expr);
+
+  if (operand->kind == AST_NODE_KIND_SYMBOL && (operand->symbol.binding == SYMBOL_BINDING_EXTERN || is_function(l, operand))) {
+    lower_group(l, node->unary_op.expr);
+    return lower_expr(l, operand);
+  }
+
+  const lvalue_t lvalue = lower_lvalue(l, node->unary_op.expr);
+
+  switch(lvalue.kind) {
+    // of a local that doesn't escape, which only dereferences use and are lowered to the local itself
+    case LVALUE_PROMOTED:
+    case LVALUE_LOCAL: return emit(l, (ir_inst_t){ .op = IR_OP_ADDR_LOCAL, .type = node->type, .imm = lvalue.slot });
+    case LVALUE_GLOBAL: return emit(l, (ir_inst_t){ .op = IR_OP_ADDR_GLOBAL, .type = node->type, .imm = lvalue.slot });
+    case LVALUE_ADDRESS: return lvalue.address;
+    default: assertm(false, "Expected: locals that have their address taken to be in the frame");
+  }
+
+  return IR_NO_VALUE;
+}
+
+static uint32_t lower_unary_op(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  const unary_op_kind_t kind = node->unary_op.kind;
+
+  if (kind == UNARY_OP_ADDR_OF) {
+    return lower_address(l, node);
+  }
+
+  if (is_inc_dec(kind)) {
+    return lower_inc_dec(l, node);
+  }
+
+  if (kind == UNARY_OP_DEREF) {
+    return load(l, lower_lvalue(l, node));
+  }
+
+  const uint32_t operand = lower_expr(l, node->unary_op.expr);
+
+  return emit(l, (ir_inst_t){ .op = IR_OP_UNARY, .sub = kind, .type = node->type, .args = { operand } });
+}
+
+// operators that already give 0 or 1
+static inline bool is_truth(const ast_node_t *node)
+{
+  node = ast_ungroup(node);
+
+  if (node->kind == AST_NODE_KIND_UNARY_OP) {
+    return node->unary_op.kind == UNARY_OP_NOT;
+  }
+
+  if (node->kind != AST_NODE_KIND_BINARY_OP) {
+    return false;
+  }
+
+  const binary_op_kind_t kind = node->binary_op.kind;
+
+  return (kind >= BINARY_OP_LT && kind <= BINARY_OP_NEQ) || kind == BINARY_OP_LOGICAL_AND || kind == BINARY_OP_LOGICAL_OR;
+}
+
+/**
+ * a && b branches to the block of b when a isn't 0 and straight to the end otherwise, where a phi picks 0 or
+ * b != 0 depending on the way it came in, a || b the other way around with 1.
+ */
+static uint32_t lower_logical(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  const bool is_and = node->binary_op.kind == BINARY_OP_LOGICAL_AND;
+  const uint32_t lhs = lower_expr(l, node->binary_op.lhs);
+  const uint32_t decided = constant(l, !is_and, l->int_type);
+  const uint32_t branch = terminate(l, IR_OP_BRANCH, lhs);
+  const size_t saved = save_defs(l);
+
+  start_block(l);
+  link_blocks(l, branch, is_and ? 0 : 1, l->block);
+
+  uint32_t rhs = lower_expr(l, node->binary_op.rhs);
+
+  if (!is_truth(node->binary_op.rhs)) {
+    const uint16_t type = l->f->insts.items[rhs].type;
+
+    rhs = emit(l, (ir_inst_t){ .op = IR_OP_BINARY, .sub = BINARY_OP_NEQ, .type = l->int_type, .args = { rhs, constant(l, 0, type) } });
+  }
+
+  const uint32_t rhs_end = terminate(l, IR_OP_JUMP, IR_NO_VALUE);
+
+  start_block(l);
+  link_blocks(l, branch, is_and ? 1 : 0, l->block);
+  link_blocks(l, rhs_end, 0, l->block);
+  merge_defs(l, saved);
+
+  return emit(l, (ir_inst_t){ .op = IR_OP_PHI, .type = l->int_type, .args = { decided, rhs } });
+}
+
+// a group of a single expression is the expression, unlike ast_ungroup() a longer one isn't as its others have effects
+static const ast_node_t *unwrap(const ast_node_t *node)
+{
+  while (node->kind == AST_NODE_KIND_LIST && node->children && node->children->length == 1) {
+    node = &node->children->items[0];
+  }
+
+  return node;
+}
+
+// whether a and b read the same variable, converted the same way, so that reading it once does for both
+static bool same_variable(const ir_lowerer_t l[const static 1], const ast_node_t *a, const ast_node_t *b)
+{
+  a = unwrap(a);
+  b = unwrap(b);
+
+  if (a->kind != b->kind || a->type != b->type) {
+    return false;
+  }
+
+  if (a->kind == AST_NODE_KIND_UNARY_OP) {
+    return a->unary_op.kind == UNARY_OP_CONVERT && b->unary_op.kind == UNARY_OP_CONVERT &&
+      same_variable(l, a->unary_op.expr, b->unary_op.expr);
+  }
+
+  if (a->kind != AST_NODE_KIND_SYMBOL || a->symbol.binding != b->symbol.binding || a->symbol.slot != b->symbol.slot) {
+    return false;
+  }
+
+  const type_t *type = type_of(l, a);
+  const bool variable = a->symbol.binding == SYMBOL_BINDING_LOCAL || (a->symbol.binding == SYMBOL_BINDING_GLOBAL && !is_function(l, a));
+
+  return variable && type && !(type->qualifiers & TYPE_QUALIFIER_VOLATILE);
+}
+
+/**
+ * Whether cond is a case of a switch on key, x == c or c == x with x an integer variable and c a constant of its
+ * type, value is set to c. key is set to x if it's NULL and otherwise x has to be the same variable as key.
+ */
+static bool case_of(ir_lowerer_t l[const static 1], const ast_node_t *cond, const ast_node_t *key[const static 1],
+                    uint64_t value[const static 1])
+{
+  cond = unwrap(cond);
+
+  if (cond->kind != AST_NODE_KIND_BINARY_OP || cond->binary_op.kind != BINARY_OP_EQ) {
+    return false;
+  }
+
+  const ast_node_t *lhs = unwrap(cond->binary_op.lhs);
+  const ast_node_t *rhs = unwrap(cond->binary_op.rhs);
+  const ast_node_t *constant = lhs->kind == AST_NODE_KIND_LITERAL ? lhs : rhs;
+  const ast_node_t *variable = constant == lhs ? rhs : lhs;
+  const type_t *type = type_of(l, variable);
+
+  if (constant->kind != AST_NODE_KIND_LITERAL || is_opaque(l, constant) || type == NULL || !type_is_integer(type) ||
+      unqualified(l, constant->type) != unqualified(l, variable->type) || !same_variable(l, *key ? *key : variable, variable)) {
+    return false;
+  }
+
+  *key = variable;
+  *value = constant->literal.integer;
+  return true;
+}
+
+// ternaries in a row, from node down its else branches, that are cases of the same switch
+static size_t chain_length(ir_lowerer_t l[const static 1], const ast_node_t *node)
+{
+  const ast_node_t *key = NULL;
+  uint64_t value = 0;
+  size_t count = 0;
+
+  for (; node->kind == AST_NODE_KIND_TERNARY && case_of(l, node->ternary.cond, &key, &value); node = unwrap(node->ternary.else_expr)) {
+    count++;
+  }
+
+  return count;
+}
+
+typedef struct {
+  uint64_t value;
+  uint32_t succ; // index in the succs of the switch
+} switch_case_t;
+
+// by value and then by succ, so that the first of the cases of the same value comes first, like it's tested first
+static int compare_signed_cases(const void *a, const void *b)
+{
+  const switch_case_t *x = a, *y = b;
+
+  if (x->value != y->value) {
+    return (int64_t)x->value < (int64_t)y->value ? -1 : 1;
+  }
+
+  return x->succ < y->succ ? -1 : x->succ > y->succ;
+}
+
+static int compare_unsigned_cases(const void *a, const void *b)
+{
+  const switch_case_t *x = a, *y = b;
+
+  if (x->value != y->value) {
+    return x->value < y->value ? -1 : 1;
+  }
+
+  return x->succ < y->succ ? -1 : x->succ > y->succ;
+}
+
+// the last of the sorted cases that the cases from first on make a range dense enough for a jump table with
+static size_t dense_end(const switch_case_t cases[const static 1], const size_t count, const size_t first)
+{
+  size_t last = first;
+
+  for (size_t i = first + 1; i < count; i++) {
+    const uint64_t span = cases[i].value - cases[first].value; // values in the range but one
+
+    if (span >= IR_SWITCH_MAX_TABLE) {
+      break;
+    } else if ((i - first + 1) * 100 >= IR_SWITCH_MIN_DENSITY * (span + 1)) {
+      last = i;
+    }
+  }
+
+  return last;
+}
+
+// cuts the sorted cases, without repeated values, into the ranges of the switch and fills their tables
+static void add_ranges(ir_lowerer_t l[const static 1], ir_switch_t sw[const static 1], const switch_case_t cases[const static 1],
+                       const size_t count)
+{
+  ir_function_t *f = l->f;
+
+  for (size_t first = 0, last = 0; first < count; first = last + 1) {
+    last = dense_end(cases, count, first);
+    last = last + 1 - first < IR_SWITCH_MIN_TABLE_CASES ? first : last;
+
+    const ir_case_range_t range = {
+      .low = cases[first].value,
+      .high = cases[last].value,
+      .table = (uint32_t)f->operands.length - sw->operands,
+    };
+
+    for (size_t i = first; i <= last; i++) {
+      // values between two cases go to the default
+      while (f->operands.length - sw->operands - range.table < cases[i].value - range.low) {
+        ir_push(l->arena, &f->operands, 0);
+      }
+
+      ir_push(l->arena, &f->operands, cases[i].succ);
+    }
+
+    ir_push(l->arena, &f->ranges, range);
+    sw->range_count++;
+    sw->table_count += last > first;
+  }
+
+  sw->operand_count = (uint32_t)f->operands.length - sw->operands;
+}
+
+typedef struct {
+  uint32_t succ; // index in the succs of the switch, 0 if no case goes to it
+  uint32_t value;
+  uint32_t end; // block
+  size_t defs; // stack index of the defs at the end
+} switch_arm_t;
+
+/**
+ * Lowers a chain of count ternaries on the same variable to a switch to the then branch of each, the else branch
+ * of the last one being the default, and the blocks that merge them in the order the ternaries would, innermost
+ * first, so that the phis are the ones of the ternaries. The variable is read once, which the ternaries can't
+ * tell apart, as nothing happens between two of their comparisons.
+ */
+static uint32_t lower_switch(ir_lowerer_t l[const static 1], const ast_node_t *node, const size_t count)
+{
+  ir_function_t *f = l->f;
+  const ast_node_t **ternaries = arena_calloc(l->arena, count, sizeof(*ternaries));
+  switch_case_t *cases = arena_calloc(l->arena, count, sizeof(*cases));
+  switch_arm_t *arms = arena_calloc(l->arena, count + 1, sizeof(*arms));
+  const ast_node_t *key = NULL;
+  size_t unique = 0;
+
+  assertm(!l->arena->err, "Expected: switch arrays alloc to succeed, Received: %s", l->arena->err);
+
+  for (size_t i = 0; i < count; i++, node = unwrap(node->ternary.else_expr)) {
+    ternaries[i] = node;
+    case_of(l, node->ternary.cond, &key, &cases[i].value);
+    cases[i].succ = (uint32_t)i; // the arm until the succs are known
+  }
+
+  const uint32_t value = lower_expr(l, key);
+  const bool is_signed = !type_is_unsigned(type_by_id(l->types, key->type)->specifiers);
+
+  qsort(cases, count, sizeof(*cases), is_signed ? compare_signed_cases : compare_unsigned_cases);
+
+  // a case of a value an earlier ternary has a case of is never reached, its block gets no preds
+  for (size_t i = 0; i < count; i++) {
+    if (unique == 0 || cases[i].value != cases[unique - 1].value) {
+      cases[unique++] = cases[i];
+      arms[cases[i].succ].succ = 1;
+    }
+  }
+
+  ir_switch_t sw = { .operands = (uint32_t)f->operands.length, .succ_count = 1, .first_range = (uint32_t)f->ranges.length };
+
+  // succs[0] is the default and the others are the arms that are reached, in order
+  for (size_t i = 0; i < count; i++) {
+    arms[i].succ = arms[i].succ ? sw.succ_count++ : 0;
+  }
+
+  for (size_t i = 0; i < unique; i++) {
+    cases[i].succ = arms[cases[i].succ].succ;
+  }
+
+  // the succs are set as their blocks are started
+  for (size_t i = 0; i < sw.succ_count; i++) {
+    ir_push(l->arena, &f->operands, 0);
+  }
+
+  add_ranges(l, &sw, cases, unique);
+  ir_push(l->arena, &f->switches, sw);
+  emit(l, (ir_inst_t){ .op = IR_OP_SWITCH, .args = { value }, .imm = f->switches.length - 1 });
+
+  const uint32_t from = l->block;
+  const size_t before = save_defs(l);
+
+  for (size_t i = 0; i <= count; i++) {
+    memcpy(l->defs, &l->stack.items[before], f->ast->frame_size * sizeof(*l->defs));
+    start_block(l);
+
+    if (i == count || arms[i].succ) {
+      f->operands.items[sw.operands + arms[i].succ] = l->block;
+      f->blocks.items[l->block].preds[f->blocks.items[l->block].pred_count++] = from;
+    }
+
+    arms[i].value = lower_expr(l, i < count ? ternaries[i]->ternary.then_expr : node);
+    arms[i].end = terminate(l, IR_OP_JUMP, IR_NO_VALUE);
+    arms[i].defs = i < count ? save_defs(l) : 0;
+  }
+
+  uint32_t result = arms[count].value;
+  uint32_t end = arms[count].end;
+
+  for (size_t i = count; i-- > 0;) {
+    start_block(l);
+    link_blocks(l, arms[i].end, 0, l->block);
+    link_blocks(l, end, 0, l->block);
+    merge_defs(l, arms[i].defs);
+
+    result = is_void(l, ternaries[i]->type) ? IR_NO_VALUE :
+      emit(l, (ir_inst_t){ .op = IR_OP_PHI, .type = ternaries[i]->type, .args = { arms[i].value, result } });
+    end = i > 0 ? terminate(l, IR_OP_JUMP, IR_NO_VALUE) : end;
+  }
+
+  l->stack.length = before;
+
+  return result;
+}
+
+static uint32_t lower_ternary(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  const size_t cases = chain_length(l, node);
+
+  if (cases >= IR_SWITCH_MIN_CASES) {
+    return lower_switch(l, node, cases);
+  }
+
+  const uint32_t branch = terminate(l, IR_OP_BRANCH, lower_expr(l, node->ternary.cond));
+  const size_t before = save_defs(l);
+
+  start_block(l);
+  link_blocks(l, branch, 0, l->block);
+
+  const uint32_t then_value = lower_expr(l, node->ternary.then_expr);
+  const uint32_t then_end = terminate(l, IR_OP_JUMP, IR_NO_VALUE);
+  const size_t after_then = save_defs(l);
+
+  memcpy(l->defs, &l->stack.items[before], l->f->ast->frame_size * sizeof(*l->defs));
+  start_block(l);
+  link_blocks(l, branch, 1, l->block);
+
+  const uint32_t else_value = lower_expr(l, node->ternary.else_expr);
+  const uint32_t else_end = terminate(l, IR_OP_JUMP, IR_NO_VALUE);
+
+  start_block(l);
+  link_blocks(l, then_end, 0, l->block);
+  link_blocks(l, else_end, 0, l->block);
+  merge_defs(l, after_then);
+  l->stack.length = before;
+
+  if (is_void(l, node->type)) {
+    return IR_NO_VALUE;
+  }
+
+  return emit(l, (ir_inst_t){ .op = IR_OP_PHI, .type = node->type, .args = { then_value, else_value } });
+}
+
+static uint32_t lower_binary_op(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  const binary_op_kind_t kind = node->binary_op.kind;
+
+  switch(kind) {
+    case BINARY_OP_LOGICAL_AND:
+    case BINARY_OP_LOGICAL_OR: return lower_logical(l, node);
+
+    case BINARY_OP_COMMA: {
+      lower_expr(l, node->binary_op.lhs);
+      return lower_expr(l, node->binary_op.rhs);
+    }
+
+    case BINARY_OP_INDEX: return load(l, lower_lvalue(l, node));
+
+    case BINARY_OP_ASSIGNMENT: {
+      const lvalue_t lvalue = lower_lvalue(l, node->binary_op.lhs);
+
+      return store(l, lvalue, lower_expr(l, node->binary_op.rhs));
+    }
+
+    default: break;
+  }
+
+  if (compound_ops[kind] != BINARY_OP_UNKNOWN) {
+    return lower_compound_assignment(l, node, compound_ops[kind]);
+  }
+
+  const uint32_t lhs = lower_expr(l, node->binary_op.lhs);
+  const uint32_t rhs = lower_expr(l, node->binary_op.rhs);
+
+  return emit(l, (ir_inst_t){ .op = IR_OP_BINARY, .sub = kind, .type = node->type, .args = { lhs, rhs } });
+}
+
+// the args are lowered first and then added to the operands together, as they may have calls of their own
+static uint32_t lower_call(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  ir_function_t *f = l->f;
+  const size_t saved = l->stack.length;
+  const size_t arg_count = node->call.args ? node->call.args->length : 0;
+
+  ir_push(l->arena, &l->stack, lower_expr(l, node->call.callee));
+
+  for (size_t i = 0; i < arg_count; i++) {
+    ir_push(l->arena, &l->stack, lower_expr(l, &node->call.args->items[i]));
+  }
+
+  const uint32_t first = (uint32_t)f->operands.length;
+
+  for (size_t i = saved; i < l->stack.length; i++) {
+    ir_push(l->arena, &f->operands, l->stack.items[i]);
+  }
+
+  l->stack.length = saved;
+
+  const ast_node_t *callee = ast_ungroup(node->call.callee);
+  const ast_node_t *literal = format_literal(node->call.args);
+  uint64_t format = 0;
+
+  // the format is compiled here once rather than parsed by every call the runtime makes
+  if (callee->kind == AST_NODE_KIND_SYMBOL && callee->symbol.binding == SYMBOL_BINDING_EXTERN &&
+      sv_eq_cstr(callee->symbol.name, FORMAT_PRINTF) && literal != NULL) {
+    // lowered with the args, so it's in the pool
+    string_pool_entry_t entry = {0};
+
+    string_pool_intern(l->arena, l->strings, literal->literal.value, &entry);
+    ir_push(l->arena, &f->formats, format_compile(l->arena, string_pool_at(l->strings, entry.offset), entry.length));
+    format = f->formats.length;
+  }
+
+  return emit(l, (ir_inst_t){ .op = IR_OP_CALL, .type = node->type, .args = { first, (uint32_t)(arg_count + 1) }, .imm = format });
+}
+
+static uint32_t lower_symbol(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  const uint32_t slot = node->symbol.slot;
+
+  switch(node->symbol.binding) {
+    case SYMBOL_BINDING_EXTERN: return emit(l, (ir_inst_t){ .op = IR_OP_EXTERN, .type = node->type, .imm = slot });
+
+    case SYMBOL_BINDING_GLOBAL: {
+      if (is_function(l, node)) {
+        return emit(l, (ir_inst_t){ .op = IR_OP_FUNCTION, .type = node->type, .imm = slot });
+      }
+    } break;
+
+    default: break;
+  }
+
+  return load(l, lower_lvalue(l, node));
+}
+
+// the checker added the literal to the pool, so it's only looked up by its spelling
+static uint32_t lower_string(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  string_pool_entry_t entry = {0};
+  const char *err = string_pool_intern(l->arena, l->strings, node->literal.value, &entry);
+
+  assertm(err == NULL, "Expected: a string literal the checker decoded, Received: %s", err);
+
+  return emit(l, (ir_inst_t){ .op = IR_OP_STRING, .type = node->type, .imm = entry.offset });
+}
+
+static uint32_t lower_expr(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  if (is_opaque(l, node)) {
+    return expr(l, node);
+  }
+
+  switch(node->kind) {
+    case AST_NODE_KIND_LIST: return lower_expr(l, lower_group(l, node));
+
+    case AST_NODE_KIND_LITERAL: {
+      return node->literal.kind == LITERAL_KIND_STRING ? lower_string(l, node) : constant(l, node->literal.integer, node->type);
+    }
+
+    case AST_NODE_KIND_SYMBOL: return lower_symbol(l, node);
+    case AST_NODE_KIND_UNARY_OP: return lower_unary_op(l, node);
+    case AST_NODE_KIND_BINARY_OP: return lower_binary_op(l, node);
+    case AST_NODE_KIND_TERNARY: return lower_ternary(l, node);
+    case AST_NODE_KIND_CALL: return lower_call(l, node);
+    default: assertm(false, "Expected: an expression, Received: %s", node_kind_name(node->kind));
+  }
+
+  return IR_NO_VALUE;
+}
+
+// locals an ast node kept as is refers to have to be in the frame for it to find them
+static void keep_in_frame(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  if (node->kind == AST_NODE_KIND_SYMBOL && node->symbol.binding == SYMBOL_BINDING_LOCAL) {
+    l->in_frame[node->symbol.slot] = true;
+  }
+
+  for (size_t i = 0; i < ast_child_count(node); i++) {
+    keep_in_frame(l, ast_child(node, i));
+  }
+}
+
+// finds the locals that can't be promoted, as they have their address taken or are used by an opaque expression
+static void scan(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  if (node->kind == AST_NODE_KIND_UNARY_OP && (node->unary_op.kind == UNARY_OP_SIZEOF || node->unary_op.kind == UNARY_OP_ALIGNOF)) {
+    return; // the operand isn't evaluated
+  }
+
+  if (is_opaque(l, node)) {
+    keep_in_frame(l, node);
+    return;
+  }
+
+  if (node->kind == AST_NODE_KIND_UNARY_OP && node->unary_op.kind == UNARY_OP_ADDR_OF) {
+    const ast_node_t *operand = ast_ungroup(node->unary_op.expr);
+
+    if (operand->kind == AST_NODE_KIND_SYMBOL && operand->symbol.binding == SYMBOL_BINDING_LOCAL) {
+      l->addressed[operand->symbol.slot] = true;
+    }
+  }
+
+  for (size_t i = 0; i < ast_child_count(node); i++) {
+    scan(l, ast_child(node, i));
+  }
+}
+
+static void declare_slot(ir_lowerer_t l[const static 1], const ast_node_t declaration[const static 1])
+{
+  const uint32_t slot = l->next_slot++;
+  const type_t *type = declaration->declaration.type;
+
+  assertm(slot < l->f->ast->frame_size, "Expected: a slot for every declaration of %s", node_kind_name(declaration->kind));
+  l->f->slot_names[slot] = declaration->declaration.name;
+  l->slot_types[slot] = value_type(l, type);
+  // a static local outlives the call, so it's stored like a global would be
+  l->f->slot_kinds[slot] = type->storage & (STORAGE_CLASS_STATIC | STORAGE_CLASS_EXTERN | STORAGE_CLASS_THREAD_LOCAL) ?
+    IR_SLOT_STATIC : IR_SLOT_FRAME;
+  l->in_frame[slot] = !type_is_scalar(type) || (type->qualifiers & TYPE_QUALIFIER_VOLATILE) ||
+    l->f->slot_kinds[slot] == IR_SLOT_STATIC;
+}
+
+static inline bool is_local_declaration(const ast_node_t node[const static 1])
+{
+  const sv_t name = node->declaration.name;
+
+  return node->kind == AST_NODE_KIND_DECLARATION && !(name.buf && name.length == 0);
+}
+
+static void lower_statement(ir_lowerer_t l[const static 1], const ast_node_t node[const static 1])
+{
+  switch(node->kind) {
+    case AST_NODE_KIND_DECLARATION: {
+      if (!is_local_declaration(node)) {
+        break;
+      }
+
+      const uint32_t slot = l->next_slot++;
+      const lvalue_t lvalue = { .kind = l->in_frame[slot] ? LVALUE_LOCAL : LVALUE_PROMOTED, .slot = slot, .type = l->slot_types[slot] };
+
+      // a static local is initialized once before the program runs, like a global, not whenever it's declared
+      if (node->declaration.init && l->f->slot_kinds[slot] != IR_SLOT_STATIC) {
+        store(l, lvalue, lower_expr(l, node->declaration.init));
+      } else if (lvalue.kind == LVALUE_PROMOTED) {
+        l->defs[slot] = emit(l, (ir_inst_t){ .op = IR_OP_UNDEF, .type = lvalue.type, .imm = slot });
+      }
+    } break;
+
+    // the statements after a return are lowered into a block nothing jumps to, which the optimizations drop
+    case AST_NODE_KIND_RETURN: {
+      terminate(l, IR_OP_RETURN, node->ret.expr ? lower_expr(l, node->ret.expr) : IR_NO_VALUE);
+      start_block(l);
+    } break;
+
+    case AST_NODE_KIND_FUNCTION: break; // a prototype
+
+    default: lower_expr(l, node); break;
+  }
+}
+
+static void lower_body(ir_lowerer_t l[const static 1], const ast_function_t function[const static 1])
+{
+  const uint32_t param_count = function->params ? (uint32_t)function->params->length : 0;
+
+  for (uint32_t slot = 0; slot < function->frame_size; slot++) {
+    l->defs[slot] = IR_NO_VALUE;
+  }
+
+  start_block(l);
+
+  for (uint32_t slot = 0; slot < param_count; slot++) {
+    const ir_inst_t param = { .op = IR_OP_PARAM, .type = l->slot_types[slot], .imm = slot };
+
+    if (l->in_frame[slot]) {
+      emit(l, (ir_inst_t){ .op = IR_OP_STORE_LOCAL, .args = { emit(l, param) }, .imm = slot });
+    } else {
+      l->defs[slot] = emit(l, param);
+    }
+  }
+
+  l->next_slot = param_count;
+
+  for (size_t i = 0; i < function->body->length; i++) {
+    lower_statement(l, &function->body->items[i]);
+  }
+
+  // falling off the end returns nothing
+  terminate(l, IR_OP_RETURN, IR_NO_VALUE);
+}
+
+/**
+ * Escape analysis of the lowered body, where the locals that have their address taken are still in the frame:
+ * an address escapes when it's used for anything but a copy, a pointer conversion or the address of a load or
+ * store of the type of the local, e.g., passed to a call, stored, compared or offset. Clears addressed for the
+ * locals whose address escapes and returns whether any local is left to promote.
+ */
+static bool find_escapes(ir_lowerer_t l[const static 1])
+{
+  ir_function_t *f = l->f;
+  bool promotable = false;
+
+  for (uint32_t v = 0; v < f->insts.length; v++) {
+    ir_inst_t *inst = &f->insts.items[v];
+    size_t count = 0;
+    const uint32_t *operands = ir_operands(f, inst, &count);
+
+    for (size_t i = 0; i < count; i++) {
+      const uint32_t slot = addressed_slot(l, operands[i]);
+
+      if (slot == IR_NO_VALUE || !l->addressed[slot]) {
+        continue;
+      }
+
+      switch(inst->op) {
+        case IR_OP_COPY: break;
+        case IR_OP_UNARY: l->addressed[slot] &= addressed_slot(l, v) == slot; break;
+        case IR_OP_LOAD: l->addressed[slot] &= inst->type == l->slot_types[slot]; break;
+        case IR_OP_STORE: l->addressed[slot] &= i == 0 && f->insts.items[inst->args[1]].type == l->slot_types[slot]; break;
+        default: l->addressed[slot] = false; break;
+      }
+    }
+  }
+
+  for (uint32_t slot = 0; slot < f->ast->frame_size; slot++) {
+    promotable |= l->addressed[slot];
+  }
+
+  return promotable;
+}
+
+static void lower_function(ir_lowerer_t l[const static 1], const ast_function_t function[const static 1])
+{
+  ir_function_t *f = l->f;
+  const size_t slots = zdx_max(function->frame_size, 1);
+
+  f->ast = function;
+  f->global = resolve_global_slot(l->resolver, function->name);
+  f->slot_count = function->frame_size;
+  f->slot_names = arena_calloc(l->arena, slots, sizeof(*f->slot_names));
+  f->slot_kinds = arena_calloc(l->arena, slots, sizeof(*f->slot_kinds));
+  l->slot_types = arena_calloc(l->arena, slots, sizeof(*l->slot_types));
+  l->in_frame = arena_calloc(l->arena, slots, sizeof(*l->in_frame));
+  l->addressed = arena_calloc(l->arena, slots, sizeof(*l->addressed));
+  l->defs = arena_calloc(l->arena, slots, sizeof(*l->defs));
+  assertm(!l->arena->err, "Expected: slot arrays alloc to succeed, Received: %s", l->arena->err);
+  l->next_slot = 0;
+  l->stack.length = 0;
+
+  for (size_t i = 0; function->params && i < function->params->length; i++) {
+    declare_slot(l, &function->params->items[i]);
+  }
+
+  for (size_t i = 0; i < function->body->length; i++) {
+    const ast_node_t *statement = &function->body->items[i];
+
+    if (is_local_declaration(statement)) {
+      declare_slot(l, statement);
+    }
+
+    for (size_t j = 0; j < ast_child_count(statement); j++) {
+      scan(l, ast_child(statement, j));
+    }
+  }
+
+  // locals that have their address taken are in the frame until the lowered body shows it doesn't escape
+  for (uint32_t slot = 0; slot < function->frame_size; slot++) {
+    l->addressed[slot] &= !l->in_frame[slot];
+    l->in_frame[slot] |= l->addressed[slot];
+  }
+
+  lower_body(l, function);
+
+  // lowered again with the locals that don't escape promoted, in the arrays of the first lowering
+  if (find_escapes(l)) {
+    for (uint32_t slot = 0; slot < function->frame_size; slot++) {
+      l->in_frame[slot] &= !l->addressed[slot];
+    }
+
+    f->insts.length = f->blocks.length = f->operands.length = f->exprs.length = f->switches.length = f->ranges.length = f->formats.length = 0;
+    l->stack.length = 0;
+    lower_body(l, function);
+  }
+
+  for (uint32_t slot = 0; slot < function->frame_size; slot++) {
+    if (!l->in_frame[slot]) {
+      f->slot_kinds[slot] = IR_SLOT_VALUE;
+    }
+  }
+}
+
+ir_program_t ir_lower(arena_t arena[const static 1], type_table_t types[const static 1], const resolver_t resolver[const static 1],
+                      string_pool_t strings[const static 1], const ast_node_t program[const static 1])
+{
+  check_program(*program);
+
+  ir_program_t ir = {
+    .types = types,
+    .global_count = (uint32_t)resolver->global_names.length,
+    .global_names = resolver->global_names.items,
+    .extern_names = resolver->extern_names.items,
+    .strings = strings,
+  };
+  ir_lowerer_t l = {
+    .arena = arena,
+    .types = types,
+    .resolver = resolver,
+    .strings = strings,
+    .int_type = type_intern(arena, types, (type_t){ .kind = TYPE_KIND_BASE, .specifiers = TYPE_SPEC_INT })->id,
+  };
+
+  for (size_t i = 0; program->children && i < program->children->length; i++) {
+    const ast_node_t *node = &program->children->items[i];
+
+    if (node->kind != AST_NODE_KIND_FUNCTION || node->function->body == NULL) {
+      continue;
+    }
+
+    ir_push(arena, &ir, (ir_function_t){0});
+    l.f = &ir.items[ir.length - 1];
+    lower_function(&l, node->function);
+
+    for (uint32_t slot = 0; slot < node->function->frame_size; slot++) {
+      ir.local_count++;
+      ir.memory_local_count += l.f->slot_kinds[slot] != IR_SLOT_VALUE;
+    }
+
+    for (size_t s = 0; s < l.f->switches.length; s++) {
+      ir.switch_count++;
+      ir.jump_table_count += l.f->switches.items[s].table_count;
+    }
+
+    ir.format_count += l.f->formats.length;
+  }
+
+  string_pool_seal(strings);
+
+  return ir;
+}
+
+// ------------------------------------ PRINTING ------------------------------------
+
+static const char *binary_op_names[BINARY_OP_COUNT] = {
+  [BINARY_OP_ADD] = "add",
+  [BINARY_OP_SUB] = "sub",
+  [BINARY_OP_MULT] = "mul",
+  [BINARY_OP_DIV] = "div",
+  [BINARY_OP_EXPO] = "expo",
+  [BINARY_OP_MOD] = "mod",
+  [BINARY_OP_LSHIFT] = "shl",
+  [BINARY_OP_RSHIFT] = "shr",
+  [BINARY_OP_LT] = "lt",
+  [BINARY_OP_LTE] = "lte",
+  [BINARY_OP_GT] = "gt",
+  [BINARY_OP_GTE] = "gte",
+  [BINARY_OP_EQ] = "eq",
+  [BINARY_OP_NEQ] = "neq",
+  [BINARY_OP_BIT_AND] = "and",
+  [BINARY_OP_BIT_XOR] = "xor",
+  [BINARY_OP_BIT_OR] = "or",
+};
+
+static const char *unary_op_names[UNARY_OP_COUNT] = {
+  [UNARY_OP_NOT] = "not",
+  [UNARY_OP_NEGATE] = "neg",
+  [UNARY_OP_POSITIVE] = "pos",
+  [UNARY_OP_BIT_NOT] = "bit_not",
+  [UNARY_OP_CONVERT] = "convert",
+};
+
+// an instruction or header line, written to the stream in one go when it ends or fills up
+typedef struct {
+  FILE *out;
+  size_t length;
+  char buf[256];
+} ir_line_t;
+
+static void line_flush(ir_line_t line[const static 1])
+{
+  fwrite(line->buf, 1, line->length, line->out);
+  line->length = 0;
+}
+
+__attribute__((format(printf, 2, 3)))
+static void line_fmt(ir_line_t line[const static 1], const char *fmt, ...)
+{
+  va_list args;
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    va_start(args, fmt);
+    const int length = vsnprintf(line->buf + line->length, sizeof(line->buf) - line->length, fmt, args);
+    va_end(args);
+
+    assertm(length >= 0, "Expected: '%s' to be formatted", fmt);
+
+    if ((size_t)length < sizeof(line->buf) - line->length) {
+      line->length += (size_t)length;
+      return;
+    }
+
+    line_flush(line);
+  }
+
+  // longer than the whole buffer, e.g., a very long name
+  va_start(args, fmt);
+  vfprintf(line->out, fmt, args);
+  va_end(args);
+}
+
+static void line_end(ir_line_t line[const static 1])
+{
+  line_fmt(line, "\n");
+  line_flush(line);
+}
+
+// constants and switch ranges of signed integer types are sign extended to 64 bits
+static bool is_signed_type(const ir_program_t program[const static 1], const uint32_t type_id)
+{
+  if (type_id == TYPE_NO_ID) {
+    return false;
+  }
+
+  const type_t *type = type_by_id(program->types, type_id);
+
+  return type->kind == TYPE_KIND_BASE && !type_is_unsigned(type->specifiers);
+}
+
+static void print_inst(ir_line_t line[const static 1], const ir_program_t program[const static 1], ir_function_t f[const static 1],
+                       const uint32_t value)
+{
+  ir_inst_t *inst = &f->insts.items[value];
+  size_t count = 0;
+  const uint32_t *operands = ir_operands(f, inst, &count);
+  const char *name = ir_op_name(inst->op);
+
+  if (inst->op == IR_OP_UNARY || inst->op == IR_OP_BINARY) {
+    name = inst->op == IR_OP_UNARY ? unary_op_names[inst->sub] : binary_op_names[inst->sub];
+    name = name ? name : ir_op_name(inst->op);
+  }
+
+  line_fmt(line, "    ");
+
+  if (inst->type != TYPE_NO_ID) {
+    line_fmt(line, "v%u = ", value);
+  }
+
+  line_fmt(line, "%s%s", (inst->op == IR_OP_LOAD || inst->op == IR_OP_STORE) && (inst->sub & IR_ACCESS_CHECKED) ? "checked " : "", name);
+
+  switch(inst->op) {
+    case IR_OP_CONST: {
+      // constants are kept sign extended to 64 bits
+      if (is_signed_type(program, inst->type)) {
+        line_fmt(line, " %lld", (long long)(int64_t)inst->imm);
+      } else {
+        line_fmt(line, " %llu", (unsigned long long)inst->imm);
+      }
+    } break;
+    case IR_OP_STRING: line_fmt(line, " @%llu", (unsigned long long)inst->imm); break;
+    case IR_OP_EXPR: line_fmt(line, " %s", node_kind_name(f->exprs.items[inst->imm]->kind)); break;
+
+    case IR_OP_UNDEF:
+    case IR_OP_PARAM:
+    case IR_OP_ADDR_LOCAL:
+    case IR_OP_LOAD_LOCAL:
+    case IR_OP_STORE_LOCAL: line_fmt(line, " "SV_FMT, sv_fmt_args(f->slot_names[inst->imm])); break;
+
+    case IR_OP_EXTERN: line_fmt(line, " "SV_FMT, sv_fmt_args(program->extern_names[inst->imm])); break;
+
+    case IR_OP_CALL:
+    case IR_OP_TAIL_CALL: {
+      if (inst->imm != 0) {
+        line_fmt(line, " [format of %u steps]", f->formats.items[inst->imm - 1].step_count);
+      }
+    } break;
+
+    case IR_OP_FUNCTION:
+    case IR_OP_ADDR_GLOBAL:
+    case IR_OP_LOAD_GLOBAL:
+    case IR_OP_STORE_GLOBAL: line_fmt(line, " "SV_FMT, sv_fmt_args(program->global_names[inst->imm])); break;
+    default: break;
+  }
+
+  ir_block_t *block = &f->blocks.items[inst->block];
+  size_t succ_count = 0;
+  const uint32_t *succs = ir_succs(f, block, &succ_count);
+
+  for (size_t i = 0; i < count; i++) {
+    line_fmt(line, "%s v%u", i == 0 ? "" : ",", operands[i]);
+
+    if (inst->op == IR_OP_PHI) {
+      line_fmt(line, " (b%u)", block->preds[i]);
+    }
+  }
+
+  for (size_t i = 0; ir_is_terminator(inst->op) && i < succ_count; i++) {
+    line_fmt(line, "%s b%u", i == 0 && count == 0 ? "" : ",", succs[i]);
+  }
+
+  // the ranges of a switch, with the block each of their values goes to
+  if (inst->op == IR_OP_SWITCH) {
+    const ir_switch_t *sw = &f->switches.items[inst->imm];
+    const bool is_signed = is_signed_type(program, f->insts.items[operands[0]].type);
+
+    for (uint32_t r = 0; r < sw->range_count; r++) {
+      const ir_case_range_t *range = &f->ranges.items[sw->first_range + r];
+      const uint32_t *table = &f->operands.items[sw->operands + range->table];
+
+      if (is_signed) {
+        line_fmt(line, " [%lld", (long long)(int64_t)range->low);
+      } else {
+        line_fmt(line, " [%llu", (unsigned long long)range->low);
+      }
+
+      if (range->high != range->low && is_signed) {
+        line_fmt(line, "..%lld", (long long)(int64_t)range->high);
+      } else if (range->high != range->low) {
+        line_fmt(line, "..%llu", (unsigned long long)range->high);
+      }
+
+      line_fmt(line, ":");
+
+      for (uint64_t i = 0; i <= range->high - range->low; i++) {
+        line_fmt(line, " b%u", succs[table[i]]);
+      }
+
+      line_fmt(line, "]");
+    }
+  }
+
+  if (inst->type != TYPE_NO_ID) {
+    const type_t *type = type_by_id(program->types, inst->type);
+    char buf[64] = "?"; // the checker doesn't know the type, e.g., of a function
+    type_writer_t w = { .buf = buf, .size = sizeof(buf) - 1 };
+
+    if (type->kind != TYPE_KIND_UNKNOWN) {
+      write_type(&w, type);
+    }
+
+    line_fmt(line, " : %s", buf);
+  }
+
+  line_end(line);
+}
+
+void ir_print(const ir_program_t program[const static 1], FILE *out)
+{
+  ir_line_t line = { .out = out };
+
+  for (size_t i = 0; i < program->length; i++) {
+    ir_function_t *f = &program->items[i];
+
+    line_fmt(&line, "function "SV_FMT", %u slots, %zu instructions\n", sv_fmt_args(f->ast->name), f->slot_count,
+            ir_function_size(f));
+
+    for (uint32_t slot = 0, listed = 0; slot < f->slot_count; slot++) {
+      if (f->slot_kinds[slot] != IR_SLOT_VALUE) {
+        line_fmt(&line, "%s "SV_FMT"%s", listed++ == 0 ? "  in memory:" : ",", sv_fmt_args(f->slot_names[slot]),
+                f->slot_kinds[slot] == IR_SLOT_STATIC ? " (static)" : "");
+      }
+
+      if (slot + 1 == f->slot_count && listed > 0) {
+        line_end(&line);
+      }
+    }
+
+    for (uint32_t b = 0; b < f->blocks.length; b++) {
+      const ir_block_t *block = &f->blocks.items[b];
+
+      if (block->dead) {
+        continue;
+      }
+
+      line_fmt(&line, "  b%u:", b);
+
+      for (size_t p = 0; p < block->pred_count; p++) {
+        line_fmt(&line, "%s b%u", p == 0 ? " preds" : ",", block->preds[p]);
+      }
+
+      line_end(&line);
+
+      for (uint32_t v = block->first; v < block->first + block->length; v++) {
+        if (f->insts.items[v].op != IR_OP_NOP) {
+          print_inst(&line, program, f, v);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,252 @@
+#ifndef IR_H_
+#define IR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "./format.h"
+#include "./parser2.h"
+#include "./resolve.h"
+#include "./string_pool.h"
+#include "./types.h"
+
+#include "./zdx_simple_arena.h"
+
+#define IR_MIN_CAP 16
+
+// appends to one of the arena lists below, growing it by doubling
+#define ir_push(arena, list, item)                                                                        \
+  do {                                                                                                    \
+    if ((list)->length == (list)->capacity) {                                                             \
+      const size_t capacity = zdx_max((list)->capacity * 2, IR_MIN_CAP);                                  \
+                                                                                                          \
+      (list)->items = arena_realloc((arena), (list)->items, (list)->capacity * sizeof(*(list)->items),    \
+                                    capacity * sizeof(*(list)->items));                                   \
+      assertm(!(arena)->err, "Expected: ir list resize to be successful, Received: %s", (arena)->err);    \
+      (list)->capacity = capacity;                                                                        \
+    }                                                                                                     \
+                                                                                                          \
+    (list)->items[(list)->length++] = (item);                                                             \
+  } while(0)
+
+// a value is the index of the instruction that defines it in ir_function_t.insts
+#define IR_NO_VALUE UINT32_MAX
+
+typedef enum {
+  IR_OP_NOP, // removed by an optimization, skipped by everything
+  IR_OP_CONST, // imm is the integer value, normalized to the type like fold_normalize() does
+  IR_OP_UNDEF, // value of a local that is read before it's assigned, imm is its slot
+  IR_OP_PARAM, // imm is the slot of the param
+  IR_OP_PHI, // args[i] is the value coming in from preds[i] of the block
+  IR_OP_COPY, // of args[0], what an assignment to a promoted local defines
+  IR_OP_UNARY, // sub is the unary_op_kind_t of args[0], one of the arithmetic ones, ! or a conversion
+  IR_OP_BINARY, // sub is the binary_op_kind_t of args[0] and args[1], arithmetic, bitwise or a comparison, a pointer
+               // plus or minus an integer moves by elements like in C
+  IR_OP_FUNCTION, // address of the function of global slot imm
+  IR_OP_EXTERN, // address of the extern of slot imm
+  IR_OP_ADDR_LOCAL, // address of the frame slot imm
+  IR_OP_ADDR_GLOBAL, // address of the global slot imm
+  IR_OP_STRING, // address of the string literal at offset imm of the read-only segment of ir_program_t.strings
+  IR_OP_LOAD_LOCAL, // of the frame slot imm
+  IR_OP_LOAD_GLOBAL, // of the global slot imm
+  IR_OP_LOAD, // from the address args[0], sub is IR_ACCESS_CHECKED if it has to be bounds checked
+  IR_OP_STORE_LOCAL, // args[0] to the frame slot imm
+  IR_OP_STORE_GLOBAL, // args[0] to the global slot imm
+  IR_OP_STORE, // args[1] to the address args[0], sub like the one of IR_OP_LOAD
+  IR_OP_CALL, // callee and args are args[1] operands from args[0] in ir_function_t.operands, the callee first, imm is
+             // 1 + the index of the compiled format of a printf in ir_function_t.formats, or 0
+  IR_OP_EXPR, // ast node imm of ir_function_t.exprs, evaluated as is, e.g., a member access
+  IR_OP_JUMP, // to succs[0] of the block
+  IR_OP_BRANCH, // to succs[0] if args[0] isn't 0 and to succs[1] otherwise
+  IR_OP_SWITCH, // on the integer args[0], to the block ir_function_t.switches[imm] picks for it, see ir_switch_t
+  IR_OP_RETURN, // args[0] or IR_NO_VALUE
+  IR_OP_TAIL_CALL, // a call like IR_OP_CALL whose value is returned, the callee reuses the frame, see ir_tail_calls()
+  IR_OP_COUNT,
+} ir_op_t;
+
+typedef struct {
+  uint8_t op; // ir_op_t
+  uint8_t sub; // unary_op_kind_t or binary_op_kind_t, or the IR_ACCESS_ flags of a load or store
+  uint16_t type; // id in the type table of the checker, TYPE_NO_ID if it has no value
+  uint32_t block;
+  uint32_t args[2];
+  uint64_t imm;
+} ir_inst_t;
+
+// a load or store through an address that a safe interpreter has to check against the object it points into,
+// every one is until ir_bounds_checks() proves it can't leave its object
+#define IR_ACCESS_CHECKED 1
+
+// Blocks merge at most two paths, the ends of the branches of a &&, || or ternary
+typedef struct {
+  uint32_t first; // the instructions of a block are insts[first] to insts[first + length - 1], the terminator last
+  uint32_t length;
+  uint32_t preds[2];
+  uint32_t succs[2]; // of a jump or branch, the ones of a switch are its own, see ir_succs()
+  uint8_t pred_count;
+  uint8_t succ_count;
+  bool dead; // unreachable, its instructions are all nops
+} ir_block_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  ir_inst_t *items;
+} ir_insts_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  ir_block_t *items;
+} ir_blocks_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  uint32_t *items;
+} ir_operands_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  const ast_node_t **items;
+} ir_exprs_t;
+
+// cases a chain of x == c ? a : ... comparisons needs to be lowered to a switch rather than to a branch each
+#define IR_SWITCH_MIN_CASES 4
+// percentage of the values of a range of cases that have to be cases for the range to be a jump table
+#define IR_SWITCH_MIN_DENSITY 40
+// cases a jump table needs, fewer are searched for like sparse ones
+#define IR_SWITCH_MIN_TABLE_CASES 3
+// entries of the largest jump table
+#define IR_SWITCH_MAX_TABLE 4096
+
+// consecutive values of a switch, from low to high, the value low + i goes to succs[operands[table + i]] of the switch
+typedef struct {
+  uint64_t low; // normalized to the type of the switch like the imm of IR_OP_CONST
+  uint64_t high;
+  uint32_t table; // relative to the operands of the switch
+} ir_case_range_t;
+
+/**
+ * The case values of a switch, sorted and cut into ranges: a dense run of cases is a jump table, indexed by the
+ * value minus the first one, and a sparse case is a range of its own. Finding the range of a value is a binary
+ * search, so a switch of dense cases is a single table lookup, one of sparse cases a binary search and one of
+ * clusters of cases a binary search of jump tables. Values outside the ranges go to the default block, succs[0].
+ */
+typedef struct {
+  uint32_t operands; // in ir_function_t.operands, the succs of the switch and then the entries of its tables
+  uint32_t operand_count;
+  uint32_t succ_count;
+  uint32_t first_range; // in ir_function_t.ranges, sorted by low
+  uint32_t range_count;
+  uint32_t table_count; // ranges of more than one value
+} ir_switch_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  ir_switch_t *items;
+} ir_switches_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  format_plan_t *items;
+} ir_formats_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  ir_case_range_t *items;
+} ir_case_ranges_t;
+
+// where the value of a param or local lives
+typedef enum {
+  IR_SLOT_VALUE, // in SSA values, the slot is never loaded or stored
+  IR_SLOT_FRAME, // in the memory of the call, as its address escapes or it isn't a scalar
+  IR_SLOT_STATIC, // in memory that outlives the call, a static, extern or thread_local local
+} ir_slot_t;
+
+typedef struct {
+  const ast_function_t *ast;
+  uint32_t global; // slot of the function, what the IR_OP_FUNCTION of its callers refers to it by
+  ir_insts_t insts;
+  ir_blocks_t blocks; // blocks[0] is the entry, every edge goes to a block with a higher index
+  ir_operands_t operands;
+  ir_exprs_t exprs;
+  ir_switches_t switches;
+  ir_case_ranges_t ranges;
+  ir_formats_t formats; // of the printf calls with a literal format, compiled once when lowered
+  uint32_t slot_count; // the frame_size of the params and locals, and the slots of the functions inlined into it
+  sv_t *slot_names;
+  uint8_t *slot_kinds; // ir_slot_t of each slot
+} ir_function_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  ir_function_t *items;
+  const type_table_t *types;
+  uint32_t global_count;
+  const sv_t *global_names; // by slot, of the resolver
+  const sv_t *extern_names;
+  const string_pool_t *strings; // sealed, the data segment of the string literals
+  size_t local_count; // params and locals of every function
+  size_t memory_local_count; // the ones that aren't IR_SLOT_VALUE
+  size_t switch_count; // chains of comparisons lowered to switches
+  size_t jump_table_count;
+  size_t tail_call_count; // found by ir_optimize()
+  size_t reduced_count; // operations ir_optimize() made cheaper
+  size_t common_count; // common subexpressions ir_optimize() removed
+  size_t checks_removed; // bounds checks of loads and stores ir_optimize() proved unneeded
+  size_t checks_kept;
+  size_t format_count; // printf formats compiled when lowered
+} ir_program_t;
+
+/**
+ * Lowers the body of every function definition of a checked program to an SSA IR of basic blocks, so that
+ * optimizations (see ir_opt.h) and, later, an interpreter work on a flat list of operations instead of the tree.
+ * The IR of a function is a few arena arrays indexed by 32 bit ids rather than nodes linked by pointers.
+ *
+ * Params and locals of a scalar type become SSA values: each assignment defines a new value (a copy) and where
+ * two paths merge, after a &&, || or ternary, a phi picks the value of the path taken. A local that has its
+ * address taken stays one when the address doesn't escape, i.e., when it's only dereferenced, as in
+ * int *p = &x; *p += 1; the dereferences then use and define the values of x. Otherwise, the address may be kept
+ * or passed anywhere and x is loaded and stored in memory, like globals and everything behind a pointer are. Expressions the IR has no operations for yet, like member accesses, are
+ * kept as ast nodes that are evaluated as is, locals they use stay in the frame for them. A string literal is
+ * the address of its decoded string in the pool the checker added it to, which is sealed once every function is
+ * lowered, so the strings are read-only and the same literal is the same address everywhere.
+ *
+ * The language has no switch statement, so a switch is written as a chain of ternaries on the same variable,
+ * x == 1 ? a : x == 2 ? b : c. A chain of at least IR_SWITCH_MIN_CASES comparisons with constants reads x once
+ * and dispatches on it with a switch, straight to the branch of its value, instead of comparing it with each
+ * constant in turn.
+ *
+ * The program has to be resolved and type checked without errors. The resolve pass parses the bodies a lazy parse
+ * skipped, the ones it left unparsed, as it had no parser_opts, are skipped and the lowering recurses as deep as
+ * the expressions nest, which the parser bounds.
+ */
+ir_program_t ir_lower(arena_t arena[const static 1], type_table_t types[const static 1], const resolver_t resolver[const static 1],
+                      string_pool_t strings[const static 1], const ast_node_t program[const static 1]);
+
+const char *ir_op_name(const ir_op_t op);
+// the values an instruction uses, in place so that they can be rewritten, count is set to their number
+uint32_t *ir_operands(ir_function_t f[const static 1], ir_inst_t inst[const static 1], size_t count[const static 1]);
+static inline bool ir_is_terminator(const uint8_t op)
+{
+  return op == IR_OP_JUMP || op == IR_OP_BRANCH || op == IR_OP_SWITCH || op == IR_OP_RETURN || op == IR_OP_TAIL_CALL;
+}
+// the blocks a block may go to next, in place so that they can be rewritten, count is set to their number
+uint32_t *ir_succs(ir_function_t f[const static 1], ir_block_t block[const static 1], size_t count[const static 1]);
+// the block a switch goes to for value, which has the type of the switch, signed or not
+uint32_t ir_switch_target(const ir_function_t f[const static 1], const ir_switch_t sw[const static 1], const bool is_signed,
+                          const uint64_t value);
+// instructions that aren't nops
+size_t ir_function_size(const ir_function_t f[const static 1]);
+size_t ir_program_size(const ir_program_t program[const static 1]);
+// prints the blocks of every function to out, one instruction a line, each written out whole
+void ir_print(const ir_program_t program[const static 1], FILE *out);
+
+#endif // IR_H_
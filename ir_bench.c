@@ -0,0 +1,391 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "./parser2.h"
+#include "./passes.h"
+#include "./resolve.h"
+#include "./typecheck.h"
+#include "./fold.h"
+#include "./ir.h"
+#include "./ir_opt.h"
+
+#include "./zdx_util.h"
+
+#define ZDX_SIMPLE_ARENA_IMPLEMENTATION
+#include "./zdx_simple_arena.h"
+
+#define BENCH_ARENA_SIZE (512 MB)
+#define BENCH_MIN_ITERATIONS 5
+#define BENCH_MIN_SECONDS 0.25
+
+typedef struct {
+  const char *name;
+  char *source;
+  size_t length;
+} bench_corpus_t;
+
+// the optimizations a run leaves out, to see what each one is worth
+typedef struct {
+  const char *name;
+  uint32_t opts;
+} bench_config_t;
+
+typedef struct {
+  bool ok;
+  size_t iterations;
+  size_t instructions; // of the program after the optimizations
+  size_t calls; // left in the program
+  size_t tail_calls;
+  size_t sites; // call sites the inliner looked at
+  size_t inlined;
+  size_t switches; // chains of comparisons lowered to switches
+  size_t jump_tables;
+  size_t reduced; // operations strength reduction made cheaper
+  size_t common; // common subexpressions removed
+  size_t checks_removed; // bounds checks of loads and stores
+  size_t checks_kept;
+  size_t arena_bytes;
+  double seconds; // of lowering and optimizing, the front end isn't timed
+} bench_result_t;
+
+// arena_calloc() relies on fresh mmap-ed memory being zeroed so a reused arena has to be zeroed by hand
+static void bench_arena_reset(arena_t arena[const static 1])
+{
+  memset(arena->arena, 0, arena->offset);
+  arena_reset(arena);
+}
+
+static double now_seconds(void)
+{
+  struct timespec ts = {0};
+  timespec_get(&ts, TIME_UTC);
+
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// ------------------------------------ CORPORA ------------------------------------
+
+typedef struct {
+  char *buf;
+  size_t length;
+  size_t capacity;
+} bench_buf_t;
+
+static void buf_printf(bench_buf_t buf[const static 1], const char fmt[const static 1], ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  const int len = vsnprintf(NULL, 0, fmt, args);
+  va_end(args);
+
+  assertm(len >= 0, "Expected: corpus line to format");
+
+  if (buf->length + (size_t)len + 1 > buf->capacity) {
+    buf->capacity = zdx_max(buf->capacity * 2, buf->length + (size_t)len + 1);
+    buf->buf = realloc(buf->buf, buf->capacity);
+    assertm(buf->buf, "Expected: corpus buffer to grow to %zu bytes", buf->capacity);
+  }
+
+  va_start(args, fmt);
+  vsnprintf(buf->buf + buf->length, (size_t)len + 1, fmt, args);
+  va_end(args);
+  buf->length += (size_t)len;
+}
+
+static bench_corpus_t corpus(const char name[const static 1], const bench_buf_t buf)
+{
+  return (bench_corpus_t){ .name = name, .source = buf.buf, .length = buf.length };
+}
+
+// a few one line helpers, the kind scripts are full of, called from many functions with constants and params
+static bench_corpus_t small_helpers(const size_t callers)
+{
+  bench_buf_t buf = {0};
+
+  buf_printf(&buf, "int sq(int x) { return x * x; }\n");
+  buf_printf(&buf, "int add(int a, int b) { return a + b; }\n");
+  buf_printf(&buf, "int clamp(int x, int lo, int hi) { return x < lo ? lo : x > hi ? hi : x; }\n");
+  buf_printf(&buf, "int is_even(int x) { return (x & 1) == 0; }\n");
+
+  for (size_t i = 0; i < callers; i++) {
+    buf_printf(&buf, "int caller%zu(int n) { int a = add(n, %zu); int b = sq(a) + clamp(n, 0, %zu); "
+               "return is_even(b) ? add(a, b) : sq(%zu); }\n", i, i, i + 10, i % 7);
+  }
+
+  return corpus("small_helpers", buf);
+}
+
+// f0 calls f1 calls f2 and so on, inlined bottom up until the callees outgrow the budget
+static bench_corpus_t call_chain(const size_t length)
+{
+  bench_buf_t buf = {0};
+
+  buf_printf(&buf, "int link%zu(int x) { return x + 1; }\n", length - 1);
+
+  for (size_t i = length - 1; i-- > 0;) {
+    buf_printf(&buf, "int link%zu(int x) { return link%zu(x) * 2; }\n", i, i + 1);
+  }
+
+  return corpus("call_chain", buf);
+}
+
+// pairs of mutually recursive functions, whose calls to each other can never all be inlined
+static bench_corpus_t recursion(const size_t pairs)
+{
+  bench_buf_t buf = {0};
+
+  for (size_t i = 0; i < pairs; i++) {
+    buf_printf(&buf, "int even%zu(int n);\n", i);
+    buf_printf(&buf, "int odd%zu(int n) { return n ? even%zu(n - 1) : 0; }\n", i, i);
+    buf_printf(&buf, "int even%zu(int n) { return n ? odd%zu(n - 1) : 1; }\n", i, i);
+    buf_printf(&buf, "int fact%zu(int n) { return n > 1 ? n * fact%zu(n - 1) : 1; }\n", i, i);
+    buf_printf(&buf, "int use%zu(void) { return even%zu(10) + fact%zu(5); }\n", i, i, i);
+  }
+
+  return corpus("recursion", buf);
+}
+
+// one function calling the same helper over and over, until inlining it hits the limit of the caller
+static bench_corpus_t fan_out(const size_t calls)
+{
+  bench_buf_t buf = {0};
+
+  buf_printf(&buf, "int mix(int a, int b) { int t = a * 31 + b; return t ^ (t >> 3); }\n");
+  buf_printf(&buf, "int hub(int x) { int acc = 0;");
+
+  for (size_t i = 0; i < calls; i++) {
+    buf_printf(&buf, " acc = mix(acc, x + %zu);", i);
+  }
+
+  buf_printf(&buf, " return acc; }\n");
+
+  return corpus("fan_out", buf);
+}
+
+// a step function of a generated state machine, states in runs of 16 a hundred apart, as a chain of comparisons
+static bench_corpus_t state_machine(const size_t states)
+{
+  bench_buf_t buf = {0};
+
+  buf_printf(&buf, "int step(int state, int input) { return");
+
+  for (size_t i = 0; i < states; i++) {
+    const size_t state = i / 16 * 100 + i % 16;
+
+    buf_printf(&buf, " state == %zu ? (input ? %zu : %zu) :", state, (i + 1) / 16 * 100 + (i + 1) % 16, state);
+  }
+
+  buf_printf(&buf, " -1; }\n");
+  buf_printf(&buf, "int run(int input) { return step(step(step(0, input), input), input); }\n");
+
+  return corpus("state_machine", buf);
+}
+
+// walks over an array in unrolled steps, each one scaling its element by the same unsigned factor
+static bench_corpus_t array_walk(const size_t walks)
+{
+  bench_buf_t buf = {0};
+
+  for (size_t i = 0; i < walks; i++) {
+    buf_printf(&buf, "unsigned int walk%zu(unsigned int *a, unsigned int k) { unsigned int s = 0;", i);
+
+    for (size_t j = 0; j < 16; j++) {
+      buf_printf(&buf, " s += a[%zu] * (k * %zu) / 8 + s %% 16;", j, (size_t)1 << (i % 4 + 1));
+    }
+
+    buf_printf(&buf, " return s * 1; }\n");
+  }
+
+  return corpus("array_walk", buf);
+}
+
+// reads of the bytes of a local, guarded or masked into range or not, and of an array passed in, which can't be proven
+static bench_corpus_t byte_access(const size_t functions)
+{
+  bench_buf_t buf = {0};
+
+  for (size_t i = 0; i < functions; i++) {
+    buf_printf(&buf, "int bytes%zu(unsigned int i, int *p) { long x = %zu; void *v = &x; unsigned char *b = v; "
+               "return (i < 8 ? b[i] : b[i & 7]) + (i >= 2 && i <= 5 ? b[i + 2] : b[i %% 9]) + p[i] + p[i]; }\n", i, i);
+  }
+
+  return corpus("byte_access", buf);
+}
+
+// ------------------------------------ RUNS ------------------------------------
+
+static bool bench_program_ok(const ast_node_t program)
+{
+  return program.children && program.children->length &&
+    !has_err(program.children->items[program.children->length - 1]);
+}
+
+static size_t count_calls(const ir_program_t program[const static 1])
+{
+  size_t calls = 0;
+
+  for (size_t i = 0; i < program->length; i++) {
+    const ir_function_t *f = &program->items[i];
+
+    for (size_t v = 0; v < f->insts.length; v++) {
+      calls += f->insts.items[v].op == IR_OP_CALL;
+    }
+  }
+
+  return calls;
+}
+
+// runs the front end and then times the lowering and the optimizations of the config
+static bool run_once(arena_t arena[const static 1], const bench_corpus_t corpus[const static 1], const bench_config_t config[const static 1],
+                     bench_result_t result[const static 1])
+{
+  type_table_t types = {0};
+  pass_errors_t errors = {0};
+  pass_manager_t passes = {0};
+  resolver_t resolver = { .arena = arena, .errors = &errors };
+  string_pool_t strings = {0};
+  type_checker_t checker = { .arena = arena, .types = &types, .resolver = &resolver, .errors = &errors, .strings = &strings };
+  folder_t folder = { .arena = arena, .types = &types };
+  ast_node_t program = parse_with_opts(arena, corpus->source, corpus->length, &(parser_opts_t){0});
+
+  if (!bench_program_ok(program)) {
+    return false;
+  }
+
+  pass_register(&passes, resolve_pass(&resolver));
+  pass_register(&passes, typecheck_pass(&checker));
+  pass_register(&passes, fold_pass(&folder));
+  pass_manager_run(arena, &passes, &program);
+
+  if (errors.length > 0) {
+    return false;
+  }
+
+  const double start = now_seconds();
+  ir_program_t ir = ir_lower(arena, &types, &resolver, &strings, &program);
+  ir_opt_stats_t stats[IR_OPT_COUNT] = {0};
+  ir_inline_sites_t sites = {0};
+
+  ir_optimize(arena, &ir, config->opts, stats, &sites);
+
+  result->seconds += now_seconds() - start;
+  result->instructions = ir_program_size(&ir);
+  result->calls = count_calls(&ir);
+  result->tail_calls = ir.tail_call_count;
+  result->switches = ir.switch_count;
+  result->jump_tables = ir.jump_table_count;
+  result->reduced = ir.reduced_count;
+  result->common = ir.common_count;
+  result->checks_removed = ir.checks_removed;
+  result->checks_kept = ir.checks_kept;
+  result->sites = sites.length;
+  result->inlined = 0;
+
+  for (size_t i = 0; i < sites.length; i++) {
+    result->inlined += sites.items[i].result == IR_INLINE_DONE;
+  }
+
+  string_pool_free(&strings);
+
+  return true;
+}
+
+static bench_result_t run_bench(arena_t arena[const static 1], const bench_corpus_t corpus[const static 1],
+                                const bench_config_t config[const static 1])
+{
+  bench_result_t result = {0};
+
+  // first run is not timed and gives the per run numbers
+  bench_arena_reset(arena);
+  result.ok = run_once(arena, corpus, config, &result);
+  result.arena_bytes = arena->offset ? arena->offset - 1 : 0;
+  result.seconds = 0;
+
+  while (result.ok && (result.iterations < BENCH_MIN_ITERATIONS || result.seconds < BENCH_MIN_SECONDS)) {
+    bench_arena_reset(arena);
+    run_once(arena, corpus, config, &result);
+    result.iterations++;
+  }
+
+  return result;
+}
+
+static void write_result(FILE *out, const bench_config_t config[const static 1], const bench_result_t result[const static 1],
+                         const bool last)
+{
+  fprintf(out, "        {\"opts\": \"%s\", \"ok\": %s", config->name, result->ok ? "true" : "false");
+
+  if (result->ok) {
+    fprintf(out, ", \"iterations\": %zu, \"instructions\": %zu, \"calls\": %zu, \"tail_calls\": %zu, \"call_sites\": %zu, "
+            "\"inlined\": %zu, \"switches\": %zu, \"jump_tables\": %zu, \"reduced\": %zu, \"common\": %zu, "
+            "\"checks_removed\": %zu, \"checks_kept\": %zu, \"ns_per_run\": %.0f, \"arena_bytes\": %zu",
+            result->iterations, result->instructions, result->calls, result->tail_calls, result->sites, result->inlined,
+            result->switches, result->jump_tables, result->reduced, result->common, result->checks_removed,
+            result->checks_kept, result->seconds / (double)result->iterations * 1e9, result->arena_bytes);
+  }
+
+  fprintf(out, "}%s\n", last ? "" : ",");
+}
+
+// gcc -O2 -g -std=c17 -Wall -Wdeprecated -Wpedantic -Wextra -o ir_bench ir_bench.c lexer.c parser2.c types.c passes.c resolve.c typecheck.c fold.c string_pool.c format.c ir.c ir_opt.c ll1_parser.c && ./ir_bench ir_bench.json
+int main(int argc, char *argv[])
+{
+  FILE *out = stdout;
+
+  if (argc > 1) {
+    out = fopen(argv[1], "w");
+
+    if (out == NULL) {
+      bail("Could not open %s for writing", argv[1]);
+    }
+  }
+
+  bench_corpus_t corpora[] = {
+    small_helpers(1000),
+    call_chain(200),
+    recursion(250),
+    fan_out(300),
+    state_machine(400),
+    array_walk(200),
+    byte_access(500),
+  };
+
+  const bench_config_t configs[] = {
+    { .name = "all", .opts = IR_OPT_ALL },
+    { .name = "no-inline", .opts = IR_OPT_ALL & ~IR_OPT_BIT(IR_OPT_INLINE) },
+    { .name = "no-strength-reduction", .opts = IR_OPT_ALL & ~IR_OPT_BIT(IR_OPT_STRENGTH_REDUCTION) },
+    { .name = "no-cse", .opts = IR_OPT_ALL & ~IR_OPT_BIT(IR_OPT_CSE) },
+    { .name = "no-bounds-checks", .opts = IR_OPT_ALL & ~IR_OPT_BIT(IR_OPT_BOUNDS_CHECKS) },
+  };
+
+  arena_t arena = arena_create(BENCH_ARENA_SIZE);
+  assertm(!arena.err, "Expected: arena creation to succeed, Received: %s", arena.err);
+
+  fprintf(out, "{\n  \"corpora\": [\n");
+
+  for (size_t i = 0; i < zdx_arr_len(corpora); i++) {
+    const bench_corpus_t *corpus = &corpora[i];
+
+    fprintf(out, "    {\n      \"name\": \"%s\",\n      \"source_bytes\": %zu,\n      \"results\": [\n", corpus->name, corpus->length);
+
+    for (size_t j = 0; j < zdx_arr_len(configs); j++) {
+      const bench_result_t result = run_bench(&arena, corpus, &configs[j]);
+      write_result(out, &configs[j], &result, j == zdx_arr_len(configs) - 1);
+    }
+
+    fprintf(out, "      ]\n    }%s\n", i == zdx_arr_len(corpora) - 1 ? "" : ",");
+    free(corpus->source);
+  }
+
+  fprintf(out, "  ]\n}\n");
+
+  if (out != stdout) {
+    fclose(out);
+  }
+
+  arena_free(&arena);
+  return 0;
+}
@@ -0,0 +1,2305 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "./zdx_util.h"
+#include "./fold.h"
+#include "./ir_opt.h"
+
+static inline uint64_t now_ns(void)
+{
+  struct timespec ts = {0};
+  timespec_get(&ts, TIME_UTC);
+
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// zeroed working memory of an optimization, taken from the arena
+static void *scratch(arena_t arena[const static 1], const size_t count, const size_t size)
+{
+  void *items = arena_calloc(arena, zdx_max(count, 1), size);
+  assertm(!arena->err, "Expected: ir optimization scratch alloc to succeed, Received: %s", arena->err);
+
+  return items;
+}
+
+// ------------------------------------ BLOCKS ------------------------------------
+
+static size_t pred_index(const ir_block_t block[const static 1], const uint32_t pred)
+{
+  for (size_t i = 0; i < block->pred_count; i++) {
+    if (block->preds[i] == pred) {
+      return i;
+    }
+  }
+
+  assertm(false, "Expected: b%u to be a predecessor", pred);
+  return 0;
+}
+
+// the phis of to lose the value coming in from from, a phi left with a single one is a copy of it
+static void remove_edge(ir_function_t f[const static 1], const uint32_t from, const uint32_t to)
+{
+  ir_block_t *block = &f->blocks.items[to];
+  const size_t removed = pred_index(block, from);
+
+  for (uint32_t v = block->first; v < block->first + block->length; v++) {
+    ir_inst_t *inst = &f->insts.items[v];
+
+    if (inst->op != IR_OP_PHI) {
+      continue;
+    }
+
+    for (size_t i = removed; i + 1 < block->pred_count; i++) {
+      inst->args[i] = inst->args[i + 1];
+    }
+
+    inst->op = block->pred_count == 2 ? IR_OP_COPY : IR_OP_NOP;
+  }
+
+  for (size_t i = removed; i + 1 < block->pred_count; i++) {
+    block->preds[i] = block->preds[i + 1];
+  }
+
+  block->pred_count--;
+}
+
+static bool has_pred(const ir_block_t block[const static 1], const uint32_t pred)
+{
+  return (block->pred_count > 0 && block->preds[0] == pred) || (block->pred_count > 1 && block->preds[1] == pred);
+}
+
+static void kill_block(ir_function_t f[const static 1], const uint32_t b)
+{
+  ir_block_t *block = &f->blocks.items[b];
+
+  for (uint32_t v = block->first; v < block->first + block->length; v++) {
+    f->insts.items[v].op = IR_OP_NOP;
+  }
+
+  block->pred_count = 0;
+  block->succ_count = 0;
+  block->dead = true;
+}
+
+// every edge goes to a block with a higher index, so a single pass in order finds all the blocks entry can't reach
+static void remove_unreachable(ir_function_t f[const static 1])
+{
+  for (uint32_t b = 1; b < f->blocks.length; b++) {
+    ir_block_t *block = &f->blocks.items[b];
+
+    if (block->dead || block->pred_count > 0) {
+      continue;
+    }
+
+    size_t count = 0;
+    const uint32_t *succs = ir_succs(f, block, &count);
+
+    for (size_t i = 0; i < count; i++) {
+      if (has_pred(&f->blocks.items[succs[i]], b)) {
+        remove_edge(f, b, succs[i]);
+      }
+    }
+
+    kill_block(f, b);
+  }
+}
+
+/**
+ * Merges a block into the one before it when that one only jumps to it and nothing else does, as happens around
+ * the branches that sccp drops and the calls that are inlined. The blocks in between are dead, so the instructions
+ * of the merged block follow the ones of the block it's merged into but for nops.
+ */
+static void merge_blocks(ir_function_t f[const static 1])
+{
+  uint32_t into = 0;
+
+  for (uint32_t b = 1; b < f->blocks.length; b++) {
+    ir_block_t *block = &f->blocks.items[b];
+    ir_block_t *prev = &f->blocks.items[into];
+    ir_inst_t *jump = &f->insts.items[prev->first + prev->length - 1];
+
+    if (block->dead) {
+      continue;
+    } else if (jump->op != IR_OP_JUMP || prev->succs[0] != b || block->pred_count != 1) {
+      into = b;
+      continue;
+    }
+
+    size_t count = 0;
+    const uint32_t *succs = ir_succs(f, block, &count);
+
+    jump->op = IR_OP_NOP;
+    prev->length = block->first + block->length - prev->first;
+    prev->succ_count = block->succ_count;
+    memcpy(prev->succs, block->succs, sizeof(prev->succs));
+
+    for (uint32_t v = block->first; v < block->first + block->length; v++) {
+      f->insts.items[v].block = into;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      ir_block_t *succ = &f->blocks.items[succs[i]];
+
+      succ->preds[pred_index(succ, b)] = into;
+    }
+
+    *block = (ir_block_t){ .first = block->first, .dead = true };
+  }
+}
+
+// ------------------------------------ SCCP ------------------------------------
+
+typedef enum {
+  LATTICE_UNKNOWN, // not evaluated yet, it may still turn out to be any constant
+  LATTICE_CONSTANT,
+  LATTICE_VARYING,
+} lattice_state_t;
+
+typedef struct {
+  uint8_t state; // lattice_state_t
+  uint64_t value;
+} lattice_t;
+
+typedef struct {
+  ir_function_t *f;
+  const type_table_t *types;
+  lattice_t *values; // by instruction
+  bool *reachable; // by block
+  bool (*taken)[2]; // by block, whether the edge from preds[i] can be taken
+  uint32_t *use_first; // the users of value v are uses[use_first[v]] to uses[use_first[v + 1] - 1]
+  uint32_t *uses;
+  uint32_t *blocks; // worklist of the blocks an edge was found to reach
+  size_t block_count;
+  uint32_t *insts; // worklist of the instructions one of the operands of changed
+  size_t inst_count;
+  bool *queued; // by instruction, whether it's in insts
+} sccp_t;
+
+static void count_uses(arena_t arena[const static 1], sccp_t s[const static 1])
+{
+  ir_function_t *f = s->f;
+  const size_t n = f->insts.length;
+  uint32_t *filled = scratch(arena, n + 1, sizeof(*filled));
+
+  s->use_first = scratch(arena, n + 1, sizeof(*s->use_first));
+
+  for (size_t v = 0; v < n; v++) {
+    size_t count = 0;
+    const uint32_t *operands = ir_operands(f, &f->insts.items[v], &count);
+
+    for (size_t i = 0; i < count; i++) {
+      s->use_first[operands[i] + 1]++;
+    }
+  }
+
+  for (size_t v = 0; v < n; v++) {
+    s->use_first[v + 1] += s->use_first[v];
+  }
+
+  s->uses = scratch(arena, s->use_first[n], sizeof(*s->uses));
+
+  for (uint32_t v = 0; v < n; v++) {
+    size_t count = 0;
+    const uint32_t *operands = ir_operands(f, &f->insts.items[v], &count);
+
+    for (size_t i = 0; i < count; i++) {
+      s->uses[s->use_first[operands[i]] + filled[operands[i]]++] = v;
+    }
+  }
+}
+
+static bool integer_specifiers(const sccp_t s[const static 1], const uint16_t type, uint16_t specifiers[const static 1])
+{
+  if (type == TYPE_NO_ID || !type_is_integer(type_by_id(s->types, type))) {
+    return false;
+  }
+
+  *specifiers = type_by_id(s->types, type)->specifiers;
+  return true;
+}
+
+static inline lattice_t varying(void)
+{
+  return (lattice_t){ .state = LATTICE_VARYING };
+}
+
+static inline lattice_t constant(const uint64_t value)
+{
+  return (lattice_t){ .state = LATTICE_CONSTANT, .value = value };
+}
+
+// the value of a phi is only decided by the paths that can be taken into its block
+static lattice_t evaluate_phi(const sccp_t s[const static 1], const ir_inst_t inst[const static 1])
+{
+  const ir_block_t *block = &s->f->blocks.items[inst->block];
+  lattice_t result = {0};
+
+  for (size_t i = 0; i < block->pred_count; i++) {
+    const lattice_t in = s->values[inst->args[i]];
+
+    if (!s->taken[inst->block][i] || in.state == LATTICE_UNKNOWN) {
+      continue;
+    }
+
+    if (in.state == LATTICE_VARYING || (result.state == LATTICE_CONSTANT && result.value != in.value)) {
+      return varying();
+    }
+
+    result = in;
+  }
+
+  return result;
+}
+
+static lattice_t evaluate_unary(const sccp_t s[const static 1], const ir_inst_t inst[const static 1])
+{
+  const lattice_t operand = s->values[inst->args[0]];
+  uint16_t specifiers = 0;
+  uint16_t from = 0;
+  uint64_t result = 0;
+
+  if (operand.state != LATTICE_CONSTANT) {
+    return operand;
+  }
+
+  if (!integer_specifiers(s, inst->type, &specifiers) || !integer_specifiers(s, s->f->insts.items[inst->args[0]].type, &from)) {
+    return varying();
+  }
+
+  if (inst->sub == UNARY_OP_CONVERT) {
+    return constant(fold_normalize(specifiers, operand.value));
+  }
+
+  return fold_evaluate_unary(inst->sub, specifiers, operand.value, &result) ? constant(result) : varying();
+}
+
+static lattice_t evaluate_binary(const sccp_t s[const static 1], const ir_inst_t inst[const static 1])
+{
+  const lattice_t lhs = s->values[inst->args[0]];
+  const lattice_t rhs = s->values[inst->args[1]];
+  uint16_t specifiers = 0;
+  uint16_t ls = 0;
+  uint16_t rs = 0;
+  uint64_t result = 0;
+
+  if (lhs.state == LATTICE_VARYING || rhs.state == LATTICE_VARYING) {
+    return varying();
+  }
+
+  if (lhs.state == LATTICE_UNKNOWN || rhs.state == LATTICE_UNKNOWN) {
+    return (lattice_t){0};
+  }
+
+  // comparisons are done in the type of their operands, which is the type of the lhs
+  if (!integer_specifiers(s, inst->type, &specifiers) || !integer_specifiers(s, s->f->insts.items[inst->args[0]].type, &ls) ||
+      !integer_specifiers(s, s->f->insts.items[inst->args[1]].type, &rs)) {
+    return varying();
+  }
+
+  return fold_evaluate_binary(inst->sub, ls, rs, lhs.value, rhs.value, &result) ? constant(result) : varying();
+}
+
+/**
+ * Values that depend on memory or on the caller are varying. So is the value of a local read before it's
+ * assigned, which could be assumed to be whatever constant suits best as reading it is undefined, but then a
+ * branch on it would take no path at all.
+ */
+static lattice_t evaluate(const sccp_t s[const static 1], const ir_inst_t inst[const static 1])
+{
+  uint16_t specifiers = 0;
+
+  switch(inst->op) {
+    case IR_OP_CONST: return integer_specifiers(s, inst->type, &specifiers) ? constant(inst->imm) : varying();
+    case IR_OP_COPY: return s->values[inst->args[0]];
+    case IR_OP_PHI: return evaluate_phi(s, inst);
+    case IR_OP_UNARY: return evaluate_unary(s, inst);
+    case IR_OP_BINARY: return evaluate_binary(s, inst);
+    default: return varying();
+  }
+}
+
+static void take_edge(sccp_t s[const static 1], const uint32_t from, const uint32_t to)
+{
+  const size_t i = pred_index(&s->f->blocks.items[to], from);
+
+  if (!s->taken[to][i]) {
+    s->taken[to][i] = true;
+    s->blocks[s->block_count++] = to;
+  }
+}
+
+// the block a switch on a constant goes to
+static uint32_t switch_target(const sccp_t s[const static 1], const ir_inst_t inst[const static 1], const uint64_t value)
+{
+  const bool is_signed = !type_is_unsigned(type_by_id(s->types, s->f->insts.items[inst->args[0]].type)->specifiers);
+
+  return ir_switch_target(s->f, &s->f->switches.items[inst->imm], is_signed, value);
+}
+
+static void visit(sccp_t s[const static 1], const uint32_t v)
+{
+  const ir_inst_t *inst = &s->f->insts.items[v];
+  ir_block_t *block = &s->f->blocks.items[inst->block];
+
+  switch(inst->op) {
+    case IR_OP_NOP: return;
+    case IR_OP_JUMP: take_edge(s, inst->block, block->succs[0]); return;
+
+    case IR_OP_BRANCH: {
+      const lattice_t cond = s->values[inst->args[0]];
+
+      if (cond.state == LATTICE_CONSTANT) {
+        take_edge(s, inst->block, block->succs[cond.value ? 0 : 1]);
+      } else if (cond.state == LATTICE_VARYING) {
+        take_edge(s, inst->block, block->succs[0]);
+        take_edge(s, inst->block, block->succs[1]);
+      }
+    } return;
+
+    case IR_OP_SWITCH: {
+      const lattice_t key = s->values[inst->args[0]];
+      size_t count = 0;
+      const uint32_t *succs = ir_succs(s->f, block, &count);
+
+      if (key.state == LATTICE_CONSTANT) {
+        take_edge(s, inst->block, switch_target(s, inst, key.value));
+      }
+
+      for (size_t i = 0; key.state == LATTICE_VARYING && i < count; i++) {
+        take_edge(s, inst->block, succs[i]);
+      }
+    } return;
+
+    default: break;
+  }
+
+  const lattice_t old = s->values[v];
+  const lattice_t value = evaluate(s, inst);
+
+  // values only ever go down the lattice, which bounds how many times they change
+  if (value.state == old.state && value.value == old.value) {
+    return;
+  }
+
+  s->values[v] = value;
+
+  for (uint32_t i = s->use_first[v]; i < s->use_first[v + 1]; i++) {
+    if (!s->queued[s->uses[i]]) {
+      s->queued[s->uses[i]] = true;
+      s->insts[s->inst_count++] = s->uses[i];
+    }
+  }
+}
+
+// a block is visited whole the first time it's reached and only its phis are visited again for each new edge
+static void visit_block(sccp_t s[const static 1], const uint32_t b)
+{
+  const ir_block_t *block = &s->f->blocks.items[b];
+  const bool first = !s->reachable[b];
+
+  s->reachable[b] = true;
+
+  for (uint32_t v = block->first; v < block->first + block->length; v++) {
+    if (first || s->f->insts.items[v].op == IR_OP_PHI) {
+      visit(s, v);
+    }
+  }
+}
+
+// constants replace the values found to be constant, branches on them jump to where they go and the blocks
+// that can't be reached are dropped, along with the values their edges bring to phis
+static void sccp_rewrite(sccp_t s[const static 1])
+{
+  ir_function_t *f = s->f;
+
+  for (uint32_t b = 0; b < f->blocks.length; b++) {
+    ir_block_t *block = &f->blocks.items[b];
+
+    for (uint32_t v = block->first; s->reachable[b] && v < block->first + block->length; v++) {
+      ir_inst_t *inst = &f->insts.items[v];
+      const lattice_t value = s->values[v];
+
+      if (inst->op == IR_OP_BRANCH && s->values[inst->args[0]].state == LATTICE_CONSTANT) {
+        const size_t taken = s->values[inst->args[0]].value ? 0 : 1;
+
+        remove_edge(f, b, block->succs[1 - taken]);
+        block->succs[0] = block->succs[taken];
+        block->succ_count = 1;
+        *inst = (ir_inst_t){ .op = IR_OP_JUMP, .block = b };
+      } else if (inst->op == IR_OP_SWITCH && s->values[inst->args[0]].state == LATTICE_CONSTANT) {
+        const uint32_t taken = switch_target(s, inst, s->values[inst->args[0]].value);
+        size_t count = 0;
+        const uint32_t *succs = ir_succs(f, block, &count);
+
+        // the succs of a switch are all different blocks
+        for (size_t i = 0; i < count; i++) {
+          if (succs[i] != taken) {
+            remove_edge(f, b, succs[i]);
+          }
+        }
+
+        block->succs[0] = taken;
+        block->succ_count = 1;
+        *inst = (ir_inst_t){ .op = IR_OP_JUMP, .block = b };
+      } else if (value.state == LATTICE_CONSTANT && inst->op != IR_OP_CONST) {
+        *inst = (ir_inst_t){ .op = IR_OP_CONST, .type = inst->type, .block = b, .imm = value.value };
+      }
+    }
+  }
+
+  for (uint32_t b = 0; b < f->blocks.length; b++) {
+    ir_block_t *block = &f->blocks.items[b];
+
+    for (size_t i = 0; s->reachable[b] && i < block->pred_count; i++) {
+      if (!s->reachable[block->preds[i]]) {
+        remove_edge(f, block->preds[i--], b);
+      }
+    }
+  }
+
+  for (uint32_t b = 0; b < f->blocks.length; b++) {
+    if (!s->reachable[b]) {
+      kill_block(f, b);
+    }
+  }
+}
+
+void ir_sccp(arena_t arena[const static 1], const type_table_t types[const static 1], ir_function_t f[const static 1])
+{
+  const size_t n = f->insts.length;
+  sccp_t s = {
+    .f = f,
+    .types = types,
+    .values = scratch(arena, n, sizeof(*s.values)),
+    .reachable = scratch(arena, f->blocks.length, sizeof(*s.reachable)),
+    .taken = scratch(arena, f->blocks.length, sizeof(*s.taken)),
+    .blocks = scratch(arena, 2 * f->blocks.length + 1, sizeof(*s.blocks)),
+    .insts = scratch(arena, n, sizeof(*s.insts)),
+    .queued = scratch(arena, n, sizeof(*s.queued)),
+  };
+
+  count_uses(arena, &s);
+  s.blocks[s.block_count++] = 0;
+
+  while (s.block_count > 0 || s.inst_count > 0) {
+    while (s.block_count > 0) {
+      visit_block(&s, s.blocks[--s.block_count]);
+    }
+
+    while (s.inst_count > 0) {
+      const uint32_t v = s.insts[--s.inst_count];
+
+      s.queued[v] = false;
+
+      // reaching the block visits it later
+      if (s.reachable[f->insts.items[v].block]) {
+        visit(&s, v);
+      }
+    }
+  }
+
+  sccp_rewrite(&s);
+}
+
+// ------------------------------------ COPY PROPAGATION ------------------------------------
+
+static inline uint32_t copied(const ir_function_t f[const static 1], uint32_t v)
+{
+  while (f->insts.items[v].op == IR_OP_COPY) {
+    v = f->insts.items[v].args[0];
+  }
+
+  return v;
+}
+
+void ir_copy_propagation(arena_t arena[const static 1], ir_function_t f[const static 1])
+{
+  (void)arena;
+
+  // phis come before their uses and every edge goes forward, so the copies a phi turns into are seen in time
+  for (uint32_t v = 0; v < f->insts.length; v++) {
+    ir_inst_t *inst = &f->insts.items[v];
+    size_t count = 0;
+    uint32_t *operands = ir_operands(f, inst, &count);
+    bool same = true;
+
+    for (size_t i = 0; i < count; i++) {
+      operands[i] = copied(f, operands[i]);
+      same = same && operands[i] == operands[0];
+    }
+
+    if (inst->op == IR_OP_PHI && count > 0 && same) {
+      inst->op = IR_OP_COPY;
+    }
+  }
+
+  for (uint32_t v = 0; v < f->insts.length; v++) {
+    if (f->insts.items[v].op == IR_OP_COPY) {
+      f->insts.items[v].op = IR_OP_NOP;
+    }
+  }
+}
+
+// ------------------------------------ STRENGTH REDUCTION ------------------------------------
+
+static inline bool is_const(const ir_function_t f[const static 1], const uint32_t v, const uint64_t value)
+{
+  return f->insts.items[v].op == IR_OP_CONST && f->insts.items[v].imm == value;
+}
+
+// k of a constant 2^k with k > 0, or 0
+static unsigned log2_const(const ir_function_t f[const static 1], const uint32_t v)
+{
+  const ir_inst_t *inst = &f->insts.items[v];
+
+  if (inst->op != IR_OP_CONST || inst->imm < 2 || (inst->imm & (inst->imm - 1)) != 0) {
+    return 0;
+  }
+
+  unsigned k = 0;
+
+  while ((inst->imm >> k) != 1) {
+    k++;
+  }
+
+  return k;
+}
+
+// the operation becomes a copy of v, which has its type as the operands of arithmetic are converted first
+static bool reduce_to_copy(ir_function_t f[const static 1], ir_inst_t inst[const static 1], const uint32_t v)
+{
+  if (f->insts.items[v].type != inst->type) {
+    return false;
+  }
+
+  *inst = (ir_inst_t){ .op = IR_OP_COPY, .type = inst->type, .block = inst->block, .args = { v } };
+  return true;
+}
+
+static bool reduce_to_zero(ir_inst_t inst[const static 1])
+{
+  *inst = (ir_inst_t){ .op = IR_OP_CONST, .type = inst->type, .block = inst->block };
+  return true;
+}
+
+// x op 0, x * 1 and the like, which are the same whatever the signedness
+static bool reduce_identity(ir_function_t f[const static 1], ir_inst_t inst[const static 1])
+{
+  const uint32_t lhs = inst->args[0];
+  const uint32_t rhs = inst->args[1];
+
+  switch(inst->sub) {
+    case BINARY_OP_ADD:
+    case BINARY_OP_BIT_OR:
+    case BINARY_OP_BIT_XOR:
+      return (is_const(f, rhs, 0) && reduce_to_copy(f, inst, lhs)) || (is_const(f, lhs, 0) && reduce_to_copy(f, inst, rhs));
+    case BINARY_OP_SUB:
+    case BINARY_OP_LSHIFT:
+    case BINARY_OP_RSHIFT: return is_const(f, rhs, 0) && reduce_to_copy(f, inst, lhs);
+    case BINARY_OP_MULT:
+      return (is_const(f, rhs, 1) && reduce_to_copy(f, inst, lhs)) || (is_const(f, lhs, 1) && reduce_to_copy(f, inst, rhs)) ||
+        ((is_const(f, lhs, 0) || is_const(f, rhs, 0)) && reduce_to_zero(inst));
+    case BINARY_OP_DIV: return is_const(f, rhs, 1) && reduce_to_copy(f, inst, lhs);
+    case BINARY_OP_MOD: return is_const(f, rhs, 1) && reduce_to_zero(inst);
+    case BINARY_OP_BIT_AND: return (is_const(f, lhs, 0) || is_const(f, rhs, 0)) && reduce_to_zero(inst);
+    default: return false;
+  }
+}
+
+/**
+ * x * 2^k, x / 2^k and x % 2^k of an unsigned x become x << k, x >> k and x & (2^k - 1). The constant is
+ * rewritten in place, so only when the operation is its only use. Signed ones are left alone, their division
+ * rounds towards zero where the shift rounds down.
+ */
+static bool reduce_power_of_two(ir_function_t f[const static 1], ir_inst_t inst[const static 1], const uint32_t uses[const static 1])
+{
+  const bool commutes = inst->sub == BINARY_OP_MULT && log2_const(f, inst->args[1]) == 0;
+  const uint32_t x = commutes ? inst->args[1] : inst->args[0];
+  const uint32_t c = commutes ? inst->args[0] : inst->args[1];
+  const unsigned k = log2_const(f, c);
+
+  if (k == 0 || uses[c] != 1 || (inst->sub != BINARY_OP_MULT && inst->sub != BINARY_OP_DIV && inst->sub != BINARY_OP_MOD)) {
+    return false;
+  }
+
+  ir_inst_t *constant = &f->insts.items[c];
+
+  switch(inst->sub) {
+    case BINARY_OP_MULT: inst->sub = BINARY_OP_LSHIFT; constant->imm = k; break;
+    case BINARY_OP_DIV: inst->sub = BINARY_OP_RSHIFT; constant->imm = k; break;
+    default: inst->sub = BINARY_OP_BIT_AND; constant->imm -= 1; break;
+  }
+
+  inst->args[0] = x;
+  inst->args[1] = c;
+  return true;
+}
+
+size_t ir_strength_reduction(arena_t arena[const static 1], const type_table_t types[const static 1], ir_function_t f[const static 1])
+{
+  const size_t n = f->insts.length;
+  uint32_t *uses = scratch(arena, n, sizeof(*uses));
+  size_t count = 0;
+
+  for (uint32_t v = 0; v < n; v++) {
+    size_t operand_count = 0;
+    const uint32_t *operands = ir_operands(f, &f->insts.items[v], &operand_count);
+
+    for (size_t i = 0; i < operand_count; i++) {
+      uses[operands[i]]++;
+    }
+  }
+
+  for (uint32_t v = 0; v < n; v++) {
+    ir_inst_t *inst = &f->insts.items[v];
+
+    if (inst->op != IR_OP_BINARY || inst->type == TYPE_NO_ID || !type_is_integer(type_by_id(types, inst->type))) {
+      continue;
+    }
+
+    if (reduce_identity(f, inst)) {
+      count++;
+    } else if (type_is_unsigned(type_by_id(types, inst->type)->specifiers) && reduce_power_of_two(f, inst, uses)) {
+      count++;
+    }
+  }
+
+  if (count > 0) {
+    ir_copy_propagation(arena, f);
+  }
+
+  return count;
+}
+
+// ------------------------------------ CSE ------------------------------------
+
+// immediate dominators by block, the preds of a block all come before it so one pass in order finds them
+static uint32_t *dominators(arena_t arena[const static 1], const ir_function_t f[const static 1])
+{
+  uint32_t *idom = scratch(arena, f->blocks.length, sizeof(*idom));
+
+  for (uint32_t b = 1; b < f->blocks.length; b++) {
+    const ir_block_t *block = &f->blocks.items[b];
+    uint32_t dom = block->pred_count > 0 ? block->preds[0] : 0;
+
+    for (size_t i = 1; i < block->pred_count; i++) {
+      uint32_t other = block->preds[i];
+
+      while (dom != other) {
+        if (dom > other) {
+          dom = idom[dom];
+        } else {
+          other = idom[other];
+        }
+      }
+    }
+
+    idom[b] = dom;
+  }
+
+  return idom;
+}
+
+static inline bool dominates(const uint32_t idom[const static 1], const uint32_t a, uint32_t b)
+{
+  while (b > a) {
+    b = idom[b];
+  }
+
+  return b == a;
+}
+
+static inline bool commutes(const uint8_t sub)
+{
+  switch(sub) {
+    case BINARY_OP_ADD:
+    case BINARY_OP_MULT:
+    case BINARY_OP_EQ:
+    case BINARY_OP_NEQ:
+    case BINARY_OP_BIT_AND:
+    case BINARY_OP_BIT_XOR:
+    case BINARY_OP_BIT_OR: return true;
+    default: return false;
+  }
+}
+
+// what two instructions that compute the same value have in common, false for the ones that may not
+static bool cse_key(const ir_function_t f[const static 1], const ir_inst_t inst[const static 1], ir_inst_t key[const static 1])
+{
+  *key = (ir_inst_t){ .op = inst->op, .type = inst->type, .args = { IR_NO_VALUE, IR_NO_VALUE } };
+
+  switch(inst->op) {
+    case IR_OP_CONST:
+    case IR_OP_FUNCTION:
+    case IR_OP_EXTERN:
+    case IR_OP_ADDR_LOCAL:
+    case IR_OP_ADDR_GLOBAL:
+    case IR_OP_STRING: key->imm = inst->imm; return true;
+    case IR_OP_UNARY:
+      key->sub = inst->sub;
+      key->args[0] = copied(f, inst->args[0]);
+      return true;
+    case IR_OP_BINARY:
+      key->sub = inst->sub;
+      key->args[0] = copied(f, inst->args[0]);
+      key->args[1] = copied(f, inst->args[1]);
+
+      if (commutes(inst->sub) && key->args[0] > key->args[1]) {
+        key->args[0] = copied(f, inst->args[1]);
+        key->args[1] = copied(f, inst->args[0]);
+      }
+
+      return true;
+    default: return false;
+  }
+}
+
+static inline bool same_key(const ir_inst_t a[const static 1], const ir_inst_t b[const static 1])
+{
+  return a->op == b->op && a->sub == b->sub && a->type == b->type && a->args[0] == b->args[0] && a->args[1] == b->args[1] &&
+    a->imm == b->imm;
+}
+
+static inline uint64_t hash_key(const ir_inst_t key[const static 1])
+{
+  uint64_t h = 0xcbf29ce484222325ULL;
+  const uint64_t parts[] = { key->op, key->sub, key->type, key->args[0], key->args[1], key->imm };
+
+  for (size_t i = 0; i < zdx_arr_len(parts); i++) {
+    h = (h ^ parts[i]) * 0x100000001b3ULL;
+  }
+
+  return h ^ (h >> 32);
+}
+
+size_t ir_cse(arena_t arena[const static 1], ir_function_t f[const static 1])
+{
+  const size_t n = f->insts.length;
+  size_t capacity = IR_MIN_CAP;
+  size_t count = 0;
+
+  while (capacity < n * 2) {
+    capacity *= 2;
+  }
+
+  uint32_t *table = scratch(arena, capacity, sizeof(*table));
+  ir_inst_t *keys = scratch(arena, n, sizeof(*keys));
+  const uint32_t *idom = dominators(arena, f);
+
+  memset(table, 0xff, capacity * sizeof(*table));
+
+  // blocks in order, so a value is looked up after every value of the blocks that dominate its own
+  for (uint32_t b = 0; b < f->blocks.length; b++) {
+    const ir_block_t *block = &f->blocks.items[b];
+
+    for (uint32_t v = block->first; !block->dead && v < block->first + block->length; v++) {
+      ir_inst_t *inst = &f->insts.items[v];
+
+      if (!cse_key(f, inst, &keys[v])) {
+        continue;
+      }
+
+      size_t h = hash_key(&keys[v]) & (capacity - 1);
+
+      for (; table[h] != IR_NO_VALUE; h = (h + 1) & (capacity - 1)) {
+        const uint32_t w = table[h];
+
+        if (same_key(&keys[w], &keys[v]) && dominates(idom, f->insts.items[w].block, b)) {
+          break;
+        }
+      }
+
+      if (table[h] == IR_NO_VALUE) {
+        table[h] = v;
+      } else {
+        *inst = (ir_inst_t){ .op = IR_OP_COPY, .type = inst->type, .block = inst->block, .args = { table[h] } };
+        count++;
+      }
+    }
+  }
+
+  if (count > 0) {
+    ir_copy_propagation(arena, f);
+  }
+
+  return count;
+}
+
+// ------------------------------------ DSE ------------------------------------
+
+typedef struct {
+  ir_function_t *f;
+  uint32_t frame_size;
+  uint32_t *tracked; // by frame slot and then by global slot, index of the bit of the slot + 1, 0 if never stored to
+  size_t words; // of a set of tracked slots
+  uint64_t *outliving; // the tracked globals and static locals, which may be read after the return
+} dse_t;
+
+static inline uint32_t store_key(const dse_t d[const static 1], const ir_inst_t inst[const static 1])
+{
+  return inst->op == IR_OP_STORE_LOCAL ? (uint32_t)inst->imm : d->frame_size + (uint32_t)inst->imm;
+}
+
+/**
+ * Walks a block backwards from the slots that may be read after it, live, which it leaves with the ones that may
+ * be read before it. Removes the stores to slots that aren't live, when remove is set.
+ */
+static void dse_block(const dse_t d[const static 1], const uint32_t b, uint64_t live[const static 1], const bool remove)
+{
+  const ir_block_t *block = &d->f->blocks.items[b];
+
+  for (uint32_t v = block->first + block->length; v-- > block->first;) {
+    ir_inst_t *inst = &d->f->insts.items[v];
+
+    switch(inst->op) {
+      case IR_OP_RETURN: memcpy(live, d->outliving, d->words * sizeof(*live)); break;
+
+      case IR_OP_LOAD_LOCAL:
+      case IR_OP_LOAD_GLOBAL: {
+        const uint32_t key = inst->op == IR_OP_LOAD_LOCAL ? (uint32_t)inst->imm : d->frame_size + (uint32_t)inst->imm;
+        const uint32_t bit = d->tracked[key];
+
+        if (bit) {
+          live[(bit - 1) / 64] |= UINT64_C(1) << ((bit - 1) % 64);
+        }
+      } break;
+
+      case IR_OP_LOAD:
+      case IR_OP_CALL:
+      case IR_OP_TAIL_CALL:
+      case IR_OP_EXPR: memset(live, 0xff, d->words * sizeof(*live)); break;
+
+      case IR_OP_STORE_LOCAL:
+      case IR_OP_STORE_GLOBAL: {
+        const uint32_t bit = d->tracked[store_key(d, inst)] - 1;
+        const uint64_t mask = UINT64_C(1) << (bit % 64);
+
+        if (remove && !(live[bit / 64] & mask)) {
+          inst->op = IR_OP_NOP;
+        }
+
+        live[bit / 64] &= ~mask;
+      } break;
+
+      default: break;
+    }
+  }
+}
+
+void ir_dse(arena_t arena[const static 1], const uint32_t global_count, ir_function_t f[const static 1])
+{
+  dse_t d = { .f = f, .frame_size = f->slot_count };
+  size_t bits = 0;
+
+  d.tracked = scratch(arena, d.frame_size + global_count, sizeof(*d.tracked));
+
+  for (uint32_t v = 0; v < f->insts.length; v++) {
+    const ir_inst_t *inst = &f->insts.items[v];
+
+    if ((inst->op == IR_OP_STORE_LOCAL || inst->op == IR_OP_STORE_GLOBAL) && d.tracked[store_key(&d, inst)] == 0) {
+      d.tracked[store_key(&d, inst)] = (uint32_t)++bits;
+    }
+  }
+
+  if (bits == 0) {
+    return;
+  }
+
+  d.words = (bits + 63) / 64;
+  d.outliving = scratch(arena, d.words, sizeof(*d.outliving));
+
+  for (uint32_t key = 0; key < d.frame_size + global_count; key++) {
+    const uint32_t bit = d.tracked[key];
+
+    if (bit && (key >= d.frame_size || f->slot_kinds[key] == IR_SLOT_STATIC)) {
+      d.outliving[(bit - 1) / 64] |= UINT64_C(1) << ((bit - 1) % 64);
+    }
+  }
+
+  // live_in[b] are the slots that may be read after the start of block b, worked out from the last block up
+  uint64_t *live_in = scratch(arena, f->blocks.length * d.words, sizeof(*live_in));
+  uint64_t *live = scratch(arena, d.words, sizeof(*live));
+  bool changed = true;
+
+  while (changed) {
+    changed = false;
+
+    for (uint32_t b = (uint32_t)f->blocks.length; b-- > 0;) {
+      size_t count = 0;
+      const uint32_t *succs = ir_succs(f, &f->blocks.items[b], &count);
+
+      memset(live, 0, d.words * sizeof(*live));
+
+      for (size_t i = 0; i < count; i++) {
+        for (size_t w = 0; w < d.words; w++) {
+          live[w] |= live_in[succs[i] * d.words + w];
+        }
+      }
+
+      dse_block(&d, b, live, false);
+
+      if (memcmp(live, &live_in[b * d.words], d.words * sizeof(*live)) != 0) {
+        memcpy(&live_in[b * d.words], live, d.words * sizeof(*live));
+        changed = true;
+      }
+    }
+  }
+
+  for (uint32_t b = 0; b < f->blocks.length; b++) {
+    size_t count = 0;
+    const uint32_t *succs = ir_succs(f, &f->blocks.items[b], &count);
+
+    memset(live, 0, d.words * sizeof(*live));
+
+    for (size_t i = 0; i < count; i++) {
+      for (size_t w = 0; w < d.words; w++) {
+        live[w] |= live_in[succs[i] * d.words + w];
+      }
+    }
+
+    dse_block(&d, b, live, true);
+  }
+}
+
+// ------------------------------------ DCE ------------------------------------
+
+static inline bool has_effect(const uint8_t op)
+{
+  switch(op) {
+    case IR_OP_STORE_LOCAL:
+    case IR_OP_STORE_GLOBAL:
+    case IR_OP_STORE:
+    case IR_OP_CALL:
+    case IR_OP_EXPR: return true;
+    default: return ir_is_terminator(op);
+  }
+}
+
+// marks what the instructions with an effect use, what they use and so on, and drops the rest
+void ir_dce(arena_t arena[const static 1], ir_function_t f[const static 1])
+{
+  const size_t n = f->insts.length;
+  bool *live = scratch(arena, n, sizeof(*live));
+  uint32_t *work = scratch(arena, n, sizeof(*work));
+  size_t work_count = 0;
+
+  remove_unreachable(f);
+  merge_blocks(f);
+
+  for (uint32_t v = 0; v < n; v++) {
+    if (has_effect(f->insts.items[v].op)) {
+      live[v] = true;
+      work[work_count++] = v;
+    }
+  }
+
+  while (work_count > 0) {
+    size_t count = 0;
+    const uint32_t *operands = ir_operands(f, &f->insts.items[work[--work_count]], &count);
+
+    for (size_t i = 0; i < count; i++) {
+      if (!live[operands[i]]) {
+        live[operands[i]] = true;
+        work[work_count++] = operands[i];
+      }
+    }
+  }
+
+  for (uint32_t v = 0; v < n; v++) {
+    if (!live[v]) {
+      f->insts.items[v].op = IR_OP_NOP;
+    }
+  }
+}
+
+// ------------------------------------ INLINING ------------------------------------
+
+typedef enum {
+  INLINE_UNVISITED,
+  INLINE_VISITING, // on the stack of the walk of the call graph, its callees are being inlined into first
+  INLINE_VISITED,
+} inline_state_t;
+
+typedef struct {
+  arena_t *arena;
+  ir_program_t *program;
+  ir_inline_sites_t *sites;
+  uint32_t opts; // of ir_optimize(), the ones the functions inlined into are optimized again with
+  uint32_t *by_global; // index + 1 in program->items of the function of each global slot, 0 if it has no body
+  uint8_t *states; // inline_state_t of each function
+} inliner_t;
+
+typedef struct {
+  uint32_t call; // value of the call in the caller
+  const ir_function_t *callee;
+  uint32_t *blocks; // new id of each block of the callee
+  uint32_t next; // new id of the block of the rest of the caller
+  uint32_t slot_base; // of the slots of the callee among the ones of the caller
+} inline_call_t;
+
+static inline const ir_inst_t *callee_of(const ir_function_t f[const static 1], const ir_inst_t call[const static 1])
+{
+  return &f->insts.items[f->operands.items[call->args[0]]];
+}
+
+static ir_function_t *defined_callee(const inliner_t in[const static 1], const ir_function_t f[const static 1],
+                                     const ir_inst_t call[const static 1])
+{
+  const ir_inst_t *callee = callee_of(f, call);
+
+  if (callee->op != IR_OP_FUNCTION || in->by_global[callee->imm] == 0) {
+    return NULL;
+  }
+
+  return &in->program->items[in->by_global[callee->imm] - 1];
+}
+
+static ir_inline_result_t inline_result(const inliner_t in[const static 1], const ir_function_t f[const static 1],
+                                        const ir_inst_t call[const static 1], const size_t caller_size)
+{
+  const ir_inst_t *callee = callee_of(f, call);
+
+  if (callee->op == IR_OP_EXTERN) {
+    return IR_INLINE_EXTERN;
+  } else if (callee->op != IR_OP_FUNCTION) {
+    return IR_INLINE_INDIRECT;
+  }
+
+  const ir_function_t *g = defined_callee(in, f, call);
+
+  if (g == NULL) {
+    return IR_INLINE_NO_BODY;
+  } else if (in->states[g - in->program->items] != INLINE_VISITED) {
+    return IR_INLINE_RECURSIVE;
+  }
+
+  const size_t size = ir_function_size(g);
+
+  if (size > IR_INLINE_BUDGET) {
+    return IR_INLINE_TOO_LARGE;
+  } else if (caller_size + size > IR_INLINE_CALLER_LIMIT) {
+    return IR_INLINE_CALLER_TOO_LARGE;
+  }
+
+  const uint32_t arg_count = call->args[1] - 1;
+  const uint32_t *args = &f->operands.items[call->args[0] + 1];
+
+  if (arg_count != (g->ast->params ? g->ast->params->length : 0)) {
+    return IR_INLINE_SIGNATURE;
+  }
+
+  for (uint32_t slot = 0; slot < g->slot_count; slot++) {
+    if (g->slot_kinds[slot] == IR_SLOT_STATIC) {
+      return IR_INLINE_STATIC_LOCALS;
+    }
+  }
+
+  for (uint32_t v = 0; v < g->insts.length; v++) {
+    const ir_inst_t *inst = &g->insts.items[v];
+
+    switch(inst->op) {
+      case IR_OP_EXPR: return IR_INLINE_AST_NODES;
+
+      case IR_OP_PARAM: {
+        if (f->insts.items[args[inst->imm]].type != inst->type) {
+          return IR_INLINE_SIGNATURE;
+        }
+      } break;
+
+      case IR_OP_RETURN: {
+        if (inst->args[0] != IR_NO_VALUE && g->insts.items[inst->args[0]].type != call->type) {
+          return IR_INLINE_SIGNATURE;
+        }
+      } break;
+
+      default: break;
+    }
+  }
+
+  return IR_INLINE_DONE;
+}
+
+// the function being rebuilt gets its blocks in the order of their ids
+static void start_part(ir_function_t out[const static 1], const uint32_t id, const uint32_t preds[const static 1],
+                       const uint8_t pred_count)
+{
+  assertm(id == out->blocks.length, "Expected: the blocks to be rebuilt in order, b%u after b%zu", id, out->blocks.length);
+
+  out->blocks.items[out->blocks.length++] = (ir_block_t){
+    .first = (uint32_t)out->insts.length,
+    .preds = { preds[0], pred_count > 1 ? preds[1] : 0 },
+    .pred_count = pred_count,
+  };
+}
+
+static uint32_t append(ir_function_t out[const static 1], ir_inst_t inst)
+{
+  inst.block = (uint32_t)out->blocks.length - 1;
+  out->blocks.items[inst.block].length++;
+  out->insts.items[out->insts.length] = inst;
+
+  return (uint32_t)out->insts.length++;
+}
+
+static void end_part(ir_function_t out[const static 1], const uint32_t succs[const static 1], const uint8_t succ_count)
+{
+  ir_block_t *block = &out->blocks.items[out->blocks.length - 1];
+
+  block->succs[0] = succs[0];
+  block->succs[1] = succ_count > 1 ? succs[1] : 0;
+  block->succ_count = succ_count;
+}
+
+// ends the part the terminator of block was just copied to, with the succs of block renamed by blocks
+static void end_copied_part(ir_function_t out[const static 1], const ir_block_t block[const static 1], const uint32_t blocks[const static 1])
+{
+  ir_block_t *part = &out->blocks.items[out->blocks.length - 1];
+  size_t count = 0;
+
+  memcpy(part->succs, block->succs, sizeof(part->succs));
+  part->succ_count = block->succ_count;
+
+  // the ones of a switch were copied along with it
+  uint32_t *succs = ir_succs(out, part, &count);
+
+  for (size_t i = 0; i < count; i++) {
+    succs[i] = blocks[succs[i]];
+  }
+}
+
+// copies the ranges and the operands of a switch of from, its succs are still the blocks of from
+static uint32_t copy_switch(ir_function_t out[const static 1], const ir_function_t from[const static 1], const uint64_t index)
+{
+  ir_switch_t sw = from->switches.items[index];
+
+  memcpy(&out->operands.items[out->operands.length], &from->operands.items[sw.operands], sw.operand_count * sizeof(*out->operands.items));
+  memcpy(&out->ranges.items[out->ranges.length], &from->ranges.items[sw.first_range], sw.range_count * sizeof(*out->ranges.items));
+  sw.operands = (uint32_t)out->operands.length;
+  sw.first_range = (uint32_t)out->ranges.length;
+  out->operands.length += sw.operand_count;
+  out->ranges.length += sw.range_count;
+  out->switches.items[out->switches.length] = sw;
+
+  return (uint32_t)out->switches.length++;
+}
+
+// copies an instruction of from to out, with its operands renamed by map and its slot moved up by slot_base
+static uint32_t copy_inst(ir_function_t out[const static 1], const ir_function_t from[const static 1], ir_inst_t inst,
+                          const uint32_t map[const static 1], const uint32_t slot_base)
+{
+  switch(inst.op) {
+    case IR_OP_CALL:
+    case IR_OP_TAIL_CALL: {
+      const uint32_t first = (uint32_t)out->operands.length;
+
+      memcpy(&out->operands.items[first], &from->operands.items[inst.args[0]], inst.args[1] * sizeof(*out->operands.items));
+      out->operands.length += inst.args[1];
+      inst.args[0] = first;
+
+      if (inst.imm != 0) {
+        out->formats.items[out->formats.length++] = from->formats.items[inst.imm - 1];
+        inst.imm = out->formats.length;
+      }
+    } break;
+
+    case IR_OP_SWITCH: inst.imm = copy_switch(out, from, inst.imm); break;
+
+    case IR_OP_UNDEF:
+    case IR_OP_PARAM:
+    case IR_OP_ADDR_LOCAL:
+    case IR_OP_LOAD_LOCAL:
+    case IR_OP_STORE_LOCAL: inst.imm += slot_base; break;
+    default: break;
+  }
+
+  const uint32_t v = append(out, inst);
+  size_t count = 0;
+  uint32_t *operands = ir_operands(out, &out->insts.items[v], &count);
+
+  for (size_t i = 0; i < count; i++) {
+    operands[i] = map[operands[i]];
+  }
+
+  return v;
+}
+
+// copies the blocks of the callee in place of the call, returns the value the call is replaced with
+static uint32_t copy_callee(arena_t arena[const static 1], ir_function_t out[const static 1], const ir_function_t caller[const static 1],
+                            const uint32_t caller_map[const static 1], const inline_call_t call[const static 1])
+{
+  const ir_function_t *g = call->callee;
+  const uint32_t *args = &caller->operands.items[caller->insts.items[call->call].args[0] + 1];
+  uint32_t *map = scratch(arena, g->insts.length, sizeof(*map));
+  uint32_t from = (uint32_t)out->blocks.length - 1;
+  uint32_t result = IR_NO_VALUE;
+
+  append(out, (ir_inst_t){ .op = IR_OP_JUMP, .type = TYPE_NO_ID });
+  end_part(out, &call->blocks[0], 1);
+
+  for (uint32_t b = 0; b < g->blocks.length; b++) {
+    const ir_block_t *block = &g->blocks.items[b];
+    uint32_t preds[2] = {0};
+
+    if (block->dead) {
+      continue;
+    }
+
+    for (size_t i = 0; i < block->pred_count; i++) {
+      preds[i] = call->blocks[block->preds[i]];
+    }
+
+    start_part(out, call->blocks[b], b == 0 ? &from : preds, b == 0 ? 1 : block->pred_count);
+
+    for (uint32_t v = block->first; v < block->first + block->length; v++) {
+      const ir_inst_t *inst = &g->insts.items[v];
+
+      assertm(inst->op != IR_OP_TAIL_CALL, "Expected: tail calls to be found after inlining, as they return from the caller");
+
+      switch(inst->op) {
+        case IR_OP_NOP: break;
+        case IR_OP_PARAM: map[v] = caller_map[args[inst->imm]]; break;
+
+        case IR_OP_RETURN: {
+          result = inst->args[0] == IR_NO_VALUE ? IR_NO_VALUE : map[inst->args[0]];
+          from = call->blocks[b];
+          append(out, (ir_inst_t){ .op = IR_OP_JUMP, .type = TYPE_NO_ID });
+          end_part(out, &call->next, 1);
+        } break;
+
+        default: {
+          map[v] = copy_inst(out, g, *inst, map, call->slot_base);
+
+          if (ir_is_terminator(inst->op)) {
+            end_copied_part(out, block, call->blocks);
+          }
+        } break;
+      }
+    }
+  }
+
+  start_part(out, call->next, &from, 1);
+
+  return result;
+}
+
+// rebuilds f with the calls, in the order of their values, replaced by their callees
+static void inline_calls(arena_t arena[const static 1], ir_function_t f[const static 1], inline_call_t calls[const static 1],
+                         const size_t count)
+{
+  ir_function_t out = { .ast = f->ast, .global = f->global, .exprs = f->exprs };
+  size_t insts = f->insts.length, blocks = f->blocks.length, operands = f->operands.length;
+  size_t switches = f->switches.length, ranges = f->ranges.length, formats = f->formats.length;
+  uint32_t slots = f->slot_count;
+
+  for (size_t i = 0; i < count; i++) {
+    insts += calls[i].callee->insts.length + 1;
+    blocks += calls[i].callee->blocks.length + 1;
+    operands += calls[i].callee->operands.length;
+    switches += calls[i].callee->switches.length;
+    ranges += calls[i].callee->ranges.length;
+    formats += calls[i].callee->formats.length;
+    calls[i].slot_base = slots;
+    slots += calls[i].callee->slot_count;
+  }
+
+  out.insts = (ir_insts_t){ .capacity = insts, .items = scratch(arena, insts, sizeof(*out.insts.items)) };
+  out.blocks = (ir_blocks_t){ .capacity = blocks, .items = scratch(arena, blocks, sizeof(*out.blocks.items)) };
+  out.operands = (ir_operands_t){ .capacity = operands, .items = scratch(arena, operands, sizeof(*out.operands.items)) };
+  out.switches = (ir_switches_t){ .capacity = switches, .items = scratch(arena, switches, sizeof(*out.switches.items)) };
+  out.ranges = (ir_case_ranges_t){ .capacity = ranges, .items = scratch(arena, ranges, sizeof(*out.ranges.items)) };
+  out.formats = (ir_formats_t){ .capacity = formats, .items = scratch(arena, formats, sizeof(*out.formats.items)) };
+  out.slot_count = slots;
+  out.slot_names = scratch(arena, slots, sizeof(*out.slot_names));
+  out.slot_kinds = scratch(arena, slots, sizeof(*out.slot_kinds));
+  memcpy(out.slot_names, f->slot_names, f->slot_count * sizeof(*f->slot_names));
+  memcpy(out.slot_kinds, f->slot_kinds, f->slot_count * sizeof(*f->slot_kinds));
+
+  for (size_t i = 0; i < count; i++) {
+    const ir_function_t *g = calls[i].callee;
+
+    memcpy(&out.slot_names[calls[i].slot_base], g->slot_names, g->slot_count * sizeof(*g->slot_names));
+    memcpy(&out.slot_kinds[calls[i].slot_base], g->slot_kinds, g->slot_count * sizeof(*g->slot_kinds));
+  }
+
+  // new ids of the blocks: a block of the caller is split at each of its calls, the blocks of the callee in between
+  uint32_t *first = scratch(arena, f->blocks.length, sizeof(*first));
+  uint32_t *last = scratch(arena, f->blocks.length, sizeof(*last)); // the part with the terminator
+  uint32_t *map = scratch(arena, f->insts.length, sizeof(*map));
+  uint32_t id = 0;
+
+  for (uint32_t b = 0, c = 0; b < f->blocks.length; b++) {
+    if (f->blocks.items[b].dead) {
+      continue;
+    }
+
+    first[b] = id++;
+
+    for (; c < count && f->insts.items[calls[c].call].block == b; c++) {
+      const ir_function_t *g = calls[c].callee;
+
+      calls[c].blocks = scratch(arena, g->blocks.length, sizeof(*calls[c].blocks));
+
+      for (uint32_t cb = 0; cb < g->blocks.length; cb++) {
+        calls[c].blocks[cb] = g->blocks.items[cb].dead ? 0 : id++;
+      }
+
+      calls[c].next = id++;
+    }
+
+    last[b] = id - 1;
+  }
+
+  for (uint32_t b = 0, c = 0; b < f->blocks.length; b++) {
+    const ir_block_t *block = &f->blocks.items[b];
+    uint32_t edges[2] = {0};
+
+    if (block->dead) {
+      continue;
+    }
+
+    for (size_t i = 0; i < block->pred_count; i++) {
+      edges[i] = last[block->preds[i]];
+    }
+
+    start_part(&out, first[b], edges, block->pred_count);
+
+    for (uint32_t v = block->first; v < block->first + block->length; v++) {
+      const ir_inst_t *inst = &f->insts.items[v];
+
+      if (inst->op == IR_OP_NOP) {
+        continue;
+      } else if (c < count && calls[c].call == v) {
+        map[v] = copy_callee(arena, &out, f, map, &calls[c++]);
+        continue;
+      }
+
+      map[v] = copy_inst(&out, f, *inst, map, 0);
+
+      if (ir_is_terminator(inst->op)) {
+        end_copied_part(&out, block, first);
+      }
+    }
+  }
+
+  *f = out;
+}
+
+// the return of block, if it ends with one, becomes a jump to join
+static void return_to(ir_function_t g[const static 1], const uint32_t b, const uint32_t join)
+{
+  ir_block_t *block = &g->blocks.items[b];
+  ir_inst_t *inst = &g->insts.items[block->first + block->length - 1];
+
+  if (inst->op == IR_OP_RETURN) {
+    *inst = (ir_inst_t){ .op = IR_OP_JUMP, .type = TYPE_NO_ID, .block = b };
+    block->succs[0] = join;
+    block->succ_count = 1;
+  }
+}
+
+/**
+ * A callee is copied block by block with its return replaced by a jump to the rest of the caller, so it has to
+ * have a single return and no block that can't be reached, which sccp and dce leave it with but for when they are
+ * off. The blocks no call can reach are dropped and every further return joins the one before it in a new block
+ * with a phi of both, after the others, as a block merges at most two paths.
+ */
+static void normalize_callee(arena_t arena[const static 1], ir_function_t g[const static 1])
+{
+  const size_t block_count = g->blocks.length;
+  uint32_t last = 0; // the block with the return found last, which the next one joins
+  uint32_t value = IR_NO_VALUE;
+  size_t returns = 0;
+
+  remove_unreachable(g);
+
+  for (uint32_t b = 0; b < block_count; b++) {
+    const ir_block_t *block = &g->blocks.items[b];
+    const ir_inst_t *ret = &g->insts.items[block->first + block->length - 1];
+
+    if (block->dead || ret->op != IR_OP_RETURN) {
+      continue;
+    } else if (returns++ == 0) {
+      last = b;
+      value = ret->args[0];
+      continue;
+    }
+
+    assertm((value == IR_NO_VALUE) == (ret->args[0] == IR_NO_VALUE), "Expected: the returns of "SV_FMT" to all have a value or none",
+            sv_fmt_args(g->ast->name));
+
+    const uint32_t join = (uint32_t)g->blocks.length;
+    const uint32_t other = ret->args[0];
+
+    return_to(g, last, join);
+    return_to(g, b, join);
+    ir_push(arena, &g->blocks, ((ir_block_t){ .first = (uint32_t)g->insts.length, .preds = { last, b }, .pred_count = 2 }));
+
+    if (value != IR_NO_VALUE) {
+      ir_push(arena, &g->insts, ((ir_inst_t){ .op = IR_OP_PHI, .type = g->insts.items[value].type, .block = join,
+                                              .args = { value, other } }));
+      value = (uint32_t)g->insts.length - 1;
+      g->blocks.items[join].length++;
+    }
+
+    ir_push(arena, &g->insts, ((ir_inst_t){ .op = IR_OP_RETURN, .type = TYPE_NO_ID, .block = join, .args = { value } }));
+    g->blocks.items[join].length++;
+    last = join;
+  }
+}
+
+// inlines what it can of the calls of a function whose callees were all inlined into already, or are recursive
+static void inline_into(inliner_t in[const static 1], const uint32_t index)
+{
+  ir_function_t *f = &in->program->items[index];
+  inline_call_t *calls = NULL;
+  size_t count = 0;
+  size_t size = ir_function_size(f);
+  uint32_t call_number = 0;
+
+  for (uint32_t v = 0; v < f->insts.length; v++) {
+    const ir_inst_t *inst = &f->insts.items[v];
+
+    if (inst->op != IR_OP_CALL) {
+      continue;
+    }
+
+    const ir_inst_t *callee = callee_of(f, inst);
+    ir_function_t *g = defined_callee(in, f, inst);
+    const ir_inline_result_t result = inline_result(in, f, inst, size);
+
+    if (result == IR_INLINE_DONE) {
+      normalize_callee(in->arena, g);
+    }
+
+    ir_push(in->arena, in->sites, ((ir_inline_site_t){
+        .caller = index,
+        .call = call_number++,
+        .callee = callee->op == IR_OP_FUNCTION || callee->op == IR_OP_EXTERN ? (uint32_t)callee->imm : IR_NO_VALUE,
+        .size = g ? (uint32_t)ir_function_size(g) : 0,
+        .result = result,
+      }));
+
+    if (result == IR_INLINE_DONE) {
+      if (calls == NULL) {
+        calls = scratch(in->arena, f->insts.length, sizeof(*calls));
+      }
+
+      calls[count++] = (inline_call_t){ .call = v, .callee = g };
+      size += ir_function_size(g);
+    }
+  }
+
+  if (count == 0) {
+    return;
+  }
+
+  inline_calls(in->arena, f, calls, count);
+
+  if (in->opts & IR_OPT_BIT(IR_OPT_SCCP)) {
+    ir_sccp(in->arena, in->program->types, f);
+  }
+
+  if (in->opts & IR_OPT_BIT(IR_OPT_COPY_PROPAGATION)) {
+    ir_copy_propagation(in->arena, f);
+  }
+
+  if (in->opts & IR_OPT_BIT(IR_OPT_DSE)) {
+    ir_dse(in->arena, in->program->global_count, f);
+  }
+
+  if (in->opts & IR_OPT_BIT(IR_OPT_DCE)) {
+    ir_dce(in->arena, f);
+  }
+}
+
+static int compare_sites(const void *a, const void *b)
+{
+  const ir_inline_site_t *x = a, *y = b;
+
+  if (x->caller != y->caller) {
+    return x->caller < y->caller ? -1 : 1;
+  }
+
+  return x->call < y->call ? -1 : x->call > y->call;
+}
+
+void ir_inline(arena_t arena[const static 1], ir_program_t program[const static 1], const uint32_t opts,
+               ir_inline_sites_t sites[const static 1])
+{
+  const size_t n = program->length;
+  inliner_t in = {
+    .arena = arena,
+    .program = program,
+    .sites = sites,
+    .opts = opts,
+    .by_global = scratch(arena, program->global_count, sizeof(*in.by_global)),
+    .states = scratch(arena, n, sizeof(*in.states)),
+  };
+  // the walk of the call graph, callees first, on a stack rather than the C one, as call chains can be long
+  uint32_t *stack = scratch(arena, n, sizeof(*stack));
+  uint32_t *cursors = scratch(arena, n, sizeof(*cursors)); // next instruction to look for calls at, by function
+  size_t depth = 0;
+
+  for (uint32_t i = 0; i < n; i++) {
+    in.by_global[program->items[i].global] = i + 1;
+  }
+
+  for (uint32_t root = 0; root < n; root++) {
+    if (in.states[root] != INLINE_UNVISITED) {
+      continue;
+    }
+
+    in.states[root] = INLINE_VISITING;
+    stack[depth++] = root;
+
+    while (depth > 0) {
+      const uint32_t top = stack[depth - 1];
+      const ir_function_t *f = &program->items[top];
+      bool pushed = false;
+
+      for (; !pushed && cursors[top] < f->insts.length; cursors[top]++) {
+        const ir_inst_t *inst = &f->insts.items[cursors[top]];
+        const ir_function_t *g = inst->op == IR_OP_CALL ? defined_callee(&in, f, inst) : NULL;
+
+        if (g && in.states[g - program->items] == INLINE_UNVISITED) {
+          in.states[g - program->items] = INLINE_VISITING;
+          stack[depth++] = (uint32_t)(g - program->items);
+          pushed = true;
+        }
+      }
+
+      if (!pushed) {
+        inline_into(&in, top);
+        in.states[top] = INLINE_VISITED;
+        depth--;
+      }
+    }
+  }
+
+  if (sites->length > 0) {
+    qsort(sites->items, sites->length, sizeof(*sites->items), compare_sites);
+  }
+}
+
+const char *ir_inline_result_name(const ir_inline_result_t result)
+{
+  static const char *ir_inline_result_to_str[] = {
+    "inlined",
+    "extern",
+    "indirect call",
+    "no body",
+    "recursive",
+    "callee too large",
+    "caller too large",
+    "signature mismatch",
+    "static locals",
+    "ast nodes",
+  };
+
+  _Static_assert(zdx_arr_len(ir_inline_result_to_str) == IR_INLINE_RESULT_COUNT, "Some inline results are missing their names");
+  assertm(result < IR_INLINE_RESULT_COUNT, "Invalid inline result %d", result);
+
+  return ir_inline_result_to_str[result];
+}
+
+void ir_inline_report(const ir_program_t program[const static 1], const ir_inline_sites_t sites[const static 1])
+{
+  fprintf(stderr, "%-24s %-24s %-20s %6s\n", "caller", "callee", "inlining", "size");
+
+  for (size_t i = 0; i < sites->length; i++) {
+    const ir_inline_site_t *site = &sites->items[i];
+    sv_t callee = sv_from_cstr("(pointer)");
+
+    if (site->result == IR_INLINE_EXTERN) {
+      callee = program->extern_names[site->callee];
+    } else if (site->callee != IR_NO_VALUE) {
+      callee = program->global_names[site->callee];
+    }
+
+    fprintf(stderr, "%-24.*s %-24.*s %-20s %6u\n", sv_fmt_args(program->items[site->caller].ast->name), sv_fmt_args(callee),
+            ir_inline_result_name(site->result), site->size);
+  }
+}
+
+// ------------------------------------ TAIL CALLS ------------------------------------
+
+// nothing may point into a frame that a callee reuses, neither an address of a local nor an ast node evaluated as is
+static bool frame_reusable(const ir_function_t f[const static 1])
+{
+  for (uint32_t v = 0; v < f->insts.length; v++) {
+    if (f->insts.items[v].op == IR_OP_ADDR_LOCAL || f->insts.items[v].op == IR_OP_EXPR) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// the last instruction of a block before its terminator that isn't a nop, IR_NO_VALUE if there is none
+static uint32_t before_terminator(const ir_function_t f[const static 1], const ir_block_t block[const static 1])
+{
+  for (uint32_t v = block->first + block->length - 1; v-- > block->first;) {
+    if (f->insts.items[v].op != IR_OP_NOP) {
+      return v;
+    }
+  }
+
+  return IR_NO_VALUE;
+}
+
+// blocks that only merge values, with phis and the copies the phis left with a single value become
+static bool only_merges(const ir_function_t f[const static 1], const ir_block_t block[const static 1])
+{
+  for (uint32_t v = block->first; v + 1 < block->first + block->length; v++) {
+    const uint8_t op = f->insts.items[v].op;
+
+    if (op != IR_OP_NOP && op != IR_OP_PHI && op != IR_OP_COPY) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static inline bool is_void(const type_table_t types[const static 1], const uint16_t id)
+{
+  const type_t *type = id == TYPE_NO_ID ? NULL : type_by_id(types, id);
+
+  return type == NULL || (type->kind == TYPE_KIND_BASE && (type->specifiers & TYPE_SPEC_VOID));
+}
+
+size_t ir_tail_calls(arena_t arena[const static 1], const type_table_t types[const static 1], ir_function_t f[const static 1])
+{
+  const size_t n = f->blocks.length;
+  bool *returns = scratch(arena, n, sizeof(*returns)); // by block, whether it only merges values on the way to a return
+  uint32_t *returned = scratch(arena, n, sizeof(*returned)); // by block, a phi of the block or a value defined before it
+  size_t count = 0;
+
+  if (!frame_reusable(f)) {
+    return 0;
+  }
+
+  // every edge goes forward, so the blocks a block jumps to are known to return or not before it
+  for (uint32_t b = (uint32_t)n; b-- > 0;) {
+    ir_block_t *block = &f->blocks.items[b];
+
+    if (block->dead) {
+      continue;
+    }
+
+    ir_inst_t *last = &f->insts.items[block->first + block->length - 1];
+    uint32_t value = last->args[0];
+
+    if (last->op == IR_OP_JUMP && returns[block->succs[0]]) {
+      const uint32_t next = block->succs[0];
+      const ir_inst_t *merged = returned[next] == IR_NO_VALUE ? NULL : &f->insts.items[returned[next]];
+
+      value = returned[next];
+
+      if (merged && merged->block == next && merged->op == IR_OP_PHI) {
+        value = merged->args[pred_index(&f->blocks.items[next], b)];
+      } else if (merged && merged->block == next && merged->op == IR_OP_COPY) {
+        value = merged->args[0];
+      }
+    } else if (last->op != IR_OP_RETURN) {
+      continue;
+    }
+
+    returns[b] = only_merges(f, block);
+    returned[b] = value;
+
+    const uint32_t v = before_terminator(f, block);
+    ir_inst_t *call = v == IR_NO_VALUE ? NULL : &f->insts.items[v];
+
+    if (call == NULL || call->op != IR_OP_CALL || callee_of(f, call)->op == IR_OP_EXTERN ||
+        (value != v && !(value == IR_NO_VALUE && is_void(types, call->type)))) {
+      continue;
+    }
+
+    // the call ends the block in place of its terminator, the blocks it jumped to may be left unreachable
+    if (last->op == IR_OP_JUMP) {
+      remove_edge(f, b, block->succs[0]);
+    }
+
+    *last = (ir_inst_t){ .op = IR_OP_NOP, .block = b };
+    call->op = IR_OP_TAIL_CALL;
+    block->length = v - block->first + 1;
+    block->succ_count = 0;
+    count++;
+  }
+
+  if (count > 0) {
+    remove_unreachable(f);
+    ir_copy_propagation(arena, f);
+    ir_dce(arena, f);
+  }
+
+  return count;
+}
+
+// ------------------------------------ BOUNDS CHECKS ------------------------------------
+
+// the values an integer may have, as signed 64 bit integers, an unsigned long past INT64_MAX is any value
+typedef struct {
+  int64_t low;
+  int64_t high;
+} range_t;
+
+typedef struct {
+  uint32_t value;
+  range_t range;
+} refinement_t;
+
+typedef struct {
+  const ir_function_t *f;
+  const type_table_t *types;
+  const uint32_t *idom;
+  range_t *ranges; // by instruction, the range of the value in its own block
+  refinement_t (*refined)[2]; // by block, what the branch of its only pred tells of the operands of its condition
+  uint32_t *via; // by block, the block every path to it comes through when a && or || rules the others out
+} ranges_t;
+
+static inline range_t any_value(void)
+{
+  return (range_t){ .low = INT64_MIN, .high = INT64_MAX };
+}
+
+static inline bool is_any(const range_t r)
+{
+  return r.low == INT64_MIN && r.high == INT64_MAX;
+}
+
+static bool integer_type(const ranges_t r[const static 1], const uint16_t type, uint16_t specifiers[const static 1])
+{
+  if (type == TYPE_NO_ID || !type_is_integer(type_by_id(r->types, type))) {
+    return false;
+  }
+
+  *specifiers = type_by_id(r->types, type)->specifiers;
+  return true;
+}
+
+// a range that isn't one of the type wraps around or overflows, so the value may be any of the type
+static range_t clamp(const ranges_t r[const static 1], const uint16_t type, const range_t range)
+{
+  uint16_t specifiers = 0;
+
+  if (!integer_type(r, type, &specifiers)) {
+    return any_value();
+  }
+
+  const unsigned width = type_integer_width(specifiers);
+  const bool is_unsigned = type_is_unsigned(specifiers);
+
+  if (width >= 64) {
+    return !is_unsigned || range.low >= 0 ? range : any_value();
+  }
+
+  const range_t of_type = is_unsigned ? (range_t){ 0, (INT64_C(1) << width) - 1 } :
+    (range_t){ -(INT64_C(1) << (width - 1)), (INT64_C(1) << (width - 1)) - 1 };
+
+  return range.low >= of_type.low && range.high <= of_type.high ? range : of_type;
+}
+
+// the smallest 2^k - 1 that isn't less than value
+static inline int64_t low_bits(const int64_t value)
+{
+  int64_t mask = 0;
+
+  while (mask < value) {
+    mask = mask * 2 + 1;
+  }
+
+  return mask;
+}
+
+static range_t range_at(const ranges_t r[const static 1], const uint32_t v, const uint32_t block);
+
+static range_t binary_range(const ranges_t r[const static 1], const ir_inst_t inst[const static 1])
+{
+  const range_t a = range_at(r, inst->args[0], inst->block);
+  const range_t b = range_at(r, inst->args[1], inst->block);
+  range_t result = any_value();
+
+  switch(inst->sub) {
+    case BINARY_OP_ADD: {
+      if (__builtin_add_overflow(a.low, b.low, &result.low) || __builtin_add_overflow(a.high, b.high, &result.high)) {
+        return any_value();
+      }
+    } break;
+
+    case BINARY_OP_SUB: {
+      if (__builtin_sub_overflow(a.low, b.high, &result.low) || __builtin_sub_overflow(a.high, b.low, &result.high)) {
+        return any_value();
+      }
+    } break;
+
+    case BINARY_OP_MULT: {
+      int64_t products[4] = {0};
+
+      if (__builtin_mul_overflow(a.low, b.low, &products[0]) || __builtin_mul_overflow(a.low, b.high, &products[1]) ||
+          __builtin_mul_overflow(a.high, b.low, &products[2]) || __builtin_mul_overflow(a.high, b.high, &products[3])) {
+        return any_value();
+      }
+
+      result = (range_t){ products[0], products[0] };
+
+      for (size_t i = 1; i < zdx_arr_len(products); i++) {
+        result.low = zdx_min(result.low, products[i]);
+        result.high = zdx_max(result.high, products[i]);
+      }
+    } break;
+
+    case BINARY_OP_DIV: {
+      if (a.low >= 0 && b.low >= 1) {
+        result = (range_t){ a.low / b.high, a.high / b.low };
+      }
+    } break;
+
+    // the remainder has the sign of the lhs and is smaller than the rhs
+    case BINARY_OP_MOD: {
+      if (b.low >= 1) {
+        result = (range_t){ a.low >= 0 ? 0 : -(b.high - 1), a.high <= 0 ? 0 : b.high - 1 };
+        result.high = a.low >= 0 ? zdx_min(result.high, a.high) : result.high;
+      }
+    } break;
+
+    case BINARY_OP_BIT_AND: {
+      if (a.low >= 0 || b.low >= 0) {
+        result = (range_t){ 0, a.low >= 0 && b.low >= 0 ? zdx_min(a.high, b.high) : a.low >= 0 ? a.high : b.high };
+      }
+    } break;
+
+    case BINARY_OP_BIT_OR:
+    case BINARY_OP_BIT_XOR: {
+      if (a.low >= 0 && b.low >= 0) {
+        result = (range_t){ 0, low_bits(zdx_max(a.high, b.high)) };
+      }
+    } break;
+
+    case BINARY_OP_LSHIFT: {
+      if (a.low >= 0 && b.low >= 0 && b.high < 63 && a.high <= (INT64_MAX >> b.high)) {
+        result = (range_t){ a.low << b.low, a.high << b.high };
+      }
+    } break;
+
+    case BINARY_OP_RSHIFT: {
+      if (a.low >= 0 && b.low >= 0 && b.high < 64) {
+        result = (range_t){ a.low >> b.high, a.high >> b.low };
+      }
+    } break;
+
+    case BINARY_OP_LT:
+    case BINARY_OP_LTE:
+    case BINARY_OP_GT:
+    case BINARY_OP_GTE:
+    case BINARY_OP_EQ:
+    case BINARY_OP_NEQ:
+    case BINARY_OP_LOGICAL_AND:
+    case BINARY_OP_LOGICAL_OR: result = (range_t){ 0, 1 }; break;
+    default: break;
+  }
+
+  return clamp(r, inst->type, result);
+}
+
+static range_t value_range(const ranges_t r[const static 1], const uint32_t v)
+{
+  const ir_inst_t *inst = &r->f->insts.items[v];
+  const ir_block_t *block = &r->f->blocks.items[inst->block];
+  uint16_t specifiers = 0;
+
+  if (!integer_type(r, inst->type, &specifiers)) {
+    return any_value();
+  }
+
+  switch(inst->op) {
+    case IR_OP_CONST: {
+      const bool past_int64 = type_integer_width(specifiers) >= 64 && type_is_unsigned(specifiers) && inst->imm > INT64_MAX;
+      return past_int64 ? any_value() : (range_t){ (int64_t)inst->imm, (int64_t)inst->imm };
+    }
+
+    case IR_OP_COPY: return range_at(r, inst->args[0], inst->block);
+
+    case IR_OP_PHI: {
+      range_t result = range_at(r, inst->args[0], block->preds[0]);
+
+      for (size_t i = 1; i < block->pred_count; i++) {
+        const range_t in = range_at(r, inst->args[i], block->preds[i]);
+
+        result = (range_t){ zdx_min(result.low, in.low), zdx_max(result.high, in.high) };
+      }
+
+      return result;
+    }
+
+    case IR_OP_UNARY: {
+      const range_t a = range_at(r, inst->args[0], inst->block);
+
+      switch(inst->sub) {
+        case UNARY_OP_CONVERT: return clamp(r, inst->type, a);
+        case UNARY_OP_NOT: return (range_t){ 0, 1 };
+        case UNARY_OP_POSITIVE: return clamp(r, inst->type, a);
+        case UNARY_OP_NEGATE: return a.low == INT64_MIN ? clamp(r, inst->type, any_value()) : clamp(r, inst->type, (range_t){ -a.high, -a.low });
+        case UNARY_OP_BIT_NOT: return clamp(r, inst->type, is_any(a) ? a : (range_t){ ~a.high, ~a.low });
+        default: return clamp(r, inst->type, any_value());
+      }
+    }
+
+    case IR_OP_BINARY: return binary_range(r, inst);
+    default: return clamp(r, inst->type, any_value());
+  }
+}
+
+// the range of v in a block its own block dominates, narrowed by the branches taken to get there
+static range_t range_at(const ranges_t r[const static 1], const uint32_t v, const uint32_t block)
+{
+  const uint32_t home = r->f->insts.items[v].block;
+  range_t result = r->ranges[v];
+
+  for (uint32_t b = block; b > home; b = r->via[b] != IR_NO_VALUE ? r->via[b] : r->idom[b]) {
+    for (size_t i = 0; i < 2; i++) {
+      const refinement_t *refinement = &r->refined[b][i];
+      const range_t narrowed = {
+        zdx_max(result.low, refinement->range.low),
+        zdx_min(result.high, refinement->range.high),
+      };
+
+      // an empty range is a path that can't be taken, which isn't worth proving anything on
+      if (refinement->value == v && narrowed.low <= narrowed.high) {
+        result = narrowed;
+      }
+    }
+  }
+
+  return result;
+}
+
+/**
+ * What the only pred of a block, which branches on a < b or the like, tells of a and b on the way to the block:
+ * on the edge where a < b holds, a is less than the most b can be and b more than the least a can be. An
+ * unsigned comparison also tells that a value isn't negative, but only with an upper bound, as an unsigned long
+ * with no range may be past INT64_MAX. A && or || branches on the phi of its value instead, and when the other
+ * values of the phi are constants that can't take the edge, the block is only reached through the one path that
+ * computes the comparison, so what holds there holds in the block too.
+ */
+static void refine(ranges_t r[const static 1], const uint32_t b)
+{
+  const ir_function_t *f = r->f;
+  const ir_block_t *block = &f->blocks.items[b];
+
+  r->refined[b][0].value = IR_NO_VALUE;
+  r->refined[b][1].value = IR_NO_VALUE;
+  r->via[b] = IR_NO_VALUE;
+
+  if (block->pred_count != 1) {
+    return;
+  }
+
+  const ir_block_t *pred = &f->blocks.items[block->preds[0]];
+  const ir_inst_t *branch = pred->length > 0 ? &f->insts.items[pred->first + pred->length - 1] : NULL;
+
+  if (branch == NULL || branch->op != IR_OP_BRANCH || pred->succs[0] == pred->succs[1]) {
+    return;
+  }
+
+  const bool taken = pred->succs[0] == b;
+  const ir_inst_t *cond = &f->insts.items[branch->args[0]];
+  uint32_t at = block->preds[0];
+
+  if (cond->op == IR_OP_PHI) {
+    const ir_block_t *join = &f->blocks.items[cond->block];
+    uint32_t path = IR_NO_VALUE;
+
+    for (uint32_t i = 0; i < join->pred_count; i++) {
+      const ir_inst_t *in = &f->insts.items[cond->args[i]];
+
+      if (in->op == IR_OP_CONST && (in->imm != 0) != taken) {
+        continue;
+      }
+
+      if (path != IR_NO_VALUE) {
+        return;
+      }
+
+      path = i;
+    }
+
+    if (path == IR_NO_VALUE) {
+      return;
+    }
+
+    at = join->preds[path];
+    r->via[b] = at;
+    cond = &f->insts.items[cond->args[path]];
+  }
+
+  uint16_t specifiers = 0;
+
+  if (cond->op != IR_OP_BINARY || !integer_type(r, f->insts.items[cond->args[0]].type, &specifiers)) {
+    return;
+  }
+
+  // a op b on the edge taken, flipped around to lhs < rhs or lhs <= rhs
+  const bool is_less = cond->sub == BINARY_OP_LT || cond->sub == BINARY_OP_LTE;
+  const bool is_strict = cond->sub == BINARY_OP_LT || cond->sub == BINARY_OP_GT;
+
+  if (!is_less && cond->sub != BINARY_OP_GT && cond->sub != BINARY_OP_GTE) {
+    return;
+  }
+
+  const bool strict = is_strict == taken;
+  const uint32_t lhs = is_less == taken ? cond->args[0] : cond->args[1];
+  const uint32_t rhs = is_less == taken ? cond->args[1] : cond->args[0];
+  const range_t a = range_at(r, lhs, at);
+  const range_t c = range_at(r, rhs, at);
+  const int64_t gap = strict ? 1 : 0;
+  range_t narrowed_lhs = { a.low, c.high == INT64_MAX ? INT64_MAX : c.high - gap };
+  range_t narrowed_rhs = { a.low == INT64_MIN ? INT64_MIN : a.low + gap, c.high };
+
+  if (type_is_unsigned(specifiers)) {
+    narrowed_lhs = narrowed_lhs.high == INT64_MAX ? any_value() : (range_t){ zdx_max(narrowed_lhs.low, 0), narrowed_lhs.high };
+    narrowed_rhs = narrowed_rhs.high == INT64_MAX ? any_value() : narrowed_rhs;
+  }
+
+  r->refined[b][0] = (refinement_t){ .value = lhs, .range = narrowed_lhs };
+  r->refined[b][1] = (refinement_t){ .value = rhs, .range = narrowed_rhs };
+}
+
+static inline uint32_t pointee_size(const ranges_t r[const static 1], const uint16_t type)
+{
+  const type_t *pointer = type_by_id(r->types, type);
+
+  return pointer->kind == TYPE_KIND_POINTER ? type_layout(pointer->pointee).size : 0;
+}
+
+/**
+ * Follows an address back through the pointer arithmetic and conversions it was computed with to the local or
+ * global it points into, adding up the range of its offset in bytes. False when it comes from anywhere else,
+ * e.g., a param or a load, whose object isn't known.
+ */
+static bool address_range(const ranges_t r[const static 1], uint32_t address, const uint32_t block, uint32_t size[const static 1],
+                          range_t offset[const static 1])
+{
+  *offset = (range_t){0};
+
+  for (;;) {
+    const ir_inst_t *inst = &r->f->insts.items[address];
+
+    switch(inst->op) {
+      case IR_OP_COPY: address = inst->args[0]; break;
+
+      case IR_OP_UNARY: {
+        if (inst->sub != UNARY_OP_CONVERT || type_by_id(r->types, r->f->insts.items[inst->args[0]].type)->kind != TYPE_KIND_POINTER) {
+          return false;
+        }
+
+        address = inst->args[0];
+      } break;
+
+      case IR_OP_BINARY: {
+        const bool pointer_lhs = type_by_id(r->types, r->f->insts.items[inst->args[0]].type)->kind == TYPE_KIND_POINTER;
+        const uint32_t index = pointer_lhs ? inst->args[1] : inst->args[0];
+        const range_t elements = range_at(r, index, block);
+        const int64_t element_size = pointee_size(r, inst->type);
+        range_t bytes = {0};
+
+        if ((inst->sub != BINARY_OP_ADD && inst->sub != BINARY_OP_SUB) || (inst->sub == BINARY_OP_SUB && !pointer_lhs) ||
+            element_size == 0 || is_any(elements) || __builtin_mul_overflow(elements.low, element_size, &bytes.low) ||
+            __builtin_mul_overflow(elements.high, element_size, &bytes.high)) {
+          return false;
+        }
+
+        bytes = inst->sub == BINARY_OP_SUB ? (range_t){ -bytes.high, -bytes.low } : bytes;
+
+        if (__builtin_add_overflow(offset->low, bytes.low, &offset->low) ||
+            __builtin_add_overflow(offset->high, bytes.high, &offset->high)) {
+          return false;
+        }
+
+        address = pointer_lhs ? inst->args[0] : inst->args[1];
+      } break;
+
+      case IR_OP_ADDR_LOCAL:
+      case IR_OP_ADDR_GLOBAL: {
+        *size = pointee_size(r, inst->type);
+        return *size > 0;
+      }
+
+      default: return false;
+    }
+  }
+}
+
+size_t ir_bounds_checks(arena_t arena[const static 1], const type_table_t types[const static 1], ir_function_t f[const static 1])
+{
+  const size_t n = f->insts.length;
+  ranges_t r = {
+    .f = f,
+    .types = types,
+    .idom = dominators(arena, f),
+    .ranges = scratch(arena, n, sizeof(*r.ranges)),
+    .refined = scratch(arena, f->blocks.length, sizeof(*r.refined)),
+    .via = scratch(arena, f->blocks.length, sizeof(*r.via)),
+  };
+  uint32_t *checked_in = scratch(arena, n, sizeof(*checked_in)); // by address, the block of the first check kept
+  uint32_t *checked_size = scratch(arena, n, sizeof(*checked_size));
+  size_t count = 0;
+
+  memset(checked_in, 0xff, n * sizeof(*checked_in));
+
+  // every edge goes forward, so the operands of a value and the branches that lead to its block come first
+  for (uint32_t b = 0; b < f->blocks.length; b++) {
+    const ir_block_t *block = &f->blocks.items[b];
+
+    if (block->dead) {
+      continue;
+    }
+
+    refine(&r, b);
+
+    for (uint32_t v = block->first; v < block->first + block->length; v++) {
+      ir_inst_t *inst = &f->insts.items[v];
+
+      r.ranges[v] = value_range(&r, v);
+
+      if ((inst->op != IR_OP_LOAD && inst->op != IR_OP_STORE) || !(inst->sub & IR_ACCESS_CHECKED)) {
+        continue;
+      }
+
+      const uint32_t address = copied(f, inst->args[0]);
+      const uint32_t access = pointee_size(&r, f->insts.items[address].type);
+      const uint16_t accessed = inst->op == IR_OP_LOAD ? inst->type : f->insts.items[inst->args[1]].type;
+      const uint32_t access_size = zdx_max(access, type_layout(type_by_id(types, accessed)).size);
+      uint32_t size = 0;
+      range_t offset = {0};
+
+      // in bounds, or already checked on every path to it by an access at least as wide
+      const bool proven = address_range(&r, address, b, &size, &offset) && offset.low >= 0 &&
+        offset.high <= (int64_t)size - (int64_t)access_size;
+      const bool redundant = checked_in[address] != IR_NO_VALUE && dominates(r.idom, checked_in[address], b) &&
+        access_size <= checked_size[address];
+
+      if (proven || redundant) {
+        inst->sub &= (uint8_t)~IR_ACCESS_CHECKED;
+        count++;
+      } else if (checked_in[address] == IR_NO_VALUE) {
+        checked_in[address] = b;
+        checked_size[address] = access_size;
+      }
+    }
+  }
+
+  return count;
+}
+
+// ------------------------------------ PIPELINE ------------------------------------
+
+const char *ir_opt_name(const ir_opt_t opt)
+{
+  static const char *ir_opt_to_str[] = {
+    "sccp",
+    "copy propagation",
+    "strength reduction",
+    "common subexpressions",
+    "dead store elimination",
+    "dead code elimination",
+    "inline",
+    "tail calls",
+    "bounds checks",
+  };
+
+  _Static_assert(zdx_arr_len(ir_opt_to_str) == IR_OPT_COUNT, "Some ir optimizations are missing their names");
+  assertm(opt < IR_OPT_COUNT, "Invalid ir optimization %d", opt);
+
+  return ir_opt_to_str[opt];
+}
+
+const char *ir_opt_flag(const ir_opt_t opt)
+{
+  static const char *ir_opt_to_flag[] = {
+    "sccp",
+    "copy-propagation",
+    "strength-reduction",
+    "cse",
+    "dse",
+    "dce",
+    "inline",
+    "tail-calls",
+    "bounds-checks",
+  };
+
+  _Static_assert(zdx_arr_len(ir_opt_to_flag) == IR_OPT_COUNT, "Some ir optimizations are missing their flags");
+  assertm(opt < IR_OPT_COUNT, "Invalid ir optimization %d", opt);
+
+  return ir_opt_to_flag[opt];
+}
+
+ir_opt_t ir_opt_from_cstr(const char name[const static 1])
+{
+  for (ir_opt_t opt = 0; opt < IR_OPT_COUNT; opt++) {
+    if (strcmp(name, ir_opt_flag(opt)) == 0) {
+      return opt;
+    }
+  }
+
+  return IR_OPT_COUNT;
+}
+
+void ir_optimize(arena_t arena[const static 1], ir_program_t program[const static 1], const uint32_t opts,
+                 ir_opt_stats_t stats[const static IR_OPT_COUNT], ir_inline_sites_t sites[const static 1])
+{
+  for (ir_opt_t opt = 0; opt < IR_OPT_COUNT; opt++) {
+    const uint64_t start = now_ns();
+
+    stats[opt].before = ir_program_size(program);
+    stats[opt].off = (opts & IR_OPT_BIT(opt)) == 0;
+
+    if (opt == IR_OPT_INLINE && !stats[opt].off) {
+      ir_inline(arena, program, opts, sites);
+    }
+
+    for (size_t i = 0; !stats[opt].off && opt != IR_OPT_INLINE && i < program->length; i++) {
+      ir_function_t *f = &program->items[i];
+
+      switch(opt) {
+        case IR_OPT_SCCP: ir_sccp(arena, program->types, f); break;
+        case IR_OPT_COPY_PROPAGATION: ir_copy_propagation(arena, f); break;
+        case IR_OPT_STRENGTH_REDUCTION: program->reduced_count += ir_strength_reduction(arena, program->types, f); break;
+        case IR_OPT_CSE: program->common_count += ir_cse(arena, f); break;
+        case IR_OPT_DSE: ir_dse(arena, program->global_count, f); break;
+        case IR_OPT_DCE: ir_dce(arena, f); break;
+        case IR_OPT_TAIL_CALLS: program->tail_call_count += ir_tail_calls(arena, program->types, f); break;
+        case IR_OPT_BOUNDS_CHECKS: program->checks_removed += ir_bounds_checks(arena, program->types, f); break;
+        default: break;
+      }
+    }
+
+    stats[opt].after = ir_program_size(program);
+    stats[opt].ns = now_ns() - start;
+  }
+
+  for (size_t i = 0; i < program->length; i++) {
+    const ir_function_t *f = &program->items[i];
+
+    for (size_t v = 0; v < f->insts.length; v++) {
+      const ir_inst_t *inst = &f->insts.items[v];
+
+      program->checks_kept += (inst->op == IR_OP_LOAD || inst->op == IR_OP_STORE) && (inst->sub & IR_ACCESS_CHECKED);
+    }
+  }
+}
+
+void ir_opt_report(const ir_opt_stats_t stats[const static IR_OPT_COUNT])
+{
+  fprintf(stderr, "%-24s %12s %12s %10s\n", "ir optimization", "before", "after", "ms");
+
+  for (ir_opt_t opt = 0; opt < IR_OPT_COUNT; opt++) {
+    if (stats[opt].off) {
+      fprintf(stderr, "%-24s %12s %12s %10s\n", ir_opt_name(opt), "-", "-", "off");
+    } else {
+      fprintf(stderr, "%-24s %12zu %12zu %10.3f\n", ir_opt_name(opt), stats[opt].before, stats[opt].after, (double)stats[opt].ns / 1e6);
+    }
+  }
+}
@@ -0,0 +1,155 @@
+#ifndef IR_OPT_H_
+#define IR_OPT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "./ir.h"
+
+#include "./zdx_simple_arena.h"
+
+typedef enum {
+  IR_OPT_SCCP,
+  IR_OPT_COPY_PROPAGATION,
+  IR_OPT_STRENGTH_REDUCTION,
+  IR_OPT_CSE,
+  IR_OPT_DSE,
+  IR_OPT_DCE,
+  IR_OPT_INLINE,
+  IR_OPT_TAIL_CALLS,
+  IR_OPT_BOUNDS_CHECKS,
+  IR_OPT_COUNT,
+} ir_opt_t;
+
+// the bit of an optimization in the opts of ir_optimize()
+#define IR_OPT_BIT(opt) (1u << (opt))
+#define IR_OPT_ALL (IR_OPT_BIT(IR_OPT_COUNT) - 1)
+
+typedef struct {
+  size_t before; // instructions of the program before the optimization ran
+  size_t after;
+  uint64_t ns;
+  bool off; // left out by the opts of ir_optimize()
+} ir_opt_stats_t;
+
+// instructions of the largest callee that is inlined
+#define IR_INLINE_BUDGET 40
+// instructions a caller may grow to by inlining
+#define IR_INLINE_CALLER_LIMIT 2000
+
+// what the inliner made of a call site, see ir_inline_result_name()
+typedef enum {
+  IR_INLINE_DONE,
+  IR_INLINE_EXTERN,
+  IR_INLINE_INDIRECT, // the callee is a value, e.g., a pointer to a function
+  IR_INLINE_NO_BODY, // declared only, or its body is lazy and was never parsed
+  IR_INLINE_RECURSIVE, // the callee is the caller or calls it back
+  IR_INLINE_TOO_LARGE,
+  IR_INLINE_CALLER_TOO_LARGE,
+  IR_INLINE_SIGNATURE, // the args don't match the params in number or type or the return doesn't match the call
+  IR_INLINE_STATIC_LOCALS, // which every call shares, so they can't move to the frame of the caller
+  IR_INLINE_AST_NODES, // the callee evaluates ast nodes as is, which refer to its own frame
+  IR_INLINE_RESULT_COUNT,
+} ir_inline_result_t;
+
+typedef struct {
+  uint32_t caller; // index in ir_program_t.items
+  uint32_t call; // the call is the call-th of the caller, in the order of its instructions before inlining
+  uint32_t callee; // global or extern slot, by the kind of callee the result says, IR_NO_VALUE if indirect
+  uint32_t size; // instructions of the callee
+  uint8_t result; // ir_inline_result_t
+} ir_inline_site_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  ir_inline_site_t *items;
+} ir_inline_sites_t;
+
+/**
+ * Sparse conditional constant propagation (Wegman and Zadeck): values are only evaluated when their block can
+ * be reached and a branch only reaches the successors its condition allows, so a constant found on one path,
+ * e.g., n in n = 4, n > 2 ? n : f(), turns its uses on that path into constants and the other path is never
+ * considered. Values that turn out constant become constants, branches on a constant become jumps and blocks
+ * that can't be reached are dropped. Integer operations are evaluated like the fold pass does, see fold.h, so
+ * undefined ones are left for the runtime.
+ */
+void ir_sccp(arena_t arena[const static 1], const type_table_t types[const static 1], ir_function_t f[const static 1]);
+// uses of a copy use what it copies instead and the copies are dropped, a phi of one value becomes a copy first
+void ir_copy_propagation(arena_t arena[const static 1], ir_function_t f[const static 1]);
+/**
+ * Replaces integer operations with cheaper ones that compute the same value: x + 0, x * 1 and the like become
+ * x, x * 0 and x & 0 become 0, and the multiplication, division and remainder of an unsigned x by a power of two
+ * become a shift or a mask. Returns the number of operations replaced.
+ */
+size_t ir_strength_reduction(arena_t arena[const static 1], const type_table_t types[const static 1], ir_function_t f[const static 1]);
+/**
+ * Common subexpression elimination: an operation that computes what one before it already has, the same
+ * operation of the same operands, uses that value instead when the block of the other one dominates its own,
+ * i.e., when every path to it goes through the other one. Only operations that read nothing but their operands
+ * are considered, a + b and b + a are the same and constants are shared. Returns the number of operations removed.
+ */
+size_t ir_cse(arena_t arena[const static 1], ir_function_t f[const static 1]);
+/**
+ * Dead store elimination: drops the stores to globals and frame slots that nothing can read before they are
+ * stored to again or, for the frame but static locals, before the function returns. Loads through a pointer,
+ * calls and ast nodes evaluated as is may read any of them.
+ */
+void ir_dse(arena_t arena[const static 1], const uint32_t global_count, ir_function_t f[const static 1]);
+// dead code elimination: drops the blocks that can't be reached, the jumps between blocks that merge into one and
+// the values that have no effect and no use
+void ir_dce(arena_t arena[const static 1], ir_function_t f[const static 1]);
+/**
+ * Replaces the calls of small functions with a copy of their body: the block of the call is split at the call,
+ * the blocks of the callee are put in between, its params become the args and its return a jump to the rest of
+ * the caller. The slots of the callee that are in memory, e.g., because their address escapes, become new slots
+ * of the caller, so every inlined call still gets its own. Callees are inlined into before their callers, so a
+ * callee brings the calls inlined into it along, and calls within a cycle of the call graph are never inlined,
+ * so inlining ends however the functions recurse. The functions inlined into are optimized again by the sccp,
+ * copy propagation, dse and dce of opts, see ir_optimize().
+ *
+ * Every call site of the program is added to sites with what became of it, sorted by caller and call.
+ */
+void ir_inline(arena_t arena[const static 1], ir_program_t program[const static 1], const uint32_t opts,
+               ir_inline_sites_t sites[const static 1]);
+const char *ir_inline_result_name(const ir_inline_result_t result);
+// prints a line a call site to stderr, whether it was inlined and why not
+void ir_inline_report(const ir_program_t program[const static 1], const ir_inline_sites_t sites[const static 1]);
+/**
+ * Turns the calls whose value is returned as is into tail calls, which end the function like a return does and
+ * run the callee in the frame of the caller instead of a new one, so recursion in tail position runs in constant
+ * memory however deep it goes. A call is in tail position when nothing but the return follows it, directly or
+ * through the blocks that only merge values, as in return n ? f(n - 1, acc * n) : acc, whose call is returned
+ * through the phi of the ternary. The args are SSA values computed before the call, so they are all read before
+ * any param of the reused frame is written, even when they swap params around as f(b, a) does. Calls of externs
+ * are left alone, as are the calls of a function that has an address of a local or an ast node evaluated as is,
+ * which may point into its frame. Returns the number of tail calls found, to be run after ir_inline(), which
+ * can't inline a callee that returns from its caller.
+ */
+size_t ir_tail_calls(arena_t arena[const static 1], const type_table_t types[const static 1], ir_function_t f[const static 1]);
+/**
+ * Drops the bounds checks of the loads and stores that can't leave the object they access: a range analysis finds
+ * the values each integer may have, narrowed in the blocks a branch on i < n or the like leads to, and an address
+ * computed from the address of a local or global plus an index whose range keeps it within the object needs no
+ * check, as in i < 4 ? b[i] : 0 where b points to the bytes of an int. An access to an address that an access at
+ * least as wide has been checked at on every path to it needs none either, as that one would have failed first.
+ * Returns the number of checks dropped.
+ */
+size_t ir_bounds_checks(arena_t arena[const static 1], const type_table_t types[const static 1], ir_function_t f[const static 1]);
+
+const char *ir_opt_name(const ir_opt_t opt);
+// the name of an optimization on the command line, e.g., copy-propagation for --no-opt=copy-propagation
+const char *ir_opt_flag(const ir_opt_t opt);
+// IR_OPT_COUNT if the name is no flag of an optimization
+ir_opt_t ir_opt_from_cstr(const char name[const static 1]);
+/**
+ * Runs the optimizations of opts, IR_OPT_BIT() of each or IR_OPT_ALL, over every function in the order of
+ * ir_opt_t, stats are indexed by ir_opt_t. The ones left out are skipped, e.g., to measure what each is worth,
+ * the inliner included, which only optimizes the functions it inlined into again with the ones left in.
+ */
+void ir_optimize(arena_t arena[const static 1], ir_program_t program[const static 1], const uint32_t opts,
+                 ir_opt_stats_t stats[const static IR_OPT_COUNT], ir_inline_sites_t sites[const static 1]);
+// prints the instruction counts before and after each optimization to stderr
+void ir_opt_report(const ir_opt_stats_t stats[const static IR_OPT_COUNT]);
+
+#endif // IR_OPT_H_
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <ctype.h>
+#include <string.h>
 
 #include "./lexer.h"
 
@@ -55,9 +56,46 @@ const char* token_kind_name(token_kind_t kind)
     "TOKEN_KIND_PLUS",
     "TOKEN_KIND_MINUS",
     "TOKEN_KIND_FSLASH",
+    "TOKEN_KIND_OBRACKET",
+    "TOKEN_KIND_CBRACKET",
+    "TOKEN_KIND_OBRACE",
+    "TOKEN_KIND_CBRACE",
+    "TOKEN_KIND_DOT",
+    "TOKEN_KIND_ARROW",
+    "TOKEN_KIND_PLUS_PLUS",
+    "TOKEN_KIND_MINUS_MINUS",
+    "TOKEN_KIND_TILDE",
+    "TOKEN_KIND_PERCENT",
+    "TOKEN_KIND_LSHIFT",
+    "TOKEN_KIND_RSHIFT",
+    "TOKEN_KIND_LT",
+    "TOKEN_KIND_LTE",
+    "TOKEN_KIND_GT",
+    "TOKEN_KIND_GTE",
+    "TOKEN_KIND_EQL_EQL",
+    "TOKEN_KIND_NOT_EQL",
+    "TOKEN_KIND_CARET",
+    "TOKEN_KIND_PIPE",
+    "TOKEN_KIND_AMPERSAND_AMPERSAND",
+    "TOKEN_KIND_PIPE_PIPE",
+    "TOKEN_KIND_QUESTION",
+    "TOKEN_KIND_COLON",
+    "TOKEN_KIND_STAR_EQL",
+    "TOKEN_KIND_FSLASH_EQL",
+    "TOKEN_KIND_PERCENT_EQL",
+    "TOKEN_KIND_PLUS_EQL",
+    "TOKEN_KIND_MINUS_EQL",
+    "TOKEN_KIND_LSHIFT_EQL",
+    "TOKEN_KIND_RSHIFT_EQL",
+    "TOKEN_KIND_AMPERSAND_EQL",
+    "TOKEN_KIND_CARET_EQL",
+    "TOKEN_KIND_PIPE_EQL",
     "TOKEN_KIND_TYPEDEF",
+    "TOKEN_KIND_RETURN",
     "TOKEN_KIND_STORAGE", // static, extern, auto, register and _Thread_local
     "TOKEN_KIND_QUALIFIER", // const, restrict, volatile, _Atomic
+    "TOKEN_KIND_SIZEOF",
+    "TOKEN_KIND_ALIGNOF", // _Alignof
     "TOKEN_KIND_SYMBOL",
     "TOKEN_KIND_STRING",
     "TOKEN_KIND_SIGNED_INT",
@@ -103,6 +141,32 @@ token_t peek_next_token(const lexer_t lexer[const static 1])
   return next_tok;
 }
 
+// returns '\0' past the end of input so multi character punctuators can look ahead freely
+static inline char lexer_char_at(const lexer_t lexer[const static 1], const size_t offset)
+{
+  const size_t idx = lexer->cursor + offset;
+
+  return idx < lexer->input->length ? lexer->input->buf[idx] : '\0';
+}
+
+// the keyword isn't the start of a longer symbol, whatever else comes after it
+static inline bool begins_with_keyword(const sv_t sv, const char keyword[const static 1], const size_t length)
+{
+  return sv.length >= length && memcmp(sv.buf, keyword, length) == 0 &&
+    (sv.length == length || !(isalnum(sv.buf[length]) || sv.buf[length] == '_'));
+}
+
+static inline token_t lex_punctuator(lexer_t lexer[const static 1], const token_kind_t kind, const size_t length)
+{
+  token_t tok = {
+    .kind = kind,
+    .value = sv_from_buf(&lexer->input->buf[lexer->cursor], length),
+  };
+  lexer->cursor += length;
+
+  return tok;
+}
+
 token_t get_next_token(lexer_t lexer[const static 1])
 {
   token_t tok = {0};
@@ -129,82 +193,92 @@ token_t get_next_token(lexer_t lexer[const static 1])
     return tok;
   }
 
-  if (lexer->input->buf[lexer->cursor] == '*') {
-    tok.kind = TOKEN_KIND_STAR;
-    tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor++], 1);
-
-    return tok;
-  }
-
-  if (lexer->input->buf[lexer->cursor] == '=') {
-    tok.kind = TOKEN_KIND_EQL;
-    tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor++], 1);
-
-    return tok;
-  }
-
-  if (lexer->input->buf[lexer->cursor] == '(') {
-    tok.kind = TOKEN_KIND_OPAREN;
-    tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor++], 1);
-
-    return tok;
-  }
-
-  if (lexer->input->buf[lexer->cursor] == ')') {
-    tok.kind = TOKEN_KIND_CPAREN;
-    tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor++], 1);
-
-    return tok;
-  }
-
-  if (lexer->input->buf[lexer->cursor] == ',') {
-    tok.kind = TOKEN_KIND_COMMA;
-    tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor++], 1);
-
-    return tok;
-  }
-
-  if (lexer->input->buf[lexer->cursor] == ';') {
-    tok.kind = TOKEN_KIND_SEMICOLON;
-    tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor++], 1);
-
-    return tok;
-  }
-
-  if (lexer->input->buf[lexer->cursor] == '&') {
-    tok.kind = TOKEN_KIND_AMPERSAND;
-    tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor++], 1);
-
-    return tok;
-  }
-
-  if (lexer->input->buf[lexer->cursor] == '!') {
-    tok.kind = TOKEN_KIND_EXCLAMATION;
-    tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor++], 1);
-
-    return tok;
-  }
-
-  if (lexer->input->buf[lexer->cursor] == '+') {
-    tok.kind = TOKEN_KIND_PLUS;
-    tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor++], 1);
-
-    return tok;
-  }
-
-  if (lexer->input->buf[lexer->cursor] == '-') {
-    tok.kind = TOKEN_KIND_MINUS;
-    tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor++], 1);
-
-    return tok;
-  }
-
-  // this == '/' and cursor+1 != '/' is as "//" are to be grouped as a single line comment starter
-  if (lexer->input->buf[lexer->cursor] == '/' && lexer->input->buf[lexer->cursor + 1] != '/') {
-    tok.kind = TOKEN_KIND_FSLASH;
-    tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor++], 1);
+  switch(lexer->input->buf[lexer->cursor]) {
+    case '(': return lex_punctuator(lexer, TOKEN_KIND_OPAREN, 1);
+    case ')': return lex_punctuator(lexer, TOKEN_KIND_CPAREN, 1);
+    case '[': return lex_punctuator(lexer, TOKEN_KIND_OBRACKET, 1);
+    case ']': return lex_punctuator(lexer, TOKEN_KIND_CBRACKET, 1);
+    case '{': return lex_punctuator(lexer, TOKEN_KIND_OBRACE, 1);
+    case '}': return lex_punctuator(lexer, TOKEN_KIND_CBRACE, 1);
+    case ',': return lex_punctuator(lexer, TOKEN_KIND_COMMA, 1);
+    case ';': return lex_punctuator(lexer, TOKEN_KIND_SEMICOLON, 1);
+    case '?': return lex_punctuator(lexer, TOKEN_KIND_QUESTION, 1);
+    case ':': return lex_punctuator(lexer, TOKEN_KIND_COLON, 1);
+    case '~': return lex_punctuator(lexer, TOKEN_KIND_TILDE, 1);
+    case '.': return lex_punctuator(lexer, TOKEN_KIND_DOT, 1);
+
+    case '=': return lexer_char_at(lexer, 1) == '='
+        ? lex_punctuator(lexer, TOKEN_KIND_EQL_EQL, 2)
+        : lex_punctuator(lexer, TOKEN_KIND_EQL, 1);
+    case '!': return lexer_char_at(lexer, 1) == '='
+        ? lex_punctuator(lexer, TOKEN_KIND_NOT_EQL, 2)
+        : lex_punctuator(lexer, TOKEN_KIND_EXCLAMATION, 1);
+    case '*': return lexer_char_at(lexer, 1) == '='
+        ? lex_punctuator(lexer, TOKEN_KIND_STAR_EQL, 2)
+        : lex_punctuator(lexer, TOKEN_KIND_STAR, 1);
+    case '%': return lexer_char_at(lexer, 1) == '='
+        ? lex_punctuator(lexer, TOKEN_KIND_PERCENT_EQL, 2)
+        : lex_punctuator(lexer, TOKEN_KIND_PERCENT, 1);
+    case '^': return lexer_char_at(lexer, 1) == '='
+        ? lex_punctuator(lexer, TOKEN_KIND_CARET_EQL, 2)
+        : lex_punctuator(lexer, TOKEN_KIND_CARET, 1);
+
+    case '+': {
+      switch(lexer_char_at(lexer, 1)) {
+        case '+': return lex_punctuator(lexer, TOKEN_KIND_PLUS_PLUS, 2);
+        case '=': return lex_punctuator(lexer, TOKEN_KIND_PLUS_EQL, 2);
+        default: return lex_punctuator(lexer, TOKEN_KIND_PLUS, 1);
+      }
+    }
+    case '-': {
+      switch(lexer_char_at(lexer, 1)) {
+        case '-': return lex_punctuator(lexer, TOKEN_KIND_MINUS_MINUS, 2);
+        case '=': return lex_punctuator(lexer, TOKEN_KIND_MINUS_EQL, 2);
+        case '>': return lex_punctuator(lexer, TOKEN_KIND_ARROW, 2);
+        default: return lex_punctuator(lexer, TOKEN_KIND_MINUS, 1);
+      }
+    }
+    case '&': {
+      switch(lexer_char_at(lexer, 1)) {
+        case '&': return lex_punctuator(lexer, TOKEN_KIND_AMPERSAND_AMPERSAND, 2);
+        case '=': return lex_punctuator(lexer, TOKEN_KIND_AMPERSAND_EQL, 2);
+        default: return lex_punctuator(lexer, TOKEN_KIND_AMPERSAND, 1);
+      }
+    }
+    case '|': {
+      switch(lexer_char_at(lexer, 1)) {
+        case '|': return lex_punctuator(lexer, TOKEN_KIND_PIPE_PIPE, 2);
+        case '=': return lex_punctuator(lexer, TOKEN_KIND_PIPE_EQL, 2);
+        default: return lex_punctuator(lexer, TOKEN_KIND_PIPE, 1);
+      }
+    }
+    case '<': {
+      switch(lexer_char_at(lexer, 1)) {
+        case '<': return lexer_char_at(lexer, 2) == '='
+            ? lex_punctuator(lexer, TOKEN_KIND_LSHIFT_EQL, 3)
+            : lex_punctuator(lexer, TOKEN_KIND_LSHIFT, 2);
+        case '=': return lex_punctuator(lexer, TOKEN_KIND_LTE, 2);
+        default: return lex_punctuator(lexer, TOKEN_KIND_LT, 1);
+      }
+    }
+    case '>': {
+      switch(lexer_char_at(lexer, 1)) {
+        case '>': return lexer_char_at(lexer, 2) == '='
+            ? lex_punctuator(lexer, TOKEN_KIND_RSHIFT_EQL, 3)
+            : lex_punctuator(lexer, TOKEN_KIND_RSHIFT, 2);
+        case '=': return lex_punctuator(lexer, TOKEN_KIND_GTE, 2);
+        default: return lex_punctuator(lexer, TOKEN_KIND_GT, 1);
+      }
+    }
+    case '/': {
+      switch(lexer_char_at(lexer, 1)) {
+        case '/': break; // "//" is a single line comment starter and is handled below
+        case '=': return lex_punctuator(lexer, TOKEN_KIND_FSLASH_EQL, 2);
+        default: return lex_punctuator(lexer, TOKEN_KIND_FSLASH, 1);
+      }
+    } break;
 
-    return tok;
+    default: break;
   }
 
   {
@@ -222,6 +296,31 @@ token_t get_next_token(lexer_t lexer[const static 1])
       return tok;
     }
 
+    // unlike the words above, return, sizeof and _Alignof are commonly followed directly by ; or (
+    if (begins_with_keyword(temp, "return", 6)) {
+      tok.kind = TOKEN_KIND_RETURN;
+      tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor], 6); // 6 = strlen("return")
+      lexer->cursor += 6;
+
+      return tok;
+    }
+
+    if (begins_with_keyword(temp, "sizeof", 6)) {
+      tok.kind = TOKEN_KIND_SIZEOF;
+      tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor], 6); // 6 = strlen("sizeof")
+      lexer->cursor += 6;
+
+      return tok;
+    }
+
+    if (begins_with_keyword(temp, "_Alignof", 8)) {
+      tok.kind = TOKEN_KIND_ALIGNOF;
+      tok.value = sv_from_buf(&lexer->input->buf[lexer->cursor], 8); // 8 = strlen("_Alignof")
+      lexer->cursor += 8;
+
+      return tok;
+    }
+
     // storage classes
     for(size_t i = 0; i < zdx_arr_len(storage_classes); i++) {
       const char *storage_class = storage_classes[i];
@@ -237,11 +336,11 @@ token_t get_next_token(lexer_t lexer[const static 1])
       }
     }
 
-    // type qualifiers
+    // type qualifiers, which end the type name of a sizeof in sizeof(char *const)
     for(size_t i = 0; i < zdx_arr_len(type_qualifiers); i++) {
       const char *type_qualifier = type_qualifiers[i];
 
-      if (sv_begins_with_word_cstr(temp, type_qualifier)) {
+      if (begins_with_keyword(temp, type_qualifier, type_qualifiers_lengths[i])) {
         const uint8_t token_length = type_qualifiers_lengths[i];
 
         tok.kind = TOKEN_KIND_QUALIFIER;
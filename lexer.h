@@ -27,9 +27,46 @@ typedef enum {
   TOKEN_KIND_PLUS,
   TOKEN_KIND_MINUS,
   TOKEN_KIND_FSLASH,
+  TOKEN_KIND_OBRACKET,
+  TOKEN_KIND_CBRACKET,
+  TOKEN_KIND_OBRACE,
+  TOKEN_KIND_CBRACE,
+  TOKEN_KIND_DOT,
+  TOKEN_KIND_ARROW,
+  TOKEN_KIND_PLUS_PLUS,
+  TOKEN_KIND_MINUS_MINUS,
+  TOKEN_KIND_TILDE,
+  TOKEN_KIND_PERCENT,
+  TOKEN_KIND_LSHIFT,
+  TOKEN_KIND_RSHIFT,
+  TOKEN_KIND_LT,
+  TOKEN_KIND_LTE,
+  TOKEN_KIND_GT,
+  TOKEN_KIND_GTE,
+  TOKEN_KIND_EQL_EQL,
+  TOKEN_KIND_NOT_EQL,
+  TOKEN_KIND_CARET,
+  TOKEN_KIND_PIPE,
+  TOKEN_KIND_AMPERSAND_AMPERSAND,
+  TOKEN_KIND_PIPE_PIPE,
+  TOKEN_KIND_QUESTION,
+  TOKEN_KIND_COLON,
+  TOKEN_KIND_STAR_EQL,
+  TOKEN_KIND_FSLASH_EQL,
+  TOKEN_KIND_PERCENT_EQL,
+  TOKEN_KIND_PLUS_EQL,
+  TOKEN_KIND_MINUS_EQL,
+  TOKEN_KIND_LSHIFT_EQL,
+  TOKEN_KIND_RSHIFT_EQL,
+  TOKEN_KIND_AMPERSAND_EQL,
+  TOKEN_KIND_CARET_EQL,
+  TOKEN_KIND_PIPE_EQL,
   TOKEN_KIND_TYPEDEF,
+  TOKEN_KIND_RETURN,
   TOKEN_KIND_STORAGE, // static, extern, auto, register and _Thread_local
   TOKEN_KIND_QUALIFIER, // const, restrict, volatile, _Atomic
+  TOKEN_KIND_SIZEOF,
+  TOKEN_KIND_ALIGNOF, // _Alignof
   TOKEN_KIND_SYMBOL,
   TOKEN_KIND_STRING,
   TOKEN_KIND_SIGNED_INT,
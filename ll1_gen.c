@@ -0,0 +1,817 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "./zdx_util.h"
+
+#define ZDX_SIMPLE_ARENA_IMPLEMENTATION
+#include "./zdx_simple_arena.h"
+
+#define ZDX_STRING_VIEW_IMPLEMENTATION
+#include "./zdx_string_view.h"
+
+#define ZDX_FILE_IMPLEMENTATION
+#define FL_ARENA_TYPE arena_t
+#define FL_ALLOC arena_alloc
+#define FL_FREE(...)
+#include "./zdx_file.h"
+
+/**
+ * Reads a grammar in the format described at the top of grammar.ll1 and writes the LL(1) parse tables
+ * for it as a C header that ll1_parser.c includes. Any conflict that isn't the longest match choice
+ * between continuing an alternative and ending it is reported and fails the build, so the grammar
+ * can't silently drift into something the table-driven parser doesn't parse like parser2.c.
+ */
+
+#define GEN_MAX_TERMINALS 128
+#define GEN_MAX_NONTERMINALS 128
+#define GEN_MAX_ACTIONS 128
+#define GEN_MAX_PRODUCTIONS 512
+#define GEN_MAX_RHS 4096
+#define GEN_NO_PRODUCTION UINT16_MAX
+
+typedef struct {
+  uint64_t bits[GEN_MAX_TERMINALS / 64];
+} gen_set_t;
+
+static inline bool gen_set_has(const gen_set_t set[const static 1], const size_t t)
+{
+  return set->bits[t / 64] & (1ULL << (t % 64));
+}
+
+static inline void gen_set_add(gen_set_t set[const static 1], const size_t t)
+{
+  set->bits[t / 64] |= 1ULL << (t % 64);
+}
+
+// returns true if dst grew
+static inline bool gen_set_union(gen_set_t dst[const static 1], const gen_set_t src[const static 1])
+{
+  bool changed = false;
+
+  for (size_t i = 0; i < zdx_arr_len(dst->bits); i++) {
+    const uint64_t bits = dst->bits[i] | src->bits[i];
+    changed |= bits != dst->bits[i];
+    dst->bits[i] = bits;
+  }
+
+  return changed;
+}
+
+typedef enum {
+  GEN_SYMBOL_TERMINAL,
+  GEN_SYMBOL_NONTERMINAL,
+  GEN_SYMBOL_ACTION,
+} gen_symbol_kind_t;
+
+typedef struct {
+  gen_symbol_kind_t kind;
+  uint16_t index;
+} gen_symbol_t;
+
+typedef struct {
+  sv_t name;
+  sv_t token_kind; // empty for %class terminals, which ll1_parser.c picks by the token value
+} gen_terminal_t;
+
+typedef struct {
+  sv_t name;
+  size_t line; // of the first use, reported if it's never defined
+  bool defined;
+  bool nullable;
+  gen_set_t first;
+  gen_set_t follow;
+  uint16_t nullable_production; // the alternative that is taken to end it, GEN_NO_PRODUCTION if none
+} gen_nonterminal_t;
+
+typedef struct {
+  sv_t name;
+  sv_t arg; // C expression passed to the action, empty passes 0
+} gen_action_t;
+
+typedef struct {
+  uint16_t lhs;
+  uint16_t rhs; // index of the first symbol in grammar_t.rhs
+  uint16_t length;
+  size_t line;
+} gen_production_t;
+
+typedef enum {
+  GEN_ENTRY_NONE,
+  GEN_ENTRY_FIRST, // the token starts the alternative
+  GEN_ENTRY_FOLLOW, // the alternative matches nothing and the token comes after it
+} gen_entry_kind_t;
+
+typedef struct {
+  const char *path;
+
+  gen_terminal_t terminals[GEN_MAX_TERMINALS];
+  size_t terminal_count;
+  gen_nonterminal_t nonterminals[GEN_MAX_NONTERMINALS];
+  size_t nonterminal_count;
+  gen_action_t actions[GEN_MAX_ACTIONS];
+  size_t action_count;
+  gen_production_t productions[GEN_MAX_PRODUCTIONS];
+  size_t production_count;
+  gen_symbol_t rhs[GEN_MAX_RHS];
+  size_t rhs_length;
+  uint16_t start;
+  bool has_start;
+
+  uint16_t table[GEN_MAX_NONTERMINALS][GEN_MAX_TERMINALS];
+  uint8_t entry_kinds[GEN_MAX_NONTERMINALS][GEN_MAX_TERMINALS];
+  // the token could also end the nonterminal, the parser takes the longest match unless told otherwise
+  bool greedy[GEN_MAX_NONTERMINALS][GEN_MAX_TERMINALS];
+  size_t greedy_count;
+  size_t conflict_count;
+} grammar_t;
+
+// ------------------------------------ SCANNER ------------------------------------
+
+typedef enum {
+  GEN_TOKEN_END,
+  GEN_TOKEN_WORD,
+  GEN_TOKEN_QUOTED, // value includes the quotes
+  GEN_TOKEN_ACTION, // value is the name without the @
+  GEN_TOKEN_DIRECTIVE, // value is the name without the %
+  GEN_TOKEN_COLON,
+  GEN_TOKEN_PIPE,
+  GEN_TOKEN_SEMICOLON,
+} gen_token_kind_t;
+
+typedef struct {
+  gen_token_kind_t kind;
+  sv_t value;
+  sv_t arg; // of an action
+  size_t line;
+} gen_token_t;
+
+typedef struct {
+  const char *path;
+  const char *buf;
+  size_t length;
+  size_t cursor;
+  size_t line;
+} gen_scanner_t;
+
+static inline bool is_word_char(const char c)
+{
+  return isalnum((unsigned char)c) || c == '_';
+}
+
+static size_t scan_word(const gen_scanner_t s[const static 1], size_t at)
+{
+  while (at < s->length && is_word_char(s->buf[at])) {
+    at++;
+  }
+
+  return at;
+}
+
+static gen_token_t next_gen_token(gen_scanner_t s[const static 1])
+{
+  while (s->cursor < s->length) {
+    const char c = s->buf[s->cursor];
+
+    if (c == '\n') {
+      s->line++;
+      s->cursor++;
+    } else if (isspace((unsigned char)c)) {
+      s->cursor++;
+    } else if (c == '#') {
+      while (s->cursor < s->length && s->buf[s->cursor] != '\n') {
+        s->cursor++;
+      }
+    } else {
+      break;
+    }
+  }
+
+  gen_token_t tok = { .line = s->line + 1 };
+
+  if (s->cursor >= s->length) {
+    tok.kind = GEN_TOKEN_END;
+    return tok;
+  }
+
+  const size_t start = s->cursor;
+  const char c = s->buf[start];
+
+  switch (c) {
+    case ':': tok.kind = GEN_TOKEN_COLON; s->cursor++; return tok;
+    case '|': tok.kind = GEN_TOKEN_PIPE; s->cursor++; return tok;
+    case ';': tok.kind = GEN_TOKEN_SEMICOLON; s->cursor++; return tok;
+
+    case '\'': {
+      size_t end = start + 1;
+
+      while (end < s->length && s->buf[end] != '\'' && s->buf[end] != '\n') {
+        end++;
+      }
+
+      if (end >= s->length || s->buf[end] != '\'' || end == start + 1) {
+        bail("%s:%zu: Error: Expected a closing quote (')", s->path, tok.line);
+      }
+
+      tok.kind = GEN_TOKEN_QUOTED;
+      tok.value = sv_from_buf(&s->buf[start], end + 1 - start);
+      s->cursor = end + 1;
+    } return tok;
+
+    case '@':
+    case '%': {
+      const size_t end = scan_word(s, start + 1);
+
+      if (end == start + 1) {
+        bail("%s:%zu: Error: Expected a name after %c", s->path, tok.line, c);
+      }
+
+      tok.kind = c == '@' ? GEN_TOKEN_ACTION : GEN_TOKEN_DIRECTIVE;
+      tok.value = sv_from_buf(&s->buf[start + 1], end - start - 1);
+      s->cursor = end;
+
+      if (c == '@' && s->cursor < s->length && s->buf[s->cursor] == '(') {
+        const size_t arg_end = scan_word(s, s->cursor + 1);
+
+        if (arg_end >= s->length || s->buf[arg_end] != ')' || arg_end == s->cursor + 1) {
+          bail("%s:%zu: Error: Expected @"SV_FMT"(ARG) with ARG made of letters, digits and _",
+               s->path, tok.line, sv_fmt_args(tok.value));
+        }
+
+        tok.arg = sv_from_buf(&s->buf[s->cursor + 1], arg_end - s->cursor - 1);
+        s->cursor = arg_end + 1;
+      }
+    } return tok;
+
+    default: {
+      const size_t end = scan_word(s, start);
+
+      if (end == start) {
+        bail("%s:%zu: Error: Unexpected character '%c'", s->path, tok.line, c);
+      }
+
+      tok.kind = GEN_TOKEN_WORD;
+      tok.value = sv_from_buf(&s->buf[start], end - start);
+      s->cursor = end;
+    } return tok;
+  }
+}
+
+static gen_token_t expect_gen_token(gen_scanner_t s[const static 1], const gen_token_kind_t kind, const char what[const static 1])
+{
+  const gen_token_t tok = next_gen_token(s);
+
+  if (tok.kind != kind) {
+    bail("%s:%zu: Error: Expected %s", s->path, tok.line, what);
+  }
+
+  return tok;
+}
+
+// ------------------------------------ READING ------------------------------------
+
+static int find_terminal(const grammar_t g[const static 1], const sv_t name)
+{
+  for (size_t i = 0; i < g->terminal_count; i++) {
+    if (sv_eq_sv(g->terminals[i].name, name)) {
+      return (int)i;
+    }
+  }
+
+  return -1;
+}
+
+static uint16_t nonterminal_index(grammar_t g[const static 1], const sv_t name, const size_t line)
+{
+  for (size_t i = 0; i < g->nonterminal_count; i++) {
+    if (sv_eq_sv(g->nonterminals[i].name, name)) {
+      return (uint16_t)i;
+    }
+  }
+
+  if (g->nonterminal_count == GEN_MAX_NONTERMINALS) {
+    bail("%s:%zu: Error: More than %d nonterminals", g->path, line, GEN_MAX_NONTERMINALS);
+  }
+
+  g->nonterminals[g->nonterminal_count] = (gen_nonterminal_t){
+    .name = name,
+    .line = line,
+    .nullable_production = GEN_NO_PRODUCTION,
+  };
+
+  return (uint16_t)g->nonterminal_count++;
+}
+
+static uint16_t action_index(grammar_t g[const static 1], const sv_t name, const sv_t arg, const size_t line)
+{
+  for (size_t i = 0; i < g->action_count; i++) {
+    if (sv_eq_sv(g->actions[i].name, name) && sv_eq_sv(g->actions[i].arg, arg)) {
+      return (uint16_t)i;
+    }
+  }
+
+  if (g->action_count == GEN_MAX_ACTIONS) {
+    bail("%s:%zu: Error: More than %d distinct actions", g->path, line, GEN_MAX_ACTIONS);
+  }
+
+  g->actions[g->action_count] = (gen_action_t){ .name = name, .arg = arg };
+
+  return (uint16_t)g->action_count++;
+}
+
+static void read_directive(grammar_t g[const static 1], gen_scanner_t s[const static 1], const gen_token_t directive)
+{
+  if (sv_eq_cstr(directive.value, "start")) {
+    const gen_token_t name = expect_gen_token(s, GEN_TOKEN_WORD, "the name of the start nonterminal after %start");
+
+    g->start = nonterminal_index(g, name.value, name.line);
+    g->has_start = true;
+    return;
+  }
+
+  const bool is_class = sv_eq_cstr(directive.value, "class");
+
+  if (!is_class && !sv_eq_cstr(directive.value, "token")) {
+    bail("%s:%zu: Error: Unknown directive %%"SV_FMT", expected one of %%token, %%class or %%start",
+         s->path, directive.line, sv_fmt_args(directive.value));
+  }
+
+  gen_token_t name = next_gen_token(s);
+
+  if (name.kind != GEN_TOKEN_WORD && name.kind != GEN_TOKEN_QUOTED) {
+    bail("%s:%zu: Error: Expected the name of the terminal after %%"SV_FMT, s->path, name.line, sv_fmt_args(directive.value));
+  }
+
+  if (find_terminal(g, name.value) >= 0) {
+    bail("%s:%zu: Error: Terminal "SV_FMT" is declared twice", s->path, name.line, sv_fmt_args(name.value));
+  }
+
+  if (g->terminal_count == GEN_MAX_TERMINALS) {
+    bail("%s:%zu: Error: More than %d terminals", s->path, name.line, GEN_MAX_TERMINALS);
+  }
+
+  gen_terminal_t *terminal = &g->terminals[g->terminal_count++];
+  *terminal = (gen_terminal_t){ .name = name.value };
+
+  if (!is_class) {
+    terminal->token_kind = expect_gen_token(s, GEN_TOKEN_WORD, "the TOKEN_KIND_ of the terminal").value;
+  }
+}
+
+static void read_rule(grammar_t g[const static 1], gen_scanner_t s[const static 1], const gen_token_t name)
+{
+  const uint16_t lhs = nonterminal_index(g, name.value, name.line);
+
+  if (g->nonterminals[lhs].defined) {
+    bail("%s:%zu: Error: Nonterminal "SV_FMT" is defined twice", s->path, name.line, sv_fmt_args(name.value));
+  }
+
+  g->nonterminals[lhs].defined = true;
+  expect_gen_token(s, GEN_TOKEN_COLON, ": after the name of the rule");
+
+  gen_token_t tok = {0};
+
+  do {
+    if (g->production_count == GEN_MAX_PRODUCTIONS) {
+      bail("%s:%zu: Error: More than %d alternatives", s->path, name.line, GEN_MAX_PRODUCTIONS);
+    }
+
+    gen_production_t *production = &g->productions[g->production_count++];
+    *production = (gen_production_t){ .lhs = lhs, .rhs = (uint16_t)g->rhs_length, .line = s->line + 1 };
+
+    for (tok = next_gen_token(s); tok.kind != GEN_TOKEN_PIPE && tok.kind != GEN_TOKEN_SEMICOLON; tok = next_gen_token(s)) {
+      gen_symbol_t symbol = {0};
+
+      switch (tok.kind) {
+        case GEN_TOKEN_QUOTED:
+        case GEN_TOKEN_WORD: {
+          const int terminal = find_terminal(g, tok.value);
+
+          if (tok.kind == GEN_TOKEN_QUOTED && terminal < 0) {
+            bail("%s:%zu: Error: Terminal "SV_FMT" isn't declared with %%token", s->path, tok.line, sv_fmt_args(tok.value));
+          }
+
+          symbol = terminal >= 0
+            ? (gen_symbol_t){ .kind = GEN_SYMBOL_TERMINAL, .index = (uint16_t)terminal }
+            : (gen_symbol_t){ .kind = GEN_SYMBOL_NONTERMINAL, .index = nonterminal_index(g, tok.value, tok.line) };
+        } break;
+
+        case GEN_TOKEN_ACTION: {
+          symbol = (gen_symbol_t){ .kind = GEN_SYMBOL_ACTION, .index = action_index(g, tok.value, tok.arg, tok.line) };
+        } break;
+
+        case GEN_TOKEN_END: bail("%s:%zu: Error: Missing ; at the end of rule "SV_FMT, s->path, tok.line, sv_fmt_args(name.value));
+        default: bail("%s:%zu: Error: Expected a terminal, a nonterminal, an action, | or ;", s->path, tok.line);
+      }
+
+      if (g->rhs_length == GEN_MAX_RHS) {
+        bail("%s:%zu: Error: More than %d symbols in all alternatives", s->path, tok.line, GEN_MAX_RHS);
+      }
+
+      g->rhs[g->rhs_length++] = symbol;
+      production->length++;
+    }
+  } while (tok.kind == GEN_TOKEN_PIPE);
+}
+
+static void read_grammar(grammar_t g[const static 1], const char path[const static 1], const char *buf, const size_t length)
+{
+  gen_scanner_t s = { .path = path, .buf = buf, .length = length };
+  bool in_rules = false;
+
+  g->path = path;
+
+  for (gen_token_t tok = next_gen_token(&s); tok.kind != GEN_TOKEN_END; tok = next_gen_token(&s)) {
+    if (tok.kind == GEN_TOKEN_DIRECTIVE) {
+      // a word in a rule is a nonterminal unless it was declared a terminal before
+      if (in_rules) {
+        bail("%s:%zu: Error: Directives must come before the rules", path, tok.line);
+      }
+
+      read_directive(g, &s, tok);
+    } else if (tok.kind == GEN_TOKEN_WORD) {
+      in_rules = true;
+      read_rule(g, &s, tok);
+    } else {
+      bail("%s:%zu: Error: Expected a directive or the name of a rule", path, tok.line);
+    }
+  }
+
+  if (!g->has_start) {
+    bail("%s: Error: Missing %%start", path);
+  }
+
+  for (size_t i = 0; i < g->nonterminal_count; i++) {
+    if (!g->nonterminals[i].defined) {
+      bail("%s:%zu: Error: Nonterminal "SV_FMT" is used but has no rule", path, g->nonterminals[i].line,
+           sv_fmt_args(g->nonterminals[i].name));
+    }
+  }
+}
+
+// ------------------------------------ SETS ------------------------------------
+
+// FIRST of rhs[from..to) into set, returns true if all of it can match nothing. Actions match nothing
+static bool first_of(const grammar_t g[const static 1], const size_t from, const size_t to, gen_set_t set[const static 1])
+{
+  for (size_t i = from; i < to; i++) {
+    const gen_symbol_t symbol = g->rhs[i];
+
+    switch (symbol.kind) {
+      case GEN_SYMBOL_ACTION: break;
+      case GEN_SYMBOL_TERMINAL: gen_set_add(set, symbol.index); return false;
+      case GEN_SYMBOL_NONTERMINAL: {
+        gen_set_union(set, &g->nonterminals[symbol.index].first);
+
+        if (!g->nonterminals[symbol.index].nullable) {
+          return false;
+        }
+      } break;
+    }
+  }
+
+  return true;
+}
+
+static void compute_sets(grammar_t g[const static 1])
+{
+  for (bool changed = true; changed;) {
+    changed = false;
+
+    for (size_t p = 0; p < g->production_count; p++) {
+      const gen_production_t *production = &g->productions[p];
+      gen_nonterminal_t *lhs = &g->nonterminals[production->lhs];
+      gen_set_t first = {0};
+
+      const bool nullable = first_of(g, production->rhs, production->rhs + production->length, &first);
+      changed |= gen_set_union(&lhs->first, &first);
+
+      if (nullable && !lhs->nullable) {
+        lhs->nullable = true;
+        changed = true;
+      }
+    }
+  }
+
+  for (bool changed = true; changed;) {
+    changed = false;
+
+    for (size_t p = 0; p < g->production_count; p++) {
+      const gen_production_t *production = &g->productions[p];
+      const size_t end = production->rhs + production->length;
+
+      for (size_t i = production->rhs; i < end; i++) {
+        if (g->rhs[i].kind != GEN_SYMBOL_NONTERMINAL) {
+          continue;
+        }
+
+        gen_nonterminal_t *nonterminal = &g->nonterminals[g->rhs[i].index];
+        gen_set_t follow = {0};
+
+        if (first_of(g, i + 1, end, &follow)) {
+          gen_set_union(&follow, &g->nonterminals[production->lhs].follow);
+        }
+
+        changed |= gen_set_union(&nonterminal->follow, &follow);
+      }
+    }
+  }
+}
+
+// ------------------------------------ TABLE ------------------------------------
+
+static void set_entry(grammar_t g[const static 1], const uint16_t p, const size_t t, const gen_entry_kind_t kind)
+{
+  const uint16_t lhs = g->productions[p].lhs;
+  gen_nonterminal_t *nonterminal = &g->nonterminals[lhs];
+  const uint16_t other = g->table[lhs][t];
+  const gen_entry_kind_t other_kind = g->entry_kinds[lhs][t];
+
+  if (other_kind == GEN_ENTRY_NONE || other == p) {
+    g->table[lhs][t] = p;
+    g->entry_kinds[lhs][t] = other_kind == GEN_ENTRY_NONE ? kind : other_kind;
+    return;
+  }
+
+  if (other_kind != kind) {
+    // continue with the alternative the token starts instead of ending, i.e., a longest match
+    g->table[lhs][t] = kind == GEN_ENTRY_FIRST ? p : other;
+    g->entry_kinds[lhs][t] = GEN_ENTRY_FIRST;
+    g->greedy[lhs][t] = true;
+    g->greedy_count++;
+    return;
+  }
+
+  fprintf(stderr, "%s:%zu: Error: LL(1) conflict in "SV_FMT" on "SV_FMT", it %s the alternative at line %zu too\n",
+          g->path, g->productions[p].line, sv_fmt_args(nonterminal->name), sv_fmt_args(g->terminals[t].name),
+          kind == GEN_ENTRY_FIRST ? "starts" : "follows", g->productions[other].line);
+  g->conflict_count++;
+}
+
+static void fill_table(grammar_t g[const static 1])
+{
+  for (size_t p = 0; p < g->production_count; p++) {
+    const gen_production_t *production = &g->productions[p];
+    gen_set_t first = {0};
+
+    const bool nullable = first_of(g, production->rhs, production->rhs + production->length, &first);
+
+    for (size_t t = 0; t < g->terminal_count; t++) {
+      if (gen_set_has(&first, t)) {
+        set_entry(g, (uint16_t)p, t, GEN_ENTRY_FIRST);
+      }
+    }
+
+    if (!nullable) {
+      continue;
+    }
+
+    gen_nonterminal_t *lhs = &g->nonterminals[production->lhs];
+
+    if (lhs->nullable_production != GEN_NO_PRODUCTION) {
+      fprintf(stderr, "%s:%zu: Error: "SV_FMT" has more than one alternative that matches nothing\n",
+              g->path, production->line, sv_fmt_args(lhs->name));
+      g->conflict_count++;
+    }
+
+    lhs->nullable_production = (uint16_t)p;
+
+    for (size_t t = 0; t < g->terminal_count; t++) {
+      if (gen_set_has(&lhs->follow, t)) {
+        set_entry(g, (uint16_t)p, t, GEN_ENTRY_FOLLOW);
+      }
+    }
+  }
+}
+
+// ------------------------------------ OUTPUT ------------------------------------
+
+static void write_c_string(FILE *out, const sv_t sv)
+{
+  fputc('"', out);
+
+  for (size_t i = 0; i < sv.length; i++) {
+    if (sv.buf[i] == '"' || sv.buf[i] == '\\') {
+      fputc('\\', out);
+    }
+
+    fputc(sv.buf[i], out);
+  }
+
+  fputc('"', out);
+}
+
+static inline size_t symbol_id(const grammar_t g[const static 1], const gen_symbol_t symbol)
+{
+  switch (symbol.kind) {
+    case GEN_SYMBOL_TERMINAL: return symbol.index;
+    case GEN_SYMBOL_NONTERMINAL: return g->terminal_count + symbol.index;
+    case GEN_SYMBOL_ACTION: return g->terminal_count + g->nonterminal_count + symbol.index;
+  }
+
+  return 0;
+}
+
+static void write_tables(const grammar_t g[const static 1], FILE *out, const char grammar_path[const static 1],
+                         const char tables_path[const static 1])
+{
+  const size_t symbol_count = g->terminal_count + g->nonterminal_count + g->action_count;
+  const bool small_symbols = symbol_count < UINT8_MAX;
+  const bool small_productions = g->production_count < UINT8_MAX;
+  const char *symbol_type = small_symbols ? "uint8_t" : "uint16_t";
+  const char *production_type = small_productions ? "uint8_t" : "uint16_t";
+
+  fprintf(out, "// Generated by ll1_gen from %s, do not edit. Regenerate with ./ll1_gen %s %s\n", grammar_path, grammar_path, tables_path);
+  fprintf(out, "// %zu terminals, %zu nonterminals, %zu actions, %zu alternatives, %zu longest match entries\n\n",
+          g->terminal_count, g->nonterminal_count, g->action_count, g->production_count, g->greedy_count);
+  fprintf(out, "#ifndef LL1_TABLES_H_\n#define LL1_TABLES_H_\n\n");
+
+  fprintf(out, "// parse stack symbols are the terminals, then the nonterminals, then the actions\n");
+  fprintf(out, "#define LL1_TERMINAL_COUNT %zu\n", g->terminal_count);
+  fprintf(out, "#define LL1_NONTERMINAL_COUNT %zu\n", g->nonterminal_count);
+  fprintf(out, "#define LL1_ACTION_COUNT %zu\n", g->action_count);
+  fprintf(out, "#define LL1_PRODUCTION_COUNT %zu\n", g->production_count);
+  fprintf(out, "#define LL1_NONTERMINAL_BASE LL1_TERMINAL_COUNT\n");
+  fprintf(out, "#define LL1_ACTION_BASE (LL1_TERMINAL_COUNT + LL1_NONTERMINAL_COUNT)\n");
+  fprintf(out, "#define LL1_START %zu\n", symbol_id(g, (gen_symbol_t){ .kind = GEN_SYMBOL_NONTERMINAL, .index = g->start }));
+  fprintf(out, "#define LL1_NO_PRODUCTION %s\n\n", small_productions ? "UINT8_MAX" : "UINT16_MAX");
+
+  for (size_t t = 0; t < g->terminal_count; t++) {
+    if (g->terminals[t].name.buf[0] != '\'') {
+      fprintf(out, "#define LL1_TERMINAL_"SV_FMT" %zu\n", sv_fmt_args(g->terminals[t].name), t);
+    }
+  }
+
+  fprintf(out, "\ntypedef %s ll1_symbol_t;\n", symbol_type);
+  fprintf(out, "typedef %s ll1_production_t;\n\n", production_type);
+
+  fprintf(out, "static const char *const ll1_symbol_names[] = {\n");
+
+  for (size_t t = 0; t < g->terminal_count; t++) {
+    fprintf(out, "  ");
+    write_c_string(out, g->terminals[t].name);
+    fprintf(out, ",\n");
+  }
+
+  for (size_t n = 0; n < g->nonterminal_count; n++) {
+    fprintf(out, "  ");
+    write_c_string(out, g->nonterminals[n].name);
+    fprintf(out, ",\n");
+  }
+
+  for (size_t a = 0; a < g->action_count; a++) {
+    fprintf(out, "  \"@"SV_FMT"\",\n", sv_fmt_args(g->actions[a].name));
+  }
+
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "// terminal + 1 of each token kind, 0 for tokens that only a %%class terminal or no terminal matches\n");
+  fprintf(out, "static const %s ll1_token_terminals[TOKEN_KIND_COUNT] = {\n", symbol_type);
+
+  for (size_t t = 0; t < g->terminal_count; t++) {
+    if (!sv_is_empty(g->terminals[t].token_kind)) {
+      fprintf(out, "  ["SV_FMT"] = %zu,\n", sv_fmt_args(g->terminals[t].token_kind), t + 1);
+    }
+  }
+
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "// symbols of each alternative in reverse so the driver pushes them in order onto its stack\n");
+  fprintf(out, "static const ll1_symbol_t ll1_rhs[] = {");
+
+  for (size_t p = 0; p < g->production_count; p++) {
+    const gen_production_t *production = &g->productions[p];
+
+    fprintf(out, "\n  /* %zu: "SV_FMT" */", p, sv_fmt_args(g->nonterminals[production->lhs].name));
+
+    for (size_t i = production->length; i > 0; i--) {
+      fprintf(out, " %zu,", symbol_id(g, g->rhs[production->rhs + i - 1]));
+    }
+  }
+
+  fprintf(out, "\n};\n\n");
+
+  fprintf(out, "static const struct { uint16_t rhs; uint8_t length; } ll1_productions[LL1_PRODUCTION_COUNT] = {\n");
+
+  for (size_t p = 0; p < g->production_count; p++) {
+    fprintf(out, "  { %u, %u },\n", g->productions[p].rhs, g->productions[p].length);
+  }
+
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "// alternative to expand a nonterminal into by the next terminal\n");
+  fprintf(out, "static const ll1_production_t ll1_table[LL1_NONTERMINAL_COUNT][LL1_TERMINAL_COUNT] = {\n");
+
+  for (size_t n = 0; n < g->nonterminal_count; n++) {
+    fprintf(out, "  /* "SV_FMT" */ {", sv_fmt_args(g->nonterminals[n].name));
+
+    for (size_t t = 0; t < g->terminal_count; t++) {
+      if (g->entry_kinds[n][t] == GEN_ENTRY_NONE) {
+        fprintf(out, " LL1_NO_PRODUCTION,");
+      } else {
+        fprintf(out, " %u,", g->table[n][t]);
+      }
+    }
+
+    fprintf(out, " },\n");
+  }
+
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "// bit t of a nonterminal is set when terminal t could also come after it, ll1_table continues instead\n");
+  fprintf(out, "static const uint8_t ll1_greedy[LL1_NONTERMINAL_COUNT][(LL1_TERMINAL_COUNT + 7) / 8] = {\n");
+
+  for (size_t n = 0; n < g->nonterminal_count; n++) {
+    fprintf(out, "  {");
+
+    for (size_t byte = 0; byte < (g->terminal_count + 7) / 8; byte++) {
+      unsigned bits = 0;
+
+      for (size_t bit = 0; bit < 8 && byte * 8 + bit < g->terminal_count; bit++) {
+        bits |= (unsigned)g->greedy[n][byte * 8 + bit] << bit;
+      }
+
+      fprintf(out, " 0x%02x,", bits);
+    }
+
+    fprintf(out, " },\n");
+  }
+
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "// the alternative that ends a nonterminal when ll1_greedy is overruled\n");
+  fprintf(out, "static const ll1_production_t ll1_nullable_productions[LL1_NONTERMINAL_COUNT] = {\n");
+
+  for (size_t n = 0; n < g->nonterminal_count; n++) {
+    const uint16_t p = g->nonterminals[n].nullable_production;
+
+    if (p == GEN_NO_PRODUCTION) {
+      fprintf(out, "  LL1_NO_PRODUCTION,\n");
+    } else {
+      fprintf(out, "  %u,\n", p);
+    }
+  }
+
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "static const ll1_action_t ll1_actions[LL1_ACTION_COUNT] = {\n");
+
+  for (size_t a = 0; a < g->action_count; a++) {
+    const gen_action_t *action = &g->actions[a];
+
+    if (sv_is_empty(action->arg)) {
+      fprintf(out, "  { ll1_action_"SV_FMT", 0 },\n", sv_fmt_args(action->name));
+    } else {
+      fprintf(out, "  { ll1_action_"SV_FMT", "SV_FMT" },\n", sv_fmt_args(action->name), sv_fmt_args(action->arg));
+    }
+  }
+
+  fprintf(out, "};\n\n#endif // LL1_TABLES_H_\n");
+}
+
+// gcc -O2 -g -std=c17 -Wall -Wdeprecated -Wpedantic -Wextra -o ll1_gen ll1_gen.c && ./ll1_gen grammar.ll1 ll1_tables.h
+int main(int argc, char *argv[])
+{
+  if (argc != 3) {
+    bail("Usage: ./ll1_gen <grammar> <output header>");
+  }
+
+  arena_t arena = arena_create(1 MB);
+  assertm(!arena.err, "Expected: arena creation to succeed, Received: %s", arena.err);
+
+  fl_content_t fc = fl_read_file(&arena, argv[1], "r");
+
+  if (fc.err) {
+    bail("%s: Error: %s", argv[1], fc.err);
+  }
+
+  grammar_t *g = arena_calloc(&arena, 1, sizeof(*g));
+  assertm(!arena.err, "Expected: grammar alloc to succeed, Received: %s", arena.err);
+
+  read_grammar(g, argv[1], fc.contents, fc.size);
+  compute_sets(g);
+  fill_table(g);
+
+  if (g->conflict_count > 0) {
+    bail("%s: Error: %zu conflicts, no tables written", argv[1], g->conflict_count);
+  }
+
+  FILE *out = fopen(argv[2], "w");
+
+  if (out == NULL) {
+    bail("%s: Error: Could not open for writing", argv[2]);
+  }
+
+  write_tables(g, out, argv[1], argv[2]);
+
+  if (fclose(out) != 0) {
+    bail("%s: Error: Could not write the tables", argv[2]);
+  }
+
+  arena_free(&arena);
+
+  return 0;
+}
@@ -0,0 +1,732 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "./zdx_util.h"
+#include "./ll1_parser.h"
+
+typedef struct {
+  uint8_t storage;
+  uint8_t qualifiers;
+  uint8_t pointer_qualifiers; // of the pointer declarator being read
+  uint16_t specifiers;
+  sv_t type_name; // typedef name among the specifiers
+  const type_t *type;
+  sv_t name;
+} ll1_declarator_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  ll1_declarator_t *items;
+} ll1_declarators_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  uint8_t *items;
+} ll1_symbols_t;
+
+typedef struct {
+  arena_t *arena;
+  type_table_t *types;
+  typedef_names_t *typedef_names;
+  lexer_t lexer;
+
+  token_t token; // next token, WS and NEWLINE are skipped
+  lexer_t token_at; // right before token, where errors about it point
+  bool newline_before; // a NEWLINE was skipped to get to token
+  token_t matched; // last token matched by a terminal, the one actions read
+  lexer_t matched_at;
+  lexer_t matched_end; // right after matched
+
+  ll1_symbols_t symbols;
+  ast_node_list_t values;
+  ll1_declarators_t declarators; // declarators being read, a declarator is done with before its params are read
+
+  // set by ll1_parse_stream(), NULL next_token lexes the source
+  ll1_next_token_fn next_token;
+  void *token_ctx;
+  ll1_statement_fn on_statement;
+  void *statement_ctx;
+} ll1_parser_t;
+
+typedef const char *(*ll1_action_fn)(ll1_parser_t p[const static 1], const int arg);
+
+typedef struct {
+  ll1_action_fn fn;
+  int arg;
+} ll1_action_t;
+
+#define LL1_STACK_MIN_CAP 64
+
+#define ll1_push(arena, stack, item)                                                                        \
+  do {                                                                                                      \
+    if ((stack)->length == (stack)->capacity) {                                                             \
+      const size_t capacity = zdx_max((stack)->capacity * 2, LL1_STACK_MIN_CAP);                            \
+                                                                                                            \
+      (stack)->items = arena_realloc((arena), (stack)->items, (stack)->capacity * sizeof(*(stack)->items),  \
+                                     capacity * sizeof(*(stack)->items));                                   \
+      assertm(!(arena)->err, "Expected: ll1 stack resize to be successful, Received: %s", (arena)->err);    \
+      (stack)->capacity = capacity;                                                                         \
+    }                                                                                                       \
+                                                                                                            \
+    (stack)->items[(stack)->length++] = (item);                                                             \
+  } while(0)
+
+static inline ast_node_t pop_value(ll1_parser_t p[const static 1])
+{
+  assertm(p->values.length > 0, "Expected: a value on the ll1 value stack, Received: an empty stack");
+
+  return p->values.items[--p->values.length];
+}
+
+static inline ast_node_t *top_value(ll1_parser_t p[const static 1], const ast_node_kind_t kind)
+{
+  assertm(p->values.length > 0 && p->values.items[p->values.length - 1].kind == kind,
+          "Expected: %s on top of the ll1 value stack, Received: %s", node_kind_name(kind),
+          p->values.length > 0 ? node_kind_name(p->values.items[p->values.length - 1].kind) : "an empty stack");
+
+  return &p->values.items[p->values.length - 1];
+}
+
+static inline void push_value(ll1_parser_t p[const static 1], const ast_node_t node)
+{
+  ll1_push(p->arena, &p->values, node);
+}
+
+static inline ast_node_t *new_ll1_node(ll1_parser_t p[const static 1], const ast_node_t node)
+{
+  ast_node_t *allocated = arena_alloc(p->arena, sizeof(*allocated));
+  assertm(!p->arena->err, "Expected: node alloc to succeed, Received: %s", p->arena->err);
+  *allocated = node;
+
+  return allocated;
+}
+
+static inline ll1_declarator_t *top_declarator(ll1_parser_t p[const static 1])
+{
+  assertm(p->declarators.length > 0, "Expected: a declarator being read, Received: none");
+
+  return &p->declarators.items[p->declarators.length - 1];
+}
+
+// ------------------------------------ ACTIONS ------------------------------------
+
+// each is called as @name(arg) from grammar.ll1 and returns NULL on success and the reason otherwise
+
+static const char *ll1_action_list(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  push_value(p, (ast_node_t){ .kind = AST_NODE_KIND_LIST });
+
+  return NULL;
+}
+
+static const char *ll1_action_append(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  const ast_node_t item = pop_value(p);
+  ast_node_t *list = top_value(p, AST_NODE_KIND_LIST);
+
+  // the program is the list at the bottom of the stack, a streamed one hands its statements on instead
+  if (p->on_statement && p->values.length == 1) {
+    p->on_statement(p->statement_ctx, item);
+    return NULL;
+  }
+
+  if (list->children == NULL) {
+    list->children = arena_calloc(p->arena, 1, sizeof(*list->children));
+    assertm(!p->arena->err, "Expected: list alloc to succeed, Received: %s", p->arena->err);
+  }
+
+  add_node(p->arena, list->children, item);
+
+  return NULL;
+}
+
+static const char *ll1_action_symbol(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  push_value(p, (ast_node_t){ .kind = AST_NODE_KIND_SYMBOL, .symbol = { .name = p->matched.value } });
+
+  return NULL;
+}
+
+static const char *ll1_action_literal(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  const ast_node_t literal = new_literal(&p->matched_end, p->matched.kind, p->matched.value);
+
+  if (has_err(literal)) {
+    return literal.err.msg;
+  }
+
+  push_value(p, literal);
+
+  return NULL;
+}
+
+static const char *ll1_action_unary(ll1_parser_t p[const static 1], const int arg)
+{
+  const ast_node_t expr = pop_value(p);
+
+  push_value(p, (ast_node_t){
+      .kind = AST_NODE_KIND_UNARY_OP,
+      .unary_op = { .kind = (unary_op_kind_t)arg, .expr = new_ll1_node(p, expr) },
+    });
+
+  return NULL;
+}
+
+static const char *ll1_action_binary(ll1_parser_t p[const static 1], const int arg)
+{
+  const ast_node_t rhs = pop_value(p);
+  const ast_node_t lhs = pop_value(p);
+
+  push_value(p, (ast_node_t){
+      .kind = AST_NODE_KIND_BINARY_OP,
+      .binary_op = { .kind = (binary_op_kind_t)arg, .lhs = new_ll1_node(p, lhs), .rhs = new_ll1_node(p, rhs) },
+    });
+
+  return NULL;
+}
+
+// the member name is the symbol just matched
+static const char *ll1_action_member(ll1_parser_t p[const static 1], const int arg)
+{
+  const ast_node_t base = pop_value(p);
+  const ast_node_t member = { .kind = AST_NODE_KIND_SYMBOL, .symbol = { .name = p->matched.value } };
+
+  push_value(p, (ast_node_t){
+      .kind = AST_NODE_KIND_BINARY_OP,
+      .binary_op = { .kind = (binary_op_kind_t)arg, .lhs = new_ll1_node(p, base), .rhs = new_ll1_node(p, member) },
+    });
+
+  return NULL;
+}
+
+static const char *ll1_action_ternary(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  const ast_node_t else_expr = pop_value(p);
+  const ast_node_t then_expr = pop_value(p);
+  const ast_node_t cond = pop_value(p);
+
+  push_value(p, (ast_node_t){
+      .kind = AST_NODE_KIND_TERNARY,
+      .ternary = {
+        .cond = new_ll1_node(p, cond),
+        .then_expr = new_ll1_node(p, then_expr),
+        .else_expr = new_ll1_node(p, else_expr),
+      },
+    });
+
+  return NULL;
+}
+
+static const char *ll1_action_call(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  const ast_node_t args = pop_value(p);
+  const ast_node_t callee = pop_value(p);
+
+  push_value(p, (ast_node_t){
+      .kind = AST_NODE_KIND_CALL,
+      .call = { .callee = new_ll1_node(p, callee), .args = args.children },
+    });
+
+  return NULL;
+}
+
+static const char *ll1_action_return(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  push_value(p, (ast_node_t){ .kind = AST_NODE_KIND_RETURN });
+
+  return NULL;
+}
+
+static const char *ll1_action_return_expr(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  const ast_node_t expr = pop_value(p);
+
+  push_value(p, (ast_node_t){ .kind = AST_NODE_KIND_RETURN, .ret = { .expr = new_ll1_node(p, expr) } });
+
+  return NULL;
+}
+
+static const char *ll1_action_declarator(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  ll1_push(p->arena, &p->declarators, (ll1_declarator_t){0});
+
+  return NULL;
+}
+
+static const char *ll1_action_storage(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  ll1_declarator_t *d = top_declarator(p);
+  const uint8_t storage_class = storage_class_from_sv(p->matched.value);
+
+  if (d->storage & storage_class) {
+    return "Duplicate storage class specifier";
+  }
+
+  d->storage |= storage_class;
+
+  return NULL;
+}
+
+static const char *ll1_action_typedef(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  ll1_declarator_t *d = top_declarator(p);
+
+  if (d->storage & STORAGE_CLASS_TYPEDEF) {
+    return "Duplicate storage class specifier";
+  }
+
+  d->storage |= STORAGE_CLASS_TYPEDEF;
+
+  return NULL;
+}
+
+static const char *ll1_action_qualifier(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  top_declarator(p)->qualifiers |= type_qualifier_from_sv(p->matched.value);
+
+  return NULL;
+}
+
+static const char *ll1_action_specifier(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  ll1_declarator_t *d = top_declarator(p);
+  const char *err = type_specifiers_add(&d->specifiers, p->matched.value);
+
+  if (err) {
+    return err;
+  }
+
+  if ((d->specifiers & TYPE_SPEC_NAMED) && sv_is_empty(d->type_name)) {
+    d->type_name = p->matched.value;
+  }
+
+  return NULL;
+}
+
+static const char *ll1_action_base_type(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  ll1_declarator_t *d = top_declarator(p);
+  const char *err = type_specifiers_normalize(&d->specifiers);
+
+  if (err) {
+    return err;
+  }
+
+  d->type = type_intern(p->arena, p->types, (type_t){
+      .kind = TYPE_KIND_BASE,
+      .qualifiers = d->qualifiers,
+      .specifiers = d->specifiers,
+      .name = d->type_name,
+      .aliased = sv_is_empty(d->type_name) ? NULL : typedef_names_type(p->typedef_names, d->type_name),
+    });
+
+  return NULL;
+}
+
+static const char *ll1_action_pointer_qualifier(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  top_declarator(p)->pointer_qualifiers |= type_qualifier_from_sv(p->matched.value);
+
+  return NULL;
+}
+
+static const char *ll1_action_pointer(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  ll1_declarator_t *d = top_declarator(p);
+
+  d->type = type_intern(p->arena, p->types, (type_t){
+      .kind = TYPE_KIND_POINTER,
+      .qualifiers = d->pointer_qualifiers,
+      .pointee = d->type,
+    });
+  d->pointer_qualifiers = 0;
+
+  return NULL;
+}
+
+static const char *ll1_action_name(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  top_declarator(p)->name = p->matched.value;
+
+  return NULL;
+}
+
+static const char *ll1_action_declare(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  const ll1_declarator_t d = *top_declarator(p);
+  const type_t *type = d.type;
+
+  p->declarators.length--;
+
+  if (d.storage) {
+    type_t outermost = *type;
+    outermost.storage = d.storage;
+    type = type_intern(p->arena, p->types, outermost);
+  }
+
+  // in scope from the end of its declarator like in parser2.c, an unnamed param declares nothing
+  if (!sv_is_empty(d.name)) {
+    typedef_names_declare(p->arena, p->typedef_names, d.name, d.storage & STORAGE_CLASS_TYPEDEF ? type : NULL);
+  }
+
+  push_value(p, (ast_node_t){
+      .kind = AST_NODE_KIND_DECLARATION,
+      .declaration = { .type = type, .name = d.name },
+    });
+
+  return NULL;
+}
+
+// the name of a type name is left empty where the name would be, like parser2.c does
+static const char *ll1_action_type_name(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  const ll1_declarator_t d = *top_declarator(p);
+
+  p->declarators.length--;
+  push_value(p, (ast_node_t){
+      .kind = AST_NODE_KIND_DECLARATION,
+      .declaration = { .type = d.type, .name = sv_from_buf(&p->matched_end.input->buf[p->matched_end.cursor], 0) },
+    });
+
+  return NULL;
+}
+
+static const char *ll1_action_init(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  const ast_node_t value = pop_value(p);
+  ast_node_t *declaration = top_value(p, AST_NODE_KIND_DECLARATION);
+
+  if (declaration->declaration.type->storage & STORAGE_CLASS_TYPEDEF) {
+    return "A typedef can't have an initializer";
+  }
+
+  declaration->declaration.init = new_ll1_node(p, value);
+
+  return NULL;
+}
+
+static const char *ll1_action_function(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  const ast_node_t params = pop_value(p);
+  const ast_node_t declarator = pop_value(p);
+
+  if (declarator.declaration.type->storage & STORAGE_CLASS_TYPEDEF) {
+    return "Function typedefs are not supported";
+  }
+
+  ast_function_t *function = arena_calloc(p->arena, 1, sizeof(*function));
+  assertm(!p->arena->err, "Expected: function alloc to succeed, Received: %s", p->arena->err);
+
+  function->type = declarator.declaration.type;
+  function->name = declarator.declaration.name;
+  function->params = params.children;
+
+  if (params.children && params.children->length == 1) {
+    const ast_node_t *param = &params.children->items[0];
+    const type_t *type = param->declaration.type;
+
+    // (void) declares no params
+    if (sv_is_empty(param->declaration.name) && type->kind == TYPE_KIND_BASE &&
+        type->specifiers == TYPE_SPEC_VOID && type->qualifiers == 0 && type->storage == 0) {
+      function->params = NULL;
+    }
+  }
+
+  for (size_t i = 0; function->params && i < function->params->length; i++) {
+    if (sv_is_empty(function->params->items[i].declaration.name)) {
+      return "Unexpected character instead of the declared name";
+    }
+  }
+
+  push_value(p, (ast_node_t){ .kind = AST_NODE_KIND_FUNCTION, .function = function });
+
+  return NULL;
+}
+
+// the ( of the params was just matched
+static const char *ll1_action_scope(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  typedef_names_open_scope(p->arena, p->typedef_names);
+
+  return NULL;
+}
+
+static const char *ll1_action_end_scope(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  typedef_names_close_scope(p->typedef_names);
+
+  return NULL;
+}
+
+// the { was just matched, a body can only have prototypes as C has no nested functions
+static const char *ll1_action_body_begin(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+
+  for (size_t i = 0; i + 1 < p->values.length; i++) {
+    if (p->values.items[i].kind == AST_NODE_KIND_FUNCTION) {
+      return "Function definition is not allowed here";
+    }
+  }
+
+  top_value(p, AST_NODE_KIND_FUNCTION)->function->body_source = sv_from_buf(p->matched.value.buf, 0);
+
+  return NULL;
+}
+
+// the } was just matched
+static const char *ll1_action_body(ll1_parser_t p[const static 1], const int arg)
+{
+  (void)arg;
+  const ast_node_t body = pop_value(p);
+  ast_function_t *function = top_value(p, AST_NODE_KIND_FUNCTION)->function;
+
+  function->body = function_body_list(p->arena, body.children);
+  function->body_source.length = (size_t)(p->matched.value.buf + 1 - function->body_source.buf);
+
+  return NULL;
+}
+
+// ------------------------------------ DRIVER ------------------------------------
+
+#include "./ll1_tables.h"
+
+_Static_assert(LL1_TERMINAL_COUNT + LL1_NONTERMINAL_COUNT + LL1_ACTION_COUNT <= UINT8_MAX,
+               "Expected: parse stack symbols to fit the uint8_t of ll1_symbols_t");
+
+#define LL1_NO_TERMINAL LL1_TERMINAL_COUNT
+
+// The lexer hack: a typedef name is a TYPE_WORD only where the symbol on top of the parse stack lets a
+// type specifier start a declaration or continue one without type specifiers yet, e.g., in T * x; T is
+// a type if it's a typedef name in scope and in int T; it's the declared name either way
+static inline bool expects_type_name(const ll1_parser_t p[const static 1], const uint8_t expected)
+{
+  if (expected == LL1_TERMINAL_TYPE_WORD) {
+    return true;
+  }
+
+  if (expected < LL1_NONTERMINAL_BASE || expected >= LL1_ACTION_BASE ||
+      ll1_table[expected - LL1_NONTERMINAL_BASE][LL1_TERMINAL_TYPE_WORD] == LL1_NO_PRODUCTION) {
+    return false;
+  }
+
+  return p->declarators.length == 0 || p->declarators.items[p->declarators.length - 1].specifiers == 0;
+}
+
+static inline size_t terminal_of(const ll1_parser_t p[const static 1], const uint8_t expected)
+{
+  const token_t token = p->token;
+
+  if (token.kind == TOKEN_KIND_SYMBOL && (type_specifier_is_keyword(token.value) ||
+      (expects_type_name(p, expected) && typedef_names_is_type(p->typedef_names, token.value)))) {
+    return LL1_TERMINAL_TYPE_WORD;
+  }
+
+  const size_t terminal = ll1_token_terminals[token.kind];
+
+  return terminal == 0 ? LL1_NO_TERMINAL : terminal - 1;
+}
+
+void ll1_lex(lexer_t lexer[const static 1], ll1_token_t token[const static 1])
+{
+  token->newline_before = false;
+
+  while (true) {
+    token->at = *lexer;
+    token->token = get_next_token(lexer);
+
+    if (token->token.kind == TOKEN_KIND_NEWLINE) {
+      token->newline_before = true;
+    } else if (token->token.kind != TOKEN_KIND_WS) {
+      token->end = *lexer;
+      return;
+    }
+  }
+}
+
+static void advance(ll1_parser_t p[const static 1])
+{
+  ll1_token_t next = {0};
+
+  if (p->next_token) {
+    p->next_token(p->token_ctx, &next);
+  } else {
+    ll1_lex(&p->lexer, &next);
+  }
+
+  p->token = next.token;
+  p->token_at = next.at;
+  p->lexer = next.end;
+  p->newline_before = next.newline_before;
+}
+
+// at is the lexer right before the token the error is about
+static inline ast_node_t ll1_error(const lexer_t at[const static 1], const char *msg)
+{
+  return (ast_node_t){
+    .kind = AST_NODE_KIND_ERROR,
+    .err = {
+      .msg = (char *)msg,
+      .line = at->line,
+      .bol = at->bol,
+      .cursor = at->cursor,
+    }
+  };
+}
+
+// fmt takes the name of the next token and then the name of the grammar symbol
+static const char *unexpected_token_msg(ll1_parser_t p[const static 1], const char fmt[const static 1], const uint8_t symbol)
+{
+  if (p->token.err) {
+    return p->token.err;
+  }
+
+  const size_t terminal = terminal_of(p, symbol);
+  const char *found = terminal == LL1_NO_TERMINAL ? token_kind_name(p->token.kind) : ll1_symbol_names[terminal];
+  const int length = snprintf(NULL, 0, fmt, found, ll1_symbol_names[symbol]);
+
+  char *msg = arena_alloc(p->arena, (size_t)length + 1);
+  assertm(!p->arena->err, "Expected: error message alloc to succeed, Received: %s", p->arena->err);
+  snprintf(msg, (size_t)length + 1, fmt, found, ll1_symbol_names[symbol]);
+
+  return msg;
+}
+
+static ast_node_t ll1_run(ll1_parser_t p[const static 1], const parser_opts_t opts[const static 1])
+{
+  arena_t *arena = p->arena;
+  p->types = opts->types;
+  p->typedef_names = opts->typedef_names;
+
+  if (p->types == NULL) {
+    p->types = arena_calloc(arena, 1, sizeof(*p->types));
+    assertm(!arena->err, "Expected: type table alloc to succeed, Received: %s", arena->err);
+  }
+
+  if (p->typedef_names == NULL) {
+    p->typedef_names = arena_calloc(arena, 1, sizeof(*p->typedef_names));
+    assertm(!arena->err, "Expected: typedef name table alloc to succeed, Received: %s", arena->err);
+  }
+
+  // scopes a failed parse leaves open are closed down to this
+  const size_t scope_depth = p->typedef_names->scope_depth;
+
+  advance(p);
+  ll1_push(arena, &p->symbols, LL1_START);
+
+  ast_node_t err = {0};
+
+  while (p->symbols.length > 0 && !has_err(err)) {
+    const uint8_t symbol = p->symbols.items[--p->symbols.length];
+
+    if (symbol < LL1_NONTERMINAL_BASE) {
+      if (terminal_of(p, symbol) != symbol) {
+        err = ll1_error(&p->token_at, unexpected_token_msg(p, "Unexpected %s instead of %s", symbol));
+        break;
+      }
+
+      p->matched = p->token;
+      p->matched_at = p->token_at;
+      p->matched_end = p->lexer;
+      advance(p);
+    } else if (symbol < LL1_ACTION_BASE) {
+      const size_t nonterminal = symbol - LL1_NONTERMINAL_BASE;
+      const size_t terminal = terminal_of(p, symbol);
+      ll1_production_t production = terminal == LL1_NO_TERMINAL ? LL1_NO_PRODUCTION : ll1_table[nonterminal][terminal];
+
+      // like parser2.c, a newline ends an expression instead of continuing it with an operator on the next line
+      if (production != LL1_NO_PRODUCTION && p->newline_before &&
+          (ll1_greedy[nonterminal][terminal / 8] & (1u << (terminal % 8)))) {
+        production = ll1_nullable_productions[nonterminal];
+      }
+
+      if (production == LL1_NO_PRODUCTION) {
+        err = ll1_error(&p->token_at, unexpected_token_msg(p, "Unexpected %s while parsing %s", symbol));
+        break;
+      }
+
+      const size_t rhs = ll1_productions[production].rhs;
+
+      for (size_t i = 0; i < ll1_productions[production].length; i++) {
+        ll1_push(arena, &p->symbols, ll1_rhs[rhs + i]);
+      }
+    } else {
+      const ll1_action_t *action = &ll1_actions[symbol - LL1_ACTION_BASE];
+      const char *msg = action->fn(p, action->arg);
+
+      if (msg) {
+        err = ll1_error(&p->matched_at, msg);
+      }
+    }
+  }
+
+  // the program list is the first value, whatever is above it are the parts of the failed statement
+  ast_node_t program = p->values.length > 0 ? p->values.items[0] : (ast_node_t){ .kind = AST_NODE_KIND_LIST };
+  check_program(program);
+
+  if (has_err(err)) {
+    while (p->typedef_names->scope_depth > scope_depth) {
+      typedef_names_close_scope(p->typedef_names);
+    }
+
+    if (program.children == NULL) {
+      program.children = arena_calloc(arena, 1, sizeof(*program.children));
+      assertm(!arena->err, "Expected: statement list alloc to succeed, Received: %s", arena->err);
+    }
+
+    add_node(arena, program.children, err);
+  }
+
+  return program;
+}
+
+ast_node_t ll1_parse(arena_t arena[const static 1], const char source[const static 1], const size_t source_length,
+                     const parser_opts_t opts[const static 1])
+{
+  const sv_t input = sv_from_buf(source, source_length);
+  ll1_parser_t p = {
+    .arena = arena,
+    .lexer = { .input = &input },
+  };
+
+  return ll1_run(&p, opts);
+}
+
+ast_node_t ll1_parse_stream(arena_t arena[const static 1], ll1_next_token_fn next_token, void *token_ctx,
+                            ll1_statement_fn on_statement, void *statement_ctx, const parser_opts_t opts[const static 1])
+{
+  ll1_parser_t p = {
+    .arena = arena,
+    .next_token = next_token,
+    .token_ctx = token_ctx,
+    .on_statement = on_statement,
+    .statement_ctx = statement_ctx,
+  };
+
+  return ll1_run(&p, opts);
+}
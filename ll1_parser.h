@@ -0,0 +1,49 @@
+#ifndef LL1_PARSER_H_
+#define LL1_PARSER_H_
+
+#include <stddef.h>
+
+#include "./parser2.h"
+
+#include "./zdx_simple_arena.h"
+
+/**
+ * Table-driven parser over the LL(1) tables ll1_gen.c generates from grammar.ll1. It builds the same
+ * tree as parse_with_opts() for the programs both accept, with an explicit parse stack instead of
+ * recursive descent and backtracking, so the grammar file is what to change to change the language.
+ *
+ * Differences to parser2.c:
+ * - a name that isn't a typedef name in scope is never a type, parser2.c takes one followed by another
+ *   word to be a typedef name of a header it didn't parse, e.g., size_t in size_t n;
+ * - a newline ends an expression where it could end, but doesn't fail one that can't, e.g., a =\n 1
+ * - function bodies are always parsed, opts.lazy_bodies and opts.hash_cons are ignored
+ *
+ * Only opts.types and opts.typedef_names are used, NULL uses a table local to the parse.
+ */
+ast_node_t ll1_parse(arena_t arena[const static 1], const char source[const static 1], const size_t source_length,
+                     const parser_opts_t opts[const static 1]);
+
+// a token as the parser reads it, with the WS and NEWLINE tokens before it skipped
+typedef struct {
+  token_t token;
+  lexer_t at; // right before the token, where errors about it point
+  lexer_t end; // right after the token
+  bool newline_before;
+} ll1_token_t;
+
+typedef void (*ll1_next_token_fn)(void *ctx, ll1_token_t token[const static 1]);
+typedef void (*ll1_statement_fn)(void *ctx, const ast_node_t statement);
+
+// reads the next token of lexer the way ll1_parse() does, for lexing on another thread than the parser's
+void ll1_lex(lexer_t lexer[const static 1], ll1_token_t token[const static 1]);
+
+/**
+ * Same as ll1_parse() but the tokens come from next_token instead of a lexer, which has to keep returning
+ * TOKEN_KIND_END once the input has ended. Each top level statement is handed to on_statement as soon as
+ * it's parsed instead of being added to the program, so the returned program only has the error node of
+ * a failed parse. The statement nodes are allocated in arena.
+ */
+ast_node_t ll1_parse_stream(arena_t arena[const static 1], ll1_next_token_fn next_token, void *token_ctx,
+                            ll1_statement_fn on_statement, void *statement_ctx, const parser_opts_t opts[const static 1]);
+
+#endif // LL1_PARSER_H_
@@ -1,3 +1,4 @@
+#include <stdint.h>
 #include <string.h>
 
 #include "./zdx_util.h"
@@ -15,6 +16,11 @@ const char *node_kind_name(const ast_node_kind_t kind)
     "AST_NODE_KIND_SYMBOL",
     "AST_NODE_KIND_UNARY_OP",
     "AST_NODE_KIND_BINARY_OP",
+    "AST_NODE_KIND_TERNARY",
+    "AST_NODE_KIND_CALL",
+    "AST_NODE_KIND_DECLARATION",
+    "AST_NODE_KIND_FUNCTION",
+    "AST_NODE_KIND_RETURN",
   };
 
   _Static_assert(zdx_arr_len(node_kind_to_str) == AST_NODE_KIND_COUNT,
@@ -25,7 +31,7 @@ const char *node_kind_name(const ast_node_kind_t kind)
   return node_kind_to_str[kind];
 }
 
-static const char *literal_kind_name(const literal_kind_t kind)
+const char *literal_kind_name(const literal_kind_t kind)
 {
   static const char *literal_kind_to_str[] = {
   "LITERAL_KIND_UNKNOWN",
@@ -42,7 +48,7 @@ _Static_assert(zdx_arr_len(literal_kind_to_str) == LITERAL_KIND_COUNT,
  return literal_kind_to_str[kind];
 }
 
-static const char *unary_kind_name(const unary_op_kind_t kind)
+const char *unary_kind_name(const unary_op_kind_t kind)
 {
   static const char *unary_kind_to_str[] = {
     "UNARY_OP_UNKNOWN",
@@ -51,6 +57,14 @@ static const char *unary_kind_name(const unary_op_kind_t kind)
     "UNARY_OP_NOT",
     "UNARY_OP_NEGATE",
     "UNARY_OP_POSITIVE",
+    "UNARY_OP_BIT_NOT",
+    "UNARY_OP_PRE_INC",
+    "UNARY_OP_PRE_DEC",
+    "UNARY_OP_POST_INC",
+    "UNARY_OP_POST_DEC",
+    "UNARY_OP_SIZEOF",
+    "UNARY_OP_ALIGNOF",
+    "UNARY_OP_CONVERT",
   };
 
   _Static_assert(zdx_arr_len(unary_kind_to_str) == UNARY_OP_COUNT,
@@ -61,7 +75,7 @@ static const char *unary_kind_name(const unary_op_kind_t kind)
   return unary_kind_to_str[kind];
 }
 
-static const char *binary_kind_name(const binary_op_kind_t kind)
+const char *binary_kind_name(const binary_op_kind_t kind)
 {
   static const char *binary_kind_to_str[] = {
     "BINARY_OP_UNKNOWN",
@@ -71,6 +85,34 @@ static const char *binary_kind_name(const binary_op_kind_t kind)
     "BINARY_OP_DIV",
     "BINARY_OP_ASSIGNMENT",
     "BINARY_OP_EXPO",
+    "BINARY_OP_MOD",
+    "BINARY_OP_LSHIFT",
+    "BINARY_OP_RSHIFT",
+    "BINARY_OP_LT",
+    "BINARY_OP_LTE",
+    "BINARY_OP_GT",
+    "BINARY_OP_GTE",
+    "BINARY_OP_EQ",
+    "BINARY_OP_NEQ",
+    "BINARY_OP_BIT_AND",
+    "BINARY_OP_BIT_XOR",
+    "BINARY_OP_BIT_OR",
+    "BINARY_OP_LOGICAL_AND",
+    "BINARY_OP_LOGICAL_OR",
+    "BINARY_OP_MULT_ASSIGNMENT",
+    "BINARY_OP_DIV_ASSIGNMENT",
+    "BINARY_OP_MOD_ASSIGNMENT",
+    "BINARY_OP_ADD_ASSIGNMENT",
+    "BINARY_OP_SUB_ASSIGNMENT",
+    "BINARY_OP_LSHIFT_ASSIGNMENT",
+    "BINARY_OP_RSHIFT_ASSIGNMENT",
+    "BINARY_OP_BIT_AND_ASSIGNMENT",
+    "BINARY_OP_BIT_XOR_ASSIGNMENT",
+    "BINARY_OP_BIT_OR_ASSIGNMENT",
+    "BINARY_OP_COMMA",
+    "BINARY_OP_INDEX",
+    "BINARY_OP_MEMBER",
+    "BINARY_OP_PTR_MEMBER",
   };
 
   _Static_assert(zdx_arr_len(binary_kind_to_str) == BINARY_OP_COUNT,
@@ -81,72 +123,79 @@ static const char *binary_kind_name(const binary_op_kind_t kind)
   return binary_kind_to_str[kind];
 }
 
-#define indent(depth) do {                      \
-    for (size_t i = 0; i < (depth); i++) {      \
-      fprintf(stderr, "   ");                   \
-    }                                           \
-  } while(0)
-
-void print_ast_(const ast_node_t node, size_t depth)
-{
-  indent(depth);
-  fprintf(stderr, "Node kind: %s\n", node_kind_name(node.kind));
-  indent(depth);
-  switch(node.kind) {
-    case AST_NODE_KIND_ERROR: {
-      fprintf(stderr, "message: %s\n", node.err.msg);
-      indent(depth);
-      fprintf(stderr, "line: %zu\n", node.err.line);
-      indent(depth);
-      fprintf(stderr, "cursor: %zu\n", node.err.cursor);
-      indent(depth);
-      fprintf(stderr, "bol: %zu\n", node.err.bol);
-    } break;
-
-    case AST_NODE_KIND_LITERAL: {
-      fprintf(stderr, "Literal kind: %s\n", literal_kind_name(node.literal.kind));
-      indent(depth);
-      fprintf(stderr, "Value: "SV_FMT"\n", sv_fmt_args(node.literal.value));
-    } break;
-
-    case AST_NODE_KIND_SYMBOL: {
-      fprintf(stderr, "Value: "SV_FMT"\n", sv_fmt_args(node.symbol.name));
-    } break;
+const char *symbol_binding_name(const symbol_binding_t binding)
+{
+  static const char *symbol_binding_to_str[] = {
+    "SYMBOL_BINDING_NONE",
+    "SYMBOL_BINDING_GLOBAL",
+    "SYMBOL_BINDING_LOCAL",
+    "SYMBOL_BINDING_EXTERN",
+    "SYMBOL_BINDING_MEMBER",
+    "SYMBOL_BINDING_UNDECLARED",
+  };
 
-    case AST_NODE_KIND_UNARY_OP: {
-      fprintf(stderr, "Op: %s\n", unary_kind_name(node.unary_op.kind));
-      indent(depth);
-      fprintf(stderr, "Expr:\n");
-      print_ast_(*node.unary_op.expr, depth + 1);
-    } break;
-
-    case AST_NODE_KIND_BINARY_OP: {
-      fprintf(stderr, "Op: %s\n", binary_kind_name(node.binary_op.kind));
-      indent(depth);
-      fprintf(stderr, "Left:\n");
-      print_ast_(*node.binary_op.lhs, depth + 1);
-      indent(depth);
-      fprintf(stderr, "Right:\n");
-      print_ast_(*node.binary_op.rhs, depth + 1);
-    } break;
-
-    case AST_NODE_KIND_LIST: {
-      if (node.children) {
-        fprintf(stderr, "Children: (length = %zu)\n", node.children->length);
-        for (size_t i = 0; i < node.children->length; i++) {
-          print_ast_(node.children->items[i], depth + 1);
-        }
-      } else {
-        fprintf(stderr, "Children: None\n");
-      }
-    } break;
+  _Static_assert(zdx_arr_len(symbol_binding_to_str) == SYMBOL_BINDING_COUNT,
+                 "Some symbol bindings are missing their corresponding strings in binding to string map");
+
+  assertm(binding < SYMBOL_BINDING_COUNT, "Invalid symbol binding %d", binding);
+
+  return symbol_binding_to_str[binding];
+}
+
+// ------------------------------------ CHILDREN ------------------------------------
+
+static inline size_t node_list_length(const ast_node_list_t *list)
+{
+  return list ? list->length : 0;
+}
+
+size_t ast_child_count(const ast_node_t node[const static 1])
+{
+  switch(node->kind) {
+    case AST_NODE_KIND_LIST: return node_list_length(node->children);
+    case AST_NODE_KIND_UNARY_OP: return 1;
+    case AST_NODE_KIND_BINARY_OP: return 2;
+    case AST_NODE_KIND_TERNARY: return 3;
+    case AST_NODE_KIND_CALL: return 1 + node_list_length(node->call.args);
+    case AST_NODE_KIND_DECLARATION: return node->declaration.init != NULL;
+    case AST_NODE_KIND_FUNCTION: return node_list_length(node->function->params) + node_list_length(node->function->body);
+    case AST_NODE_KIND_RETURN: return node->ret.expr != NULL;
+    default: return 0;
+  }
+}
 
-    default: assertm(false, "Missing case of ast node of kind %d", node.kind);
+ast_node_t *ast_child(const ast_node_t node[const static 1], const size_t i)
+{
+  assertm(i < ast_child_count(node), "Expected: child %zu of a %s node to exist", i, node_kind_name(node->kind));
+
+  switch(node->kind) {
+    case AST_NODE_KIND_LIST: return &node->children->items[i];
+    case AST_NODE_KIND_UNARY_OP: return node->unary_op.expr;
+    case AST_NODE_KIND_BINARY_OP: return i == 0 ? node->binary_op.lhs : node->binary_op.rhs;
+    case AST_NODE_KIND_TERNARY: return i == 0 ? node->ternary.cond : i == 1 ? node->ternary.then_expr : node->ternary.else_expr;
+    case AST_NODE_KIND_CALL: return i == 0 ? node->call.callee : &node->call.args->items[i - 1];
+    case AST_NODE_KIND_DECLARATION: return node->declaration.init;
+    case AST_NODE_KIND_FUNCTION: {
+      const size_t params = node_list_length(node->function->params);
+
+      return i < params ? &node->function->params->items[i] : &node->function->body->items[i - params];
+    }
+    case AST_NODE_KIND_RETURN: return node->ret.expr;
+    default: assertm(false, "Unexpected child of %s node", node_kind_name(node->kind));
   }
 
-  if (depth == 0) {
-    fprintf(stderr, "--------------------\n");
+  return NULL;
+}
+
+const ast_node_t *ast_ungroup(const ast_node_t node[const static 1])
+{
+  const ast_node_t *value = node;
+
+  while (value->kind == AST_NODE_KIND_LIST && node_list_length(value->children) > 0) {
+    value = &value->children->items[value->children->length - 1];
   }
+
+  return value;
 }
 
 
@@ -228,8 +277,276 @@ bool is_next(const lexer_t *const lexer, token_kind_t kind)
 
 // ------------------------------------ PARSERS ------------------------------------
 
+#ifdef PARSER_BENCH
+parser_stats_t parser_stats = {0};
+#endif
+
 // forward sub-parser declarations
-static ast_node_t parse_expr(arena_t arena[const static 1], lexer_t lexer[const static 1], size_t parser_choice);
+static ast_node_t parse_expr(arena_t arena[const static 1], lexer_t lexer[const static 1], size_t parser_choice, uint8_t min_precedence);
+static ast_node_t parse_sizeof_type(arena_t arena[const static 1], lexer_t lexer[const static 1], const unary_op_kind_t op);
+ast_node_t pratt_parse_binary_infix_op(arena_t arena[const static 1], lexer_t lexer[const static 1], uint8_t min_precedence, uint8_t parser_choice);
+
+// ------------------------------------ HASH-CONSING ------------------------------------
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  ast_node_t **items;
+} node_table_t;
+
+#define NODE_TABLE_MIN_CAP 256
+#define NODE_TABLE_MAX_LOAD(capacity) ((capacity) / 4 * 3)
+
+// set by parse_with_opts() for the duration of a parse with parser_opts_t.hash_cons
+static _Thread_local node_table_t *interned_nodes = NULL;
+// set by parse_with_opts() for the duration of a parse, for the type names sizeof and _Alignof can take, which
+// the expression parsers have no opts for
+static _Thread_local const parser_opts_t *parsing_opts = NULL;
+
+static inline bool is_assignment_op(const binary_op_kind_t kind)
+{
+  return kind == BINARY_OP_ASSIGNMENT || (kind >= BINARY_OP_MULT_ASSIGNMENT && kind <= BINARY_OP_BIT_OR_ASSIGNMENT);
+}
+
+// a node can be shared if evaluating it has no side effects, which is the case
+// when its op has none and all of its children are shared themselves
+static bool is_shareable(const ast_node_t node[const static 1])
+{
+  switch(node->kind) {
+    case AST_NODE_KIND_LITERAL:
+    case AST_NODE_KIND_SYMBOL: return true;
+    case AST_NODE_KIND_UNARY_OP: {
+      const unary_op_kind_t op = node->unary_op.kind;
+
+      return op != UNARY_OP_PRE_INC && op != UNARY_OP_PRE_DEC && op != UNARY_OP_POST_INC && op != UNARY_OP_POST_DEC &&
+        node->unary_op.expr->shared;
+    }
+    case AST_NODE_KIND_BINARY_OP: return !is_assignment_op(node->binary_op.kind) &&
+                                    node->binary_op.lhs->shared && node->binary_op.rhs->shared;
+    case AST_NODE_KIND_TERNARY: return node->ternary.cond->shared && node->ternary.then_expr->shared &&
+                                  node->ternary.else_expr->shared;
+    default: return false; // calls have side effects and lists, declarations and errors are never pointed to twice
+  }
+}
+
+static inline uint64_t hash_mix(uint64_t h, const uint64_t value)
+{
+  return (h ^ value) * 0x100000001b3ULL;
+}
+
+static inline uint64_t hash_sv(uint64_t h, const sv_t sv)
+{
+  for (size_t i = 0; i < sv.length; i++) {
+    h = hash_mix(h, (uint8_t)sv.buf[i]);
+  }
+
+  return h;
+}
+
+// children of a shareable node are interned already so their addresses are their ids
+static uint64_t node_hash(const ast_node_t node[const static 1])
+{
+  uint64_t h = hash_mix(0xcbf29ce484222325ULL, node->kind);
+
+  switch(node->kind) {
+    case AST_NODE_KIND_LITERAL: return hash_sv(hash_mix(h, node->literal.kind), node->literal.value);
+    case AST_NODE_KIND_SYMBOL: return hash_sv(h, node->symbol.name);
+    case AST_NODE_KIND_UNARY_OP: return hash_mix(hash_mix(h, node->unary_op.kind), (uintptr_t)node->unary_op.expr);
+    case AST_NODE_KIND_BINARY_OP: return hash_mix(hash_mix(hash_mix(h, node->binary_op.kind),
+                                                           (uintptr_t)node->binary_op.lhs),
+                                                  (uintptr_t)node->binary_op.rhs);
+    case AST_NODE_KIND_TERNARY: return hash_mix(hash_mix(hash_mix(h, (uintptr_t)node->ternary.cond),
+                                                         (uintptr_t)node->ternary.then_expr),
+                                                (uintptr_t)node->ternary.else_expr);
+    default: assertm(false, "Unexpected hash-consing of node of kind %s", node_kind_name(node->kind));
+  }
+
+  return h;
+}
+
+static bool node_eq(const ast_node_t a[const static 1], const ast_node_t b[const static 1])
+{
+  if (a->kind != b->kind) {
+    return false;
+  }
+
+  switch(a->kind) {
+    case AST_NODE_KIND_LITERAL: return a->literal.kind == b->literal.kind && sv_eq_sv(a->literal.value, b->literal.value);
+    case AST_NODE_KIND_SYMBOL: return sv_eq_sv(a->symbol.name, b->symbol.name);
+    case AST_NODE_KIND_UNARY_OP: return a->unary_op.kind == b->unary_op.kind && a->unary_op.expr == b->unary_op.expr;
+    case AST_NODE_KIND_BINARY_OP: return a->binary_op.kind == b->binary_op.kind &&
+                                    a->binary_op.lhs == b->binary_op.lhs && a->binary_op.rhs == b->binary_op.rhs;
+    case AST_NODE_KIND_TERNARY: return a->ternary.cond == b->ternary.cond && a->ternary.then_expr == b->ternary.then_expr &&
+                                  a->ternary.else_expr == b->ternary.else_expr;
+    default: return false;
+  }
+}
+
+static void node_table_grow(arena_t arena[const static 1], node_table_t table[const static 1])
+{
+  const size_t capacity = zdx_max(table->capacity * 2, NODE_TABLE_MIN_CAP);
+  ast_node_t **items = arena_calloc(arena, capacity, sizeof(*items));
+  assertm(!arena->err, "Expected: node table alloc to succeed, Received: %s", arena->err);
+
+  for (size_t i = 0; i < table->capacity; i++) {
+    if (table->items[i] == NULL) {
+      continue;
+    }
+
+    size_t slot = node_hash(table->items[i]) & (capacity - 1);
+
+    while (items[slot]) {
+      slot = (slot + 1) & (capacity - 1);
+    }
+
+    items[slot] = table->items[i];
+  }
+
+  table->items = items;
+  table->capacity = capacity;
+}
+
+static ast_node_t *intern_node(arena_t arena[const static 1], node_table_t table[const static 1], const ast_node_t node)
+{
+  if (table->length + 1 > NODE_TABLE_MAX_LOAD(table->capacity)) {
+    node_table_grow(arena, table);
+  }
+
+  size_t slot = node_hash(&node) & (table->capacity - 1);
+
+  while (table->items[slot]) {
+    if (node_eq(table->items[slot], &node)) {
+      return table->items[slot];
+    }
+
+    slot = (slot + 1) & (table->capacity - 1);
+  }
+
+  ast_node_t *p_node = arena_calloc(arena, 1, sizeof(*p_node));
+  assertm(!arena->err, "Expected: node alloc to succeed, Received: %s", arena->err);
+  memcpy(p_node, &node, sizeof(node));
+  p_node->shared = true;
+
+  table->items[slot] = p_node;
+  table->length++;
+
+  return p_node;
+}
+
+// moves a node built on the stack into the arena so that it can be pointed to by its parent
+static inline ast_node_t *new_node(arena_t arena[const static 1], const ast_node_t node)
+{
+  if (interned_nodes && is_shareable(&node)) {
+    return intern_node(arena, interned_nodes, node);
+  }
+
+  ast_node_t *p_node = arena_calloc(arena, 1, sizeof(*p_node));
+  assertm(!arena->err, "Expected: node alloc to succeed, Received: %s", arena->err);
+  memcpy(p_node, &node, sizeof(node));
+
+  return p_node;
+}
+
+// Binding powers of the C operators, lowest to highest. An operator continues the expression
+// on its left only if its left binding power is >= the min precedence it's parsed under. Its
+// right operand is then parsed with its right binding power as the min precedence, which is
+// one above the left for left associative ops and one below it for right associative ones.
+enum {
+  BP_NONE = 0,
+  BP_COMMA = 1,
+  BP_ASSIGNMENT = 4,
+  BP_TERNARY = 6,
+  BP_LOGICAL_OR = 7,
+  BP_LOGICAL_AND = 9,
+  BP_BIT_OR = 11,
+  BP_BIT_XOR = 13,
+  BP_BIT_AND = 15,
+  BP_EQUALITY = 17,
+  BP_RELATIONAL = 19,
+  BP_SHIFT = 21,
+  BP_ADDITIVE = 23,
+  BP_MULTIPLICATIVE = 25,
+  BP_PREFIX = 27,
+  BP_POSTFIX = 29,
+};
+
+// items in (a, b, c) are parsed above the comma operator as such lists are our call args
+#define BP_LIST_ITEM (BP_COMMA + 1)
+
+typedef enum {
+  OP_SHAPE_NONE, // token is not an infix or postfix operator
+  OP_SHAPE_BINARY,
+  OP_SHAPE_TERNARY,
+  OP_SHAPE_CALL,
+  OP_SHAPE_INDEX,
+  OP_SHAPE_MEMBER,
+  OP_SHAPE_POSTFIX,
+} op_shape_t;
+
+typedef enum {
+  ASSOC_LEFT,
+  ASSOC_RIGHT,
+} assoc_t;
+
+typedef struct {
+  uint8_t left;
+  uint8_t right;
+  uint8_t shape; // op_shape_t
+  uint8_t assoc; // assoc_t
+  uint8_t op; // binary_op_kind_t or unary_op_kind_t for OP_SHAPE_POSTFIX
+} binding_power_t;
+
+#define BP_LEFT_ASSOC(bp) .left = (bp), .right = (bp) + 1, .assoc = ASSOC_LEFT
+#define BP_RIGHT_ASSOC(bp) .left = (bp), .right = (bp) - 1, .assoc = ASSOC_RIGHT
+
+static const binding_power_t binding_powers[TOKEN_KIND_COUNT] = {
+  [TOKEN_KIND_COMMA]               = { BP_LEFT_ASSOC(BP_COMMA), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_COMMA },
+
+  [TOKEN_KIND_EQL]                 = { BP_RIGHT_ASSOC(BP_ASSIGNMENT), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_ASSIGNMENT },
+  [TOKEN_KIND_STAR_EQL]            = { BP_RIGHT_ASSOC(BP_ASSIGNMENT), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_MULT_ASSIGNMENT },
+  [TOKEN_KIND_FSLASH_EQL]          = { BP_RIGHT_ASSOC(BP_ASSIGNMENT), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_DIV_ASSIGNMENT },
+  [TOKEN_KIND_PERCENT_EQL]         = { BP_RIGHT_ASSOC(BP_ASSIGNMENT), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_MOD_ASSIGNMENT },
+  [TOKEN_KIND_PLUS_EQL]            = { BP_RIGHT_ASSOC(BP_ASSIGNMENT), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_ADD_ASSIGNMENT },
+  [TOKEN_KIND_MINUS_EQL]           = { BP_RIGHT_ASSOC(BP_ASSIGNMENT), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_SUB_ASSIGNMENT },
+  [TOKEN_KIND_LSHIFT_EQL]          = { BP_RIGHT_ASSOC(BP_ASSIGNMENT), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_LSHIFT_ASSIGNMENT },
+  [TOKEN_KIND_RSHIFT_EQL]          = { BP_RIGHT_ASSOC(BP_ASSIGNMENT), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_RSHIFT_ASSIGNMENT },
+  [TOKEN_KIND_AMPERSAND_EQL]       = { BP_RIGHT_ASSOC(BP_ASSIGNMENT), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_BIT_AND_ASSIGNMENT },
+  [TOKEN_KIND_CARET_EQL]           = { BP_RIGHT_ASSOC(BP_ASSIGNMENT), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_BIT_XOR_ASSIGNMENT },
+  [TOKEN_KIND_PIPE_EQL]            = { BP_RIGHT_ASSOC(BP_ASSIGNMENT), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_BIT_OR_ASSIGNMENT },
+
+  [TOKEN_KIND_QUESTION]            = { BP_RIGHT_ASSOC(BP_TERNARY), .shape = OP_SHAPE_TERNARY },
+
+  [TOKEN_KIND_PIPE_PIPE]           = { BP_LEFT_ASSOC(BP_LOGICAL_OR), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_LOGICAL_OR },
+  [TOKEN_KIND_AMPERSAND_AMPERSAND] = { BP_LEFT_ASSOC(BP_LOGICAL_AND), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_LOGICAL_AND },
+  [TOKEN_KIND_PIPE]                = { BP_LEFT_ASSOC(BP_BIT_OR), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_BIT_OR },
+  [TOKEN_KIND_CARET]               = { BP_LEFT_ASSOC(BP_BIT_XOR), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_BIT_XOR },
+  [TOKEN_KIND_AMPERSAND]           = { BP_LEFT_ASSOC(BP_BIT_AND), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_BIT_AND },
+
+  [TOKEN_KIND_EQL_EQL]             = { BP_LEFT_ASSOC(BP_EQUALITY), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_EQ },
+  [TOKEN_KIND_NOT_EQL]             = { BP_LEFT_ASSOC(BP_EQUALITY), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_NEQ },
+
+  [TOKEN_KIND_LT]                  = { BP_LEFT_ASSOC(BP_RELATIONAL), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_LT },
+  [TOKEN_KIND_LTE]                 = { BP_LEFT_ASSOC(BP_RELATIONAL), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_LTE },
+  [TOKEN_KIND_GT]                  = { BP_LEFT_ASSOC(BP_RELATIONAL), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_GT },
+  [TOKEN_KIND_GTE]                 = { BP_LEFT_ASSOC(BP_RELATIONAL), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_GTE },
+
+  [TOKEN_KIND_LSHIFT]              = { BP_LEFT_ASSOC(BP_SHIFT), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_LSHIFT },
+  [TOKEN_KIND_RSHIFT]              = { BP_LEFT_ASSOC(BP_SHIFT), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_RSHIFT },
+
+  [TOKEN_KIND_PLUS]                = { BP_LEFT_ASSOC(BP_ADDITIVE), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_ADD },
+  [TOKEN_KIND_MINUS]               = { BP_LEFT_ASSOC(BP_ADDITIVE), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_SUB },
+
+  [TOKEN_KIND_STAR]                = { BP_LEFT_ASSOC(BP_MULTIPLICATIVE), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_MULT },
+  [TOKEN_KIND_FSLASH]              = { BP_LEFT_ASSOC(BP_MULTIPLICATIVE), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_DIV },
+  [TOKEN_KIND_PERCENT]             = { BP_LEFT_ASSOC(BP_MULTIPLICATIVE), .shape = OP_SHAPE_BINARY, .op = BINARY_OP_MOD },
+
+  [TOKEN_KIND_OPAREN]              = { BP_LEFT_ASSOC(BP_POSTFIX), .shape = OP_SHAPE_CALL },
+  [TOKEN_KIND_OBRACKET]            = { BP_LEFT_ASSOC(BP_POSTFIX), .shape = OP_SHAPE_INDEX, .op = BINARY_OP_INDEX },
+  [TOKEN_KIND_DOT]                 = { BP_LEFT_ASSOC(BP_POSTFIX), .shape = OP_SHAPE_MEMBER, .op = BINARY_OP_MEMBER },
+  [TOKEN_KIND_ARROW]               = { BP_LEFT_ASSOC(BP_POSTFIX), .shape = OP_SHAPE_MEMBER, .op = BINARY_OP_PTR_MEMBER },
+  [TOKEN_KIND_PLUS_PLUS]           = { BP_LEFT_ASSOC(BP_POSTFIX), .shape = OP_SHAPE_POSTFIX, .op = UNARY_OP_POST_INC },
+  [TOKEN_KIND_MINUS_MINUS]         = { BP_LEFT_ASSOC(BP_POSTFIX), .shape = OP_SHAPE_POSTFIX, .op = UNARY_OP_POST_DEC },
+};
 
 static literal_kind_t get_literal_kind(const token_kind_t token_kind)
 {
@@ -243,6 +560,51 @@ static literal_kind_t get_literal_kind(const token_kind_t token_kind)
   }
 }
 
+// Converts the digits in place instead of copying them into a NUL terminated buffer for strtoull
+static bool integer_literal_value(const sv_t digits, uint64_t value[const static 1])
+{
+  uint64_t v = 0;
+
+  for (size_t i = 0; i < digits.length; i++) {
+    const uint64_t digit = (uint64_t)(digits.buf[i] - '0');
+
+    if (v > (UINT64_MAX - digit) / 10) {
+      return false;
+    }
+
+    v = v * 10 + digit;
+  }
+
+  *value = v;
+  return true;
+}
+
+ast_node_t new_literal(const lexer_t lexer[const static 1], const token_kind_t token_kind, const sv_t value)
+{
+  ast_node_t node = {
+    .kind = AST_NODE_KIND_LITERAL,
+    .literal = {
+      .kind = get_literal_kind(token_kind),
+      .value = value
+    },
+  };
+
+  if ((token_kind == TOKEN_KIND_SIGNED_INT || token_kind == TOKEN_KIND_UNSIGNED_INT) &&
+      !integer_literal_value(value, &node.literal.integer)) {
+    return (ast_node_t){
+      .kind = AST_NODE_KIND_ERROR,
+      .err = {
+        .msg = "Integer literal is too large",
+        .line = lexer->line,
+        .bol = lexer->bol,
+        .cursor = lexer->cursor - value.length,
+      }
+    };
+  }
+
+  return node;
+}
+
 static ast_node_t parse_literal(arena_t arena[const static 1], lexer_t lexer[const static 1])
 {
   token_kind_t literal_kinds[] = {
@@ -277,18 +639,7 @@ static ast_node_t parse_literal(arena_t arena[const static 1], lexer_t lexer[con
     };
   }
 
-  // TODO(mudit): should we parse the value here or instead of letting
-  // the intepreter do it since it knows better what kind of conversion
-  // of the literal is necessary based on context?
-  ast_node_t node = {
-    .kind = AST_NODE_KIND_LITERAL,
-    .literal = {
-      .kind = get_literal_kind(literal_kind),
-      .value = literal
-    },
-  };
-
-  return node;
+  return new_literal(lexer, literal_kind, literal);
 }
 
 static ast_node_t parse_symbol(arena_t arena[const static 1], lexer_t lexer[const static 1])
@@ -326,20 +677,57 @@ static inline unary_op_kind_t get_unary_op_kind(const token_kind_t token_kind)
     case TOKEN_KIND_MINUS: return UNARY_OP_NEGATE;
     case TOKEN_KIND_PLUS: return UNARY_OP_POSITIVE;
     case TOKEN_KIND_EXCLAMATION: return UNARY_OP_NOT;
+    case TOKEN_KIND_TILDE: return UNARY_OP_BIT_NOT;
+    case TOKEN_KIND_PLUS_PLUS: return UNARY_OP_PRE_INC;
+    case TOKEN_KIND_MINUS_MINUS: return UNARY_OP_PRE_DEC;
     default: return UNARY_OP_UNKNOWN;
   }
 }
 
+// sizeof unary | sizeof '(' type name ')' | _Alignof '(' type name ')'
+static ast_node_t parse_sizeof(arena_t arena[const static 1], lexer_t lexer[const static 1])
+{
+  const unary_op_kind_t op = get_next_token(lexer).kind == TOKEN_KIND_SIZEOF ? UNARY_OP_SIZEOF : UNARY_OP_ALIGNOF;
+  const ast_node_t node = parse_sizeof_type(arena, lexer, op);
+
+  if (node.kind != AST_NODE_KIND_UNKNOWN) {
+    return node;
+  }
+
+  zero_or_more(lexer, TOKEN_KIND_WS);
+
+  ast_node_t expr = parse_expr(arena, lexer, 0, BP_PREFIX);
+
+  if (has_err(expr)) {
+    return expr;
+  }
+
+  return (ast_node_t){
+    .kind = AST_NODE_KIND_UNARY_OP,
+    .unary_op = {
+      .kind = op,
+      .expr = new_node(arena, expr)
+    }
+  };
+}
+
 static ast_node_t parse_unary_op(arena_t arena[const static 1], lexer_t lexer[const static 1])
 {
+  if (is_next(lexer, TOKEN_KIND_SIZEOF) || is_next(lexer, TOKEN_KIND_ALIGNOF)) {
+    return parse_sizeof(arena, lexer);
+  }
+
   sv_t op = {0};
-  // TODO(mudit): add other unary ops here
+  // TODO(mudit): add casts here
   const token_kind_t unary_ops[] = {
     TOKEN_KIND_STAR,
     TOKEN_KIND_AMPERSAND,
     TOKEN_KIND_MINUS,
     TOKEN_KIND_PLUS,
     TOKEN_KIND_EXCLAMATION,
+    TOKEN_KIND_TILDE,
+    TOKEN_KIND_PLUS_PLUS,
+    TOKEN_KIND_MINUS_MINUS,
   };
   token_kind_t unary_op = {0};
   bool found_unary_op = false;
@@ -367,9 +755,9 @@ static ast_node_t parse_unary_op(arena_t arena[const static 1], lexer_t lexer[co
 
   zero_or_more(lexer, TOKEN_KIND_WS);
 
-  // only allowed exprs after a unary op are non-binary ops
-  // so we use 1 as the parser choice as that's after pratt_parse_binary_infix_op() in parse_expr()
-  ast_node_t expr = parse_expr(arena, lexer, 1);
+  // only binary ops are not allowed after a unary op but postfix ops are as they bind tighter
+  // for e.g., -a[1] is -(a[1]) and *p++ is *(p++)
+  ast_node_t expr = parse_expr(arena, lexer, 0, BP_PREFIX);
 
   if (has_err(expr)) {
     return expr;
@@ -379,10 +767,9 @@ static ast_node_t parse_unary_op(arena_t arena[const static 1], lexer_t lexer[co
     .kind = AST_NODE_KIND_UNARY_OP,
     .unary_op = {
       .kind = get_unary_op_kind(unary_op),
-      .expr = arena_calloc(arena, 1, sizeof(expr))
+      .expr = new_node(arena, expr)
     }
   };
-  memcpy(node.unary_op.expr, &expr, sizeof(expr));
 
   return node;
 }
@@ -408,7 +795,7 @@ static ast_node_t parse_parenthesized_expr(arena_t arena[const static 1], lexer_
   // this check is to parse () with no expr in it as parse_expr
   // doesn't have a case for parse_empty() or such (epsilon in the grammar)
   if (!is_next(lexer, TOKEN_KIND_CPAREN)) {
-    ast_node_t expr = parse_expr(arena, lexer, 0);
+    ast_node_t expr = parse_expr(arena, lexer, 0, BP_LIST_ITEM);
 
     while(!(has_err(expr))) {
       if (expr_list == NULL) {
@@ -427,7 +814,7 @@ static ast_node_t parse_parenthesized_expr(arena_t arena[const static 1], lexer_
 
       zero_or_more(lexer, TOKEN_KIND_WS);
 
-      expr = parse_expr(arena, lexer, 0);
+      expr = parse_expr(arena, lexer, 0, BP_LIST_ITEM);
     }
   }
 
@@ -451,32 +838,9 @@ static ast_node_t parse_parenthesized_expr(arena_t arena[const static 1], lexer_
   return node;
 }
 
-typedef struct {
-  size_t left;
-  size_t right;
-  const char *err;
-} precedence_t;
-
-
-static inline precedence_t get_infix_precedence(token_t op)
-{
-  if (op.kind == TOKEN_KIND_EQL) {
-    return (precedence_t){ .left = 2, .right = 1 }; // = is right associative
-  }
-  if (op.kind == TOKEN_KIND_PLUS || op.kind == TOKEN_KIND_MINUS) {
-    return (precedence_t){ .left = 3, .right = 4 };
-  }
-
-  if (op.kind == TOKEN_KIND_STAR || op.kind == TOKEN_KIND_FSLASH) {
-    return (precedence_t){ .left = 5, .right = 6 };
-  }
-
-  return (precedence_t){ .err = "No precedence value for op" };
-}
-
 ast_node_t pratt_parse_binary_infix_op(arena_t arena[const static 1], lexer_t lexer[const static 1], uint8_t min_precedence, uint8_t parser_choice)
 {
-  ast_node_t lhs = parse_expr(arena, lexer, parser_choice + 1);
+  ast_node_t lhs = parse_expr(arena, lexer, parser_choice + 1, BP_NONE);
 
   if (has_err(lhs)) {
     return lhs;
@@ -486,79 +850,176 @@ ast_node_t pratt_parse_binary_infix_op(arena_t arena[const static 1], lexer_t le
     zero_or_more(lexer, TOKEN_KIND_WS);
 
     token_t op = peek_next_token(lexer);
-    binary_op_kind_t binop_kind = {0};
+    const binding_power_t bp = binding_powers[op.kind];
 
-
-    if (op.kind == TOKEN_KIND_PLUS) {
-      binop_kind = BINARY_OP_ADD;
-    }
-    else if (op.kind == TOKEN_KIND_MINUS) {
-      binop_kind = BINARY_OP_SUB;
-    }
-    else if (op.kind == TOKEN_KIND_STAR) {
-      binop_kind = BINARY_OP_MULT;
-    }
-    else if (op.kind == TOKEN_KIND_FSLASH) {
-      binop_kind = BINARY_OP_DIV;
-    }
-    else if (op.kind == TOKEN_KIND_EQL) {
-      binop_kind = BINARY_OP_ASSIGNMENT;
-    }
-    else {
+    if (bp.shape == OP_SHAPE_NONE || bp.left < min_precedence) {
       break;
     }
 
-    precedence_t p = get_infix_precedence(op);
+    ast_node_t node = {0};
 
-    if (p.err) {
-      ast_node_t error = (ast_node_t){
-        .kind = AST_NODE_KIND_ERROR,
-        .err = {
-          .msg = (char *)p.err
+    switch(bp.shape) {
+      case OP_SHAPE_BINARY: {
+        get_next_token(lexer); // consume op
+        zero_or_more(lexer, TOKEN_KIND_WS);
+
+        // consume following exprs with greater precendence until same or
+        // lower precendence op is hit. Try it with a + b * c * d + e in
+        // your head
+        ast_node_t rhs = pratt_parse_binary_infix_op(arena, lexer, bp.right, parser_choice);
+
+        if (has_err(rhs)) {
+          return rhs;
         }
-      };
 
-      return error;
-    }
+        node = (ast_node_t){
+          .kind = AST_NODE_KIND_BINARY_OP,
+          .binary_op = {
+            .kind = bp.op,
+            .lhs = new_node(arena, lhs),
+            .rhs = new_node(arena, rhs)
+          }
+        };
+      } break;
 
-    if (p.left < min_precedence) {
-      break;
-    }
+      case OP_SHAPE_TERNARY: {
+        get_next_token(lexer); // consume ?
+        zero_or_more(lexer, TOKEN_KIND_WS);
 
-    get_next_token(lexer); // consume op
+        // anything, even a comma expr, can go between ? and :
+        ast_node_t then_expr = parse_expr(arena, lexer, 0, BP_NONE);
 
-    zero_or_more(lexer, TOKEN_KIND_WS);
+        if (has_err(then_expr)) {
+          return then_expr;
+        }
 
-    // consume following exprs with greater precendence until same or
-    // lower precendence op is hit. Try it with a + b * c * d + e in
-    // your head
-    ast_node_t rhs = pratt_parse_binary_infix_op(arena, lexer, p.right, parser_choice);
+        zero_or_more(lexer, TOKEN_KIND_WS);
+
+        if (!exactly_one(lexer, TOKEN_KIND_COLON, NULL)) {
+          return (ast_node_t){
+            .kind = AST_NODE_KIND_ERROR,
+            .err = {
+              .msg = "Unexpected character instead of ':' in ternary expression",
+              .line = lexer->line,
+              .bol = lexer->bol,
+              .cursor = lexer->cursor
+            }
+          };
+        }
 
-    if (has_err(rhs)) {
-      return rhs;
-    }
+        zero_or_more(lexer, TOKEN_KIND_WS);
 
-    ast_node_t *p_lhs = arena_calloc(arena, 1, sizeof(*p_lhs));
-    memcpy(p_lhs, &lhs, sizeof(lhs));
-    ast_node_t *p_rhs = arena_calloc(arena, 1, sizeof(*p_rhs));
-    memcpy(p_rhs, &rhs, sizeof(rhs));
+        ast_node_t else_expr = pratt_parse_binary_infix_op(arena, lexer, bp.right, parser_choice);
 
-    ast_node_t binop_node = {
-      .kind = AST_NODE_KIND_BINARY_OP,
-      .binary_op = {
-        .kind = binop_kind,
-        .lhs = p_lhs,
-        .rhs = p_rhs
-      }
-    };
+        if (has_err(else_expr)) {
+          return else_expr;
+        }
+
+        node = (ast_node_t){
+          .kind = AST_NODE_KIND_TERNARY,
+          .ternary = {
+            .cond = new_node(arena, lhs),
+            .then_expr = new_node(arena, then_expr),
+            .else_expr = new_node(arena, else_expr)
+          }
+        };
+      } break;
+
+      case OP_SHAPE_CALL: {
+        // args are parsed as a parenthesized expr list so the ( is left for it to consume
+        ast_node_t args = parse_parenthesized_expr(arena, lexer);
+
+        if (has_err(args)) {
+          return args;
+        }
+
+        node = (ast_node_t){
+          .kind = AST_NODE_KIND_CALL,
+          .call = {
+            .callee = new_node(arena, lhs),
+            .args = args.children
+          }
+        };
+      } break;
 
-    lhs = binop_node;
+      case OP_SHAPE_INDEX: {
+        get_next_token(lexer); // consume [
+        zero_or_more(lexer, TOKEN_KIND_WS);
+
+        ast_node_t index = parse_expr(arena, lexer, 0, BP_NONE);
+
+        if (has_err(index)) {
+          return index;
+        }
+
+        zero_or_more(lexer, TOKEN_KIND_WS);
+
+        if (!exactly_one(lexer, TOKEN_KIND_CBRACKET, NULL)) {
+          return (ast_node_t){
+            .kind = AST_NODE_KIND_ERROR,
+            .err = {
+              .msg = "Unexpected character instead of a closing bracket",
+              .line = lexer->line,
+              .bol = lexer->bol,
+              .cursor = lexer->cursor
+            }
+          };
+        }
+
+        node = (ast_node_t){
+          .kind = AST_NODE_KIND_BINARY_OP,
+          .binary_op = {
+            .kind = bp.op,
+            .lhs = new_node(arena, lhs),
+            .rhs = new_node(arena, index)
+          }
+        };
+      } break;
+
+      case OP_SHAPE_MEMBER: {
+        get_next_token(lexer); // consume . or ->
+        zero_or_more(lexer, TOKEN_KIND_WS);
+
+        ast_node_t member = parse_symbol(arena, lexer);
+
+        if (has_err(member)) {
+          return member;
+        }
+
+        node = (ast_node_t){
+          .kind = AST_NODE_KIND_BINARY_OP,
+          .binary_op = {
+            .kind = bp.op,
+            .lhs = new_node(arena, lhs),
+            .rhs = new_node(arena, member)
+          }
+        };
+      } break;
+
+      case OP_SHAPE_POSTFIX: {
+        get_next_token(lexer); // consume ++ or --
+
+        node = (ast_node_t){
+          .kind = AST_NODE_KIND_UNARY_OP,
+          .unary_op = {
+            .kind = bp.op,
+            .expr = new_node(arena, lhs)
+          }
+        };
+      } break;
+
+      default: assertm(false, "Unexpected op shape %d for token %s", bp.shape, token_kind_name(op.kind));
+    }
+
+    lhs = node;
   }
 
   return lhs;
 }
 
-static ast_node_t parse_expr(arena_t arena[const static 1], lexer_t lexer[const static 1], size_t parser_choice)
+// min_precedence is only used by the pratt parser (parser choice 0) and is
+// the binding power below which it stops consuming infix and postfix ops
+static ast_node_t parse_expr(arena_t arena[const static 1], lexer_t lexer[const static 1], size_t parser_choice, uint8_t min_precedence)
 {
   ast_node_t node = {0};
 
@@ -573,7 +1034,7 @@ static ast_node_t parse_expr(arena_t arena[const static 1], lexer_t lexer[const
   while(true) {
     switch(parser_choice) {
       case 0: {
-        node = pratt_parse_binary_infix_op(arena, lexer, 0, parser_choice); // lowest precendence of op is 0
+        node = pratt_parse_binary_infix_op(arena, lexer, min_precedence, parser_choice);
       } break;
       case 1: {
         node = parse_unary_op(arena, lexer);
@@ -611,6 +1072,7 @@ static ast_node_t parse_expr(arena_t arena[const static 1], lexer_t lexer[const
 
       reset_lexer(lexer, before);
       parser_choice++;
+      parser_stats_inc(expr_resets);
 
     }
     else {
@@ -621,95 +1083,1106 @@ static ast_node_t parse_expr(arena_t arena[const static 1], lexer_t lexer[const
   return node;
 }
 
-ast_node_t parse(arena_t arena[const static 1], const char source[const static 1], const size_t source_length)
-{
-  const sv_t input = sv_from_buf(source, source_length);
-  lexer_t lexer = {
-    .input = &input
-  };
+// ------------------------------------ ITERATIVE EXPRESSION PARSER ------------------------------------
+
+// Each frame is a pending call of the recursive parser above, i.e., an operator (or bracket)
+// that has been consumed and is waiting on the sub-expression to its right to be completed.
+// Keeping them in the arena instead of on the C stack lets nesting depth be bound by the
+// configured max depth instead of the stack size.
+typedef enum {
+  EXPR_FRAME_ROOT,
+  EXPR_FRAME_PREFIX, // waiting on the operand of a prefix unary op
+  EXPR_FRAME_BINARY, // lhs is on the operand stack, waiting on rhs
+  EXPR_FRAME_TERNARY_THEN, // cond is on the operand stack, waiting on then expr and :
+  EXPR_FRAME_TERNARY_ELSE, // cond and then expr are on the operand stack, waiting on else expr
+  EXPR_FRAME_INDEX, // base is on the operand stack, waiting on index expr and ]
+  EXPR_FRAME_LIST, // waiting on the next item or ) of a parenthesized list
+  EXPR_FRAME_CALL_ARGS, // same as EXPR_FRAME_LIST but the callee is on the operand stack
+} expr_frame_kind_t;
 
-  ast_node_t program = {
-    .kind = AST_NODE_KIND_LIST,
-  };
-  ast_node_list_t *statements = NULL;
+typedef struct {
+  uint8_t kind; // expr_frame_kind_t
+  uint8_t op; // unary_op_kind_t or binary_op_kind_t for prefix and binary frames
+  uint8_t min_precedence; // binding power the sub-expression this frame waits on is parsed with
+  ast_node_list_t *items; // list and call args frames
+} expr_frame_t;
 
-  size_t max_chars_consumed = 0;
-  char *error_msg = "Unexpected error while parsing";
-  size_t error_line = 0;
-  size_t error_bol = 0;
-  size_t error_cursor = 0;
+typedef struct {
+  size_t capacity;
+  size_t length;
+  expr_frame_t *items;
+} expr_frames_t;
 
-  lexer_t before = lexer;
-  uint8_t parser_choice = 0;
+#define EXPR_FRAMES_MIN_CAP 16
 
-  token_t token = peek_next_token(&lexer);
+static inline void push_expr_frame(arena_t arena[const static 1], expr_frames_t frames[const static 1], const expr_frame_t frame)
+{
+  if (frames->length == frames->capacity) {
+    const size_t capacity = zdx_max(frames->capacity * 2, EXPR_FRAMES_MIN_CAP);
 
-  while(token.kind != TOKEN_KIND_END) {
-    assertm(before.cursor <= lexer.cursor, "Expected: previous lexer cursor to be smaller than current, "
-            "Received: (previous = %zu, current = %zu)", before.cursor, lexer.cursor);
+    frames->items = arena_realloc(arena, frames->items, frames->capacity * sizeof(*frames->items), capacity * sizeof(*frames->items));
+    assertm(!arena->err, "Expected: expr frames resize to be successful, Received: %s", arena->err);
+    frames->capacity = capacity;
+  }
 
+  frames->items[frames->length++] = frame;
+}
 
-    if (token.kind == TOKEN_KIND_WS || token.kind == TOKEN_KIND_NEWLINE) {
-      get_next_token(&lexer); // consume WS or NEWLINE
-    }
-    else {
-      ast_node_t node = {0};
+static inline ast_node_t pop_operand(ast_node_list_t operands[const static 1])
+{
+  assertm(operands->length > 0, "Expected: operand stack to not be empty");
 
-      if (statements == NULL) {
-        // allocate only when we are sure to have at least one node in it (here it's the default case error node)
-        statements = arena_calloc(arena, 1, sizeof(*statements));
-        assertm(!arena->err, "Expected: statement list alloc to succeed, Received: %s", arena->err);
-        program.children = statements;
-      }
+  return operands->items[--operands->length];
+}
 
-      switch(parser_choice) {
-        case 0: {
-          node = parse_expr(arena, &lexer, 0);
-        } break;
-        default: {
-          add_node(arena, statements, (ast_node_t){
-              .kind = AST_NODE_KIND_ERROR,
-              .err = {
-                .msg = error_msg,
-                .line = error_line,
-                .bol = error_bol,
-                .cursor = error_cursor
-              }
-            });
-          return program;
-        } break;
-      }
+static inline ast_node_t error_node(const lexer_t lexer[const static 1], char *msg)
+{
+  return (ast_node_t){
+    .kind = AST_NODE_KIND_ERROR,
+    .err = {
+      .msg = msg,
+      .line = lexer->line,
+      .bol = lexer->bol,
+      .cursor = lexer->cursor
+    }
+  };
+}
 
-      if (has_err(node)) {
-        size_t chars_consumed = lexer.cursor - before.cursor;
-
-        // choose error from the node that was returned by the
-        // sub-parser that consumed the most of the source input
-        if (chars_consumed >= max_chars_consumed) {
-          max_chars_consumed = chars_consumed;
-          error_msg = node.err.msg;
-          error_line = node.err.line;
-          error_bol = node.err.bol;
-          error_cursor = node.err.cursor;
-        }
+// What one step of a parse loop allocates at most, leaving out the lists growing with the input that the loop
+// passes in. The loops keep two of them free, so an out of memory error can still be added to the statements
+#define PARSE_STEP_BYTES (64 KB)
+#define list_growth_bytes(list) (zdx_max((list)->capacity, EXPR_FRAMES_MIN_CAP) * 2 * sizeof(*(list)->items))
 
-        reset_lexer(&lexer, before);
-        parser_choice++;
-      }
-      else {
-        add_node(arena, statements, node);
-        node = (ast_node_t){0};
-        before = lexer;
-        parser_choice = 0;
-      }
-    }
+// A parse that would run the arena out of memory ends with an error node instead of failing an allocation
+static bool has_room(const arena_t arena[const static 1], const size_t list_bytes)
+{
+  const size_t table_bytes = interned_nodes
+    ? zdx_max(interned_nodes->capacity, NODE_TABLE_MIN_CAP) * 2 * sizeof(*interned_nodes->items)
+    : 0;
+
+  return arena->offset <= arena->size && arena->size - arena->offset >= 2 * PARSE_STEP_BYTES + list_bytes + table_bytes;
+}
 
-    token = peek_next_token(&lexer);
+// makes sure count more nodes fit in the list without resizing it
+static inline void reserve_nodes(arena_t arena[const static 1], ast_node_list_t list[const static 1], const size_t count)
+{
+  for (size_t i = 0; i < count; i++) {
+    add_node(arena, list, (ast_node_t){0});
   }
 
-  token = get_next_token(&lexer);
-  assertm(token.kind == TOKEN_KIND_END, "Expected: TOKEN_KIND_END, Received: %s (%d)",
-          token_kind_name(token.kind), token.kind);
+  list->length -= count;
+}
 
-  return program;
+// consumes the ) of a parenthesized list or call args and pushes the resulting node
+static inline void close_expr_list(arena_t arena[const static 1], lexer_t lexer[const static 1],
+                                   expr_frames_t frames[const static 1], ast_node_list_t operands[const static 1])
+{
+  const expr_frame_t frame = frames->items[--frames->length];
+  get_next_token(lexer); // consume )
+
+  if (frame.kind == EXPR_FRAME_CALL_ARGS) {
+    ast_node_t callee = pop_operand(operands);
+
+    add_node(arena, operands, (ast_node_t){
+        .kind = AST_NODE_KIND_CALL,
+        .call = {
+          .callee = new_node(arena, callee),
+          .args = frame.items
+        }
+      });
+  } else {
+    add_node(arena, operands, (ast_node_t){
+        .kind = AST_NODE_KIND_LIST,
+        .children = frame.items
+      });
+  }
+}
+
+// Produces the same AST as parse_expr(arena, lexer, 0, min_precedence) but never recurses
+static ast_node_t parse_expr_iterative(arena_t arena[const static 1], lexer_t lexer[const static 1],
+                                              const uint8_t min_precedence, const size_t max_depth)
+{
+  expr_frames_t frames = {0};
+  ast_node_list_t operands = {0};
+  bool expect_operand = true;
+
+  push_expr_frame(arena, &frames, (expr_frame_t){ .kind = EXPR_FRAME_ROOT, .min_precedence = min_precedence });
+
+  for(;;) {
+    if (frames.length > max_depth) {
+      return error_node(lexer, "Expression is nested deeper than the max expression depth");
+    }
+
+    // a step pushes at most one frame, one operand and one item of the top frame
+    const expr_frame_t *last = &frames.items[frames.length - 1];
+    const size_t list_bytes = list_growth_bytes(&frames) + list_growth_bytes(&operands) +
+      (last->items ? list_growth_bytes(last->items) : 0);
+
+    if (!has_room(arena, list_bytes)) {
+      return error_node(lexer, "Ran out of memory while parsing the expression");
+    }
+
+    zero_or_more(lexer, TOKEN_KIND_WS);
+
+    const token_t tok = peek_next_token(lexer);
+
+    // ---- prefix position ----
+    if (expect_operand) {
+      switch(tok.kind) {
+        case TOKEN_KIND_STAR:
+        case TOKEN_KIND_AMPERSAND:
+        case TOKEN_KIND_MINUS:
+        case TOKEN_KIND_PLUS:
+        case TOKEN_KIND_EXCLAMATION:
+        case TOKEN_KIND_TILDE:
+        case TOKEN_KIND_PLUS_PLUS:
+        case TOKEN_KIND_MINUS_MINUS: {
+          get_next_token(lexer);
+          push_expr_frame(arena, &frames, (expr_frame_t){
+              .kind = EXPR_FRAME_PREFIX,
+              .op = get_unary_op_kind(tok.kind),
+              .min_precedence = BP_PREFIX
+            });
+        } break;
+
+        // an operand that isn't a type name is parsed like the operand of any other prefix op
+        case TOKEN_KIND_SIZEOF:
+        case TOKEN_KIND_ALIGNOF: {
+          get_next_token(lexer);
+
+          const unary_op_kind_t op = tok.kind == TOKEN_KIND_SIZEOF ? UNARY_OP_SIZEOF : UNARY_OP_ALIGNOF;
+          const ast_node_t node = parse_sizeof_type(arena, lexer, op);
+
+          if (has_err(node)) {
+            return node;
+          }
+
+          if (node.kind == AST_NODE_KIND_UNKNOWN) {
+            push_expr_frame(arena, &frames, (expr_frame_t){ .kind = EXPR_FRAME_PREFIX, .op = op, .min_precedence = BP_PREFIX });
+          } else {
+            add_node(arena, &operands, node);
+            expect_operand = false;
+          }
+        } break;
+
+        case TOKEN_KIND_OPAREN: {
+          get_next_token(lexer);
+          zero_or_more(lexer, TOKEN_KIND_WS);
+
+          if (is_next(lexer, TOKEN_KIND_CPAREN)) {
+            get_next_token(lexer);
+            add_node(arena, &operands, (ast_node_t){ .kind = AST_NODE_KIND_LIST });
+            expect_operand = false;
+          } else {
+            push_expr_frame(arena, &frames, (expr_frame_t){ .kind = EXPR_FRAME_LIST, .min_precedence = BP_LIST_ITEM });
+          }
+        } break;
+
+        case TOKEN_KIND_SYMBOL: {
+          get_next_token(lexer);
+          add_node(arena, &operands, (ast_node_t){
+              .kind = AST_NODE_KIND_SYMBOL,
+              .symbol = {
+                .name = tok.value
+              }
+            });
+          expect_operand = false;
+        } break;
+
+        case TOKEN_KIND_SIGNED_INT:
+        case TOKEN_KIND_UNSIGNED_INT:
+        case TOKEN_KIND_FLOAT:
+        case TOKEN_KIND_DOUBLE:
+        case TOKEN_KIND_STRING: {
+          get_next_token(lexer);
+
+          const ast_node_t literal = new_literal(lexer, tok.kind, tok.value);
+
+          if (has_err(literal)) {
+            return literal;
+          }
+
+          add_node(arena, &operands, literal);
+          expect_operand = false;
+        } break;
+
+        case TOKEN_KIND_CPAREN: {
+          const expr_frame_t *top = &frames.items[frames.length - 1];
+
+          // a trailing comma as in (a, b,) is allowed by parse_parenthesized_expr()
+          if ((top->kind == EXPR_FRAME_LIST || top->kind == EXPR_FRAME_CALL_ARGS) && top->items) {
+            close_expr_list(arena, lexer, &frames, &operands);
+            expect_operand = false;
+            break;
+          }
+
+          return error_node(lexer, "Unexpected character while parsing literal");
+        }
+
+        default: return error_node(lexer, "Unexpected character while parsing literal");
+      }
+
+      continue;
+    }
+
+    // ---- infix/postfix position ----
+    const binding_power_t bp = binding_powers[tok.kind];
+    expr_frame_t *top = &frames.items[frames.length - 1];
+
+    if (bp.shape != OP_SHAPE_NONE && bp.left >= top->min_precedence) {
+      switch(bp.shape) {
+        case OP_SHAPE_BINARY: {
+          get_next_token(lexer);
+          push_expr_frame(arena, &frames, (expr_frame_t){ .kind = EXPR_FRAME_BINARY, .op = bp.op, .min_precedence = bp.right });
+          expect_operand = true;
+        } break;
+
+        case OP_SHAPE_TERNARY: {
+          get_next_token(lexer);
+          push_expr_frame(arena, &frames, (expr_frame_t){ .kind = EXPR_FRAME_TERNARY_THEN, .min_precedence = BP_NONE });
+          expect_operand = true;
+        } break;
+
+        case OP_SHAPE_INDEX: {
+          get_next_token(lexer);
+          push_expr_frame(arena, &frames, (expr_frame_t){ .kind = EXPR_FRAME_INDEX, .min_precedence = BP_NONE });
+          expect_operand = true;
+        } break;
+
+        case OP_SHAPE_CALL: {
+          get_next_token(lexer);
+          zero_or_more(lexer, TOKEN_KIND_WS);
+
+          if (is_next(lexer, TOKEN_KIND_CPAREN)) {
+            push_expr_frame(arena, &frames, (expr_frame_t){ .kind = EXPR_FRAME_CALL_ARGS });
+            close_expr_list(arena, lexer, &frames, &operands);
+          } else {
+            push_expr_frame(arena, &frames, (expr_frame_t){ .kind = EXPR_FRAME_CALL_ARGS, .min_precedence = BP_LIST_ITEM });
+            expect_operand = true;
+          }
+        } break;
+
+        case OP_SHAPE_MEMBER: {
+          get_next_token(lexer);
+          zero_or_more(lexer, TOKEN_KIND_WS);
+
+          sv_t member = {0};
+
+          if (!exactly_one(lexer, TOKEN_KIND_SYMBOL, &member)) {
+            return error_node(lexer, "Unexpected character instead of valid symbol");
+          }
+
+          ast_node_t base = pop_operand(&operands);
+          add_node(arena, &operands, (ast_node_t){
+              .kind = AST_NODE_KIND_BINARY_OP,
+              .binary_op = {
+                .kind = bp.op,
+                .lhs = new_node(arena, base),
+                .rhs = new_node(arena, (ast_node_t){ .kind = AST_NODE_KIND_SYMBOL, .symbol = { .name = member } })
+              }
+            });
+        } break;
+
+        case OP_SHAPE_POSTFIX: {
+          get_next_token(lexer);
+
+          ast_node_t operand = pop_operand(&operands);
+          add_node(arena, &operands, (ast_node_t){
+              .kind = AST_NODE_KIND_UNARY_OP,
+              .unary_op = {
+                .kind = bp.op,
+                .expr = new_node(arena, operand)
+              }
+            });
+        } break;
+
+        default: assertm(false, "Unexpected op shape %d for token %s", bp.shape, token_kind_name(tok.kind));
+      }
+
+      continue;
+    }
+
+    // the token doesn't continue the sub-expression the top frame is waiting on so that
+    // sub-expression is complete and the frame can be reduced into a node
+    switch(top->kind) {
+      case EXPR_FRAME_ROOT: {
+        assertm(operands.length == 1, "Expected: exactly one operand at the end of an expr, Received: %zu", operands.length);
+        return operands.items[0];
+      }
+
+      case EXPR_FRAME_PREFIX: {
+        const unary_op_kind_t op = top->op;
+        ast_node_t operand = pop_operand(&operands);
+        frames.length--;
+
+        add_node(arena, &operands, (ast_node_t){
+            .kind = AST_NODE_KIND_UNARY_OP,
+            .unary_op = {
+              .kind = op,
+              .expr = new_node(arena, operand)
+            }
+          });
+      } break;
+
+      case EXPR_FRAME_BINARY: {
+        const binary_op_kind_t op = top->op;
+        ast_node_t rhs = pop_operand(&operands);
+        ast_node_t lhs = pop_operand(&operands);
+        frames.length--;
+
+        add_node(arena, &operands, (ast_node_t){
+            .kind = AST_NODE_KIND_BINARY_OP,
+            .binary_op = {
+              .kind = op,
+              .lhs = new_node(arena, lhs),
+              .rhs = new_node(arena, rhs)
+            }
+          });
+      } break;
+
+      case EXPR_FRAME_TERNARY_THEN: {
+        if (tok.kind != TOKEN_KIND_COLON) {
+          return error_node(lexer, "Unexpected character instead of ':' in ternary expression");
+        }
+
+        get_next_token(lexer);
+        top->kind = EXPR_FRAME_TERNARY_ELSE;
+        top->min_precedence = binding_powers[TOKEN_KIND_QUESTION].right;
+        expect_operand = true;
+      } break;
+
+      case EXPR_FRAME_TERNARY_ELSE: {
+        ast_node_t else_expr = pop_operand(&operands);
+        ast_node_t then_expr = pop_operand(&operands);
+        ast_node_t cond = pop_operand(&operands);
+        frames.length--;
+
+        add_node(arena, &operands, (ast_node_t){
+            .kind = AST_NODE_KIND_TERNARY,
+            .ternary = {
+              .cond = new_node(arena, cond),
+              .then_expr = new_node(arena, then_expr),
+              .else_expr = new_node(arena, else_expr)
+            }
+          });
+      } break;
+
+      case EXPR_FRAME_INDEX: {
+        if (tok.kind != TOKEN_KIND_CBRACKET) {
+          return error_node(lexer, "Unexpected character instead of a closing bracket");
+        }
+
+        get_next_token(lexer);
+
+        ast_node_t index = pop_operand(&operands);
+        ast_node_t base = pop_operand(&operands);
+        frames.length--;
+
+        add_node(arena, &operands, (ast_node_t){
+            .kind = AST_NODE_KIND_BINARY_OP,
+            .binary_op = {
+              .kind = BINARY_OP_INDEX,
+              .lhs = new_node(arena, base),
+              .rhs = new_node(arena, index)
+            }
+          });
+      } break;
+
+      case EXPR_FRAME_LIST:
+      case EXPR_FRAME_CALL_ARGS: {
+        if (top->items == NULL) {
+          // allocated only if we have at least one expr
+          top->items = arena_calloc(arena, 1, sizeof(*top->items));
+          assertm(!arena->err, "Expected: expr list alloc to succeed, Received: %s", arena->err);
+        }
+
+        ast_node_t item = pop_operand(&operands);
+        add_node(arena, top->items, item);
+
+        if (tok.kind == TOKEN_KIND_CPAREN) {
+          close_expr_list(arena, lexer, &frames, &operands);
+        } else if (one_or_more(lexer, TOKEN_KIND_COMMA)) {
+          expect_operand = true;
+        } else {
+          return error_node(lexer, "Unexpected character instead of an closing paren");
+        }
+      } break;
+
+      default: assertm(false, "Unexpected expr frame kind %d", top->kind);
+    }
+  }
+}
+
+// ------------------------------------ DECLARATIONS ------------------------------------
+
+static ast_node_t parse_expr_with_opts(arena_t arena[const static 1], lexer_t lexer[const static 1],
+                                       const parser_opts_t opts[const static 1], const uint8_t min_precedence)
+{
+  return opts->recursive_exprs
+    ? parse_expr(arena, lexer, 0, min_precedence)
+    : parse_expr_iterative(arena, lexer, min_precedence, opts->max_expr_depth);
+}
+
+// A symbol is a type specifier if it's a builtin one like int or a typedef name before any other type specifier,
+// in int T, T is the declared name even if it's a typedef name. A name that isn't known as a typedef name is
+// taken to be one of a header that wasn't parsed if what follows can only be a declarator. A '*' only follows
+// such a name inside a declaration, e.g., a param, as at the start of a statement it's a multiplication
+static bool is_type_specifier(const lexer_t lexer[const static 1], const parser_opts_t opts[const static 1],
+                              const sv_t word, const uint16_t specifiers, const bool in_declaration)
+{
+  if (type_specifier_is_keyword(word)) {
+    return true;
+  }
+
+  if (specifiers) {
+    return false;
+  }
+
+  if (typedef_names_is_type(opts->typedef_names, word)) {
+    return true;
+  }
+
+  lexer_t after = *lexer;
+  zero_or_more(&after, TOKEN_KIND_WS);
+  const token_kind_t next = peek_next_token(&after).kind;
+
+  return next == TOKEN_KIND_SYMBOL || next == TOKEN_KIND_QUALIFIER || next == TOKEN_KIND_STORAGE ||
+    (in_declaration && next == TOKEN_KIND_STAR);
+}
+
+// declarator := (storage class | typedef | qualifier | type specifier)+ ('*' qualifier*)* name
+// returns a declaration node without an initializer or an error node. An abstract declarator, the type name
+// of section 6.7.7, has no name and no storage class, its name is left empty where the name would be
+static ast_node_t parse_declarator(arena_t arena[const static 1], lexer_t lexer[const static 1],
+                                   const parser_opts_t opts[const static 1], const bool abstract)
+{
+  uint8_t storage = 0;
+  uint8_t qualifiers = 0;
+  uint16_t specifiers = 0;
+  sv_t type_name = {0};
+  sv_t name = {0};
+  bool in_specifiers = true;
+
+  while (in_specifiers) {
+    zero_or_more(lexer, TOKEN_KIND_WS);
+
+    const lexer_t at = *lexer;
+    const token_t tok = peek_next_token(lexer);
+
+    switch(tok.kind) {
+      case TOKEN_KIND_STORAGE: {
+        const uint8_t storage_class = storage_class_from_sv(tok.value);
+
+        if (storage & storage_class) {
+          return error_node(&at, "Duplicate storage class specifier");
+        }
+
+        storage |= storage_class;
+        get_next_token(lexer);
+      } break;
+
+      case TOKEN_KIND_TYPEDEF: {
+        if (storage & STORAGE_CLASS_TYPEDEF) {
+          return error_node(&at, "Duplicate storage class specifier");
+        }
+
+        storage |= STORAGE_CLASS_TYPEDEF;
+        get_next_token(lexer);
+      } break;
+
+      case TOKEN_KIND_QUALIFIER: {
+        qualifiers |= type_qualifier_from_sv(tok.value); // repeating a qualifier is allowed by section 6.7.3
+        get_next_token(lexer);
+      } break;
+
+      case TOKEN_KIND_SYMBOL: {
+        get_next_token(lexer);
+
+        if (!is_type_specifier(lexer, opts, tok.value, specifiers, true)) {
+          if (abstract) {
+            return error_node(&at, "Unexpected name in a type name");
+          }
+
+          name = tok.value;
+          in_specifiers = false;
+          break;
+        }
+
+        const char *err = type_specifiers_add(&specifiers, tok.value);
+
+        if (err) {
+          return error_node(&at, (char *)err);
+        }
+
+        if ((specifiers & TYPE_SPEC_NAMED) && sv_is_empty(type_name)) {
+          type_name = tok.value;
+        }
+      } break;
+
+      case TOKEN_KIND_STAR: {
+        in_specifiers = false;
+      } break;
+
+      default: {
+        if (!abstract) {
+          return error_node(lexer, "Unexpected character in declaration specifiers");
+        }
+
+        in_specifiers = false;
+      } break;
+    }
+  }
+
+  if (abstract && storage) {
+    return error_node(lexer, "A type name can't have a storage class");
+  }
+
+  const char *err = type_specifiers_normalize(&specifiers);
+
+  if (err) {
+    return error_node(lexer, (char *)err);
+  }
+
+  const type_t *type = type_intern(arena, opts->types, (type_t){
+      .kind = TYPE_KIND_BASE,
+      .qualifiers = qualifiers,
+      .specifiers = specifiers,
+      .name = type_name,
+      .aliased = sv_is_empty(type_name) ? NULL : typedef_names_type(opts->typedef_names, type_name),
+    });
+
+  // pointer declarators
+  while (sv_is_empty(name)) {
+    const lexer_t end = *lexer;
+    zero_or_more(lexer, TOKEN_KIND_WS);
+
+    if (!exactly_one(lexer, TOKEN_KIND_STAR, NULL)) {
+      if (abstract) {
+        name = sv_from_buf(&end.input->buf[end.cursor], 0);
+        break;
+      }
+
+      if (!exactly_one(lexer, TOKEN_KIND_SYMBOL, &name)) {
+        return error_node(lexer, "Unexpected character instead of the declared name");
+      }
+
+      break;
+    }
+
+    uint8_t pointer_qualifiers = 0;
+    zero_or_more(lexer, TOKEN_KIND_WS);
+
+    for (token_t tok = peek_next_token(lexer); tok.kind == TOKEN_KIND_QUALIFIER; tok = peek_next_token(lexer)) {
+      pointer_qualifiers |= type_qualifier_from_sv(tok.value);
+      get_next_token(lexer);
+      zero_or_more(lexer, TOKEN_KIND_WS);
+    }
+
+    type = type_intern(arena, opts->types, (type_t){
+        .kind = TYPE_KIND_POINTER,
+        .qualifiers = pointer_qualifiers,
+        .pointee = type,
+      });
+  }
+
+  if (storage) {
+    type_t outermost = *type;
+    outermost.storage = storage;
+    type = type_intern(arena, opts->types, outermost);
+  }
+
+  return (ast_node_t){
+    .kind = AST_NODE_KIND_DECLARATION,
+    .declaration = {
+      .type = type,
+      .name = name,
+    }
+  };
+}
+
+// a type name starts with a qualifier or a type specifier, e.g., sizeof (T) takes a type name if T is a typedef
+// name in scope and an expression otherwise
+static bool starts_type_name(const lexer_t lexer[const static 1], const parser_opts_t opts[const static 1])
+{
+  lexer_t at = *lexer;
+  zero_or_more(&at, TOKEN_KIND_WS);
+  const token_t tok = peek_next_token(&at);
+
+  return tok.kind == TOKEN_KIND_QUALIFIER || (tok.kind == TOKEN_KIND_SYMBOL &&
+    (type_specifier_is_keyword(tok.value) || typedef_names_is_type(opts->typedef_names, tok.value)));
+}
+
+// '(' type name ')' after sizeof or _Alignof, the lexer is expected to be right after the keyword. Returns the
+// unary op node or an error, or a node of kind AST_NODE_KIND_UNKNOWN without moving the lexer if the operand
+// of sizeof is an expression instead, which the expression parser is left to parse
+static ast_node_t parse_sizeof_type(arena_t arena[const static 1], lexer_t lexer[const static 1], const unary_op_kind_t op)
+{
+  assertm(parsing_opts, "Expected: sizeof to be parsed by parse_with_opts() or parse_function_body()");
+
+  lexer_t after_paren = *lexer;
+  zero_or_more(&after_paren, TOKEN_KIND_WS);
+
+  if (!exactly_one(&after_paren, TOKEN_KIND_OPAREN, NULL) || !starts_type_name(&after_paren, parsing_opts)) {
+    return op == UNARY_OP_SIZEOF ? (ast_node_t){0} : error_node(lexer, "Expected a type name in parens after _Alignof");
+  }
+
+  *lexer = after_paren;
+  const ast_node_t type_name = parse_declarator(arena, lexer, parsing_opts, true);
+
+  if (has_err(type_name)) {
+    return type_name;
+  }
+
+  zero_or_more(lexer, TOKEN_KIND_WS);
+
+  if (!exactly_one(lexer, TOKEN_KIND_CPAREN, NULL)) {
+    return error_node(lexer, "Unexpected character instead of a closing paren after the type name");
+  }
+
+  return (ast_node_t){
+    .kind = AST_NODE_KIND_UNARY_OP,
+    .unary_op = {
+      .kind = op,
+      .expr = new_node(arena, type_name)
+    }
+  };
+}
+
+static ast_node_t parse_statements(arena_t arena[const static 1], lexer_t lexer[const static 1],
+                                   const parser_opts_t opts[const static 1], const token_kind_t terminator);
+
+// params := '(' ('void' | declarator (',' declarator)*)? ')', the lexer is expected to be right before the '('
+static ast_node_t parse_params(arena_t arena[const static 1], lexer_t lexer[const static 1],
+                               const parser_opts_t opts[const static 1], ast_node_list_t *params[const static 1])
+{
+  *params = NULL;
+  exactly_one(lexer, TOKEN_KIND_OPAREN, NULL);
+  zero_or_more(lexer, TOKEN_KIND_WS);
+
+  {
+    lexer_t after_void = *lexer;
+    sv_t word = {0};
+
+    if (exactly_one(&after_void, TOKEN_KIND_SYMBOL, &word) && sv_eq_cstr(word, "void") &&
+        zero_or_more(&after_void, TOKEN_KIND_WS) && is_next(&after_void, TOKEN_KIND_CPAREN)) {
+      *lexer = after_void;
+    }
+  }
+
+  while (!exactly_one(lexer, TOKEN_KIND_CPAREN, NULL)) {
+    if (*params && !exactly_one(lexer, TOKEN_KIND_COMMA, NULL)) {
+      return error_node(lexer, "Expected , or ) after a parameter");
+    }
+
+    if (!has_room(arena, *params ? list_growth_bytes(*params) : 0)) {
+      return error_node(lexer, "Ran out of memory while parsing the parameters");
+    }
+
+    const ast_node_t param = parse_declarator(arena, lexer, opts, false);
+
+    if (has_err(param)) {
+      return param;
+    }
+
+    if (*params == NULL) {
+      *params = arena_calloc(arena, 1, sizeof(**params));
+      assertm(!arena->err, "Expected: parameter list alloc to succeed, Received: %s", arena->err);
+    }
+
+    add_node(arena, *params, param);
+    typedef_names_declare(arena, opts->typedef_names, param.declaration.name, NULL);
+    zero_or_more(lexer, TOKEN_KIND_WS);
+  }
+
+  return (ast_node_t){ .kind = AST_NODE_KIND_LIST, .children = *params };
+}
+
+// Only the braces are matched so the body isn't parsed at all, the lexer is expected to be right before the '{'
+static ast_node_t skip_function_body(lexer_t lexer[const static 1], sv_t body_source[const static 1])
+{
+  const lexer_t start = *lexer;
+  size_t depth = 0;
+
+  do {
+    const token_t tok = get_next_token(lexer);
+
+    switch(tok.kind) {
+      case TOKEN_KIND_OBRACE: depth++; break;
+      case TOKEN_KIND_CBRACE: depth--; break;
+      case TOKEN_KIND_END: return error_node(&start, "Missing } at the end of function body");
+      default: break;
+    }
+  } while (depth > 0);
+
+  *body_source = sv_from_buf(&start.input->buf[start.cursor], lexer->cursor - start.cursor);
+
+  return (ast_node_t){ .kind = AST_NODE_KIND_LIST };
+}
+
+// function := declarator params (';' | '{' statement* '}'), the lexer is expected to be right before the '('
+// and the params and the body to be in their own typedef name scope, opened when opts.typedef_names had
+// visible_typedef_names declarations. A body can only have prototypes, C has no nested functions
+static ast_node_t parse_function_(arena_t arena[const static 1], lexer_t lexer[const static 1],
+                                  const parser_opts_t opts[const static 1], const ast_node_t declarator,
+                                  const size_t visible_typedef_names, const bool in_body)
+{
+  ast_function_t *function = arena_calloc(arena, 1, sizeof(*function));
+  assertm(!arena->err, "Expected: function alloc to succeed, Received: %s", arena->err);
+
+  function->type = declarator.declaration.type;
+  function->name = declarator.declaration.name;
+  function->visible_typedef_names = visible_typedef_names;
+
+  const ast_node_t params = parse_params(arena, lexer, opts, &function->params);
+
+  if (has_err(params)) {
+    return params;
+  }
+
+  zero_or_more(lexer, TOKEN_KIND_WS);
+
+  if (exactly_one(lexer, TOKEN_KIND_SEMICOLON, NULL)) {
+    return (ast_node_t){ .kind = AST_NODE_KIND_FUNCTION, .function = function };
+  }
+
+  if (!is_next(lexer, TOKEN_KIND_OBRACE)) {
+    return error_node(lexer, "Expected ; or a function body after the parameters");
+  }
+
+  if (in_body) {
+    return error_node(lexer, "Function definition is not allowed here");
+  }
+
+  const lexer_t body_start = *lexer;
+  const ast_node_t skipped = skip_function_body(lexer, &function->body_source);
+
+  if (has_err(skipped) || opts->lazy_bodies) {
+    return has_err(skipped) ? skipped : (ast_node_t){ .kind = AST_NODE_KIND_FUNCTION, .function = function };
+  }
+
+  // parse the body in place now that its end is known to exist
+  lexer_t body_lexer = body_start;
+  exactly_one(&body_lexer, TOKEN_KIND_OBRACE, NULL);
+
+  const ast_node_t body = parse_statements(arena, &body_lexer, opts, TOKEN_KIND_CBRACE);
+
+  if (body.children && has_err(body.children->items[body.children->length - 1])) {
+    return body.children->items[body.children->length - 1];
+  }
+
+  function->body = function_body_list(arena, body.children);
+
+  return (ast_node_t){ .kind = AST_NODE_KIND_FUNCTION, .function = function };
+}
+
+static ast_node_t parse_function(arena_t arena[const static 1], lexer_t lexer[const static 1],
+                                 const parser_opts_t opts[const static 1], const ast_node_t declarator, const bool in_body)
+{
+  if (declarator.declaration.type->storage & STORAGE_CLASS_TYPEDEF) {
+    return error_node(lexer, "Function typedefs are not supported");
+  }
+
+  const size_t visible_typedef_names = opts->typedef_names->length;
+
+  typedef_names_open_scope(arena, opts->typedef_names);
+  const ast_node_t function = parse_function_(arena, lexer, opts, declarator, visible_typedef_names, in_body);
+  typedef_names_close_scope(opts->typedef_names);
+
+  return function;
+}
+
+// declaration := declarator ('=' initializer)? ';' | function, in_body if it's a statement of a function body
+static ast_node_t parse_declaration(arena_t arena[const static 1], lexer_t lexer[const static 1],
+                                    const parser_opts_t opts[const static 1], const bool in_body)
+{
+  const ast_node_t declarator = parse_declarator(arena, lexer, opts, false);
+
+  if (has_err(declarator)) {
+    return declarator;
+  }
+
+  // in scope from the end of its declarator, so a function's own name is visible in its params and body
+  const bool is_typedef = declarator.declaration.type->storage & STORAGE_CLASS_TYPEDEF;
+  typedef_names_declare(arena, opts->typedef_names, declarator.declaration.name,
+                        is_typedef ? declarator.declaration.type : NULL);
+  zero_or_more(lexer, TOKEN_KIND_WS);
+
+  if (is_next(lexer, TOKEN_KIND_OPAREN)) {
+    return parse_function(arena, lexer, opts, declarator, in_body);
+  }
+
+  ast_node_t *init = NULL;
+
+  if (is_typedef && is_next(lexer, TOKEN_KIND_EQL)) {
+    return error_node(lexer, "A typedef can't have an initializer");
+  }
+
+  if (exactly_one(lexer, TOKEN_KIND_EQL, NULL)) {
+    zero_or_more(lexer, TOKEN_KIND_WS);
+
+    // an initializer is an assignment expression so it stops at a comma
+    const ast_node_t value = parse_expr_with_opts(arena, lexer, opts, BP_LIST_ITEM);
+
+    if (has_err(value)) {
+      return value;
+    }
+
+    init = new_node(arena, value);
+    zero_or_more(lexer, TOKEN_KIND_WS);
+  }
+
+  if (!exactly_one(lexer, TOKEN_KIND_SEMICOLON, NULL)) {
+    return error_node(lexer, "Missing semicolon at the end of declaration");
+  }
+
+  ast_node_t declaration = declarator;
+  declaration.declaration.init = init;
+
+  return declaration;
+}
+
+// return := 'return' expr? ';'
+static ast_node_t parse_return(arena_t arena[const static 1], lexer_t lexer[const static 1],
+                               const parser_opts_t opts[const static 1])
+{
+  if (!exactly_one(lexer, TOKEN_KIND_RETURN, NULL)) {
+    return error_node(lexer, "Expected return");
+  }
+
+  zero_or_more(lexer, TOKEN_KIND_WS);
+  ast_node_t *expr = NULL;
+
+  if (!is_next(lexer, TOKEN_KIND_SEMICOLON)) {
+    const ast_node_t value = parse_expr_with_opts(arena, lexer, opts, BP_NONE);
+
+    if (has_err(value)) {
+      return value;
+    }
+
+    expr = new_node(arena, value);
+    zero_or_more(lexer, TOKEN_KIND_WS);
+  }
+
+  if (!exactly_one(lexer, TOKEN_KIND_SEMICOLON, NULL)) {
+    return error_node(lexer, "Missing semicolon at the end of return statement");
+  }
+
+  return (ast_node_t){ .kind = AST_NODE_KIND_RETURN, .ret = { .expr = expr } };
+}
+
+// ------------------------------------ STATEMENTS ------------------------------------
+
+typedef enum {
+  STATEMENT_KIND_EXPR,
+  STATEMENT_KIND_DECLARATION,
+  STATEMENT_KIND_RETURN,
+} statement_kind_t;
+
+// decided from the first tokens and the typedef names in scope, so that a statement is parsed once
+// instead of being tried as a declaration first, e.g., T * x; is a declaration only if T is a type
+static statement_kind_t classify_statement(const lexer_t lexer[const static 1], const parser_opts_t opts[const static 1])
+{
+  lexer_t at = *lexer;
+  const token_t first = get_next_token(&at);
+
+  switch(first.kind) {
+    case TOKEN_KIND_RETURN: return STATEMENT_KIND_RETURN;
+    case TOKEN_KIND_TYPEDEF:
+    case TOKEN_KIND_STORAGE:
+    case TOKEN_KIND_QUALIFIER: return STATEMENT_KIND_DECLARATION;
+    case TOKEN_KIND_SYMBOL: return is_type_specifier(&at, opts, first.value, 0, false) ? STATEMENT_KIND_DECLARATION : STATEMENT_KIND_EXPR;
+    default: return STATEMENT_KIND_EXPR;
+  }
+}
+
+/**
+ * statements := (declaration | return | expr)* terminator
+ *
+ * Parses up to but not including the terminator, TOKEN_KIND_END for a program and TOKEN_KIND_CBRACE
+ * for a function body. If a statement fails to parse, the list ends with its error node.
+ */
+static ast_node_t parse_statements(arena_t arena[const static 1], lexer_t lexer[const static 1],
+                                   const parser_opts_t opts[const static 1], const token_kind_t terminator)
+{
+  ast_node_t program = {
+    .kind = AST_NODE_KIND_LIST,
+  };
+  ast_node_list_t *statements = NULL;
+
+  token_t token = peek_next_token(lexer);
+
+  while(token.kind != terminator) {
+    if (token.kind == TOKEN_KIND_WS || token.kind == TOKEN_KIND_NEWLINE || token.kind == TOKEN_KIND_SEMICOLON) {
+      get_next_token(lexer); // consume WS, NEWLINE or the ; ending an expression statement
+      token = peek_next_token(lexer);
+      continue;
+    }
+
+    if (statements == NULL) {
+      // allocate only when we are sure to have at least one node in it (here it may be an error node)
+      statements = arena_calloc(arena, 1, sizeof(*statements));
+      assertm(!arena->err, "Expected: statement list alloc to succeed, Received: %s", arena->err);
+      program.children = statements;
+      reserve_nodes(arena, statements, 2);
+    }
+
+    // the statement and the error after it always fit, since parsing the statement may use up the arena
+    if (!has_room(arena, list_growth_bytes(statements))) {
+      add_node(arena, statements, error_node(lexer, "Ran out of memory while parsing the statements"));
+      return program;
+    }
+
+    reserve_nodes(arena, statements, 2);
+
+    if (token.kind == TOKEN_KIND_END) {
+      // only reachable inside of a function body as END is the terminator of the program
+      add_node(arena, statements, error_node(lexer, "Missing } at the end of function body"));
+      return program;
+    }
+
+    ast_node_t node = {0};
+
+    switch(classify_statement(lexer, opts)) {
+      case STATEMENT_KIND_RETURN: {
+        node = terminator == TOKEN_KIND_CBRACE
+          ? parse_return(arena, lexer, opts)
+          : error_node(lexer, "Unexpected return outside of a function body");
+      } break;
+      case STATEMENT_KIND_DECLARATION: node = parse_declaration(arena, lexer, opts, terminator == TOKEN_KIND_CBRACE); break;
+      case STATEMENT_KIND_EXPR: node = parse_expr_with_opts(arena, lexer, opts, BP_NONE); break; // lowest precendence of op is BP_NONE
+    }
+
+    add_node(arena, statements, node);
+
+    if (has_err(node)) {
+      return program;
+    }
+
+    token = peek_next_token(lexer);
+  }
+
+  return program;
+}
+
+static parser_opts_t resolve_parser_opts(arena_t arena[const static 1], const parser_opts_t opts[const static 1])
+{
+  parser_opts_t resolved_opts = *opts;
+
+  if (resolved_opts.max_expr_depth == 0) {
+    resolved_opts.max_expr_depth = PARSER_DEFAULT_MAX_EXPR_DEPTH;
+  }
+
+  if (resolved_opts.types == NULL) {
+    resolved_opts.types = arena_calloc(arena, 1, sizeof(*resolved_opts.types));
+    assertm(!arena->err, "Expected: type table alloc to succeed, Received: %s", arena->err);
+  }
+
+  if (resolved_opts.typedef_names == NULL) {
+    resolved_opts.typedef_names = arena_calloc(arena, 1, sizeof(*resolved_opts.typedef_names));
+    assertm(!arena->err, "Expected: typedef name table alloc to succeed, Received: %s", arena->err);
+  }
+
+  return resolved_opts;
+}
+
+ast_node_t parse(arena_t arena[const static 1], const char source[const static 1], const size_t source_length)
+{
+  return parse_with_opts(arena, source, source_length, &(parser_opts_t){0});
+}
+
+ast_node_t parse_with_opts(arena_t arena[const static 1], const char source[const static 1], const size_t source_length,
+                           const parser_opts_t opts[const static 1])
+{
+  const parser_opts_t resolved_opts = resolve_parser_opts(arena, opts);
+
+  node_table_t node_table = {0};
+  interned_nodes = opts->hash_cons ? &node_table : NULL;
+  parsing_opts = &resolved_opts;
+
+  const sv_t input = sv_from_buf(source, source_length);
+  lexer_t lexer = {
+    .input = &input
+  };
+
+  const ast_node_t program = parse_statements(arena, &lexer, &resolved_opts, TOKEN_KIND_END);
+  interned_nodes = NULL;
+  parsing_opts = NULL;
+
+  const bool failed = program.children && has_err(program.children->items[program.children->length - 1]);
+  const token_t token = get_next_token(&lexer);
+  assertm(failed || token.kind == TOKEN_KIND_END, "Expected: TOKEN_KIND_END, Received: %s (%d)",
+          token_kind_name(token.kind), token.kind);
+
+  return program;
+}
+
+ast_node_t parse_function_body(arena_t arena[const static 1], const char source[const static 1], const size_t source_length,
+                               ast_function_t function[const static 1], const parser_opts_t opts[const static 1])
+{
+  assertm(function->body_source.length > 0, "Expected: a function with a body, Received: prototype of "SV_FMT,
+          sv_fmt_args(function->name));
+
+  if (function->body) {
+    return (ast_node_t){ .kind = AST_NODE_KIND_LIST, .children = function->body };
+  }
+
+  parser_opts_t resolved_opts = resolve_parser_opts(arena, opts);
+
+  // the file is parsed by now, so the body only sees the typedef names declared before it like it would have then
+  typedef_names_t visible = {0};
+
+  if (function->visible_typedef_names < resolved_opts.typedef_names->length) {
+    visible = typedef_names_prefix(arena, resolved_opts.typedef_names, function->visible_typedef_names);
+    resolved_opts.typedef_names = &visible;
+  }
+
+  node_table_t node_table = {0};
+  interned_nodes = opts->hash_cons ? &node_table : NULL;
+  parsing_opts = &resolved_opts;
+
+  const sv_t input = sv_from_buf(source, source_length);
+  const size_t offset = (size_t)(function->body_source.buf - source);
+  lexer_t lexer = {
+    .input = &input,
+    .cursor = offset,
+  };
+
+  // errors report lines so they are counted up to the body once instead of keeping them on every function
+  for (const char *nl = memchr(source, '\n', offset); nl; nl = memchr(nl + 1, '\n', offset - (size_t)(nl + 1 - source))) {
+    lexer.line++;
+    lexer.bol = (size_t)(nl + 1 - source);
+  }
+
+  // the params hide typedef names of the same name in the body like they did when the function was scanned
+  typedef_names_open_scope(arena, resolved_opts.typedef_names);
+
+  for (size_t i = 0; function->params && i < function->params->length; i++) {
+    typedef_names_declare(arena, resolved_opts.typedef_names, function->params->items[i].declaration.name, NULL);
+  }
+
+  exactly_one(&lexer, TOKEN_KIND_OBRACE, NULL);
+  const ast_node_t body = parse_statements(arena, &lexer, &resolved_opts, TOKEN_KIND_CBRACE);
+  typedef_names_close_scope(resolved_opts.typedef_names);
+  interned_nodes = NULL;
+  parsing_opts = NULL;
+
+  if (body.children && has_err(body.children->items[body.children->length - 1])) {
+    return body.children->items[body.children->length - 1];
+  }
+
+  function->body = function_body_list(arena, body.children);
+
+  return (ast_node_t){ .kind = AST_NODE_KIND_LIST, .children = function->body };
+}
+
+ast_node_list_t *function_body_list(arena_t arena[const static 1], ast_node_list_t *statements)
+{
+  if (statements) {
+    return statements;
+  }
+
+  ast_node_list_t *empty = arena_calloc(arena, 1, sizeof(*empty));
+  assertm(!arena->err, "Expected: empty body alloc to succeed, Received: %s", arena->err);
+
+  return empty;
 }
@@ -4,6 +4,7 @@
 #include <stddef.h>
 
 #include "./lexer.h"
+#include "./types.h"
 
 #include "./zdx_simple_arena.h"
 
@@ -15,6 +16,11 @@ typedef enum {
   AST_NODE_KIND_SYMBOL,
   AST_NODE_KIND_UNARY_OP,
   AST_NODE_KIND_BINARY_OP,
+  AST_NODE_KIND_TERNARY,
+  AST_NODE_KIND_CALL,
+  AST_NODE_KIND_DECLARATION,
+  AST_NODE_KIND_FUNCTION,
+  AST_NODE_KIND_RETURN,
   AST_NODE_KIND_COUNT,
 } ast_node_kind_t;
 
@@ -33,6 +39,14 @@ typedef enum {
   UNARY_OP_NOT,
   UNARY_OP_NEGATE,
   UNARY_OP_POSITIVE,
+  UNARY_OP_BIT_NOT,
+  UNARY_OP_PRE_INC,
+  UNARY_OP_PRE_DEC,
+  UNARY_OP_POST_INC,
+  UNARY_OP_POST_DEC,
+  UNARY_OP_SIZEOF, // expr is a type name, i.e., a declaration with an empty name, or an expression that isn't evaluated
+  UNARY_OP_ALIGNOF, // expr is always a type name
+  UNARY_OP_CONVERT, // implicit conversion to the type of the node, inserted by the type checker of typecheck.h
   UNARY_OP_COUNT,
 } unary_op_kind_t;
 
@@ -44,13 +58,61 @@ typedef enum {
   BINARY_OP_DIV,
   BINARY_OP_ASSIGNMENT,
   BINARY_OP_EXPO,
+  BINARY_OP_MOD,
+  BINARY_OP_LSHIFT,
+  BINARY_OP_RSHIFT,
+  BINARY_OP_LT,
+  BINARY_OP_LTE,
+  BINARY_OP_GT,
+  BINARY_OP_GTE,
+  BINARY_OP_EQ,
+  BINARY_OP_NEQ,
+  BINARY_OP_BIT_AND,
+  BINARY_OP_BIT_XOR,
+  BINARY_OP_BIT_OR,
+  BINARY_OP_LOGICAL_AND,
+  BINARY_OP_LOGICAL_OR,
+  BINARY_OP_MULT_ASSIGNMENT,
+  BINARY_OP_DIV_ASSIGNMENT,
+  BINARY_OP_MOD_ASSIGNMENT,
+  BINARY_OP_ADD_ASSIGNMENT,
+  BINARY_OP_SUB_ASSIGNMENT,
+  BINARY_OP_LSHIFT_ASSIGNMENT,
+  BINARY_OP_RSHIFT_ASSIGNMENT,
+  BINARY_OP_BIT_AND_ASSIGNMENT,
+  BINARY_OP_BIT_XOR_ASSIGNMENT,
+  BINARY_OP_BIT_OR_ASSIGNMENT,
+  BINARY_OP_COMMA,
+  BINARY_OP_INDEX,
+  BINARY_OP_MEMBER, // rhs is always a symbol
+  BINARY_OP_PTR_MEMBER, // rhs is always a symbol
   BINARY_OP_COUNT,
 } binary_op_kind_t;
 
+// what a symbol refers to, filled in by the resolve pass of resolve.h. Declarations get their slots in the
+// order they are made: the i-th param or local declaration of a function is slot i of its frame and a global
+// gets the next global slot on the first declaration of its name, later ones (e.g., a prototype and then the
+// definition) share it
+typedef enum {
+  SYMBOL_BINDING_NONE, // not resolved
+  SYMBOL_BINDING_GLOBAL, // slot indexes the globals
+  SYMBOL_BINDING_LOCAL, // slot indexes the frame of the function the symbol is used in
+  SYMBOL_BINDING_EXTERN, // callee that was never declared, e.g., printf, slot indexes the externs linked by name
+  SYMBOL_BINDING_MEMBER, // member name of a . or ->, not a variable
+  SYMBOL_BINDING_UNDECLARED, // reported by the resolve pass
+  SYMBOL_BINDING_COUNT,
+} symbol_binding_t;
+
 typedef struct ast_node_list_t ast_node_list_t;
+typedef struct ast_function_t ast_function_t;
 
 typedef struct ast_node_t {
   ast_node_kind_t kind;
+  // hash-consed node that may have several parents so it must never be modified in place, but for
+  // binding its symbols and typing it the way every parent sees them (see resolve.h).
+  // Two shared nodes are the same side-effect-free expression iff they are the same pointer
+  bool shared;
+  uint16_t type; // id of the type of an expression in the type table of typecheck.h, TYPE_NO_ID until checked
 
   union {
     struct ast_node_list_t *children;
@@ -64,11 +126,16 @@ typedef struct ast_node_t {
 
     struct {
       literal_kind_t kind;
+      bool folded; // by the fold pass of fold.h, value is the source of the expression it was folded from
       sv_t value;
+      uint64_t integer; // value of integer literals, converted while parsing, of the type of the node if folded
     } literal;
 
     struct {
       sv_t name;
+      uint8_t binding; // symbol_binding_t
+      uint32_t slot;
+      uint32_t declaration; // number of the declaration it refers to in resolver_t.declarations, 0 if none
     } symbol;
 
     struct {
@@ -81,6 +148,30 @@ typedef struct ast_node_t {
       unary_op_kind_t kind;
       struct ast_node_t *expr;
     } unary_op;
+
+    struct {
+      struct ast_node_t *cond;
+      struct ast_node_t *then_expr;
+      struct ast_node_t *else_expr;
+    } ternary;
+
+    struct {
+      struct ast_node_t *callee;
+      struct ast_node_list_t *args; // NULL when called with no args
+    } call;
+
+    struct {
+      const type_t *type; // interned so declarations of the same type share it
+      sv_t name;
+      struct ast_node_t *init; // NULL when there is no initializer
+    } declaration;
+
+    // kept out of line so function definitions don't grow every other node
+    struct ast_function_t *function;
+
+    struct {
+      struct ast_node_t *expr; // NULL for a bare return
+    } ret;
   };
 } ast_node_t;
 
@@ -90,7 +181,19 @@ struct ast_node_list_t {
   ast_node_t *items;
 };
 
-#define has_err(node) (node).kind == AST_NODE_KIND_ERROR
+struct ast_function_t {
+  const type_t *type; // return type
+  sv_t name;
+  ast_node_list_t *params; // declarations without initializers, NULL for () and (void)
+  // statements of the body, an empty list for {}, NULL for prototypes and for bodies that were only scanned by the
+  // lazy mode and haven't been parsed by parse_function_body() yet
+  ast_node_list_t *body;
+  sv_t body_source; // from { to } inclusive, empty for prototypes
+  size_t visible_typedef_names; // declarations of parser_opts_t.typedef_names before the function, the ones its body sees
+  uint32_t frame_size; // slots of the params and locals, set by the resolve pass
+};
+
+#define has_err(node) ((node).kind == AST_NODE_KIND_ERROR)
 #define check_program(program)                                  \
   assertm((program).kind == AST_NODE_KIND_LIST,                 \
           "Expected: Program node, Received: %s (%d)",          \
@@ -125,10 +228,57 @@ struct ast_node_list_t {
     }                                                                                                                           \
   } while(0)
 
-#define print_ast(node) print_ast_((node), 0);
-void print_ast_(const ast_node_t node, size_t depth);
 const char *node_kind_name(const ast_node_kind_t kind);
+// children in source order, a function has its params followed by its body statements (none if not parsed yet)
+size_t ast_child_count(const ast_node_t node[const static 1]);
+ast_node_t *ast_child(const ast_node_t node[const static 1], const size_t i);
+// a parenthesized expression is a list of its comma separated expressions, this is the innermost one that
+// gives it its value, the node itself if it isn't one or is empty
+const ast_node_t *ast_ungroup(const ast_node_t node[const static 1]);
+const char *literal_kind_name(const literal_kind_t kind);
+const char *unary_kind_name(const unary_op_kind_t kind);
+const char *binary_kind_name(const binary_op_kind_t kind);
+const char *symbol_binding_name(const symbol_binding_t binding);
+// literal node of a literal token or an error node if its value doesn't fit, the lexer is expected to be right after the token
+ast_node_t new_literal(const lexer_t lexer[const static 1], const token_kind_t token_kind, const sv_t value);
+
+#ifdef PARSER_BENCH
+// counters read by parser_bench.c, only compiled in with -DPARSER_BENCH
+typedef struct {
+  size_t expr_resets; // times parse_expr backtracked to try its next parser choice
+} parser_stats_t;
+
+extern parser_stats_t parser_stats;
+#define parser_stats_inc(field) (parser_stats.field++)
+#else
+#define parser_stats_inc(field)
+#endif
+
+// max number of operators and brackets an expression can have pending at once, e.g., 1 + (2 * -3) has 3
+#define PARSER_DEFAULT_MAX_EXPR_DEPTH 4096
+
+typedef struct {
+  size_t max_expr_depth; // 0 means PARSER_DEFAULT_MAX_EXPR_DEPTH
+  bool recursive_exprs; // use the recursive expression parser instead of the iterative one
+  type_table_t *types; // types of declarations are interned here, NULL uses a table local to the parse
+  // share structurally equal side-effect-free subtrees instead of allocating each one, a shared subtree has the
+  // source positions of its first occurrence
+  bool hash_cons;
+  bool lazy_bodies; // only check function bodies for balanced braces, parse_function_body() parses them on first use
+  // typedef names in scope, NULL uses a table local to the parse. Pass the table of the parse that produced
+  // a lazy function body to parse_function_body() so the body sees the file scope typedefs declared before it
+  typedef_names_t *typedef_names;
+} parser_opts_t;
 
 ast_node_t parse(arena_t arena[const static 1], const char source[const static 1], const size_t source_length);
+ast_node_t parse_with_opts(arena_t arena[const static 1], const char source[const static 1], const size_t source_length,
+                           const parser_opts_t opts[const static 1]);
+// Parses a body skipped by the lazy mode and keeps it in function->body, returns the body as a list node or an
+// error node. Pass the opts.types and opts.typedef_names of the parse that produced the function so both intern
+// into the same table and the body sees the typedef names that were declared before it, and only those.
+ast_node_t parse_function_body(arena_t arena[const static 1], const char source[const static 1], const size_t source_length,
+                               ast_function_t function[const static 1], const parser_opts_t opts[const static 1]);
+// the statements of a parsed body as function->body keeps them, an empty list for none as NULL is a body not parsed yet
+ast_node_list_t *function_body_list(arena_t arena[const static 1], ast_node_list_t *statements);
 
 #endif // PARSER_H_
@@ -0,0 +1,357 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "./parser2.h"
+#include "./ll1_parser.h"
+
+#include "./zdx_util.h"
+
+#define ZDX_SIMPLE_ARENA_IMPLEMENTATION
+#include "./zdx_simple_arena.h"
+
+#ifndef PARSER_BENCH
+#error "parser_bench.c needs -DPARSER_BENCH to read the parser stats and to link the prototype parser"
+#endif
+
+#define BENCH_ARENA_SIZE (512 MB)
+#define BENCH_MIN_ITERATIONS 5
+#define BENCH_MIN_SECONDS 0.25
+
+// defined in pratt_parser_test.c when compiled with -DPARSER_BENCH
+size_t pratt_prototype_bench_parse(arena_t arena[const static 1], const char input[const static 1], size_t resets[const static 1]);
+
+typedef enum {
+  BENCH_PARSER_ITERATIVE,
+  BENCH_PARSER_RECURSIVE,
+  BENCH_PARSER_PROTOTYPE,
+  BENCH_PARSER_LL1,
+  BENCH_PARSER_COUNT,
+} bench_parser_t;
+
+static const char *bench_parser_name[] = {
+  "parser2_iterative",
+  "parser2_recursive",
+  "pratt_prototype",
+  "ll1_table",
+};
+
+_Static_assert(zdx_arr_len(bench_parser_name) == BENCH_PARSER_COUNT, "Missing name for bench parser");
+
+typedef struct {
+  const char *name;
+  char *source;
+  size_t length;
+  bool prototype_supported; // the prototype only knows numbers, parens and + - * /
+} bench_corpus_t;
+
+typedef struct {
+  bool supported;
+  bool ok;
+  size_t iterations;
+  size_t nodes;
+  size_t arena_bytes;
+  size_t expr_resets;
+  double seconds;
+} bench_result_t;
+
+// arena_calloc() relies on fresh mmap-ed memory being zeroed so a reused arena has to be zeroed by hand
+static void bench_arena_reset(arena_t arena[const static 1])
+{
+  memset(arena->arena, 0, arena->offset);
+  arena_reset(arena);
+}
+
+static double now_seconds(void)
+{
+  struct timespec ts = {0};
+  timespec_get(&ts, TIME_UTC);
+
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// ------------------------------------ CORPORA ------------------------------------
+
+typedef struct {
+  char *buf;
+  size_t length;
+  size_t capacity;
+} bench_buf_t;
+
+static void buf_append(bench_buf_t buf[const static 1], const char str[const static 1])
+{
+  const size_t len = strlen(str);
+
+  if (buf->length + len + 1 > buf->capacity) {
+    buf->capacity = zdx_max(buf->capacity * 2, buf->length + len + 1);
+    buf->buf = realloc(buf->buf, buf->capacity);
+    assertm(buf->buf, "Expected: corpus buffer to grow to %zu bytes", buf->capacity);
+  }
+
+  memcpy(buf->buf + buf->length, str, len + 1);
+  buf->length += len;
+}
+
+// 1 + 2 + 3 + ... is one long left associative loop in every parser
+static bench_corpus_t wide_sum(const size_t terms)
+{
+  bench_buf_t buf = {0};
+  char num[32] = {0};
+
+  for (size_t i = 0; i < terms; i++) {
+    snprintf(num, sizeof(num), i ? " + %zu" : "%zu", i + 1);
+    buf_append(&buf, num);
+  }
+
+  return (bench_corpus_t){ .name = "wide_sum", .source = buf.buf, .length = buf.length, .prototype_supported = true };
+}
+
+// ((((1)))) exercises every parenthesized expr path
+static bench_corpus_t deep_nesting(const size_t depth)
+{
+  bench_buf_t buf = {0};
+
+  for (size_t i = 0; i < depth; i++) buf_append(&buf, "(");
+  buf_append(&buf, "1");
+  for (size_t i = 0; i < depth; i++) buf_append(&buf, ")");
+
+  return (bench_corpus_t){ .name = "deep_nesting", .source = buf.buf, .length = buf.length, .prototype_supported = true };
+}
+
+// -~-~-~1 nests one prefix op per char
+static bench_corpus_t unary_chain(const size_t length)
+{
+  bench_buf_t buf = {0};
+
+  for (size_t i = 0; i < length; i++) buf_append(&buf, i % 2 ? "~" : "-");
+  buf_append(&buf, "1");
+
+  return (bench_corpus_t){ .name = "unary_chain", .source = buf.buf, .length = buf.length, .prototype_supported = false };
+}
+
+// every binding power change forces the pratt loop to return to a shallower level
+static bench_corpus_t mixed_precedence(const size_t groups)
+{
+  bench_buf_t buf = {0};
+
+  for (size_t i = 0; i < groups; i++) {
+    buf_append(&buf, i ? " - " : "");
+    buf_append(&buf, "1 + 2 * 3 / (4 - 5 * 6) + 7 * (8 + 9) / 10");
+  }
+
+  return (bench_corpus_t){ .name = "mixed_precedence", .source = buf.buf, .length = buf.length, .prototype_supported = true };
+}
+
+// one declaration and one function per line, a statement parser2 used to try as a declaration before an expression
+static bench_corpus_t declarations(const size_t lines)
+{
+  bench_buf_t buf = {0};
+  char line[160] = {0};
+
+  for (size_t i = 0; i < lines; i++) {
+    snprintf(line, sizeof(line), "static const unsigned int *p%zu = a + b * c;\n"
+             "int f%zu(int a, char *b) { return a ? b[a] : -a; }\n", i, i);
+    buf_append(&buf, line);
+  }
+
+  return (bench_corpus_t){ .name = "declarations", .source = buf.buf, .length = buf.length, .prototype_supported = false };
+}
+
+// ------------------------------------ RUNNER ------------------------------------
+
+static size_t count_ast_nodes(const ast_node_t node)
+{
+  switch(node.kind) {
+    case AST_NODE_KIND_LIST: {
+      size_t count = 1;
+
+      for (size_t i = 0; node.children && i < node.children->length; i++) {
+        count += count_ast_nodes(node.children->items[i]);
+      }
+
+      return count;
+    }
+    case AST_NODE_KIND_UNARY_OP: return 1 + count_ast_nodes(*node.unary_op.expr);
+    case AST_NODE_KIND_BINARY_OP: return 1 + count_ast_nodes(*node.binary_op.lhs) + count_ast_nodes(*node.binary_op.rhs);
+    case AST_NODE_KIND_TERNARY: return 1 + count_ast_nodes(*node.ternary.cond) +
+                                  count_ast_nodes(*node.ternary.then_expr) + count_ast_nodes(*node.ternary.else_expr);
+    case AST_NODE_KIND_CALL: return 1 + count_ast_nodes(*node.call.callee) +
+                               (node.call.args ? count_ast_nodes((ast_node_t){ .kind = AST_NODE_KIND_LIST, .children = node.call.args }) : 0);
+    case AST_NODE_KIND_DECLARATION:
+    case AST_NODE_KIND_FUNCTION:
+    case AST_NODE_KIND_RETURN: {
+      size_t count = 1;
+
+      for (size_t i = 0; i < ast_child_count(&node); i++) {
+        count += count_ast_nodes(*ast_child(&node, i));
+      }
+
+      return count;
+    }
+    default: return 1;
+  }
+}
+
+// a generated header where every other name is a typedef name, so whether a statement is a declaration
+// or an expression like v0 * x; depends on the typedef names in scope
+static bench_corpus_t typedef_header(const size_t typedefs)
+{
+  bench_buf_t buf = {0};
+  char line[320] = {0};
+
+  for (size_t i = 0; i < typedefs; i++) {
+    snprintf(line, sizeof(line), "typedef unsigned long long t%zu;\n"
+             "typedef const t%zu *pt%zu;\n"
+             "t%zu *v%zu = a * b;\n"
+             "pt%zu f%zu(t%zu t%zu, pt%zu p) { t%zu * p; return t%zu; }\n"
+             "v%zu * t%zu;\n", i, i, i, i, i, i, i, i, i, i, i, i, i, i);
+    buf_append(&buf, line);
+  }
+
+  return (bench_corpus_t){ .name = "typedef_header", .source = buf.buf, .length = buf.length, .prototype_supported = false };
+}
+
+static bool program_ok(const ast_node_t program)
+{
+  return program.children && program.children->length &&
+    !has_err(program.children->items[program.children->length - 1]);
+}
+
+// parses the corpus once and returns the node count or 0 on error
+static size_t run_once(arena_t arena[const static 1], const bench_parser_t parser, const bench_corpus_t corpus[const static 1],
+                       size_t resets[const static 1])
+{
+  switch(parser) {
+    case BENCH_PARSER_ITERATIVE:
+    case BENCH_PARSER_RECURSIVE: {
+      const parser_opts_t opts = {
+        .max_expr_depth = SIZE_MAX,
+        .recursive_exprs = parser == BENCH_PARSER_RECURSIVE
+      };
+
+      parser_stats = (parser_stats_t){0};
+      const ast_node_t program = parse_with_opts(arena, corpus->source, corpus->length, &opts);
+      *resets = parser_stats.expr_resets;
+
+      return program_ok(program) ? count_ast_nodes(program) : 0;
+    }
+    case BENCH_PARSER_PROTOTYPE: return pratt_prototype_bench_parse(arena, corpus->source, resets);
+    case BENCH_PARSER_LL1: {
+      const ast_node_t program = ll1_parse(arena, corpus->source, corpus->length, &(parser_opts_t){0});
+      *resets = 0; // the tables pick the alternative from the next token so nothing is ever reparsed
+
+      return program_ok(program) ? count_ast_nodes(program) : 0;
+    }
+    default: assertm(false, "Unexpected bench parser %d", parser);
+  }
+
+  return 0;
+}
+
+static bench_result_t run_bench(arena_t arena[const static 1], const bench_parser_t parser, const bench_corpus_t corpus[const static 1])
+{
+  bench_result_t result = {
+    .supported = parser != BENCH_PARSER_PROTOTYPE || corpus->prototype_supported
+  };
+
+  if (!result.supported) {
+    return result;
+  }
+
+  // first run is not timed and gives the per parse numbers
+  bench_arena_reset(arena);
+  result.nodes = run_once(arena, parser, corpus, &result.expr_resets);
+  result.arena_bytes = arena->offset ? arena->offset - 1 : 0;
+  result.ok = result.nodes > 0;
+
+  if (!result.ok) {
+    return result;
+  }
+
+  size_t resets = 0;
+
+  while (result.iterations < BENCH_MIN_ITERATIONS || result.seconds < BENCH_MIN_SECONDS) {
+    bench_arena_reset(arena);
+
+    const double start = now_seconds();
+    run_once(arena, parser, corpus, &resets);
+    result.seconds += now_seconds() - start;
+    result.iterations++;
+  }
+
+  return result;
+}
+
+static void write_result(FILE *out, const bench_parser_t parser, const bench_result_t result[const static 1], const bool last)
+{
+  fprintf(out, "        {\"parser\": \"%s\", \"supported\": %s", bench_parser_name[parser], result->supported ? "true" : "false");
+
+  if (result->supported) {
+    fprintf(out, ", \"ok\": %s", result->ok ? "true" : "false");
+  }
+
+  if (result->ok) {
+    const double per_parse = result->seconds / (double)result->iterations;
+
+    fprintf(out, ", \"iterations\": %zu, \"nodes\": %zu, \"nodes_per_sec\": %.0f, \"ns_per_parse\": %.0f, "
+            "\"arena_bytes\": %zu, \"arena_bytes_per_node\": %.2f, \"expr_resets\": %zu",
+            result->iterations, result->nodes, (double)result->nodes / per_parse, per_parse * 1e9,
+            result->arena_bytes, (double)result->arena_bytes / (double)result->nodes, result->expr_resets);
+  }
+
+  fprintf(out, "}%s\n", last ? "" : ",");
+}
+
+// gcc -o ll1_gen ll1_gen.c && ./ll1_gen grammar.ll1 ll1_tables.h &&
+// gcc -O2 -g -std=c17 -Wall -Wdeprecated -Wpedantic -Wextra -DPARSER_BENCH -o parser_bench parser_bench.c lexer.c parser2.c types.c ll1_parser.c pratt_parser_test.c && ./parser_bench parser_bench.json
+int main(int argc, char *argv[])
+{
+  FILE *out = stdout;
+
+  if (argc > 1) {
+    out = fopen(argv[1], "w");
+
+    if (out == NULL) {
+      bail("Could not open %s for writing", argv[1]);
+    }
+  }
+
+  // depths are kept low enough for the recursive parsers to not overflow the stack
+  bench_corpus_t corpora[] = {
+    wide_sum(20000),
+    deep_nesting(1000),
+    unary_chain(1000),
+    mixed_precedence(2000),
+    declarations(2000),
+    typedef_header(2000),
+  };
+
+  arena_t arena = arena_create(BENCH_ARENA_SIZE);
+  assertm(!arena.err, "Expected: arena creation to succeed, Received: %s", arena.err);
+
+  fprintf(out, "{\n  \"corpora\": [\n");
+
+  for (size_t i = 0; i < zdx_arr_len(corpora); i++) {
+    const bench_corpus_t *corpus = &corpora[i];
+
+    fprintf(out, "    {\n      \"name\": \"%s\",\n      \"source_bytes\": %zu,\n      \"results\": [\n", corpus->name, corpus->length);
+
+    for (bench_parser_t parser = 0; parser < BENCH_PARSER_COUNT; parser++) {
+      const bench_result_t result = run_bench(&arena, parser, corpus);
+      write_result(out, parser, &result, parser == BENCH_PARSER_COUNT - 1);
+    }
+
+    fprintf(out, "      ]\n    }%s\n", i == zdx_arr_len(corpora) - 1 ? "" : ",");
+    free(corpus->source);
+  }
+
+  fprintf(out, "  ]\n}\n");
+
+  if (out != stdout) {
+    fclose(out);
+  }
+
+  arena_free(&arena);
+  return 0;
+}
@@ -0,0 +1,310 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "./zdx_util.h"
+#include "./passes.h"
+
+static inline uint64_t now_ns(void)
+{
+  struct timespec ts = {0};
+  timespec_get(&ts, TIME_UTC);
+
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void pass_register(pass_manager_t pm[const static 1], const pass_t pass)
+{
+  assertm(pm->length < PASS_MAX, "Expected: at most %d passes, Received: one more for %s", PASS_MAX, pass.name);
+
+  pm->passes[pm->length++] = pass;
+}
+
+// ------------------------------------ DISPATCH ------------------------------------
+
+typedef struct {
+  pass_visit_fn fn;
+  void *ctx;
+  uint8_t pass;
+} pass_callback_t;
+
+// callbacks of the fused passes by node kind so a visit only calls the passes interested in that kind
+typedef struct {
+  uint8_t length;
+  pass_callback_t items[PASS_MAX];
+} pass_dispatch_t;
+
+typedef struct {
+  pass_dispatch_t pre[AST_NODE_KIND_COUNT];
+  pass_dispatch_t post[AST_NODE_KIND_COUNT];
+} pass_table_t;
+
+static void pass_table_fill(pass_table_t table[const static 1], const pass_manager_t pm[const static 1],
+                            const size_t from, const size_t to)
+{
+  *table = (pass_table_t){0};
+
+  for (size_t p = from; p < to; p++) {
+    const pass_t *pass = &pm->passes[p];
+
+    for (size_t kind = 0; kind < AST_NODE_KIND_COUNT; kind++) {
+      if (pass->pre[kind]) {
+        pass_dispatch_t *d = &table->pre[kind];
+        d->items[d->length++] = (pass_callback_t){ .fn = pass->pre[kind], .ctx = pass->ctx, .pass = (uint8_t)p };
+      }
+
+      if (pass->post[kind]) {
+        pass_dispatch_t *d = &table->post[kind];
+        d->items[d->length++] = (pass_callback_t){ .fn = pass->post[kind], .ctx = pass->ctx, .pass = (uint8_t)p };
+      }
+    }
+  }
+}
+
+static inline void pass_dispatch(pass_manager_t pm[const static 1], const pass_dispatch_t d[const static 1],
+                                 ast_node_t node[const static 1])
+{
+  if (!pm->timing) {
+    for (uint8_t i = 0; i < d->length; i++) {
+      d->items[i].fn(d->items[i].ctx, node);
+    }
+
+    return;
+  }
+
+  for (uint8_t i = 0; i < d->length; i++) {
+    const uint64_t start = now_ns();
+    d->items[i].fn(d->items[i].ctx, node);
+    pm->stats[d->items[i].pass].ns += now_ns() - start;
+    pm->stats[d->items[i].pass].calls++;
+  }
+}
+
+// ------------------------------------ WALK ------------------------------------
+
+typedef struct {
+  ast_node_t *node;
+  size_t next_child;
+} pass_frame_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  pass_frame_t *items;
+} pass_frames_t;
+
+#define PASS_FRAMES_MIN_CAP 64
+
+static inline void push_pass_frame(arena_t arena[const static 1], pass_frames_t frames[const static 1], const pass_frame_t frame)
+{
+  if (frames->length == frames->capacity) {
+    const size_t capacity = zdx_max(frames->capacity * 2, PASS_FRAMES_MIN_CAP);
+
+    frames->items = arena_realloc(arena, frames->items, frames->capacity * sizeof(*frames->items), capacity * sizeof(*frames->items));
+    assertm(!arena->err, "Expected: pass frames resize to be successful, Received: %s", arena->err);
+    frames->capacity = capacity;
+  }
+
+  frames->items[frames->length++] = frame;
+}
+
+// the explicit stack keeps deeply nested programs, which the iterative parser accepts, off the C stack
+static uint64_t pass_walk(arena_t arena[const static 1], pass_manager_t pm[const static 1], const pass_table_t table[const static 1],
+                          pass_frames_t frames[const static 1], ast_node_t program[const static 1])
+{
+  uint64_t nodes = 1;
+
+  frames->length = 0;
+  pass_dispatch(pm, &table->pre[program->kind], program);
+  push_pass_frame(arena, frames, (pass_frame_t){ .node = program });
+
+  while (frames->length > 0) {
+    pass_frame_t *frame = &frames->items[frames->length - 1];
+
+    // counted on every step as a pre callback may rewrite the node, e.g., into a literal
+    if (frame->next_child >= ast_child_count(frame->node)) {
+      pass_dispatch(pm, &table->post[frame->node->kind], frame->node);
+      frames->length--;
+      continue;
+    }
+
+    ast_node_t *child = ast_child(frame->node, frame->next_child++);
+
+    pass_dispatch(pm, &table->pre[child->kind], child);
+    push_pass_frame(arena, frames, (pass_frame_t){ .node = child });
+    nodes++;
+  }
+
+  return nodes;
+}
+
+void pass_manager_run(arena_t arena[const static 1], pass_manager_t pm[const static 1], ast_node_t program[const static 1])
+{
+  memset(pm->stats, 0, sizeof(pm->stats));
+  memset(pm->walks, 0, sizeof(pm->walks));
+  pm->walk_count = 0;
+
+  pass_table_t *table = arena_calloc(arena, 1, sizeof(*table));
+  assertm(!arena->err, "Expected: pass table alloc to succeed, Received: %s", arena->err);
+  pass_frames_t frames = {0};
+
+  for (size_t from = 0; from < pm->length;) {
+    size_t to = from + 1;
+
+    while (to < pm->length && !pm->passes[to].barrier) {
+      to++;
+    }
+
+    const size_t walk = pm->walk_count++;
+
+    for (size_t p = from; p < to; p++) {
+      pm->stats[p].walk = walk;
+    }
+
+    pass_table_fill(table, pm, from, to);
+
+    const uint64_t start = now_ns();
+    pm->walks[walk].nodes = pass_walk(arena, pm, table, &frames, program);
+    pm->walks[walk].ns = now_ns() - start;
+
+    from = to;
+  }
+}
+
+// ------------------------------------ STREAM ------------------------------------
+
+struct pass_stream_t {
+  pass_manager_t *pm;
+  pass_table_t table;
+  pass_frames_t frames;
+};
+
+bool pass_manager_can_stream(const pass_manager_t pm[const static 1])
+{
+  for (size_t p = 1; p < pm->length; p++) {
+    if (pm->passes[p].barrier) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+pass_stream_t *pass_stream_begin(arena_t arena[const static 1], pass_manager_t pm[const static 1])
+{
+  assertm(pass_manager_can_stream(pm), "Expected: passes without a barrier to stream statements through, Received: a barrier");
+
+  memset(pm->stats, 0, sizeof(pm->stats));
+  memset(pm->walks, 0, sizeof(pm->walks));
+  pm->walk_count = pm->length > 0;
+
+  pass_stream_t *stream = arena_calloc(arena, 1, sizeof(*stream));
+  assertm(!arena->err, "Expected: pass stream alloc to succeed, Received: %s", arena->err);
+  stream->pm = pm;
+  pass_table_fill(&stream->table, pm, 0, pm->length);
+
+  return stream;
+}
+
+void pass_stream_run(arena_t arena[const static 1], pass_stream_t *stream, ast_node_t statement[const static 1])
+{
+  pass_manager_t *pm = stream->pm;
+
+  if (pm->length == 0) {
+    return;
+  }
+
+  const uint64_t start = now_ns();
+  pm->walks[0].nodes += pass_walk(arena, pm, &stream->table, &stream->frames, statement);
+  pm->walks[0].ns += now_ns() - start;
+}
+
+void pass_manager_report(const pass_manager_t pm[const static 1])
+{
+  fprintf(stderr, "%-24s %6s %12s %10s %12s\n", "pass", "walk", "calls", "ms", "ns/call");
+
+  for (size_t p = 0; p < pm->length; p++) {
+    const pass_stats_t *stats = &pm->stats[p];
+
+    if (pm->timing) {
+      fprintf(stderr, "%-24s %6zu %12llu %10.3f %12.1f\n", pm->passes[p].name, stats->walk,
+              (unsigned long long)stats->calls, (double)stats->ns / 1e6,
+              stats->calls ? (double)stats->ns / (double)stats->calls : 0.0);
+    } else {
+      fprintf(stderr, "%-24s %6zu %12s %10s %12s\n", pm->passes[p].name, stats->walk, "-", "-", "-");
+    }
+  }
+
+  for (size_t w = 0; w < pm->walk_count; w++) {
+    const pass_walk_stats_t *walk = &pm->walks[w];
+
+    fprintf(stderr, "walk %zu: %llu nodes in %.3f ms (%.1f ns/node)\n", w, (unsigned long long)walk->nodes,
+            (double)walk->ns / 1e6, walk->nodes ? (double)walk->ns / (double)walk->nodes : 0.0);
+  }
+}
+
+// ------------------------------------ ERRORS ------------------------------------
+
+#define PASS_ERRORS_MIN_CAP 16
+
+void pass_error(arena_t arena[const static 1], pass_errors_t errors[const static 1], const sv_t at, const char *fmt, ...)
+{
+  va_list args;
+
+  va_start(args, fmt);
+  const int length = vsnprintf(NULL, 0, fmt, args);
+  va_end(args);
+  assertm(length >= 0, "Expected: '%s' to be formatted", fmt);
+
+  char *msg = arena_alloc(arena, (size_t)length + 1);
+  assertm(!arena->err, "Expected: error message alloc to succeed, Received: %s", arena->err);
+
+  va_start(args, fmt);
+  vsnprintf(msg, (size_t)length + 1, fmt, args);
+  va_end(args);
+
+  if (errors->length == errors->capacity) {
+    const size_t capacity = zdx_max(errors->capacity * 2, PASS_ERRORS_MIN_CAP);
+
+    errors->items = arena_realloc(arena, errors->items, errors->capacity * sizeof(*errors->items), capacity * sizeof(*errors->items));
+    assertm(!arena->err, "Expected: pass errors resize to be successful, Received: %s", arena->err);
+    errors->capacity = capacity;
+  }
+
+  errors->items[errors->length++] = (pass_error_t){ .at = at, .msg = msg };
+}
+
+size_t pass_errors_report(const pass_errors_t errors[const static 1], const char path[const static 1], const char source[const static 1])
+{
+  size_t line = 0;
+  size_t bol = 0;
+  const char *scanned = source;
+
+  for (size_t i = 0; i < errors->length; i++) {
+    const pass_error_t *err = &errors->items[i];
+
+    if (err->at.buf == NULL || err->at.buf < source) {
+      fprintf(stderr, "%s: Error: %s\n", path, err->msg);
+      continue;
+    }
+
+    // errors come in the order the passes visited the program, which is the source order most of the time
+    if (err->at.buf < scanned) {
+      line = 0;
+      bol = 0;
+      scanned = source;
+    }
+
+    for (const char *nl = memchr(scanned, '\n', (size_t)(err->at.buf - scanned)); nl;
+         nl = memchr(nl + 1, '\n', (size_t)(err->at.buf - nl - 1))) {
+      line++;
+      bol = (size_t)(nl + 1 - source);
+    }
+
+    scanned = err->at.buf;
+    fprintf(stderr, "%s:%zu:%zu: Error: %s\n", path, line + 1, (size_t)(err->at.buf - source) - bol + 1, err->msg);
+  }
+
+  return errors->length;
+}
@@ -0,0 +1,90 @@
+#ifndef PASSES_H_
+#define PASSES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "./parser2.h"
+
+#include "./zdx_simple_arena.h"
+
+#define PASS_MAX 16
+
+typedef void (*pass_visit_fn)(void *ctx, ast_node_t node[const static 1]);
+
+/**
+ * A pass is a set of callbacks by node kind. pre runs before the children of a node are visited
+ * and post after them, so post callbacks see already visited (e.g., folded) children.
+ *
+ * Passes run in the order they are registered and all passes between two barriers share a single
+ * traversal of the program: each node is visited once and the callbacks of all those passes run on
+ * it in registration order. A pass sets barrier when it needs the passes before it to have seen the
+ * whole program first, e.g., to use a function that is only defined further down.
+ *
+ * Hash-consed nodes are reached once per parent, so passes must not rewrite shared nodes in place.
+ */
+typedef struct {
+  const char *name;
+  void *ctx;
+  pass_visit_fn pre[AST_NODE_KIND_COUNT];
+  pass_visit_fn post[AST_NODE_KIND_COUNT];
+  bool barrier;
+} pass_t;
+
+typedef struct {
+  uint64_t ns; // time spent in the callbacks of the pass, only measured with pass_manager_t.timing
+  uint64_t calls;
+  size_t walk; // index of the traversal the pass was fused into
+} pass_stats_t;
+
+typedef struct {
+  uint64_t ns; // whole traversal, callbacks included
+  uint64_t nodes;
+} pass_walk_stats_t;
+
+typedef struct {
+  pass_t passes[PASS_MAX];
+  size_t length;
+  bool timing; // time every callback, adds two clock reads per call so only turn it on to profile
+  pass_stats_t stats[PASS_MAX];
+  pass_walk_stats_t walks[PASS_MAX];
+  size_t walk_count;
+} pass_manager_t;
+
+void pass_register(pass_manager_t pm[const static 1], const pass_t pass);
+void pass_manager_run(arena_t arena[const static 1], pass_manager_t pm[const static 1], ast_node_t program[const static 1]);
+
+typedef struct pass_stream_t pass_stream_t;
+
+/**
+ * Runs the passes over a program one top level statement at a time as the statements get parsed, e.g., by
+ * pipeline.c, instead of over the whole program at once. Every statement gets a single traversal fused from
+ * all passes and the program list itself isn't visited, so it only works for passes without a barrier.
+ * The stats add up over the statements as a single walk.
+ */
+bool pass_manager_can_stream(const pass_manager_t pm[const static 1]);
+pass_stream_t *pass_stream_begin(arena_t arena[const static 1], pass_manager_t pm[const static 1]);
+void pass_stream_run(arena_t arena[const static 1], pass_stream_t *stream, ast_node_t statement[const static 1]);
+
+// prints the time taken by each pass and traversal of the last run to stderr
+void pass_manager_report(const pass_manager_t pm[const static 1]);
+
+// problem an analysis found in the program, at points into the source so it can be reported like a parse error
+typedef struct {
+  sv_t at;
+  const char *msg;
+} pass_error_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  pass_error_t *items;
+} pass_errors_t;
+
+// adds an error with a printf formatted message, kept in the arena
+__attribute__((format(printf, 4, 5)))
+void pass_error(arena_t arena[const static 1], pass_errors_t errors[const static 1], const sv_t at, const char *fmt, ...);
+// prints the errors to stderr as path:line:column: Error: msg, returns their number
+size_t pass_errors_report(const pass_errors_t errors[const static 1], const char path[const static 1], const char source[const static 1]);
+
+#endif // PASSES_H_
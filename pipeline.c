@@ -0,0 +1,327 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "./zdx_util.h"
+#include "./ll1_parser.h"
+#include "./pipeline.h"
+
+static inline uint64_t now_ns(void)
+{
+  struct timespec ts = {0};
+  timespec_get(&ts, TIME_UTC);
+
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// ------------------------------------ RING ------------------------------------
+
+#define PIPELINE_CACHE_LINE 64
+#define PIPELINE_SPINS 64 // before a waiting stage yields its core
+
+/**
+ * Bounded single producer single consumer queue of fixed size slots. The producer fills the slot at tail in
+ * place and publishes it by moving tail, the consumer reads the slot at head in place and hands it back by
+ * moving head. Each index is only written by one side, so a release store of it paired with an acquire load
+ * on the other side is all the synchronization there is. Each side keeps a copy of the other's index and only
+ * reloads it when the copy says the ring is full or empty, which keeps the two cache lines from bouncing.
+ */
+typedef struct {
+  _Alignas(PIPELINE_CACHE_LINE) _Atomic size_t head;
+  size_t tail_copy; // consumer's copy of tail
+
+  _Alignas(PIPELINE_CACHE_LINE) _Atomic size_t tail;
+  size_t head_copy; // producer's copy of head
+
+  _Alignas(PIPELINE_CACHE_LINE) _Atomic bool closed; // set by the producer after publishing its last slot
+  size_t mask; // slot count - 1
+  size_t slot_size;
+  unsigned char *slots;
+} spsc_ring_t;
+
+static void ring_init(arena_t arena[const static 1], spsc_ring_t ring[const static 1], const size_t slots, const size_t slot_size)
+{
+  assertm(slots > 0 && (slots & (slots - 1)) == 0, "Expected: a power of 2 ring slots, Received: %zu", slots);
+
+  ring->mask = slots - 1;
+  ring->slot_size = slot_size;
+  ring->slots = arena_calloc(arena, slots, slot_size);
+  assertm(!arena->err, "Expected: ring alloc to succeed, Received: %s", arena->err);
+}
+
+static inline void ring_wait(size_t spins[const static 1])
+{
+  if (++*spins > PIPELINE_SPINS) {
+    sched_yield();
+  }
+}
+
+// waits for a free slot, returns NULL instead if cancel gets set while waiting
+static void *ring_reserve(spsc_ring_t ring[const static 1], const _Atomic bool *cancel, size_t waits[const static 1])
+{
+  const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  size_t spins = 0;
+
+  while (tail - ring->head_copy > ring->mask) {
+    ring->head_copy = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (tail - ring->head_copy <= ring->mask) {
+      break;
+    }
+
+    if (cancel && atomic_load_explicit(cancel, memory_order_relaxed)) {
+      return NULL;
+    }
+
+    *waits += spins == 0;
+    ring_wait(&spins);
+  }
+
+  return ring->slots + (tail & ring->mask) * ring->slot_size;
+}
+
+static inline void ring_publish(spsc_ring_t ring[const static 1])
+{
+  const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+static inline void ring_close(spsc_ring_t ring[const static 1])
+{
+  atomic_store_explicit(&ring->closed, true, memory_order_release);
+}
+
+// waits for a published slot, returns NULL once the ring is closed and empty
+static void *ring_peek(spsc_ring_t ring[const static 1], size_t waits[const static 1])
+{
+  const size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  size_t spins = 0;
+
+  while (head == ring->tail_copy) {
+    // closed is read first so that a tail read after it has every slot published before closing
+    const bool closed = atomic_load_explicit(&ring->closed, memory_order_acquire);
+    ring->tail_copy = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head != ring->tail_copy) {
+      break;
+    }
+
+    if (closed) {
+      return NULL;
+    }
+
+    *waits += spins == 0;
+    ring_wait(&spins);
+  }
+
+  return ring->slots + (head & ring->mask) * ring->slot_size;
+}
+
+static inline void ring_release(spsc_ring_t ring[const static 1])
+{
+  const size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+// ------------------------------------ STAGES ------------------------------------
+
+typedef struct {
+  size_t length;
+  ll1_token_t items[PIPELINE_TOKEN_BATCH];
+} token_batch_t;
+
+typedef struct {
+  spsc_ring_t tokens; // token_batch_t from the lexer to the parser
+  spsc_ring_t statements; // ast_node_t from the parser to the passes
+  _Atomic bool parser_done; // the lexer stops once nothing reads its tokens anymore
+
+  sv_t input;
+  arena_t *parser_arena;
+  parser_opts_t opts;
+  ast_node_t parse_result;
+
+  // the parser's place in the token batch it's reading
+  token_batch_t *batch;
+  size_t batch_next;
+  ll1_token_t last; // the END, repeated once the tokens ran out
+
+  // each stage only counts in its own fields, they are read once the threads are joined
+  size_t token_count;
+  size_t statement_count;
+  size_t lexer_waits;
+  size_t parser_waits;
+} pipeline_ctx_t;
+
+static void *lexer_stage(void *arg)
+{
+  pipeline_ctx_t *ctx = arg;
+  lexer_t lexer = { .input = &ctx->input };
+  bool ended = false;
+
+  while (!ended) {
+    token_batch_t *batch = ring_reserve(&ctx->tokens, &ctx->parser_done, &ctx->lexer_waits);
+
+    if (batch == NULL) {
+      break;
+    }
+
+    batch->length = 0;
+
+    // the parser stops at an unknown token so there is no point lexing past one
+    while (batch->length < PIPELINE_TOKEN_BATCH && !ended) {
+      ll1_token_t *token = &batch->items[batch->length++];
+      ll1_lex(&lexer, token);
+      ended = token->token.kind == TOKEN_KIND_END || token->token.kind == TOKEN_KIND_UNKNOWN;
+    }
+
+    ctx->token_count += batch->length;
+    ring_publish(&ctx->tokens);
+  }
+
+  ring_close(&ctx->tokens);
+
+  return NULL;
+}
+
+static void next_token(void *arg, ll1_token_t token[const static 1])
+{
+  pipeline_ctx_t *ctx = arg;
+  spsc_ring_t *tokens = &ctx->tokens;
+
+  if (ctx->batch && ctx->batch_next == ctx->batch->length) {
+    ring_release(tokens);
+    ctx->batch = NULL;
+  }
+
+  if (ctx->batch == NULL) {
+    ctx->batch = ring_peek(tokens, &ctx->parser_waits);
+    ctx->batch_next = 0;
+
+    if (ctx->batch == NULL) {
+      *token = ctx->last;
+      return;
+    }
+  }
+
+  *token = ctx->batch->items[ctx->batch_next++];
+  ctx->last = *token;
+}
+
+static void push_statement(void *arg, const ast_node_t statement)
+{
+  pipeline_ctx_t *ctx = arg;
+  // the passes drain every statement, so waiting for them never needs cancelling
+  ast_node_t *slot = ring_reserve(&ctx->statements, NULL, &ctx->parser_waits);
+
+  *slot = statement;
+  ring_publish(&ctx->statements);
+  ctx->statement_count++;
+}
+
+static void *parser_stage(void *arg)
+{
+  pipeline_ctx_t *ctx = arg;
+
+  ctx->parse_result = ll1_parse_stream(ctx->parser_arena, next_token, ctx, push_statement, ctx, &ctx->opts);
+  atomic_store_explicit(&ctx->parser_done, true, memory_order_relaxed);
+  ring_close(&ctx->statements);
+
+  return NULL;
+}
+
+// ------------------------------------ PIPELINE ------------------------------------
+
+pipeline_t pipeline_run(arena_t arena[const static 1], const char source[const static 1], const size_t source_length,
+                        const parser_opts_t opts[const static 1], pass_manager_t passes[const static 1])
+{
+  const uint64_t start = now_ns();
+  pipeline_t pipeline = {
+    .program = { .kind = AST_NODE_KIND_LIST },
+    .parser_arena = arena_create(PIPELINE_PARSER_ARENA_MIN_SIZE + source_length * PIPELINE_PARSER_ARENA_BYTES_PER_SOURCE_BYTE),
+  };
+
+  if (pipeline.parser_arena.err) {
+    pipeline.err = pipeline.parser_arena.err;
+    return pipeline;
+  }
+
+  pipeline_ctx_t ctx = {
+    .input = sv_from_buf(source, source_length),
+    .parser_arena = &pipeline.parser_arena,
+    .opts = *opts,
+  };
+
+  // allocated before the parser thread starts to allocate from the same arena
+  ring_init(&pipeline.parser_arena, &ctx.tokens, PIPELINE_TOKEN_SLOTS, sizeof(token_batch_t));
+  ring_init(&pipeline.parser_arena, &ctx.statements, PIPELINE_STATEMENT_SLOTS, sizeof(ast_node_t));
+
+  pthread_t lexer_thread = {0};
+  pthread_t parser_thread = {0};
+
+  if (pthread_create(&lexer_thread, NULL, lexer_stage, &ctx) != 0) {
+    pipeline.err = "Could not start the lexer thread";
+    return pipeline;
+  }
+
+  if (pthread_create(&parser_thread, NULL, parser_stage, &ctx) != 0) {
+    atomic_store_explicit(&ctx.parser_done, true, memory_order_relaxed);
+    pthread_join(lexer_thread, NULL);
+    pipeline.err = "Could not start the parser thread";
+    return pipeline;
+  }
+
+  pass_stream_t *pass_stream = pass_manager_can_stream(passes) ? pass_stream_begin(arena, passes) : NULL;
+  ast_node_list_t *statements = NULL;
+
+  for (ast_node_t *slot = NULL; (slot = ring_peek(&ctx.statements, &pipeline.stats.pass_waits));) {
+    if (statements == NULL) {
+      statements = arena_calloc(arena, 1, sizeof(*statements));
+      assertm(!arena->err, "Expected: statement list alloc to succeed, Received: %s", arena->err);
+      pipeline.program.children = statements;
+    }
+
+    add_node(arena, statements, *slot);
+    ring_release(&ctx.statements);
+
+    if (pass_stream) {
+      pass_stream_run(arena, pass_stream, &statements->items[statements->length - 1]);
+    }
+  }
+
+  pthread_join(parser_thread, NULL);
+  pthread_join(lexer_thread, NULL);
+
+  // a failed parse returns a program with only its error, the statements before it were streamed
+  if (ctx.parse_result.children) {
+    if (statements == NULL) {
+      statements = arena_calloc(arena, 1, sizeof(*statements));
+      assertm(!arena->err, "Expected: statement list alloc to succeed, Received: %s", arena->err);
+      pipeline.program.children = statements;
+    }
+
+    add_node(arena, statements, ctx.parse_result.children->items[ctx.parse_result.children->length - 1]);
+  } else if (pass_stream == NULL) {
+    pass_manager_run(arena, passes, &pipeline.program);
+  }
+
+  pipeline.stats = (pipeline_stats_t){
+    .tokens = ctx.token_count,
+    .statements = ctx.statement_count,
+    .lexer_waits = ctx.lexer_waits,
+    .parser_waits = ctx.parser_waits,
+    .pass_waits = pipeline.stats.pass_waits,
+    .ns = now_ns() - start,
+  };
+
+  return pipeline;
+}
+
+void pipeline_free(pipeline_t pipeline[const static 1])
+{
+  if (pipeline->parser_arena.arena) {
+    arena_free(&pipeline->parser_arena);
+  }
+
+  *pipeline = (pipeline_t){0};
+}
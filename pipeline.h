@@ -0,0 +1,51 @@
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "./parser2.h"
+#include "./passes.h"
+
+#include "./zdx_simple_arena.h"
+
+#define PIPELINE_TOKEN_BATCH 256 // tokens the lexer hands to the parser at once
+#define PIPELINE_TOKEN_SLOTS 8 // batches the lexer can be ahead of the parser, a power of 2
+#define PIPELINE_STATEMENT_SLOTS 64 // statements the parser can be ahead of the passes, a power of 2
+// the parser thread has its own arena as arenas aren't thread safe, it only reserves address space until used
+#define PIPELINE_PARSER_ARENA_MIN_SIZE (1 MB)
+#define PIPELINE_PARSER_ARENA_BYTES_PER_SOURCE_BYTE 256
+
+typedef struct {
+  size_t tokens;
+  size_t statements;
+  // times a stage had to wait for the next one to catch up or for the one before to deliver
+  size_t lexer_waits; // token ring full
+  size_t parser_waits; // token ring empty or statement ring full
+  size_t pass_waits; // statement ring empty
+  uint64_t ns;
+} pipeline_stats_t;
+
+typedef struct {
+  ast_node_t program; // program list in the arena passed to pipeline_run(), its nodes are in parser_arena
+  arena_t parser_arena;
+  pipeline_stats_t stats;
+  const char *err; // set if the threads could not be started, program is empty then
+} pipeline_t;
+
+/**
+ * Parses source on three threads connected by bounded single producer single consumer rings: the lexer
+ * thread lexes batches of tokens, the parser thread parses them with the table-driven parser of ll1_parser.h
+ * and the calling thread runs the passes on each top level statement as soon as it's parsed, so all three
+ * work on different parts of the program at once.
+ *
+ * The program is the same as ll1_parse() returns, with a parse error as its last statement. The statements
+ * before a parse error have been through the passes already. Passes with a barrier need the whole program,
+ * so with one of those the passes run after the parse instead. opts is used like ll1_parse() does, its
+ * tables are only touched by the parser thread until pipeline_run() returns.
+ */
+pipeline_t pipeline_run(arena_t arena[const static 1], const char source[const static 1], const size_t source_length,
+                        const parser_opts_t opts[const static 1], pass_manager_t passes[const static 1]);
+void pipeline_free(pipeline_t pipeline[const static 1]);
+
+#endif // PIPELINE_H_
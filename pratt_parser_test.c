@@ -3,12 +3,32 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <ctype.h>
+#include <string.h>
 
 #include "./zdx_util.h"
 
+#ifdef PARSER_BENCH
+// parser_bench.c links this next to lexer.c and parser2.c which define the same names and
+// the string view implementation so everything here is kept local to this translation unit
+#include "./zdx_string_view.h"
+#include "./zdx_simple_arena.h"
+
+#define PRATT_API static inline
+
+static arena_t *pratt_bench_arena = NULL;
+static size_t pratt_bench_resets = 0;
+
+#define PRATT_ALLOC(sz) arena_alloc(pratt_bench_arena, (sz))
+#define PRATT_ON_RESET() (pratt_bench_resets++)
+#else
 #define ZDX_STRING_VIEW_IMPLEMENTATION
 #include "./zdx_string_view.h"
 
+#define PRATT_API
+#define PRATT_ALLOC(sz) malloc(sz)
+#define PRATT_ON_RESET()
+#endif
+
 typedef struct {
   sv_t input;
   size_t cursor;
@@ -89,14 +109,14 @@ typedef struct {
 } precedence_t;
 
 
-void indent(size_t depth)
+PRATT_API void indent(size_t depth)
 {
   while(depth--) {
     fprintf(stderr, "  ");
   }
 }
 
-void print_token(token_t token)
+PRATT_API void print_token(token_t token)
 {
   static const char *token_kind_to_str[] = {
     "TOKEN_KIND_UNKNOWN",
@@ -112,7 +132,7 @@ void print_token(token_t token)
   fprintf(stderr, "Token: kind %s, value "SV_FMT"\n", token_kind_to_str[token.kind], sv_fmt_args(token.value));
 }
 
-void print_node(node_t node, size_t depth)
+PRATT_API void print_node(node_t node, size_t depth)
 {
   static const char *node_kind_to_str[] = {
     "NODE_KIND_UNKNOWN",
@@ -171,12 +191,12 @@ void print_node(node_t node, size_t depth)
 }
 
 
-void reset_lexer(lexer_t *dst, const lexer_t *const src)
+PRATT_API void reset_lexer(lexer_t *dst, const lexer_t *const src)
 {
   *dst = *src;
 }
 
-token_t get_next_token(lexer_t lexer[const static 1])
+PRATT_API token_t get_next_token(lexer_t lexer[const static 1])
 {
   if (lexer->cursor >= lexer->input.length) {
     return (token_t){ .kind = TOKEN_KIND_END };
@@ -248,7 +268,7 @@ token_t get_next_token(lexer_t lexer[const static 1])
   assertm(false, "Unrecognized character: %c", lexer->input.buf[lexer->cursor]);
 }
 
-token_t peek_next_token(lexer_t lexer[const static 1])
+PRATT_API token_t peek_next_token(lexer_t lexer[const static 1])
 {
   lexer_t before = *lexer;
   token_t tok = get_next_token(lexer);
@@ -257,7 +277,7 @@ token_t peek_next_token(lexer_t lexer[const static 1])
   return tok;
 }
 
-node_t parse_literal(lexer_t lexer[const static 1])
+PRATT_API node_t parse_literal(lexer_t lexer[const static 1])
 {
   token_t token = peek_next_token(lexer);
 
@@ -282,9 +302,9 @@ node_t parse_literal(lexer_t lexer[const static 1])
 }
 
 // fwd declaration for use below
-node_t parse_expr(lexer_t lexer[const static 1], uint8_t parser_choice);
+PRATT_API node_t parse_expr(lexer_t lexer[const static 1], uint8_t parser_choice);
 
-node_t parse_parenthesized_expr(lexer_t lexer[const static 1])
+PRATT_API node_t parse_parenthesized_expr(lexer_t lexer[const static 1])
 {
   token_t token = peek_next_token(lexer);
 
@@ -335,7 +355,7 @@ static inline precedence_t get_infix_precedence(token_t op)
 }
 
 // precedence climbing for math binary ops via a pratt parser
-node_t pratt_parser_expr(lexer_t lexer[const static 1], uint8_t min_precedence, uint8_t parser_choice)
+PRATT_API node_t pratt_parser_expr(lexer_t lexer[const static 1], uint8_t min_precedence, uint8_t parser_choice)
 {
   node_t lhs = parse_expr(lexer, parser_choice + 1);
 
@@ -394,9 +414,9 @@ node_t pratt_parser_expr(lexer_t lexer[const static 1], uint8_t min_precedence,
       return rhs;
     }
 
-    node_t *p_lhs = malloc(sizeof(*p_lhs));
+    node_t *p_lhs = PRATT_ALLOC(sizeof(*p_lhs));
     memcpy(p_lhs, &lhs, sizeof(lhs));
-    node_t *p_rhs = malloc(sizeof(*p_rhs));
+    node_t *p_rhs = PRATT_ALLOC(sizeof(*p_rhs));
     memcpy(p_rhs, &rhs, sizeof(rhs));
 
     node_t binop_node = {
@@ -414,7 +434,7 @@ node_t pratt_parser_expr(lexer_t lexer[const static 1], uint8_t min_precedence,
   return lhs;
 }
 
-node_t parse_expr(lexer_t lexer[const static 1], uint8_t parser_choice)
+PRATT_API node_t parse_expr(lexer_t lexer[const static 1], uint8_t parser_choice)
 {
   node_t node = {0};
   lexer_t before = *lexer;
@@ -443,6 +463,7 @@ node_t parse_expr(lexer_t lexer[const static 1], uint8_t parser_choice)
     if (node.kind == NODE_KIND_ERROR) {
       parser_choice++;
       reset_lexer(lexer, &before);
+      PRATT_ON_RESET();
       node = (node_t){0};
     } else {
       break;
@@ -452,7 +473,7 @@ node_t parse_expr(lexer_t lexer[const static 1], uint8_t parser_choice)
   return node;
 }
 
-node_t parse(const char* input)
+PRATT_API node_t parse(const char* input)
 {
   lexer_t lexer = {
     .input = sv_from_buf(input, strlen(input))
@@ -471,6 +492,25 @@ node_t parse(const char* input)
   return result;
 }
 
+#ifdef PARSER_BENCH
+static size_t count_nodes(const node_t node)
+{
+  return node.kind == NODE_KIND_BINOP ? 1 + count_nodes(*node.binop.left) + count_nodes(*node.binop.right) : 1;
+}
+
+// entry point for parser_bench.c, returns the number of nodes in the parsed
+// expression or 0 if it failed to parse
+size_t pratt_prototype_bench_parse(arena_t arena[const static 1], const char input[const static 1], size_t resets[const static 1])
+{
+  pratt_bench_arena = arena;
+  pratt_bench_resets = 0;
+
+  const node_t result = parse(input);
+  *resets = pratt_bench_resets;
+
+  return result.kind == NODE_KIND_ERROR ? 0 : count_nodes(result);
+}
+#else
 // gcc -O2 -g -std=c17 -Wall -Wdeprecated -Wpedantic -Wextra -o pratt_parser_test pratt_parser_test.c && ./pratt_parser_test
 int main(void)
 {
@@ -506,3 +546,4 @@ int main(void)
 
   return 0;
 }
+#endif // PARSER_BENCH
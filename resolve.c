@@ -0,0 +1,537 @@
+#include <string.h>
+
+#include "./zdx_util.h"
+#include "./resolve.h"
+
+#define RESOLVE_MIN_CAP 64
+#define RESOLVE_MAX_LOAD 0.75
+
+#define resolve_push(arena, list, item)                                                                    \
+  do {                                                                                                     \
+    if ((list)->length == (list)->capacity) {                                                              \
+      const size_t capacity = zdx_max((list)->capacity * 2, RESOLVE_MIN_CAP);                              \
+                                                                                                           \
+      (list)->items = arena_realloc((arena), (list)->items, (list)->capacity * sizeof(*(list)->items),     \
+                                    capacity * sizeof(*(list)->items));                                    \
+      assertm(!(arena)->err, "Expected: resolver list resize to be successful, Received: %s", (arena)->err); \
+      (list)->capacity = capacity;                                                                         \
+    }                                                                                                      \
+                                                                                                           \
+    (list)->items[(list)->length++] = (item);                                                              \
+  } while(0)
+
+// ------------------------------------ NAMES ------------------------------------
+
+static inline uint64_t name_hash(const sv_t name)
+{
+  uint64_t h = 0xcbf29ce484222325ULL;
+
+  for (size_t i = 0; i < name.length; i++) {
+    h = (h ^ (uint8_t)name.buf[i]) * 0x100000001b3ULL;
+  }
+
+  return h;
+}
+
+static inline bool is_live(const resolve_names_t names[const static 1], const resolve_name_t entry[const static 1])
+{
+  return entry->name.buf != NULL && entry->generation == names->generation;
+}
+
+// entries of older generations count as empty, there are no deletions within a generation
+static resolve_name_t *names_slot(const resolve_names_t names[const static 1], const sv_t name)
+{
+  const size_t mask = names->capacity - 1;
+
+  for (size_t i = (size_t)name_hash(name) & mask;; i = (i + 1) & mask) {
+    resolve_name_t *entry = &names->items[i];
+
+    if (!is_live(names, entry) || sv_eq_sv(entry->name, name)) {
+      return entry;
+    }
+  }
+}
+
+static resolve_name_t *names_find(const resolve_names_t names[const static 1], const sv_t name)
+{
+  if (names->length == 0) {
+    return NULL;
+  }
+
+  resolve_name_t *entry = names_slot(names, name);
+
+  return is_live(names, entry) ? entry : NULL;
+}
+
+static void names_grow(arena_t arena[const static 1], resolve_names_t names[const static 1])
+{
+  const resolve_names_t old = *names;
+
+  names->capacity = zdx_max(old.capacity * 2, RESOLVE_MIN_CAP);
+  names->items = arena_calloc(arena, names->capacity, sizeof(*names->items));
+  assertm(!arena->err, "Expected: resolver names alloc to succeed, Received: %s", arena->err);
+
+  for (size_t i = 0; i < old.capacity; i++) {
+    if (is_live(&old, &old.items[i])) {
+      *names_slot(names, old.items[i].name) = old.items[i];
+    }
+  }
+}
+
+static void names_set(arena_t arena[const static 1], resolve_names_t names[const static 1], const sv_t name, const uint32_t slot,
+                      const uint32_t declaration)
+{
+  if ((double)(names->length + 1) > (double)names->capacity * RESOLVE_MAX_LOAD) {
+    names_grow(arena, names);
+  }
+
+  resolve_name_t *entry = names_slot(names, name);
+
+  if (!is_live(names, entry)) {
+    names->length++;
+  }
+
+  *entry = (resolve_name_t){ .name = name, .slot = slot, .declaration = declaration, .generation = names->generation };
+}
+
+static void names_clear(resolve_names_t names[const static 1])
+{
+  names->generation++;
+  names->length = 0;
+}
+
+// ------------------------------------ BINDING ------------------------------------
+
+typedef enum {
+  RESOLVE_CONTEXT_VALUE,
+  RESOLVE_CONTEXT_CALLEE,
+  RESOLVE_CONTEXT_MEMBER,
+} resolve_context_t;
+
+typedef struct {
+  uint8_t binding;
+  uint32_t slot;
+  uint32_t declaration;
+} resolve_binding_t;
+
+static uint32_t declare(resolver_t r[const static 1], const sv_t name, const type_t *type, const ast_function_t *function)
+{
+  resolve_push(r->arena, &r->declarations, ((resolve_declaration_t){ .name = name, .type = type, .function = function }));
+
+  return (uint32_t)r->declarations.length;
+}
+
+static resolve_binding_t lookup(resolver_t r[const static 1], const sv_t name, const resolve_context_t context)
+{
+  if (context == RESOLVE_CONTEXT_MEMBER) {
+    return (resolve_binding_t){ .binding = SYMBOL_BINDING_MEMBER };
+  }
+
+  const resolve_name_t *entry = r->function ? names_find(&r->locals, name) : NULL;
+
+  if (entry) {
+    return (resolve_binding_t){ .binding = SYMBOL_BINDING_LOCAL, .slot = entry->slot, .declaration = entry->declaration };
+  }
+
+  if ((entry = names_find(&r->globals, name))) {
+    return (resolve_binding_t){ .binding = SYMBOL_BINDING_GLOBAL, .slot = entry->slot, .declaration = entry->declaration };
+  }
+
+  if (context != RESOLVE_CONTEXT_CALLEE) {
+    return (resolve_binding_t){ .binding = SYMBOL_BINDING_UNDECLARED };
+  }
+
+  // implicitly declared like C89 did, the same name is always the same extern
+  if ((entry = names_find(&r->externs, name))) {
+    return (resolve_binding_t){ .binding = SYMBOL_BINDING_EXTERN, .slot = entry->slot };
+  }
+
+  const uint32_t slot = (uint32_t)r->extern_names.length;
+
+  names_set(r->arena, &r->externs, name, slot, 0);
+  resolve_push(r->arena, &r->extern_names, name);
+
+  return (resolve_binding_t){ .binding = SYMBOL_BINDING_EXTERN, .slot = slot };
+}
+
+static void bind_symbol(resolver_t r[const static 1], ast_node_t symbol[const static 1], const resolve_context_t context)
+{
+  const resolve_binding_t found = lookup(r, symbol->symbol.name, context);
+
+  symbol->symbol.binding = found.binding;
+  symbol->symbol.slot = found.slot;
+  symbol->symbol.declaration = found.declaration;
+
+  if (found.binding == SYMBOL_BINDING_UNDECLARED) {
+    pass_error(r->arena, r->errors, symbol->symbol.name, "Undeclared name '"SV_FMT"'", sv_fmt_args(symbol->symbol.name));
+  }
+}
+
+// ------------------------------------ SHARED SUBTREES ------------------------------------
+
+// hash-consed subtrees only have side-effect-free operators, literals and symbols in them
+static void push_children(resolver_t r[const static 1], ast_node_t node[const static 1])
+{
+  switch(node->kind) {
+    case AST_NODE_KIND_UNARY_OP: {
+      resolve_push(r->arena, &r->stack, ((resolve_item_t){ .node = node->unary_op.expr }));
+    } break;
+    case AST_NODE_KIND_BINARY_OP: {
+      const bool member = node->binary_op.kind == BINARY_OP_MEMBER || node->binary_op.kind == BINARY_OP_PTR_MEMBER;
+
+      resolve_push(r->arena, &r->stack, ((resolve_item_t){ .node = node->binary_op.lhs }));
+      resolve_push(r->arena, &r->stack, ((resolve_item_t){
+            .node = node->binary_op.rhs,
+            .context = member ? RESOLVE_CONTEXT_MEMBER : RESOLVE_CONTEXT_VALUE,
+          }));
+    } break;
+    case AST_NODE_KIND_TERNARY: {
+      resolve_push(r->arena, &r->stack, ((resolve_item_t){ .node = node->ternary.cond }));
+      resolve_push(r->arena, &r->stack, ((resolve_item_t){ .node = node->ternary.then_expr }));
+      resolve_push(r->arena, &r->stack, ((resolve_item_t){ .node = node->ternary.else_expr }));
+    } break;
+    default: break;
+  }
+}
+
+// true if no symbol of the subtree refers to another declaration than it would here
+static bool bindings_match(resolver_t r[const static 1], ast_node_t root[const static 1], const resolve_context_t context)
+{
+  r->stack.length = 0;
+  resolve_push(r->arena, &r->stack, ((resolve_item_t){ .node = root, .context = context }));
+
+  while (r->stack.length > 0) {
+    const resolve_item_t item = r->stack.items[--r->stack.length];
+
+    if (item.node->kind == AST_NODE_KIND_SYMBOL) {
+      if (item.node->symbol.binding != SYMBOL_BINDING_NONE) {
+        const resolve_binding_t found = lookup(r, item.node->symbol.name, item.context);
+
+        if (found.binding != item.node->symbol.binding || found.slot != item.node->symbol.slot ||
+            found.declaration != item.node->symbol.declaration) {
+          return false;
+        }
+      }
+    } else {
+      push_children(r, item.node);
+    }
+  }
+
+  return true;
+}
+
+static void bind_unbound(resolver_t r[const static 1], ast_node_t root[const static 1], const resolve_context_t context)
+{
+  r->stack.length = 0;
+  resolve_push(r->arena, &r->stack, ((resolve_item_t){ .node = root, .context = context }));
+
+  while (r->stack.length > 0) {
+    const resolve_item_t item = r->stack.items[--r->stack.length];
+
+    if (item.node->kind == AST_NODE_KIND_SYMBOL) {
+      if (item.node->symbol.binding == SYMBOL_BINDING_NONE) {
+        bind_symbol(r, item.node, item.context);
+      }
+    } else {
+      push_children(r, item.node);
+    }
+  }
+}
+
+// a copy is a new expression to the passes after this one too, so it's without their conversions and types
+static ast_node_t *copy_node(resolver_t r[const static 1], const ast_node_t *node)
+{
+  while (node->kind == AST_NODE_KIND_UNARY_OP && node->unary_op.kind == UNARY_OP_CONVERT) {
+    node = node->unary_op.expr;
+  }
+
+  ast_node_t *copy = arena_alloc(r->arena, sizeof(*copy));
+  assertm(!r->arena->err, "Expected: node alloc to succeed, Received: %s", r->arena->err);
+  *copy = *node;
+  copy->shared = false;
+  copy->type = TYPE_NO_ID;
+
+  if (copy->kind == AST_NODE_KIND_SYMBOL) {
+    copy->symbol.binding = SYMBOL_BINDING_NONE;
+  }
+
+  return copy;
+}
+
+// copies with a single parent, which get their own bindings
+static ast_node_t *unshare(resolver_t r[const static 1], const ast_node_t root[const static 1])
+{
+  ast_node_t *copy = copy_node(r, root);
+
+  r->stack.length = 0;
+  resolve_push(r->arena, &r->stack, ((resolve_item_t){ .node = copy }));
+
+  while (r->stack.length > 0) {
+    ast_node_t *node = r->stack.items[--r->stack.length].node;
+    ast_node_t **children[3] = {0};
+
+    switch(node->kind) {
+      case AST_NODE_KIND_UNARY_OP: children[0] = &node->unary_op.expr; break;
+      case AST_NODE_KIND_BINARY_OP: {
+        children[0] = &node->binary_op.lhs;
+        children[1] = &node->binary_op.rhs;
+      } break;
+      case AST_NODE_KIND_TERNARY: {
+        children[0] = &node->ternary.cond;
+        children[1] = &node->ternary.then_expr;
+        children[2] = &node->ternary.else_expr;
+      } break;
+      default: break;
+    }
+
+    for (size_t i = 0; i < zdx_arr_len(children) && children[i]; i++) {
+      *children[i] = copy_node(r, *children[i]);
+      resolve_push(r->arena, &r->stack, ((resolve_item_t){ .node = *children[i] }));
+    }
+  }
+
+  return copy;
+}
+
+// Binds the symbols a child pointer of a node with a single parent leads to. A shared child is bound in
+// place if that doesn't change what any of its other parents see, otherwise this parent gets a copy
+static void resolve_child(resolver_t r[const static 1], ast_node_t *child[const static 1], const resolve_context_t context)
+{
+  if ((*child)->shared) {
+    if (!bindings_match(r, *child, context)) {
+      *child = unshare(r, *child);
+    }
+
+    bind_unbound(r, *child, context);
+  } else if ((*child)->kind == AST_NODE_KIND_SYMBOL && context != RESOLVE_CONTEXT_VALUE) {
+    bind_symbol(r, *child, context);
+  }
+}
+
+// list items are values and thus have a single parent, even if they were copied from a shared node
+static void unshare_items(ast_node_list_t *items)
+{
+  for (size_t i = 0; items && i < items->length; i++) {
+    items->items[i].shared = false;
+  }
+}
+
+// ------------------------------------ CALLBACKS ------------------------------------
+
+// symbols with a single parent and a value context, the others are bound by their parents
+static void resolve_symbol(void *ctx, ast_node_t node[const static 1])
+{
+  resolver_t *r = ctx;
+
+  if (!node->shared && node->symbol.binding == SYMBOL_BINDING_NONE) {
+    bind_symbol(r, node, RESOLVE_CONTEXT_VALUE);
+  }
+}
+
+static void resolve_list(void *ctx, ast_node_t node[const static 1])
+{
+  (void)ctx;
+  unshare_items(node->children);
+}
+
+// a shared node was reached through a parent with a single parent that resolved all of it already
+static void resolve_unary_op(void *ctx, ast_node_t node[const static 1])
+{
+  if (!node->shared) {
+    resolve_child(ctx, &node->unary_op.expr, RESOLVE_CONTEXT_VALUE);
+  }
+}
+
+static void resolve_binary_op(void *ctx, ast_node_t node[const static 1])
+{
+  if (!node->shared) {
+    const bool member = node->binary_op.kind == BINARY_OP_MEMBER || node->binary_op.kind == BINARY_OP_PTR_MEMBER;
+
+    resolve_child(ctx, &node->binary_op.lhs, RESOLVE_CONTEXT_VALUE);
+    resolve_child(ctx, &node->binary_op.rhs, member ? RESOLVE_CONTEXT_MEMBER : RESOLVE_CONTEXT_VALUE);
+  }
+}
+
+static void resolve_ternary(void *ctx, ast_node_t node[const static 1])
+{
+  if (!node->shared) {
+    resolve_child(ctx, &node->ternary.cond, RESOLVE_CONTEXT_VALUE);
+    resolve_child(ctx, &node->ternary.then_expr, RESOLVE_CONTEXT_VALUE);
+    resolve_child(ctx, &node->ternary.else_expr, RESOLVE_CONTEXT_VALUE);
+  }
+}
+
+static void resolve_call(void *ctx, ast_node_t node[const static 1])
+{
+  resolver_t *r = ctx;
+
+  resolve_child(r, &node->call.callee, RESOLVE_CONTEXT_CALLEE);
+  unshare_items(node->call.args);
+
+  if (node->call.callee->kind == AST_NODE_KIND_SYMBOL && node->call.callee->symbol.binding == SYMBOL_BINDING_EXTERN) {
+    resolve_push(r->arena, &r->extern_calls, ((resolve_call_t){ .callee = node->call.callee, .args = node->call.args }));
+  }
+}
+
+static void resolve_return(void *ctx, ast_node_t node[const static 1])
+{
+  if (node->ret.expr) {
+    resolve_child(ctx, &node->ret.expr, RESOLVE_CONTEXT_VALUE);
+  }
+}
+
+// in scope from the end of its declarator, so before its initializer is resolved
+static void resolve_declaration(void *ctx, ast_node_t node[const static 1])
+{
+  resolver_t *r = ctx;
+  const sv_t name = node->declaration.name;
+
+  // the type name of a sizeof declares nothing, its empty name is where the name would be in the source unlike
+  // the missing name of an unnamed param, which still gets a slot for its argument
+  if (name.buf && name.length == 0) {
+    return;
+  }
+
+  if (r->prototype) {
+    // nothing can refer to them, they only have to be distinct
+    if (name.length > 0 && names_find(&r->params, name)) {
+      pass_error(r->arena, r->errors, name, "Redeclaration of '"SV_FMT"'", sv_fmt_args(name));
+    } else if (name.length > 0) {
+      names_set(r->arena, &r->params, name, (uint32_t)r->params.length, 0);
+    }
+  } else if (r->function) {
+    if (names_find(&r->locals, name)) {
+      pass_error(r->arena, r->errors, name, "Redeclaration of '"SV_FMT"'", sv_fmt_args(name));
+    }
+
+    names_set(r->arena, &r->locals, name, r->frame_size++, declare(r, name, node->declaration.type, NULL));
+  } else if (names_find(&r->globals, name) == NULL) {
+    names_set(r->arena, &r->globals, name, (uint32_t)r->global_names.length, declare(r, name, node->declaration.type, NULL));
+    resolve_push(r->arena, &r->global_names, name);
+  }
+
+  if (node->declaration.init) {
+    resolve_child(r, &node->declaration.init, RESOLVE_CONTEXT_VALUE);
+  }
+}
+
+// The calls made to name as an extern before it was declared call the global of slot now. Its extern slot is given
+// up and the externs after it move down one, so they stay numbered in order of first call
+static void rebind_extern_calls(resolver_t r[const static 1], const sv_t name, const uint32_t slot, const uint32_t declaration)
+{
+  const resolve_name_t *entry = names_find(&r->externs, name);
+
+  if (entry == NULL) {
+    return;
+  }
+
+  const uint32_t extern_slot = entry->slot;
+
+  r->extern_names.length--;
+  memmove(&r->extern_names.items[extern_slot], &r->extern_names.items[extern_slot + 1],
+          (r->extern_names.length - extern_slot) * sizeof(*r->extern_names.items));
+
+  // the table can't delete, so it's filled again with the names that are left
+  names_clear(&r->externs);
+
+  for (size_t i = 0; i < r->extern_names.length; i++) {
+    names_set(r->arena, &r->externs, r->extern_names.items[i], (uint32_t)i, 0);
+  }
+
+  // by name, as a shared callee is there once per call
+  size_t kept = 0;
+
+  for (size_t i = 0; i < r->extern_calls.length; i++) {
+    const resolve_call_t call = r->extern_calls.items[i];
+
+    if (sv_eq_sv(call.callee->symbol.name, name)) {
+      call.callee->symbol.binding = SYMBOL_BINDING_GLOBAL;
+      call.callee->symbol.slot = slot;
+      call.callee->symbol.declaration = declaration;
+      resolve_push(r->arena, &r->rebound, call);
+    } else {
+      const resolve_name_t *moved = names_find(&r->externs, call.callee->symbol.name);
+      assertm(moved, "Expected: the extern "SV_FMT" to keep a slot", sv_fmt_args(call.callee->symbol.name));
+
+      call.callee->symbol.slot = moved->slot;
+      r->extern_calls.items[kept++] = call;
+    }
+  }
+
+  r->extern_calls.length = kept;
+}
+
+// The name is in scope in the params and the body so that a function can call itself. A prototype in a body
+// declares the function without leaving the body, only its params are a scope of their own
+static void resolve_function_begin(void *ctx, ast_node_t node[const static 1])
+{
+  resolver_t *r = ctx;
+  ast_function_t *function = node->function;
+  const bool definition = function->body != NULL || function->body_source.length > 0;
+
+  if (names_find(&r->globals, function->name) == NULL) {
+    const uint32_t slot = (uint32_t)r->global_names.length;
+    const uint32_t declaration = declare(r, function->name, function->type, function);
+
+    names_set(r->arena, &r->globals, function->name, slot, declaration);
+    resolve_push(r->arena, &r->global_names, function->name);
+    rebind_extern_calls(r, function->name, slot, declaration);
+  }
+
+  if (!definition) {
+    r->prototype = function;
+    names_clear(&r->params);
+    return;
+  }
+
+  r->function = function;
+  r->frame_size = 0;
+  names_clear(&r->locals);
+  unshare_items(function->body);
+}
+
+static void resolve_function_end(void *ctx, ast_node_t node[const static 1])
+{
+  resolver_t *r = ctx;
+
+  if (r->prototype == node->function) {
+    r->prototype = NULL;
+    names_clear(&r->params);
+    return;
+  }
+
+  node->function->frame_size = r->frame_size;
+  r->function = NULL;
+  names_clear(&r->locals);
+}
+
+pass_t resolve_pass(resolver_t resolver[const static 1])
+{
+  assertm(resolver->arena && resolver->errors, "Expected: the resolver to have an arena and an error list");
+
+  return (pass_t){
+    .name = "resolve",
+    .ctx = resolver,
+    .pre = {
+      [AST_NODE_KIND_SYMBOL] = resolve_symbol,
+      [AST_NODE_KIND_LIST] = resolve_list,
+      [AST_NODE_KIND_UNARY_OP] = resolve_unary_op,
+      [AST_NODE_KIND_BINARY_OP] = resolve_binary_op,
+      [AST_NODE_KIND_TERNARY] = resolve_ternary,
+      [AST_NODE_KIND_CALL] = resolve_call,
+      [AST_NODE_KIND_RETURN] = resolve_return,
+      [AST_NODE_KIND_DECLARATION] = resolve_declaration,
+      [AST_NODE_KIND_FUNCTION] = resolve_function_begin,
+    },
+    .post = {
+      [AST_NODE_KIND_FUNCTION] = resolve_function_end,
+    },
+  };
+}
+
+uint32_t resolve_global_slot(const resolver_t resolver[const static 1], const sv_t name)
+{
+  const resolve_name_t *entry = names_find(&resolver->globals, name);
+
+  return entry ? entry->slot : RESOLVE_NO_SLOT;
+}
@@ -0,0 +1,117 @@
+#ifndef RESOLVE_H_
+#define RESOLVE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "./parser2.h"
+#include "./passes.h"
+
+#include "./zdx_simple_arena.h"
+
+typedef struct {
+  sv_t name;
+  uint32_t slot;
+  uint32_t declaration; // number in resolver_t.declarations, 0 for externs
+  uint32_t generation; // the entry is only in the table while this is the table's generation
+} resolve_name_t;
+
+// name to slot, emptied in O(1) by moving on to the next generation
+typedef struct {
+  size_t capacity;
+  size_t length;
+  resolve_name_t *items;
+  uint32_t generation;
+} resolve_names_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  sv_t *items;
+} resolve_slot_names_t;
+
+// what a symbol refers to, for passes that need more than its slot
+typedef struct {
+  sv_t name;
+  const type_t *type; // of a variable or the return type of a function
+  const ast_function_t *function; // NULL for variables
+} resolve_declaration_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  resolve_declaration_t *items; // declaration number n is items[n - 1]
+} resolve_declarations_t;
+
+typedef struct {
+  ast_node_t *node;
+  uint8_t context; // resolve_context_t of resolve.c
+} resolve_item_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  resolve_item_t *items;
+} resolve_items_t;
+
+// call to a callee that was bound as an extern, rebound if the program declares the name after all
+typedef struct {
+  ast_node_t *callee; // a symbol
+  ast_node_list_t *args;
+} resolve_call_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  resolve_call_t *items;
+} resolve_calls_t;
+
+typedef struct {
+  // the fields to set before registering the pass
+  arena_t *arena;
+  pass_errors_t *errors; // undeclared and redeclared names are added here
+
+  resolve_names_t globals;
+  resolve_names_t locals; // of the function being resolved
+  resolve_names_t externs;
+  resolve_slot_names_t global_names; // by slot
+  resolve_slot_names_t extern_names; // by slot, what an interpreter links the externs by
+  ast_function_t *function; // being resolved, NULL at file scope
+  uint32_t frame_size; // of function so far
+  const ast_function_t *prototype; // being resolved, its params are a scope of their own, NULL outside of one
+  resolve_names_t params; // of prototype, without slots
+  resolve_calls_t extern_calls; // in the order they were made
+  resolve_calls_t rebound; // extern_calls bound to a function declared after them, the type checker checks them
+  resolve_declarations_t declarations; // in the order they were made
+  resolve_items_t stack; // for walking hash-consed subtrees without recursion
+} resolver_t;
+
+/**
+ * Pass that binds every symbol to a slot (see symbol_binding_t), so that an interpreter loads a variable
+ * from its frame or the globals by index instead of looking up its name on every access. Scopes are C's
+ * for the subset parser2.c parses: a name is in scope from the end of its declarator, a function's params
+ * and locals share one scope that hides the globals, and redeclaring a local is an error. A callee that
+ * was never declared is an extern, so that printf and friends can be linked by name, any other undeclared
+ * name is an error. A function declared at file scope after it was called becomes the callee of the calls before
+ * it too, which are added to rebound, and gives up its extern slot. The params of a prototype, at
+ * file scope or in a body, are in a scope that ends with the prototype.
+ *
+ * Every declaration gets a number and every symbol the number of the declaration it refers to, so that a
+ * later pass, e.g., the type checker, can find out more about a symbol than its slot. A global keeps the
+ * number of its first declaration.
+ *
+ * Hash-consed subtrees are reached from every parent, they keep their bindings as long as every parent
+ * sees the same declarations, a parent in a scope where the names mean something else gets its own copy.
+ * So shared subtrees always mean the same thing and later passes can annotate them once.
+ *
+ * A function whose body a lazy parse skipped and nothing parsed since only has its params resolved, and its
+ * frame_size only counts them.
+ */
+pass_t resolve_pass(resolver_t resolver[const static 1]);
+
+#define RESOLVE_NO_SLOT UINT32_MAX
+
+// slot of a global variable or function once the pass ran, RESOLVE_NO_SLOT if the program never declares it
+uint32_t resolve_global_slot(const resolver_t resolver[const static 1], const sv_t name);
+
+#endif // RESOLVE_H_
@@ -0,0 +1,290 @@
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "./zdx_util.h"
+#include "./string_pool.h"
+
+// ------------------------------------ DECODING ------------------------------------
+
+static inline bool is_octal(const char c)
+{
+  return c >= '0' && c <= '7';
+}
+
+static inline int hex_value(const char c)
+{
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+
+  return c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+}
+
+// decodes the escape sequence of the backslash at literal.buf[*i] into c and moves *i to its last character
+static const char *decode_escape(const sv_t literal, size_t i[const static 1], char c[const static 1])
+{
+  if (++*i == literal.length) {
+    return "Escape sequence at the end of the string";
+  }
+
+  switch(literal.buf[*i]) {
+    case 'n': *c = '\n'; return NULL;
+    case 't': *c = '\t'; return NULL;
+    case 'r': *c = '\r'; return NULL;
+    case 'a': *c = '\a'; return NULL;
+    case 'b': *c = '\b'; return NULL;
+    case 'f': *c = '\f'; return NULL;
+    case 'v': *c = '\v'; return NULL;
+    case '\\':
+    case '\'':
+    case '"':
+    case '?': *c = literal.buf[*i]; return NULL;
+
+    case 'x': {
+      unsigned value = 0;
+      size_t digits = 0;
+
+      for (; *i + 1 < literal.length && hex_value(literal.buf[*i + 1]) >= 0; ++*i, digits++) {
+        value = value * 16 + (unsigned)hex_value(literal.buf[*i + 1]);
+
+        if (value > UCHAR_MAX) {
+          return "Hex escape sequence out of range";
+        }
+      }
+
+      *c = (char)value;
+      return digits == 0 ? "\\x used with no following hex digits" : NULL;
+    }
+
+    default: {
+      if (!is_octal(literal.buf[*i])) {
+        return "Unknown escape sequence";
+      }
+
+      unsigned value = (unsigned)(literal.buf[*i] - '0');
+
+      for (size_t digits = 1; digits < 3 && *i + 1 < literal.length && is_octal(literal.buf[*i + 1]); digits++) {
+        value = value * 8 + (unsigned)(literal.buf[++*i] - '0');
+      }
+
+      *c = (char)value;
+      return value > UCHAR_MAX ? "Octal escape sequence out of range" : NULL;
+    }
+  }
+}
+
+// the escapes of section 6.4.4.4 of the c17 standard, the length of the decoded text in out or NULL err
+static size_t decode(const sv_t literal, char out[const static 1], const char *err[const static 1])
+{
+  size_t length = 0;
+
+  // the runs between backslashes are found and copied by memchr() and memcpy(), which go through them a vector
+  // at a time rather than a character at a time, so a literal without escapes is one of each
+  for (size_t i = 0; i < literal.length; i++) {
+    const char *backslash = memchr(&literal.buf[i], '\\', literal.length - i);
+    const size_t run = backslash ? (size_t)(backslash - &literal.buf[i]) : literal.length - i;
+
+    memcpy(&out[length], &literal.buf[i], run);
+    length += run;
+    i += run;
+
+    if (backslash == NULL) {
+      break;
+    }
+
+    if ((*err = decode_escape(literal, &i, &out[length++]))) {
+      return 0;
+    }
+  }
+
+  return length;
+}
+
+// ------------------------------------ TABLES ------------------------------------
+
+static inline uint64_t hash_bytes(const char *buf, const size_t length)
+{
+  uint64_t h = 0xcbf29ce484222325ULL;
+
+  for (size_t i = 0; i < length; i++) {
+    h = (h ^ (uint8_t)buf[i]) * 0x100000001b3ULL;
+  }
+
+  return h;
+}
+
+// the slot of text in by_text, or the empty one it would go to
+static size_t text_slot(const string_pool_t pool[const static 1], const char *text, const size_t length)
+{
+  const size_t mask = pool->slot_count - 1;
+
+  for (size_t i = hash_bytes(text, length) & mask;; i = (i + 1) & mask) {
+    const uint32_t string = pool->by_text[i];
+
+    if (string == 0) {
+      return i;
+    }
+
+    const string_pool_entry_t *entry = &pool->strings[string - 1];
+
+    if (entry->length == length && memcmp(&pool->data[entry->offset], text, length) == 0) {
+      return i;
+    }
+  }
+}
+
+static size_t spelling_slot(const string_pool_t pool[const static 1], const sv_t raw)
+{
+  const size_t mask = pool->slot_count - 1;
+
+  for (size_t i = hash_bytes(raw.buf, raw.length) & mask;; i = (i + 1) & mask) {
+    const string_pool_spelling_t *spelling = &pool->by_spelling[i];
+
+    if (spelling->string == 0 || sv_eq_sv(spelling->raw, raw)) {
+      return i;
+    }
+  }
+}
+
+// both tables are rehashed into ones twice as large, the arena keeps the old ones
+static void grow_tables(arena_t arena[const static 1], string_pool_t pool[const static 1])
+{
+  const string_pool_spelling_t *spellings = pool->by_spelling;
+  const size_t slot_count = pool->slot_count;
+
+  pool->slot_count = slot_count ? slot_count * 2 : STRING_POOL_MIN_SLOTS;
+  pool->by_text = arena_calloc(arena, pool->slot_count, sizeof(*pool->by_text));
+  pool->by_spelling = arena_calloc(arena, pool->slot_count, sizeof(*pool->by_spelling));
+  assertm(!arena->err, "Expected: string pool tables alloc to succeed, Received: %s", arena->err);
+
+  for (size_t i = 0; i < pool->string_count; i++) {
+    const string_pool_entry_t *entry = &pool->strings[i];
+
+    pool->by_text[text_slot(pool, &pool->data[entry->offset], entry->length)] = (uint32_t)i + 1;
+  }
+
+  for (size_t i = 0; i < slot_count; i++) {
+    if (spellings[i].string != 0) {
+      pool->by_spelling[spelling_slot(pool, spellings[i].raw)] = spellings[i];
+    }
+  }
+}
+
+// room for at least more bytes after the strings
+static void reserve_data(arena_t arena[const static 1], string_pool_t pool[const static 1], const size_t more)
+{
+  if (pool->length + more <= pool->capacity) {
+    return;
+  }
+
+  const size_t capacity = zdx_max(pool->capacity * 2, pool->length + more);
+
+  pool->data = arena_realloc(arena, pool->data, pool->capacity, capacity);
+  assertm(!arena->err, "Expected: string pool data resize to succeed, Received: %s", arena->err);
+  pool->capacity = capacity;
+}
+
+// ------------------------------------ POOL ------------------------------------
+
+const char *string_pool_intern(arena_t arena[const static 1], string_pool_t pool[const static 1], const sv_t literal,
+                               string_pool_entry_t entry[const static 1])
+{
+  assertm(!pool->sealed, "Expected: strings to be added before the pool is sealed");
+
+  // half full tables keep probes short, there is at most a string per spelling so by_text is never fuller
+  if ((pool->spelling_count + 1) * 2 > pool->slot_count) {
+    grow_tables(arena, pool);
+  }
+
+  string_pool_spelling_t *spelling = &pool->by_spelling[spelling_slot(pool, literal)];
+
+  if (spelling->string != 0) {
+    *entry = pool->strings[spelling->string - 1];
+    return NULL;
+  }
+
+  // decoded past the end of the strings, where it stays if it's a new one, escapes never make a literal longer
+  const char *err = NULL;
+
+  reserve_data(arena, pool, literal.length + 1);
+
+  const size_t length = decode(literal, &pool->data[pool->length], &err);
+
+  if (err) {
+    return err;
+  }
+
+  assertm(pool->length + length + 1 <= UINT32_MAX, "Expected: string pool to fit 32 bit offsets, Received: %zu bytes",
+          pool->length + length + 1);
+
+  const size_t slot = text_slot(pool, &pool->data[pool->length], length);
+
+  if (pool->by_text[slot] == 0) {
+    if (pool->string_count == pool->string_capacity) {
+      const size_t capacity = zdx_max(pool->string_capacity * 2, (size_t)STRING_POOL_MIN_SLOTS);
+
+      pool->strings = arena_realloc(arena, pool->strings, pool->string_capacity * sizeof(*pool->strings),
+                                    capacity * sizeof(*pool->strings));
+      assertm(!arena->err, "Expected: string pool strings resize to succeed, Received: %s", arena->err);
+      pool->string_capacity = capacity;
+    }
+
+    pool->strings[pool->string_count++] = (string_pool_entry_t){ .offset = (uint32_t)pool->length, .length = (uint32_t)length };
+    pool->by_text[slot] = (uint32_t)pool->string_count;
+    pool->data[pool->length + length] = '\0';
+    pool->length += length + 1;
+  }
+
+  *spelling = (string_pool_spelling_t){ .raw = literal, .string = pool->by_text[slot] };
+  pool->spelling_count++;
+  *entry = pool->strings[spelling->string - 1];
+
+  return NULL;
+}
+
+const char *string_pool_at(const string_pool_t pool[const static 1], const uint32_t offset)
+{
+  assertm(offset < pool->length, "Expected: an offset of the pool, Received: %u of %zu bytes", offset, pool->length);
+
+  return &pool->data[offset];
+}
+
+void string_pool_seal(string_pool_t pool[const static 1])
+{
+  assertm(!pool->sealed, "Expected: the pool to be sealed once");
+  pool->sealed = true;
+
+  if (pool->length == 0) {
+    return;
+  }
+
+  const long page_size = sysconf(_SC_PAGESIZE);
+  const size_t page = page_size > 0 ? (size_t)page_size : 4096;
+  const size_t size = (pool->length + page - 1) / page * page;
+  char *segment = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+
+  assertm(segment != MAP_FAILED, "Expected: string pool segment mmap to succeed");
+  memcpy(segment, pool->data, pool->length);
+
+  const int err = mprotect(segment, size, PROT_READ);
+  assertm(err == 0, "Expected: string pool segment to be made read-only, Received: %d", err);
+
+  pool->data = segment;
+  pool->capacity = pool->length;
+  pool->segment_size = size;
+}
+
+void string_pool_free(string_pool_t pool[const static 1])
+{
+  if (pool->segment_size > 0) {
+    munmap(pool->data, pool->segment_size);
+  }
+
+  *pool = (string_pool_t){0};
+}
@@ -0,0 +1,61 @@
+#ifndef STRING_POOL_H_
+#define STRING_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "./zdx_simple_arena.h"
+#include "./zdx_string_view.h"
+
+// slots a table of the pool starts with, it doubles whenever it's half full
+#define STRING_POOL_MIN_SLOTS 64
+
+typedef struct {
+  uint32_t offset; // of its first character in string_pool_t.data
+  uint32_t length; // decoded, without the nul that ends it
+} string_pool_entry_t;
+
+// a literal as the source spells it, so that a spelling seen before is found without decoding it again
+typedef struct {
+  sv_t raw;
+  uint32_t string; // 1 + index in string_pool_t.strings, 0 for an empty slot
+} string_pool_spelling_t;
+
+/**
+ * String literals with their escapes decoded once, the way section 6.4.4.4 of the c17 standard has them, and
+ * every distinct string kept once, however it's spelled, e.g., "A" and "\x41" are the same string. The strings
+ * are laid out one after another in data, each followed by a nul, which is the data segment of the program:
+ * once sealed it's copied to memory of its own that is only readable, and a string literal is the address of
+ * its string in it. The tables are open addressing ones, keyed by the decoded text and by the spelling.
+ */
+typedef struct {
+  char *data;
+  size_t length;
+  size_t capacity;
+  string_pool_entry_t *strings;
+  size_t string_count;
+  size_t string_capacity;
+  uint32_t *by_text; // 1 + index in strings, 0 for an empty slot
+  string_pool_spelling_t *by_spelling;
+  size_t slot_count; // of each table, a power of two
+  size_t spelling_count;
+  size_t segment_size; // bytes mapped for data once sealed, 0 before
+  bool sealed;
+} string_pool_t;
+
+/**
+ * Finds the string of the contents of a string literal, as the source spells them, and adds it, decoded, if
+ * it's new. Returns why the literal can't be decoded, e.g., an unknown escape sequence, or NULL and the string
+ * in entry. Runs without a backslash are copied as is, a literal without any is a single copy.
+ */
+const char *string_pool_intern(arena_t arena[const static 1], string_pool_t pool[const static 1], const sv_t literal,
+                               string_pool_entry_t entry[const static 1]);
+// the nul terminated string at offset, its address in the read-only segment once the pool is sealed
+const char *string_pool_at(const string_pool_t pool[const static 1], const uint32_t offset);
+// moves data to memory of its own and makes it read-only, no string can be added after
+void string_pool_seal(string_pool_t pool[const static 1]);
+// unmaps the segment of a sealed pool, the rest is in the arena
+void string_pool_free(string_pool_t pool[const static 1]);
+
+#endif // STRING_POOL_H_
@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "./string_pool.h"
+
+#include "./zdx_util.h"
+
+#define ZDX_SIMPLE_ARENA_IMPLEMENTATION
+#include "./zdx_simple_arena.h"
+#define ZDX_STRING_VIEW_IMPLEMENTATION
+#include "./zdx_string_view.h"
+
+// the literal, spelled as in the source between its quotes, has to decode to the bytes of expected
+#define CHECK_DECODED(literal, expected) \
+  (failed += !check_decoded(&arena, &pool, literal, expected, sizeof(expected) - 1))
+#define CHECK_ERROR(literal, expected) (failed += !check_error(&arena, &pool, literal, expected))
+// both spellings have to be the same string
+#define CHECK_SAME(a, b) (failed += !check_same(&arena, &pool, a, b, true))
+#define CHECK_DISTINCT(a, b) (failed += !check_same(&arena, &pool, a, b, false))
+
+static void print_bytes(const char *bytes, const size_t length)
+{
+  for (size_t i = 0; i < length; i++) {
+    printf(" %02x", (unsigned char)bytes[i]);
+  }
+}
+
+static bool check_decoded(arena_t arena[const static 1], string_pool_t pool[const static 1], const char literal[const static 1],
+                          const char expected[const static 1], const size_t expected_length)
+{
+  string_pool_entry_t entry = {0};
+  const char *err = string_pool_intern(arena, pool, sv_from_cstr(literal), &entry);
+
+  if (err) {
+    printf("FAIL \"%s\": %s\n", literal, err);
+    return false;
+  }
+
+  const char *decoded = string_pool_at(pool, entry.offset);
+
+  if (entry.length != expected_length || memcmp(decoded, expected, expected_length) != 0 || decoded[entry.length] != '\0') {
+    printf("FAIL \"%s\": Expected:", literal);
+    print_bytes(expected, expected_length);
+    printf(", Received:");
+    print_bytes(decoded, entry.length);
+    printf("\n");
+    return false;
+  }
+
+  return true;
+}
+
+static bool check_error(arena_t arena[const static 1], string_pool_t pool[const static 1], const char literal[const static 1],
+                        const char expected[const static 1])
+{
+  string_pool_entry_t entry = {0};
+  const size_t length = pool->length;
+  const char *err = string_pool_intern(arena, pool, sv_from_cstr(literal), &entry);
+
+  if (err == NULL || strcmp(err, expected) != 0 || pool->length != length) {
+    printf("FAIL \"%s\": Expected: %s, Received: %s\n", literal, expected, err ? err : "no error");
+    return false;
+  }
+
+  return true;
+}
+
+static bool check_same(arena_t arena[const static 1], string_pool_t pool[const static 1], const char a[const static 1],
+                       const char b[const static 1], const bool same)
+{
+  string_pool_entry_t entry_a = {0};
+  string_pool_entry_t entry_b = {0};
+  const size_t string_count = pool->string_count;
+
+  if (string_pool_intern(arena, pool, sv_from_cstr(a), &entry_a) || string_pool_intern(arena, pool, sv_from_cstr(b), &entry_b)) {
+    printf("FAIL \"%s\" and \"%s\": Expected: both to decode\n", a, b);
+    return false;
+  }
+
+  if ((entry_a.offset == entry_b.offset) != same || (same && pool->string_count > string_count + 1)) {
+    printf("FAIL \"%s\" and \"%s\": Expected: %s strings, Received: @%u and @%u\n", a, b, same ? "the same" : "distinct",
+           entry_a.offset, entry_b.offset);
+    return false;
+  }
+
+  return true;
+}
+
+// gcc -O2 -g -std=c17 -D_DEFAULT_SOURCE -Wall -Wextra -o string_pool_test string_pool_test.c string_pool.c && ./string_pool_test
+int main(void)
+{
+  arena_t arena = arena_create(1 MB);
+  string_pool_t pool = {0};
+  size_t failed = 0;
+
+  // runs without backslashes are copied as they are
+  CHECK_DECODED("plain text", "plain text");
+  CHECK_DECODED("", "");
+
+  // the simple escapes
+  CHECK_DECODED("\\a\\b\\f\\n\\r\\t\\v", "\a\b\f\n\r\t\v");
+  CHECK_DECODED("\\\\\\'\\\"\\?", "\\'\"?");
+  CHECK_DECODED("tab\\tin the middle\\n", "tab\tin the middle\n");
+
+  // octal escapes take at most 3 digits, hex ones every hex digit that follows
+  CHECK_DECODED("\\0", "\0");
+  CHECK_DECODED("\\101\\1012", "AA2");
+  CHECK_DECODED("\\7\\77\\377", "\7\77\377");
+  CHECK_DECODED("\\x41\\x4a\\x4A\\x0041", "AJJA");
+  CHECK_DECODED("\\xff", "\xff");
+  CHECK_DECODED("ab\\0cd", "ab\0cd");
+
+  CHECK_ERROR("\\q", "Unknown escape sequence");
+  CHECK_ERROR("\\8", "Unknown escape sequence");
+  CHECK_ERROR("\\x", "\\x used with no following hex digits");
+  CHECK_ERROR("\\xg", "\\x used with no following hex digits");
+  CHECK_ERROR("\\x100", "Hex escape sequence out of range");
+  CHECK_ERROR("\\777", "Octal escape sequence out of range");
+  CHECK_ERROR("end\\", "Escape sequence at the end of the string");
+
+  // every distinct string is kept once, however it's spelled
+  CHECK_SAME("A", "\\x41");
+  CHECK_SAME("A\\tB", "\\101\\11B");
+  CHECK_SAME("same", "same");
+  CHECK_DISTINCT("A\\tB", "A\\\\tB");
+  CHECK_DISTINCT("ab\\0cd", "ab");
+
+  // past the tables' first size, which they double from, every string is still found
+  char spellings[3000][8];
+
+  for (size_t i = 0; i < 5000; i++) {
+    snprintf(spellings[i % 3000], sizeof(spellings[i % 3000]), "s%zu", i % 3000);
+
+    string_pool_entry_t entry = {0};
+    string_pool_intern(&arena, &pool, sv_from_cstr(spellings[i % 3000]), &entry);
+
+    if (strcmp(string_pool_at(&pool, entry.offset), spellings[i % 3000]) != 0) {
+      printf("FAIL \"%s\": Expected: to be found, Received: \"%s\"\n", spellings[i % 3000], string_pool_at(&pool, entry.offset));
+      failed++;
+      break;
+    }
+  }
+
+  const size_t string_count = pool.string_count;
+
+  string_pool_seal(&pool);
+
+  if (pool.string_count != string_count || strcmp(string_pool_at(&pool, 0), "plain text") != 0) {
+    printf("FAIL sealing: Expected: the same strings in the read-only segment\n");
+    failed++;
+  }
+
+  string_pool_free(&pool);
+  arena_free(&arena);
+
+  if (failed > 0) {
+    printf("%zu failed\n", failed);
+    return 1;
+  }
+
+  printf("All passed\n");
+  return 0;
+}
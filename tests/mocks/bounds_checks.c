@@ -0,0 +1,8 @@
+// run: --dump-ir
+// run: --dump-ir --no-opt=bounds-checks
+// the bytes of x read with an index whose range keeps them inside x need no check, guarded by a branch, masked or
+// reduced, b[i % 9] may be past it and p[i] can't be proven, but its second read was checked by the first
+int bytes(unsigned int i, int *p) {
+  long x = 7; void *v = &x; unsigned char *b = v;
+  return (i < 8 ? b[i] : b[i & 7]) + (i >= 2 && i <= 5 ? b[i + 2] : b[i % 9]) + p[i] + p[i];
+}
@@ -0,0 +1,3 @@
+// the specifiers are checked as they're parsed, unsigned can't go with double
+int a;
+unsigned double b;
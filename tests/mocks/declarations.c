@@ -0,0 +1,19 @@
+// declarations with their specifiers, qualifiers, pointers and initializers, each with the interned type of its name
+int a;
+unsigned int b = 4294967295;
+long long c = 100;
+unsigned long d;
+short int e;
+long int f;
+const char *s = "declared";
+char *const t = 0;
+int **const *pp = 0;
+static int u = 1;
+extern int v;
+signed char h;
+unsigned char i = 255;
+_Bool j = 1;
+double k;
+long double l;
+float m;
+unsigned n = -1;
@@ -0,0 +1,8 @@
+// run:
+// run: --max-expr-depth=64
+// the iterative parser keeps its operators and operands on arena stacks rather than the C stack, so nesting
+// 200 deep parses, --max-expr-depth=64 makes it an error
+int x;
+((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((((x))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))));
+x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x * x;
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - x;
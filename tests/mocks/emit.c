@@ -0,0 +1,7 @@
+// run:
+// run: --emit=json
+// the same tree dumped as text and as JSON
+const char *s = "dumped \"quoted\"";
+int n = 100;
+n = n * 2 + sizeof(*s);
+-n ? s : 0;
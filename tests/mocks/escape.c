@@ -0,0 +1,6 @@
+// run: --dump-ir
+// a local whose address is only loaded and stored through stays an SSA value, one whose address escapes is a slot
+int *kept;
+int stays(int x) { int *p = &x; *p += 1; return x; }
+int escapes(int x) { kept = &x; return x; }
+int passed(int x) { int y = x; use(&y); return y; }
@@ -17,7 +17,7 @@ test
 (    "omg", 123, * test, & omg, **test, "some other '\"string\"'")
 // test "string"
 (100, 20, "test \"string\"")
-// TODO(mudit): Do AST optimization wherein nodes with no context such as 100 + 10 here can be nuked from the tree safely
+// nodes with no context such as 100 + 10 here are folded into literals, see fold.h
 (100 + 10, 20 * 200)
 
 100 + 10
@@ -31,7 +31,7 @@ test
 // 275
 (100 + 10) / 2 * 5
 (100 + 10) / (2 * 5)
-// TODO(mudit): should this be a parse error or runtime error?
+// neither, it's pointer arithmetic typed char *
 120 + "multi word string"
 // // 1
 // 100 / add(10, 90)
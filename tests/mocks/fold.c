@@ -0,0 +1,20 @@
+// integer expressions of constants become literals of their value in the type of the expression
+int x;
+unsigned u;
+(100 + 10) / 2 * 5;
+1 << 10 | 3;
+-7 / 2 + -7 % 2;
+4294967295 + 1;
+10 > 3 && 2 < 1;
+1 ? 20 : 30;
+~0 ^ 5;
+// identities keep the other operand
+x + 0;
+x * 1;
+0 + x * 1 - 0;
+u | 0;
+// undefined at runtime, left as is
+2147483647 + 1;
+1 / 0;
+5 % 0;
+1 << 40;
@@ -0,0 +1,7 @@
+// a call before the declaration of its callee is checked as one to int name(), which the declaration has to agree
+// with, and the params of a prototype have to be distinct
+int g(int x) { return wide(x) + two(x) + three(x, x); }
+long wide(int y) { return y; }
+int two(int a, int b) { return a + b; }
+int three(int a, int *p);
+int both(int a, int a);
@@ -0,0 +1,7 @@
+// run: --dump-ir --inline-report
+// later and twice are defined after the calls to them, which call them and not externs named like them, puts and
+// putchar keep the extern slots 0 and 1
+int g(int x) { return puts(x) + later(x) + twice(x, 1) + putchar(x); }
+int later(int y) { return y * 2; }
+int twice(int a, int b) { return a * 2 + b; }
+int h(int x) { return putchar(x) + later(x); }
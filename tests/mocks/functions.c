@@ -0,0 +1,16 @@
+// run: --dump-ir
+// function definitions and declarations, with their params, locals, returns and the calls between them, an empty
+// body is lowered like any other
+int declared(int a, long b);
+void nothing(void) { }
+void early(int x) { return; }
+static int helper(int x) { return x * 2; }
+const char *name(void) { return "name"; }
+int *first(int *items, unsigned long count) { return items; }
+long nested(int a, int b, int c) {
+  int sum = helper(a) + helper(b);
+  long total = sum * c;
+  nothing();
+  return total + declared(sum, total) + *first(&a, 1);
+}
+int counter(void) { static int count = 0; count += 1; return count; }
@@ -0,0 +1,11 @@
+// run:
+// run: --hash-cons
+// the repeated names and literals are shared by --hash-cons, each error is still reported where it is
+const int c = 100;
+c = 200;
+c = 200;
+x + 1;
+(x + 1) * 2;
+y = x + 1;
+"s" * 3;
+"s" * 3;
@@ -0,0 +1,7 @@
+// run: --dump-ir --inline-report
+// run: --dump-ir --no-opt=sccp --no-opt=dce
+// f is inlined into g, with sccp and dce off f still has the unreachable block after its return
+int f(int x){ return x; }
+int g(int y){ int a = f(y); return a; }
+// 7, through both calls
+int h(int z){ return g(z) + 2; }
@@ -0,0 +1,14 @@
+// run: --inline-report
+// small callees are inlined, callees first, the report says why the other calls are kept
+int sq(int x) { return x * x; }
+int quad(int x) { return sq(sq(x)); }
+int fact(int n) { return n > 1 ? n * fact(n - 1) : 1; }
+int big(int x) {
+  int a = x * 3 + 1; int b = a * a - x; int c = b / 7 + a; int d = c * c + b * a; int e = d - c + b - a;
+  int f = e * e + d * 2; int g = f / 3 + e; int h = g * g + f - e + d * c; int i = h * h - g * f + e / 3;
+  int j = i * 5 + h * 3 - g; int k = j * j + i * h;
+  return k * j + i - h * g;
+}
+int counter(int x) { static int count = 0; count += x; return count; }
+int declared(int x);
+int main(int argc) { return quad(argc) + fact(argc) + big(argc) + counter(argc) + declared(argc) + puts(argc); }
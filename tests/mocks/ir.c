@@ -0,0 +1,8 @@
+// run: --dump-ir
+// each-opt
+// the IR with every optimization left out and with each one alone, sccp folds the branch of a constant condition,
+// copy propagation forwards b, dse drops the store overwritten before it's read and dce the unused values
+int g;
+int consts(int x) { int a = 2 * 3; int b = x; int unused = x * 7; return a > 5 ? b + a : b - a; }
+int stores(int x) { g = 1; g = x; return g; }
+int logic(int x, int y) { return x > 0 && y > 0 ? x : y; }
@@ -0,0 +1,6 @@
+// run: --dump-ir
+// run: --lazy-bodies --dump-ir
+// the IR needs every body, so a lazy parse parses the ones it skipped before the passes run and prints the same IR
+typedef int t;
+int sq(t x) { t y = x; return y * x; }
+int f(int y) { return sq(y) + 1; }
@@ -0,0 +1,8 @@
+// run: --lazy-bodies
+// run: --lazy-bodies --dump-ir
+// a lazy parse only parses the bodies main reaches, so the syntax error of unused goes unnoticed until the IR needs
+// every body, which has it reported like an eager parse does
+int unused(int z) { return z + ; }
+int h(int y) { return y; }
+int f(int x) { return undeclared + "s" * 3 + h(x); }
+int main(void) { return f(1); }
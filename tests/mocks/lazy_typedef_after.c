@@ -0,0 +1,5 @@
+// run: --lazy-bodies
+// a body parsed lazily doesn't know about the typedef name declared after it, so T * y; multiplies by an undeclared
+// name instead of declaring y again, the same as when it's parsed eagerly
+int main(void) { int y = 2; T * y; return y; }
+typedef int T;
@@ -0,0 +1,8 @@
+// run: --lazy-bodies
+// run: --lazy-bodies --dump-ir
+// a body only sees the typedef names declared before it, even when it's parsed once the file is
+typedef int T;
+int f(void) { T x = 1; return x; }
+typedef char *T2;
+int g(int T2) { return T2 + 1; }
+int main(void) { return f() + g(2); }
@@ -0,0 +1,9 @@
+// run: --lazy-bodies
+// C has no nested functions, a body can only declare prototypes
+int main(void) {
+  int g(int a);
+  int h(int b) {
+    return b;
+  }
+  return g(1) + h(2);
+}
@@ -0,0 +1,23 @@
+// every C operator with its precedence and associativity, see the binding powers in parser2.c
+int a;
+int b;
+int c;
+int *p;
+a = b = c;
+a += b -= c *= 2;
+a /= b %= c <<= 1;
+a >>= b &= c ^= 3;
+a |= 4;
+a ? b : c ? a : b;
+a || b && c;
+a | b ^ c & a;
+a == b != c;
+a < b <= c > a >= b;
+a << 1 >> b;
+a + b * c - a / b % c;
+-a + ~b - !c;
+*p + p[1] - *&a;
+++a + b++ - --c - a--;
+sizeof a + sizeof(int *);
+(a, b, c);
+a = (b + c) * (a - b);
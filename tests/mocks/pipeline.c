@@ -0,0 +1,47 @@
+// more tokens than a batch of the lexer thread and more statements than the ring to the passes holds, the
+// passes see them in order while the rest is parsed, run.sh checks that --pipeline prints the same
+typedef long count_t;
+count_t v = 1;
+v = v * 2 + 0;
+v = v * 2 + 1;
+v = v * 2 + 2;
+v = v * 2 + 3;
+v = v * 2 + 4;
+v = v * 2 + 5;
+v = v * 2 + 6;
+v = v * 2 + 7;
+v = v * 2 + 8;
+v = v * 2 + 9;
+v = v * 2 + 10;
+v = v * 2 + 11;
+v = v * 2 + 12;
+v = v * 2 + 13;
+v = v * 2 + 14;
+v = v * 2 + 15;
+v = v * 2 + 16;
+v = v * 2 + 17;
+v = v * 2 + 18;
+v = v * 2 + 19;
+v = v * 2 + 20;
+int twice(int x) { return x + x; }
+v = v * 2 + 21;
+v = v * 2 + 22;
+v = v * 2 + 23;
+v = v * 2 + 24;
+v = v * 2 + 25;
+v = v * 2 + 26;
+v = v * 2 + 27;
+v = v * 2 + 28;
+v = v * 2 + 29;
+v = v * 2 + 30;
+v = v * 2 + 31;
+v = v * 2 + 32;
+v = v * 2 + 33;
+v = v * 2 + 34;
+v = v * 2 + 35;
+v = v * 2 + 36;
+v = v * 2 + 37;
+v = v * 2 + 38;
+v = v * 2 + 39;
+count_t * w;
+twice(v);
@@ -0,0 +1,30 @@
+// printf with a literal format has its data args checked against the conversions, after they are promoted
+int main(void) {
+  int count = 3;
+  long total = 42;
+  double ratio = count;
+  char c = 120;
+  const char *name = "copy";
+
+  printf("%s: %d of %ld, %5.1f%% done, %c\n", name, count, total, ratio * 100, c);
+  printf("%*d|%-*.*f|\n", count, count, -10, 2, ratio);
+  printf("%p %hhd %hd %lu %zu\n", name, c, count, total, sizeof(total));
+  printf("no conversions\n");
+
+  printf("%d\n", total);
+  printf("%ld\n", count);
+  printf("%s\n", count);
+  printf("%f\n", count);
+  printf("%Lf\n", ratio);
+  printf("%d %d\n", count);
+  printf("%*d\n", ratio, count);
+  printf("%p\n", total);
+
+  printf("%y\n", count);
+  printf("%n\n", &count);
+  printf("%lc\n", c);
+  printf("trailing %");
+  printf("\x25q\n", count);
+
+  return 0;
+}
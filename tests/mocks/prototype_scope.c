@@ -0,0 +1,7 @@
+// run: --dump-ir
+// a prototype in a body declares the function and its params in a scope that ends with it, t and a are still the
+// locals of f after it, and a param of a prototype can have the name of a local
+int f(int a) { int t = a; int use(int *t, int n); long u = t; return t + a + u; }
+int use(int *q, int n) { return *q + n; }
+int g(int x) { int y = x; int id(int y); return use(&y, id(x)) + y; }
+int id(int v) { return v; }
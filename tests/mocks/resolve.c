@@ -0,0 +1,9 @@
+// globals and externs are numbered in order of first declaration, params and locals are slots of their frame
+int g;
+int h = 2;
+int add(int a, int b) { int sum = a + b; return sum + g; }
+int shadow(int g) { int h = g * 2; return h + add(g, h); }
+int calls(int x) { return puts(x) + puts(x) + putchar(x); }
+int redeclared(int a) { int a = 1; int b; int b; return a; }
+int undeclared(int a) { return a + missing; }
+g = h + add(1, 2);
@@ -0,0 +1,6 @@
+// run: --dump-ir
+// constants and switch ranges of signed types print as negative numbers, of unsigned ones as they are
+int neg(int x) { return x * -3 + -7; }
+unsigned wrap(unsigned x) { return x + -1; }
+int cases(int x) { return x == -2 ? 1 : x == -1 ? 2 : x == 0 ? 3 : x == 1 ? 4 : 5; }
+int main(void) { return neg(1) + wrap(2) + cases(-1); }
@@ -0,0 +1,28 @@
+// sizeof and _Alignof fold to the size and alignment of the x86-64 System V layout of their operand's type
+char c;
+short s;
+long long ll;
+long double ld;
+const char *str = "eleven char";
+sizeof(char);
+sizeof(short);
+sizeof(int);
+sizeof(long);
+sizeof(long long);
+sizeof(unsigned long);
+sizeof(float);
+sizeof(double);
+sizeof(long double);
+sizeof(_Bool);
+sizeof(void *);
+sizeof(char **);
+_Alignof(short);
+_Alignof(long double);
+_Alignof(double *);
+sizeof c;
+sizeof(s + s);
+sizeof ll;
+sizeof(ld);
+sizeof *str;
+sizeof str;
+sizeof(c ? s : ll);
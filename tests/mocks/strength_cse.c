@@ -0,0 +1,9 @@
+// run: --dump-ir
+// each-opt
+// strength reduction turns unsigned multiplication, division and remainder by powers of two into shifts and masks and
+// drops identities, cse reuses a + b for b + a in a dominated block and the address of p[k] for the unrolled steps
+unsigned shifts(unsigned u) { return u * 8 + u / 4 + u % 16; }
+int identities(int x) { return (x + 0) * 1 + (x & 0) + x * 0; }
+int signed_div(int x) { return x / 4; }
+int common(int a, int b) { int s = a + b; return s > 0 ? (b + a) * 2 : a * b + b * a; }
+int walk(int *p, int k) { return p[k] + p[k] * 2 + p[k] * 3; }
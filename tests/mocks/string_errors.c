@@ -0,0 +1,6 @@
+// escapes that can't be decoded are reported where their literal is
+const char *unknown = "\q";
+const char *no_digits = "\xg";
+const char *hex = "\x100";
+const char *octal = "\777";
+const char *fine = "\x41";
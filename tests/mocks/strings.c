@@ -0,0 +1,7 @@
+// run: --dump-ir
+// escapes are decoded once and each distinct string is kept once, however it's spelled, so the literals of same are
+// one offset of the data segment
+const char *same(int i) { return i > 0 ? "A\tB" : i < 0 ? "\x41\11B" : "\101\tB"; }
+const char *other(void) { return "A\\tB"; }
+const char *escapes(void) { return "\a\b\f\n\r\t\v\\\'\"\?\0\377\x7f"; }
+const char *empty(void) { return ""; }
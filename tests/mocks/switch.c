@@ -0,0 +1,9 @@
+// run: --dump-ir
+// chains of ternaries on one variable become switches: dense cases a jump table, sparse ones a binary search over
+// ranges of one value, clustered ones a binary search of tables, short chains stay branches
+int dense(int s) { return s == 1 ? 10 : s == 2 ? 20 : s == 3 ? 30 : s == 4 ? 40 : s == 5 ? 50 : 0; }
+int sparse(int s) { return s == 1 ? 10 : s == 100 ? 20 : s == 1000 ? 30 : s == 10000 ? 40 : 0; }
+int clustered(int s) {
+  return s == 1 ? 1 : s == 2 ? 2 : s == 3 ? 3 : s == 4 ? 4 : s == 500 ? 5 : s == 501 ? 6 : s == 502 ? 7 : s == 503 ? 8 : 0;
+}
+int short_chain(int s) { return s == 1 ? 10 : s == 2 ? 20 : 0; }
@@ -0,0 +1,8 @@
+// run: --dump-ir
+// a call whose value is returned as is, directly or through the phi of a ternary, is a tail call, a caller with the
+// address of a local and calls of externs are left alone
+int fact(int n, int acc) { return n > 1 ? fact(n - 1, acc * n) : acc; }
+int swap(int a, int b, int n) { return n > 0 ? swap(b, a, n - 1) : a - b; }
+int not_tail(int n) { return n > 0 ? not_tail(n - 1) + 1 : 0; }
+int extern_call(int n) { return next(n); }
+int address(int n) { int x = n; int *p = &x; keep(p); return address(x - 1); }
@@ -0,0 +1,27 @@
+// expressions get their types with the promotions and usual arithmetic conversions of LP64, conversions are explicit
+char c;
+short s;
+unsigned u;
+long l;
+unsigned long ul;
+double d;
+float f;
+const int k = 1;
+int *p;
+c + s;
+u + 1;
+l + u;
+ul - l;
+f * 2;
+d / l;
+p + 1;
+p - p;
+p == 0;
+!d;
+int call(int a, long b) { return a + b; }
+call(c, s);
+call(1);
+k = 2;
+1 = c;
+p * 2;
+"s" + d;
@@ -0,0 +1,6 @@
+// the checker sees through typedef names, so these are the errors of the types they stand for
+typedef int *iptr;
+typedef const int cint;
+iptr p = "not an int pointer";
+int f(void) { cint c = 1; c = 2; return c; }
+int g(iptr q) { return q * 2; }
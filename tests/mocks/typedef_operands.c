@@ -0,0 +1,9 @@
+// run: --dump-ir
+// a typedef name has the type it stands for, so its operands are converted and typed like those of that type and
+// sizeof of one folds
+typedef unsigned long size;
+typedef int *iptr;
+typedef const size csize;
+size half(size n) { return n / 2; }
+int scale(int x) { size s = sizeof(size); return x * s; }
+int load(iptr p) { csize bytes = sizeof(*p); return *p + bytes; }
@@ -0,0 +1,10 @@
+// T * x; is a declaration when T is a typedef name in scope and a multiplication when it isn't
+typedef int T;
+typedef T *T_ptr;
+int a;
+int b;
+T * x;
+a * b;
+T_ptr y = x;
+int f(int T) { return T * a; }
+int g(int z) { T * w = &z; return *w; }
@@ -0,0 +1,7 @@
+// a name that isn't a typedef name is not a type, even where another word after it makes it look like one
+typedef int T;
+itn x = 5;
+int f(void) { itn y = "s"; return y; }
+int g(T t, unsigend u) { return t + u; }
+itn k(void) { return 1; }
+T h(void) { T ok = 1; return ok; }
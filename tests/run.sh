@@ -0,0 +1,140 @@
+#!/bin/sh
+# Runs the mocks of tests/mocks through an interpreter built without logs and compares what it prints with
+# tests/expected and runs format_test.c and string_pool_test.c. It then runs every mock with each IR optimization
+# left out and with only it left in, which has to finish without a crash or a failed assertion, with hash-consing,
+# which has to report the same errors, through the AST cache and, if it has no errors, with --pipeline, which both
+# have to print the same. Its IR, or its errors, also have to be the same with --lazy-bodies.
+#
+# A mock runs once with no flags, or once per `// run: FLAGS` line it has. The output of a run goes to
+# tests/expected/NAME.out, or NAME.FLAGS.out with the dashes of the flags dropped and spaces as underscores,
+# e.g., `// run: --dump-ir --no-opt=dce` to NAME.dump-ir_no-opt=dce.out. A mock with a `// each-opt` line is also
+# run with --dump-ir, and no AST dump, with every IR optimization left out, to NAME.no-opt.out, and with only one of
+# them left in, to NAME.only-OPT.out, e.g., NAME.only-sccp.out.
+#
+# Usage: ./tests/run.sh [--update], --update writes the output of the runs to tests/expected instead
+set -u
+
+cd "$(dirname "$0")/.." || exit 1
+
+cc=${CC:-gcc}
+cflags="-O2 -g -std=c17 -D_DEFAULT_SOURCE -pthread"
+opts="sccp copy-propagation strength-reduction cse dse dce inline tail-calls bounds-checks"
+update=0
+failed=0
+build=$(mktemp -d)
+trap 'rm -rf "$build"' EXIT
+
+[ "${1:-}" = "--update" ] && update=1
+
+if [ ! -f ll1_tables.h ]; then
+  $cc -O2 -o "$build/ll1_gen" ll1_gen.c && "$build/ll1_gen" grammar.ll1 ll1_tables.h >/dev/null || exit 1
+fi
+
+$cc $cflags -DZDX_LOGS_DISABLE -o "$build/interpreter" interpreter.c lexer.c parser2.c types.c ast_cache.c ast_emit.c \
+  passes.c resolve.c typecheck.c fold.c string_pool.c format.c ir.c ir_opt.c ll1_parser.c pipeline.c || exit 1
+
+fail() {
+  echo "FAIL $*"
+  failed=$((failed + 1))
+}
+
+# run FILE FLAGS..., the status of the interpreter, 1 for a crash or a failed assertion
+run() {
+  file=$1
+  shift
+  "$build/interpreter" --no-cache "$@" "$file" > "$build/out" 2>&1
+  status=$?
+
+  [ $status -lt 128 ] && ! grep -q "FAILED ASSERTION" "$build/out"
+}
+
+# compare MOCK SUFFIX FLAGS..., diffs a run of a mock with tests/expected/NAME.SUFFIX.out, or NAME.out
+compare() {
+  mock=$1
+  expected=tests/expected/$(basename "$mock" .c)${2:+.$2}.out
+  shift 2
+
+  run "$mock" "$@" || echo "crashed" >> "$build/out"
+
+  if [ $update -eq 1 ]; then
+    cp "$build/out" "$expected"
+  elif [ ! -f "$expected" ]; then
+    echo "FAIL $mock $*: no $expected, run with --update to write it"
+    echo x >> "$build/failures"
+  elif ! diff -u "$expected" "$build/out"; then
+    echo "FAIL $mock $*"
+    echo x >> "$build/failures"
+  fi
+}
+
+# without OPT, the flags that leave out every IR optimization but OPT
+all_but() {
+  for other in $opts; do
+    [ "$other" = "$1" ] || printf ' %s' "--no-opt=$other"
+  done
+}
+
+for mock in tests/mocks/*.c; do
+  runs=$(sed -n 's|^// run: *||p' "$mock")
+  [ -n "$runs" ] || runs="-"
+
+  echo "$runs" | while IFS= read -r flags; do
+    [ "$flags" = "-" ] && flags=""
+    compare "$mock" "$(echo "$flags" | sed 's|--||g; s| |_|g')" $flags
+  done
+
+  # the IR before the optimizations and after each one alone, without the AST
+  if grep -q '^// each-opt' "$mock"; then
+    compare "$mock" "no-opt" --dump-ir --emit-out=/dev/null $(all_but "")
+
+    for opt in $opts; do
+      compare "$mock" "only-$opt" --dump-ir --emit-out=/dev/null $(all_but "$opt")
+    done
+  fi
+done
+
+[ -f "$build/failures" ] && failed=$(wc -l < "$build/failures")
+
+# format_print() has to write what the C library does for the same plans, the pool has to decode and dedup strings
+$cc $cflags -DZDX_LOGS_DISABLE -o "$build/format_test" format_test.c format.c lexer.c parser2.c types.c || exit 1
+"$build/format_test" > "$build/out" || { cat "$build/out"; fail "format_test.c"; }
+$cc $cflags -DZDX_LOGS_DISABLE -o "$build/string_pool_test" string_pool_test.c string_pool.c || exit 1
+"$build/string_pool_test" > "$build/out" || { cat "$build/out"; fail "string_pool_test.c"; }
+
+for mock in tests/mocks/*.c; do
+  for opt in $opts; do
+    run "$mock" --dump-ir --no-opt="$opt" || fail "$mock --no-opt=$opt"
+    run "$mock" --dump-ir $(all_but "$opt") || fail "$mock only $opt"
+  done
+
+  run "$mock"
+  cp "$build/out" "$build/plain"
+  grep ": Error:" "$build/plain" > "$build/errors"
+  run "$mock" --hash-cons
+  grep ": Error:" "$build/out" | diff -u "$build/errors" - || fail "$mock --hash-cons"
+
+  # the first run writes the AST cache and the second reads it back, both have to print what a fresh parse does
+  for pass in write read; do
+    C_INTERPRETER_CACHE_DIR="$build/cache" "$build/interpreter" "$mock" > "$build/out" 2>&1
+    diff -u "$build/plain" "$build/out" || fail "$mock cache $pass"
+  done
+
+  # the reports parse every body a lazy parse skipped, so it gets to the same IR and the same errors
+  run "$mock" --dump-ir --emit-out=/dev/null
+  cp "$build/out" "$build/eager"
+  run "$mock" --lazy-bodies --dump-ir --emit-out=/dev/null
+  diff -u "$build/eager" "$build/out" || fail "$mock --lazy-bodies"
+
+  # the table-driven parser builds the same tree, only its syntax errors are worded differently
+  if [ ! -s "$build/errors" ]; then
+    run "$mock" --pipeline
+    diff -u "$build/plain" "$build/out" || fail "$mock --pipeline"
+  fi
+done
+
+if [ $failed -gt 0 ]; then
+  echo "$failed failed"
+  exit 1
+fi
+
+echo "All passed"
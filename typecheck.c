@@ -0,0 +1,947 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "./zdx_util.h"
+#include "./format.h"
+#include "./typecheck.h"
+
+#define TYPECHECK_MIN_CAP 64
+
+// ------------------------------------ TYPES ------------------------------------
+
+static inline const type_t *intern(type_checker_t c[const static 1], const type_t type)
+{
+  return type_intern(c->arena, c->types, type);
+}
+
+static inline const type_t *base_type(type_checker_t c[const static 1], const uint16_t specifiers)
+{
+  return intern(c, (type_t){ .kind = TYPE_KIND_BASE, .specifiers = specifiers });
+}
+
+static inline const type_t *pointer_to(type_checker_t c[const static 1], const type_t pointee[const static 1])
+{
+  return intern(c, (type_t){ .kind = TYPE_KIND_POINTER, .pointee = pointee });
+}
+
+// declared types are interned by the parser, which may use another table, and may have typedef names
+static inline const type_t *import(type_checker_t c[const static 1], const type_t type[const static 1])
+{
+  return type_import(c->arena, c->types, type);
+}
+
+// storage classes are kept on declared types but aren't a part of the type of an expression
+static const type_t *without_storage(type_checker_t c[const static 1], const type_t type[const static 1])
+{
+  if (type->storage == 0) {
+    return type;
+  }
+
+  type_t t = *type;
+  t.storage = 0;
+
+  return intern(c, t);
+}
+
+// the value of an lvalue of a qualified type has the unqualified type
+static const type_t *unqualified(type_checker_t c[const static 1], const type_t type[const static 1])
+{
+  if (type->storage == 0 && type->qualifiers == 0) {
+    return type;
+  }
+
+  type_t t = *type;
+  t.storage = 0;
+  t.qualifiers = 0;
+
+  return intern(c, t);
+}
+
+// type of the symbols that refer to a declaration, imported on first use
+static const type_t *declared_type(type_checker_t c[const static 1], const uint32_t declaration)
+{
+  if (declaration > c->declared_capacity) {
+    const size_t capacity = zdx_max(c->declared_capacity * 2, zdx_max(declaration, TYPECHECK_MIN_CAP));
+
+    c->declared = arena_realloc(c->arena, c->declared, c->declared_capacity * sizeof(*c->declared), capacity * sizeof(*c->declared));
+    assertm(!c->arena->err, "Expected: declared types resize to be successful, Received: %s", c->arena->err);
+    memset(c->declared + c->declared_capacity, 0, (capacity - c->declared_capacity) * sizeof(*c->declared));
+    c->declared_capacity = capacity;
+  }
+
+  if (c->declared[declaration - 1] == NULL) {
+    c->declared[declaration - 1] = without_storage(c, import(c, c->resolver->declarations.items[declaration - 1].type));
+  }
+
+  return c->declared[declaration - 1];
+}
+
+// groups aren't typed, they have the type of the expression that gives their value
+static inline const type_t *type_of(const type_checker_t c[const static 1], const ast_node_t node[const static 1])
+{
+  const uint16_t id = ast_ungroup(node)->type;
+
+  return id == TYPE_NO_ID ? c->unknown : type_by_id(c->types, id);
+}
+
+static inline const type_t *value_type(type_checker_t c[const static 1], const ast_node_t node[const static 1])
+{
+  return unqualified(c, type_of(c, node));
+}
+
+// types the checker can't tell anything about until structs are there, and names that aren't a typedef
+static inline bool is_opaque(const type_t type[const static 1])
+{
+  return type->kind == TYPE_KIND_UNKNOWN || (type->kind == TYPE_KIND_BASE && (type->specifiers & TYPE_SPEC_NAMED));
+}
+
+static inline bool is_void(const type_t type[const static 1])
+{
+  return type->kind == TYPE_KIND_BASE && (type->specifiers & TYPE_SPEC_VOID);
+}
+
+// pointers to the same type but for the qualifiers of the pointee
+static inline bool same_pointee(type_checker_t c[const static 1], const type_t a[const static 1], const type_t b[const static 1])
+{
+  return unqualified(c, a->pointee) == unqualified(c, b->pointee);
+}
+
+static bool is_null_pointer_constant(const ast_node_t *node)
+{
+  node = ast_ungroup(node);
+
+  return node->kind == AST_NODE_KIND_LITERAL && node->literal.kind == LITERAL_KIND_NUMBER && node->literal.integer == 0;
+}
+
+static bool is_lvalue(const type_checker_t c[const static 1], const ast_node_t *node)
+{
+  node = ast_ungroup(node);
+
+  switch(node->kind) {
+    case AST_NODE_KIND_SYMBOL: {
+      const uint32_t declaration = node->symbol.declaration;
+
+      return (node->symbol.binding == SYMBOL_BINDING_LOCAL || node->symbol.binding == SYMBOL_BINDING_GLOBAL) &&
+        declaration != 0 && c->resolver->declarations.items[declaration - 1].function == NULL;
+    }
+    case AST_NODE_KIND_UNARY_OP: return node->unary_op.kind == UNARY_OP_DEREF;
+    case AST_NODE_KIND_BINARY_OP: {
+      const binary_op_kind_t kind = node->binary_op.kind;
+
+      return kind == BINARY_OP_INDEX || kind == BINARY_OP_MEMBER || kind == BINARY_OP_PTR_MEMBER;
+    }
+    default: return false;
+  }
+}
+
+// ------------------------------------ ERRORS ------------------------------------
+
+// leftmost token of an expression, which is where its errors are reported
+static sv_t node_at(const ast_node_t *node)
+{
+  for (;;) {
+    switch(node->kind) {
+      case AST_NODE_KIND_LITERAL: return node->literal.value;
+      case AST_NODE_KIND_SYMBOL: return node->symbol.name;
+      case AST_NODE_KIND_DECLARATION: return node->declaration.name;
+      case AST_NODE_KIND_UNARY_OP: node = node->unary_op.expr; break;
+      case AST_NODE_KIND_BINARY_OP: node = node->binary_op.lhs; break;
+      case AST_NODE_KIND_TERNARY: node = node->ternary.cond; break;
+      case AST_NODE_KIND_CALL: node = node->call.callee; break;
+      case AST_NODE_KIND_RETURN: {
+        if (node->ret.expr == NULL) {
+          return (sv_t){0};
+        }
+
+        node = node->ret.expr;
+      } break;
+      case AST_NODE_KIND_LIST: {
+        if (node->children == NULL || node->children->length == 0) {
+          return (sv_t){0};
+        }
+
+        node = &node->children->items[0];
+      } break;
+      default: return (sv_t){0};
+    }
+  }
+}
+
+__attribute__((format(printf, 3, 4)))
+static void report(type_checker_t c[const static 1], const ast_node_t node[const static 1], const char *fmt, ...)
+{
+  char msg[512];
+  va_list args;
+
+  va_start(args, fmt);
+  vsnprintf(msg, sizeof(msg), fmt, args);
+  va_end(args);
+
+  sv_t at = node_at(node);
+
+  if (at.buf == NULL && c->function) {
+    at = c->function->name;
+  }
+
+  pass_error(c->arena, c->errors, at, "%s", msg);
+}
+
+static const char *spell(type_checker_t c[const static 1], const type_t type[const static 1])
+{
+  char buf[256];
+  type_writer_t w = { .buf = buf, .size = sizeof(buf) };
+
+  write_type(&w, type);
+
+  const size_t length = zdx_min(w.length, w.size);
+  char *spelling = arena_alloc(c->arena, length + 1);
+  assertm(!c->arena->err, "Expected: type spelling alloc to succeed, Received: %s", c->arena->err);
+  memcpy(spelling, buf, length);
+  spelling[length] = '\0';
+
+  return spelling;
+}
+
+// ------------------------------------ CONVERSIONS ------------------------------------
+
+static ast_node_t *conversion(type_checker_t c[const static 1], ast_node_t operand[const static 1], const type_t to[const static 1],
+                              const bool shared)
+{
+  ast_node_t *node = arena_alloc(c->arena, sizeof(*node));
+  assertm(!c->arena->err, "Expected: conversion node alloc to succeed, Received: %s", c->arena->err);
+  *node = (ast_node_t){
+    .kind = AST_NODE_KIND_UNARY_OP,
+    .shared = shared,
+    .type = to->id,
+    .unary_op = { .kind = UNARY_OP_CONVERT, .expr = operand },
+  };
+
+  return node;
+}
+
+static inline bool needs_conversion(type_checker_t c[const static 1], const ast_node_t node[const static 1], const type_t to[const static 1])
+{
+  const type_t *from = value_type(c, node);
+
+  return from != to && !is_opaque(from) && !is_opaque(to);
+}
+
+// a child that is shared keeps its type, the parent points to the conversion of it instead. The conversion
+// is reached once per parent of the parent, so it's shared when the parent is
+static void convert_child(type_checker_t c[const static 1], ast_node_t *child[const static 1], const type_t to[const static 1],
+                          const bool shared)
+{
+  if (needs_conversion(c, *child, to)) {
+    *child = conversion(c, *child, to, shared);
+  }
+}
+
+// list items are values, so the item is moved out and replaced by its conversion
+static void convert_item(type_checker_t c[const static 1], ast_node_t item[const static 1], const type_t to[const static 1])
+{
+  if (needs_conversion(c, item, to)) {
+    ast_node_t *operand = arena_alloc(c->arena, sizeof(*operand));
+    assertm(!c->arena->err, "Expected: conversion operand alloc to succeed, Received: %s", c->arena->err);
+    *operand = *item;
+    *item = *conversion(c, operand, to, false);
+  }
+}
+
+typedef enum {
+  CONVERSION_ASSIGN,
+  CONVERSION_INIT,
+  CONVERSION_ARG,
+  CONVERSION_RETURN,
+} conversion_context_t;
+
+// constraints of simple assignment from section 6.5.16.1, which initializers, args and returns follow too
+static bool check_assignable(type_checker_t c[const static 1], const type_t to[const static 1], const ast_node_t from_node[const static 1],
+                             const conversion_context_t context)
+{
+  static const char *const verbs[] = {
+    [CONVERSION_ASSIGN] = "Assigning to",
+    [CONVERSION_INIT] = "Initializing",
+    [CONVERSION_ARG] = "Passing to a parameter of type",
+    [CONVERSION_RETURN] = "Returning as",
+  };
+  const type_t *from = value_type(c, from_node);
+
+  if (is_opaque(to) || is_opaque(from) || (type_is_arithmetic(to) && type_is_arithmetic(from))) {
+    return true;
+  }
+
+  if ((to->kind == TYPE_KIND_BASE && (to->specifiers & TYPE_SPEC_BOOL) && from->kind == TYPE_KIND_POINTER) ||
+      (to->kind == TYPE_KIND_POINTER && is_null_pointer_constant(from_node))) {
+    return true;
+  }
+
+  if (to->kind == TYPE_KIND_POINTER && from->kind == TYPE_KIND_POINTER) {
+    if (from->pointee->qualifiers & ~to->pointee->qualifiers) {
+      report(c, from_node, "%s '%s' from '%s' discards qualifiers", verbs[context], spell(c, to), spell(c, from));
+      return false;
+    }
+
+    if (is_void(to->pointee) || is_void(from->pointee) || is_opaque(to->pointee) || is_opaque(from->pointee) ||
+        same_pointee(c, to, from)) {
+      return true;
+    }
+  }
+
+  report(c, from_node, "%s '%s' from incompatible type '%s'", verbs[context], spell(c, to), spell(c, from));
+  return false;
+}
+
+static bool check_modifiable(type_checker_t c[const static 1], const ast_node_t node[const static 1], const type_t type[const static 1])
+{
+  if (!is_lvalue(c, node)) {
+    report(c, node, "Expression is not assignable");
+    return false;
+  }
+
+  if (type->qualifiers & TYPE_QUALIFIER_CONST) {
+    report(c, node, "Cannot assign to const-qualified type '%s'", spell(c, type));
+    return false;
+  }
+
+  return true;
+}
+
+// ------------------------------------ EXPRESSIONS ------------------------------------
+
+static void check_literal(void *ctx, ast_node_t node[const static 1])
+{
+  type_checker_t *c = ctx;
+
+  if (node->type != TYPE_NO_ID) {
+    return;
+  }
+
+  const type_t *type = c->unknown;
+
+  switch(node->literal.kind) {
+    // decimal literals without a suffix are the first of int and long their value fits, gcc makes larger ones unsigned
+    case LITERAL_KIND_NUMBER: {
+      type = node->literal.integer <= INT32_MAX ? c->int_type : node->literal.integer <= INT64_MAX ? c->long_type : c->ulong_type;
+    } break;
+    // arrays aren't parsed yet so the char array is typed as what it decays to
+    case LITERAL_KIND_STRING: {
+      string_pool_entry_t entry = {0};
+      const char *err = string_pool_intern(c->arena, c->strings, node->literal.value, &entry);
+
+      if (err) {
+        report(c, node, "%s", err);
+      }
+
+      type = c->string_type;
+    } break;
+    case LITERAL_KIND_BOOL: type = c->int_type; break;
+    default: break;
+  }
+
+  node->type = type->id;
+}
+
+// functions aren't values yet, calls look up what their callee refers to themselves
+static void check_symbol(void *ctx, ast_node_t node[const static 1])
+{
+  type_checker_t *c = ctx;
+
+  if (node->type != TYPE_NO_ID) {
+    return;
+  }
+
+  const type_t *type = c->unknown;
+  const uint32_t declaration = node->symbol.declaration;
+
+  if (declaration != 0 && (node->symbol.binding == SYMBOL_BINDING_LOCAL || node->symbol.binding == SYMBOL_BINDING_GLOBAL)) {
+    const resolve_declaration_t *d = &c->resolver->declarations.items[declaration - 1];
+
+    if (d->function == NULL) {
+      type = declared_type(c, declaration);
+    }
+  }
+
+  node->type = type->id;
+}
+
+static void check_unary_op(void *ctx, ast_node_t node[const static 1])
+{
+  type_checker_t *c = ctx;
+
+  if (node->type != TYPE_NO_ID) {
+    return;
+  }
+
+  const type_t *operand = type_of(c, node->unary_op.expr);
+  const type_t *value = unqualified(c, operand);
+  const type_t *type = c->unknown;
+
+  switch(node->unary_op.kind) {
+    case UNARY_OP_ADDR_OF: {
+      if (operand->kind == TYPE_KIND_UNKNOWN) {
+        break;
+      }
+
+      if (!is_lvalue(c, node->unary_op.expr)) {
+        report(c, node, "Cannot take the address of an rvalue of type '%s'", spell(c, value));
+        break;
+      }
+
+      type = pointer_to(c, operand);
+    } break;
+
+    case UNARY_OP_DEREF: {
+      if (value->kind == TYPE_KIND_POINTER) {
+        type = value->pointee;
+      } else if (!is_opaque(value)) {
+        report(c, node, "Indirection requires pointer operand ('%s' invalid)", spell(c, value));
+      }
+    } break;
+
+    case UNARY_OP_NOT: {
+      if (!is_opaque(value) && !type_is_scalar(value)) {
+        report(c, node, "Invalid argument type '%s' to unary expression", spell(c, value));
+      }
+
+      type = c->int_type;
+    } break;
+
+    case UNARY_OP_NEGATE:
+    case UNARY_OP_POSITIVE:
+    case UNARY_OP_BIT_NOT: {
+      if (is_opaque(value)) {
+        break;
+      }
+
+      if (node->unary_op.kind == UNARY_OP_BIT_NOT ? !type_is_integer(value) : !type_is_arithmetic(value)) {
+        report(c, node, "Invalid argument type '%s' to unary expression", spell(c, value));
+        break;
+      }
+
+      type = base_type(c, type_promote(value->specifiers));
+      convert_child(c, &node->unary_op.expr, type, node->shared);
+    } break;
+
+    case UNARY_OP_PRE_INC:
+    case UNARY_OP_PRE_DEC:
+    case UNARY_OP_POST_INC:
+    case UNARY_OP_POST_DEC: {
+      if (is_opaque(value) || !check_modifiable(c, node->unary_op.expr, operand)) {
+        break;
+      }
+
+      if (!type_is_scalar(value)) {
+        report(c, node, "Cannot increment or decrement value of type '%s'", spell(c, value));
+        break;
+      }
+
+      type = value;
+    } break;
+
+    // size_t is unsigned long on LP64, the operand isn't evaluated so it isn't converted either
+    case UNARY_OP_SIZEOF:
+    case UNARY_OP_ALIGNOF: {
+      const ast_node_t *measured = ast_ungroup(node->unary_op.expr);
+
+      if (measured->kind == AST_NODE_KIND_DECLARATION) {
+        value = unqualified(c, import(c, measured->declaration.type));
+      }
+
+      if (is_void(value)) {
+        report(c, node, "Invalid application of '%s' to an incomplete type 'void'",
+               node->unary_op.kind == UNARY_OP_SIZEOF ? "sizeof" : "_Alignof");
+      }
+
+      type = c->ulong_type;
+    } break;
+
+    default: break; // conversions are typed when they are inserted
+  }
+
+  node->type = type->id;
+}
+
+static inline bool is_comparison(const binary_op_kind_t kind)
+{
+  return kind >= BINARY_OP_LT && kind <= BINARY_OP_NEQ;
+}
+
+/**
+ * Type of lhs op rhs, with the operands converted to the type the operation is done in. The lhs of a
+ * compound assignment is a location and isn't converted, its value is converted to the type of the
+ * converted rhs before the operation (but for shifts, which convert each operand on its own).
+ */
+static const type_t *operation_type(type_checker_t c[const static 1], ast_node_t node[const static 1], const binary_op_kind_t op,
+                                    const bool compound)
+{
+  ast_node_t **lhs = &node->binary_op.lhs;
+  ast_node_t **rhs = &node->binary_op.rhs;
+  const type_t *l = value_type(c, *lhs);
+  const type_t *r = value_type(c, *rhs);
+
+  if (is_opaque(l) || is_opaque(r)) {
+    return is_comparison(op) || op == BINARY_OP_LOGICAL_AND || op == BINARY_OP_LOGICAL_OR ? c->int_type : c->unknown;
+  }
+
+  switch(op) {
+    case BINARY_OP_ADD:
+    case BINARY_OP_SUB:
+    case BINARY_OP_MULT:
+    case BINARY_OP_DIV:
+    case BINARY_OP_EXPO:
+    case BINARY_OP_MOD:
+    case BINARY_OP_BIT_AND:
+    case BINARY_OP_BIT_XOR:
+    case BINARY_OP_BIT_OR: {
+      const bool integers = op == BINARY_OP_MOD || op == BINARY_OP_BIT_AND || op == BINARY_OP_BIT_XOR || op == BINARY_OP_BIT_OR;
+
+      if (integers ? type_is_integer(l) && type_is_integer(r) : type_is_arithmetic(l) && type_is_arithmetic(r)) {
+        const type_t *common = base_type(c, type_common(l->specifiers, r->specifiers));
+
+        if (!compound) {
+          convert_child(c, lhs, common, node->shared);
+        }
+
+        convert_child(c, rhs, common, node->shared);
+        return common;
+      }
+
+      if ((op == BINARY_OP_ADD || op == BINARY_OP_SUB) && l->kind == TYPE_KIND_POINTER && type_is_integer(r)) {
+        return l;
+      }
+
+      if (op == BINARY_OP_ADD && !compound && type_is_integer(l) && r->kind == TYPE_KIND_POINTER) {
+        return r;
+      }
+
+      // ptrdiff_t
+      if (op == BINARY_OP_SUB && !compound && l->kind == TYPE_KIND_POINTER && r->kind == TYPE_KIND_POINTER && same_pointee(c, l, r)) {
+        return c->long_type;
+      }
+    } break;
+
+    case BINARY_OP_LSHIFT:
+    case BINARY_OP_RSHIFT: {
+      if (type_is_integer(l) && type_is_integer(r)) {
+        const type_t *promoted = base_type(c, type_promote(l->specifiers));
+
+        if (!compound) {
+          convert_child(c, lhs, promoted, node->shared);
+        }
+
+        convert_child(c, rhs, base_type(c, type_promote(r->specifiers)), node->shared);
+        return promoted;
+      }
+    } break;
+
+    case BINARY_OP_LT:
+    case BINARY_OP_LTE:
+    case BINARY_OP_GT:
+    case BINARY_OP_GTE:
+    case BINARY_OP_EQ:
+    case BINARY_OP_NEQ: {
+      if (type_is_arithmetic(l) && type_is_arithmetic(r)) {
+        const type_t *common = base_type(c, type_common(l->specifiers, r->specifiers));
+
+        convert_child(c, lhs, common, node->shared);
+        convert_child(c, rhs, common, node->shared);
+        return c->int_type;
+      }
+
+      if (l->kind == TYPE_KIND_POINTER && r->kind == TYPE_KIND_POINTER &&
+          (same_pointee(c, l, r) || is_void(l->pointee) || is_void(r->pointee))) {
+        return c->int_type;
+      }
+
+      if ((op == BINARY_OP_EQ || op == BINARY_OP_NEQ) &&
+          ((l->kind == TYPE_KIND_POINTER && is_null_pointer_constant(*rhs)) ||
+           (r->kind == TYPE_KIND_POINTER && is_null_pointer_constant(*lhs)))) {
+        return c->int_type;
+      }
+    } break;
+
+    case BINARY_OP_LOGICAL_AND:
+    case BINARY_OP_LOGICAL_OR: {
+      if (type_is_scalar(l) && type_is_scalar(r)) {
+        return c->int_type;
+      }
+    } break;
+
+    case BINARY_OP_INDEX: {
+      if (l->kind == TYPE_KIND_POINTER && type_is_integer(r)) {
+        return l->pointee;
+      }
+
+      if (type_is_integer(l) && r->kind == TYPE_KIND_POINTER) {
+        return r->pointee;
+      }
+
+      const bool pointer = l->kind == TYPE_KIND_POINTER || r->kind == TYPE_KIND_POINTER;
+
+      report(c, node, pointer ? "Array subscript is not an integer" : "Subscripted value is not an array or pointer");
+      return c->unknown;
+    }
+
+    default: break;
+  }
+
+  report(c, node, "Invalid operands to binary expression ('%s' and '%s')", spell(c, l), spell(c, r));
+  return c->unknown;
+}
+
+// the operation of each compound assignment
+static const binary_op_kind_t compound_ops[BINARY_OP_COUNT] = {
+  [BINARY_OP_MULT_ASSIGNMENT] = BINARY_OP_MULT,
+  [BINARY_OP_DIV_ASSIGNMENT] = BINARY_OP_DIV,
+  [BINARY_OP_MOD_ASSIGNMENT] = BINARY_OP_MOD,
+  [BINARY_OP_ADD_ASSIGNMENT] = BINARY_OP_ADD,
+  [BINARY_OP_SUB_ASSIGNMENT] = BINARY_OP_SUB,
+  [BINARY_OP_LSHIFT_ASSIGNMENT] = BINARY_OP_LSHIFT,
+  [BINARY_OP_RSHIFT_ASSIGNMENT] = BINARY_OP_RSHIFT,
+  [BINARY_OP_BIT_AND_ASSIGNMENT] = BINARY_OP_BIT_AND,
+  [BINARY_OP_BIT_XOR_ASSIGNMENT] = BINARY_OP_BIT_XOR,
+  [BINARY_OP_BIT_OR_ASSIGNMENT] = BINARY_OP_BIT_OR,
+};
+
+static void check_binary_op(void *ctx, ast_node_t node[const static 1])
+{
+  type_checker_t *c = ctx;
+
+  if (node->type != TYPE_NO_ID) {
+    return;
+  }
+
+  const binary_op_kind_t kind = node->binary_op.kind;
+  const type_t *type = c->unknown;
+
+  switch(kind) {
+    case BINARY_OP_MEMBER:
+    case BINARY_OP_PTR_MEMBER: break; // structs aren't parsed yet
+    case BINARY_OP_COMMA: type = type_of(c, node->binary_op.rhs); break;
+
+    case BINARY_OP_ASSIGNMENT: {
+      const type_t *target = type_of(c, node->binary_op.lhs);
+
+      if (is_opaque(target) || !check_modifiable(c, node->binary_op.lhs, target)) {
+        break;
+      }
+
+      type = unqualified(c, target);
+
+      if (check_assignable(c, type, node->binary_op.rhs, CONVERSION_ASSIGN)) {
+        convert_child(c, &node->binary_op.rhs, type, node->shared);
+      }
+    } break;
+
+    default: {
+      if (compound_ops[kind] == BINARY_OP_UNKNOWN) {
+        type = operation_type(c, node, kind, false);
+        break;
+      }
+
+      const type_t *target = type_of(c, node->binary_op.lhs);
+
+      if (is_opaque(target) || !check_modifiable(c, node->binary_op.lhs, target)) {
+        break;
+      }
+
+      operation_type(c, node, compound_ops[kind], true);
+      type = unqualified(c, target);
+    } break;
+  }
+
+  node->type = type->id;
+}
+
+static void check_ternary(void *ctx, ast_node_t node[const static 1])
+{
+  type_checker_t *c = ctx;
+
+  if (node->type != TYPE_NO_ID) {
+    return;
+  }
+
+  const type_t *cond = value_type(c, node->ternary.cond);
+  const type_t *then_type = value_type(c, node->ternary.then_expr);
+  const type_t *else_type = value_type(c, node->ternary.else_expr);
+  const type_t *type = c->unknown;
+
+  if (!is_opaque(cond) && !type_is_scalar(cond)) {
+    report(c, node, "Used type '%s' where arithmetic or pointer type is required", spell(c, cond));
+  }
+
+  if (is_opaque(then_type) || is_opaque(else_type)) {
+    // nothing to go by
+  } else if (type_is_arithmetic(then_type) && type_is_arithmetic(else_type)) {
+    type = base_type(c, type_common(then_type->specifiers, else_type->specifiers));
+    convert_child(c, &node->ternary.then_expr, type, node->shared);
+    convert_child(c, &node->ternary.else_expr, type, node->shared);
+  } else if (then_type == else_type) {
+    type = then_type;
+  } else if (then_type->kind == TYPE_KIND_POINTER && else_type->kind == TYPE_KIND_POINTER &&
+             (same_pointee(c, then_type, else_type) || is_void(then_type->pointee) || is_void(else_type->pointee))) {
+    type = is_void(else_type->pointee) ? else_type : then_type;
+  } else if (then_type->kind == TYPE_KIND_POINTER && is_null_pointer_constant(node->ternary.else_expr)) {
+    type = then_type;
+    convert_child(c, &node->ternary.else_expr, type, node->shared);
+  } else if (else_type->kind == TYPE_KIND_POINTER && is_null_pointer_constant(node->ternary.then_expr)) {
+    type = else_type;
+    convert_child(c, &node->ternary.then_expr, type, node->shared);
+  } else {
+    report(c, node, "Incompatible operand types ('%s' and '%s')", spell(c, then_type), spell(c, else_type));
+  }
+
+  node->type = type->id;
+}
+
+// args of a call without a prototype get the default argument promotions
+static void promote_args(type_checker_t c[const static 1], ast_node_list_t *args)
+{
+  for (size_t i = 0; args && i < args->length; i++) {
+    const type_t *from = value_type(c, &args->items[i]);
+
+    if (type_is_arithmetic(from)) {
+      const uint16_t specifiers = from->specifiers & TYPE_SPEC_FLOAT ? TYPE_SPEC_DOUBLE : type_promote(from->specifiers);
+
+      convert_item(c, &args->items[i], base_type(c, specifiers));
+    }
+  }
+}
+
+static bool format_accepts(const format_arg_t arg, const type_t type[const static 1])
+{
+  switch(arg) {
+    case FORMAT_ARG_INT:
+    case FORMAT_ARG_LONG: return type_is_integer(type) && type_integer_width(type->specifiers) == (arg == FORMAT_ARG_INT ? 32 : 64);
+    case FORMAT_ARG_DOUBLE:
+    case FORMAT_ARG_LONG_DOUBLE: {
+      const bool long_double = (type->specifiers & TYPE_SPEC_LONG) != 0;
+
+      return type->kind == TYPE_KIND_BASE && (type->specifiers & TYPE_SPEC_DOUBLE) && long_double == (arg == FORMAT_ARG_LONG_DOUBLE);
+    }
+    case FORMAT_ARG_STRING: return type->kind == TYPE_KIND_POINTER && type->pointee->kind == TYPE_KIND_BASE &&
+                                   (type->pointee->specifiers & TYPE_SPEC_CHAR);
+    case FORMAT_ARG_POINTER: return type->kind == TYPE_KIND_POINTER;
+    default: assertm(false, "Invalid format arg %d", arg);
+  }
+
+  return false;
+}
+
+// printf with a literal format gets its data args checked against the conversions, after they are promoted
+static void check_format(type_checker_t c[const static 1], const ast_node_t node[const static 1], ast_node_list_t *args)
+{
+  const ast_node_t *literal = format_literal(args);
+
+  if (literal == NULL) {
+    return;
+  }
+
+  // the literal is already in the pool, with its escapes decoded
+  string_pool_entry_t entry = {0};
+
+  if (string_pool_intern(c->arena, c->strings, literal->literal.value, &entry)) {
+    return;
+  }
+
+  const format_plan_t plan = format_compile(c->arena, string_pool_at(c->strings, entry.offset), entry.length);
+
+  if (plan.err) {
+    report(c, literal, "Invalid format string: %s", plan.err);
+    return;
+  }
+
+  if (args->length - 1 < plan.arg_count) {
+    report(c, node, "More '%%' conversions than data arguments");
+  }
+
+  for (size_t i = 0; i < zdx_min(args->length - 1, (size_t)plan.arg_count); i++) {
+    const type_t *type = value_type(c, &args->items[i + 1]);
+
+    if (!is_opaque(type) && !format_accepts(plan.args[i], type)) {
+      report(c, &args->items[i + 1], "Format specifies type '%s' but the argument has type '%s'",
+             format_arg_name(plan.args[i]), spell(c, type));
+    }
+  }
+}
+
+// the args of a call to a function with a prototype, at is where the errors are reported
+static void check_args(type_checker_t c[const static 1], const ast_node_t at[const static 1], ast_node_list_t *args,
+                       const ast_function_t function[const static 1])
+{
+  const size_t arg_count = args ? args->length : 0;
+  const size_t param_count = function->params->length;
+
+  if (arg_count != param_count) {
+    report(c, at, "Too %s arguments to function call, expected %zu, have %zu",
+           arg_count > param_count ? "many" : "few", param_count, arg_count);
+  }
+
+  for (size_t i = 0; i < zdx_min(arg_count, param_count); i++) {
+    const type_t *to = unqualified(c, import(c, function->params->items[i].declaration.type));
+
+    if (check_assignable(c, to, &args->items[i], CONVERSION_ARG)) {
+      convert_item(c, &args->items[i], to);
+    }
+  }
+}
+
+static void check_call(void *ctx, ast_node_t node[const static 1])
+{
+  type_checker_t *c = ctx;
+  const ast_node_t *callee = node->call.callee;
+  ast_node_list_t *args = node->call.args;
+  const type_t *type = c->unknown;
+
+  if (callee->kind != AST_NODE_KIND_SYMBOL) {
+    // function pointers aren't typed yet
+  } else if (callee->symbol.binding == SYMBOL_BINDING_EXTERN) {
+    // implicitly declared as int name(), like C89 did
+    type = c->int_type;
+    promote_args(c, args);
+
+    if (sv_eq_cstr(callee->symbol.name, FORMAT_PRINTF)) {
+      check_format(c, node, args);
+    }
+  } else if (callee->symbol.declaration != 0) {
+    const resolve_declaration_t *d = &c->resolver->declarations.items[callee->symbol.declaration - 1];
+    const ast_function_t *function = d->function;
+
+    if (function == NULL) {
+      const type_t *called = unqualified(c, declared_type(c, callee->symbol.declaration));
+
+      if (!is_opaque(called) && called->kind != TYPE_KIND_POINTER) {
+        report(c, node, "Called object type '%s' is not a function", spell(c, called));
+      }
+    } else if (function->params == NULL) {
+      // () and (void) look the same after parsing, so calls to either aren't checked against a prototype
+      type = unqualified(c, import(c, function->type));
+      promote_args(c, args);
+    } else {
+      type = unqualified(c, import(c, function->type));
+      check_args(c, node, args, function);
+    }
+  }
+
+  node->type = type->id;
+}
+
+// A call made before its callee was declared was checked as one to int name(), like C89 did, and the resolve pass
+// binds it to the declaration once it gets there. The declaration has to agree with the call
+static void check_rebound_calls(type_checker_t c[const static 1])
+{
+  for (; c->rebound_checked < c->resolver->rebound.length; c->rebound_checked++) {
+    const resolve_call_t *call = &c->resolver->rebound.items[c->rebound_checked];
+    const resolve_declaration_t *d = &c->resolver->declarations.items[call->callee->symbol.declaration - 1];
+    const type_t *returned = unqualified(c, import(c, d->function->type));
+
+    if (!is_opaque(returned) && returned != c->int_type) {
+      report(c, call->callee, "Conflicting types for '"SV_FMT"', called before its declaration as returning 'int'",
+             sv_fmt_args(call->callee->symbol.name));
+    } else if (d->function->params) {
+      check_args(c, call->callee, call->args, d->function);
+    }
+  }
+}
+
+// ------------------------------------ STATEMENTS ------------------------------------
+
+// A word the parser took for a type name as another word came after it, e.g., itn x;, has to be a typedef name. It's
+// reported at what's declared, as an interned type has the spelling of its first use. The type stays opaque, so
+// the declarations of one aren't reported again wherever they are used
+static void check_type_name(type_checker_t c[const static 1], const type_t *type, const sv_t at)
+{
+  while (type->kind == TYPE_KIND_POINTER) {
+    type = type->pointee;
+  }
+
+  if (type->kind == TYPE_KIND_BASE && (type->specifiers & TYPE_SPEC_NAMED) && type->aliased == NULL) {
+    pass_error(c->arena, c->errors, at, "Unknown type name '"SV_FMT"'", sv_fmt_args(type->name));
+  }
+}
+
+static void check_declaration(void *ctx, ast_node_t node[const static 1])
+{
+  type_checker_t *c = ctx;
+
+  check_type_name(c, node->declaration.type, node->declaration.name);
+
+  if (node->declaration.init) {
+    const type_t *to = unqualified(c, import(c, node->declaration.type));
+
+    if (check_assignable(c, to, node->declaration.init, CONVERSION_INIT)) {
+      convert_child(c, &node->declaration.init, to, false);
+    }
+  }
+}
+
+static void check_return(void *ctx, ast_node_t node[const static 1])
+{
+  type_checker_t *c = ctx;
+
+  if (c->function == NULL || node->ret.expr == NULL) {
+    return;
+  }
+
+  const type_t *to = unqualified(c, import(c, c->function->type));
+
+  if (is_void(to)) {
+    report(c, node, "Void function should not return a value");
+  } else if (check_assignable(c, to, node->ret.expr, CONVERSION_RETURN)) {
+    convert_child(c, &node->ret.expr, to, false);
+  }
+}
+
+// a prototype in a body doesn't leave the body, its returns are still checked against the function
+static void check_function_begin(void *ctx, ast_node_t node[const static 1])
+{
+  type_checker_t *c = ctx;
+
+  check_rebound_calls(c);
+  check_type_name(c, node->function->type, node->function->name);
+
+  if (node->function->body || node->function->body_source.length > 0) {
+    c->function = node->function;
+  }
+}
+
+static void check_function_end(void *ctx, ast_node_t node[const static 1])
+{
+  type_checker_t *c = ctx;
+
+  if (c->function == node->function) {
+    c->function = NULL;
+  }
+}
+
+pass_t typecheck_pass(type_checker_t checker[const static 1])
+{
+  assertm(checker->arena && checker->types && checker->resolver && checker->errors,
+          "Expected: the type checker to have an arena, a type table, a resolver and an error list");
+
+  checker->unknown = intern(checker, (type_t){ .kind = TYPE_KIND_UNKNOWN });
+  checker->int_type = base_type(checker, TYPE_SPEC_INT);
+  checker->long_type = base_type(checker, TYPE_SPEC_LONG | TYPE_SPEC_INT);
+  checker->ulong_type = base_type(checker, TYPE_SPEC_UNSIGNED | TYPE_SPEC_LONG | TYPE_SPEC_INT);
+  checker->string_type = pointer_to(checker, base_type(checker, TYPE_SPEC_CHAR));
+
+  return (pass_t){
+    .name = "typecheck",
+    .ctx = checker,
+    .pre = {
+      [AST_NODE_KIND_FUNCTION] = check_function_begin,
+    },
+    .post = {
+      [AST_NODE_KIND_LITERAL] = check_literal,
+      [AST_NODE_KIND_SYMBOL] = check_symbol,
+      [AST_NODE_KIND_UNARY_OP] = check_unary_op,
+      [AST_NODE_KIND_BINARY_OP] = check_binary_op,
+      [AST_NODE_KIND_TERNARY] = check_ternary,
+      [AST_NODE_KIND_CALL] = check_call,
+      [AST_NODE_KIND_DECLARATION] = check_declaration,
+      [AST_NODE_KIND_RETURN] = check_return,
+      [AST_NODE_KIND_FUNCTION] = check_function_end,
+    },
+  };
+}
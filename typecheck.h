@@ -0,0 +1,56 @@
+#ifndef TYPECHECK_H_
+#define TYPECHECK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "./parser2.h"
+#include "./passes.h"
+#include "./resolve.h"
+#include "./string_pool.h"
+#include "./types.h"
+
+#include "./zdx_simple_arena.h"
+
+typedef struct {
+  // the fields to set before registering the pass
+  arena_t *arena;
+  // expression types are interned here and declared types again, so that all of them compare by pointer. It can
+  // be the table of the parser unless the parser runs on another thread like in pipeline.h
+  type_table_t *types;
+  const resolver_t *resolver; // registered before the checker, tells what the symbols refer to
+  pass_errors_t *errors;
+  string_pool_t *strings; // string literals are decoded and added to it, see string_pool.h
+
+  const ast_function_t *function; // being checked, NULL at file scope
+  size_t rebound_checked; // of resolver->rebound
+  const type_t **declared; // by declaration number - 1, NULL until a symbol refers to it
+  size_t declared_capacity;
+  // interned once for the expressions that have them
+  const type_t *unknown; // of expressions that can't be typed yet, e.g., members, which are never errors
+  const type_t *int_type;
+  const type_t *long_type;
+  const type_t *ulong_type;
+  const type_t *string_type;
+} type_checker_t;
+
+/**
+ * Pass that gives every expression the id of its type in node.type, so that an interpreter picks the
+ * operation for int + int or double + double when it compiles the program instead of looking at tags on
+ * every add. The integer promotions and the usual arithmetic conversions are applied like section 6.3.1 of
+ * the c17 standard does for an LP64 target, and wherever an operand, initializer, argument or return value
+ * gets converted, the checker wraps it in a UNARY_OP_CONVERT node of the type it's converted to. Operations
+ * whose operands don't have the types they need are added to errors. Parenthesized expressions, which are
+ * list nodes, aren't typed themselves but have the type of the expression that gives their value.
+ *
+ * A typedef name is the type it stands for, see type_import(). Structs aren't parsed yet, so members get an
+ * unknown type, which the checker lets through anything without a conversion or an error so that one problem
+ * isn't reported again by every expression around it.
+ *
+ * Symbols are typed by the declarations the resolve pass bound them to, so it has to be registered before
+ * the checker. Conversions are inserted in shared subtrees too, which is safe as they mean the same thing
+ * to every parent after the resolve pass.
+ */
+pass_t typecheck_pass(type_checker_t checker[const static 1]);
+
+#endif // TYPECHECK_H_
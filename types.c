@@ -0,0 +1,649 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "./types.h"
+
+#include "./zdx_util.h"
+
+#define TYPE_TABLE_MIN_CAP 64
+// grow when the table is 3/4th full to keep the linear probe sequences short
+#define TYPE_TABLE_MAX_LOAD(capacity) ((capacity) / 4 * 3)
+
+const char *type_kind_name(const type_kind_t kind)
+{
+  static const char *type_kind_names[] = {
+    "TYPE_KIND_UNKNOWN",
+    "TYPE_KIND_BASE",
+    "TYPE_KIND_POINTER",
+  };
+
+  _Static_assert(zdx_arr_len(type_kind_names) == TYPE_KIND_COUNT, "Missing name for type kind");
+
+  return kind < TYPE_KIND_COUNT ? type_kind_names[kind] : "INVALID_TYPE_KIND";
+}
+
+// ------------------------------------ SPECIFIERS ------------------------------------
+
+static const struct {
+  const char *word;
+  uint16_t flag;
+} type_specifier_words[] = {
+  { "void", TYPE_SPEC_VOID },
+  { "_Bool", TYPE_SPEC_BOOL },
+  { "char", TYPE_SPEC_CHAR },
+  { "short", TYPE_SPEC_SHORT },
+  { "int", TYPE_SPEC_INT },
+  { "long", TYPE_SPEC_LONG },
+  { "float", TYPE_SPEC_FLOAT },
+  { "double", TYPE_SPEC_DOUBLE },
+  { "signed", TYPE_SPEC_SIGNED },
+  { "unsigned", TYPE_SPEC_UNSIGNED },
+};
+
+// every valid multiset of type specifiers from section 6.7.2 of the c17 standard after normalization
+static const uint16_t valid_type_specifiers[] = {
+  TYPE_SPEC_VOID,
+  TYPE_SPEC_BOOL,
+  TYPE_SPEC_CHAR,
+  TYPE_SPEC_SIGNED | TYPE_SPEC_CHAR,
+  TYPE_SPEC_UNSIGNED | TYPE_SPEC_CHAR,
+  TYPE_SPEC_SHORT | TYPE_SPEC_INT,
+  TYPE_SPEC_UNSIGNED | TYPE_SPEC_SHORT | TYPE_SPEC_INT,
+  TYPE_SPEC_INT,
+  TYPE_SPEC_UNSIGNED | TYPE_SPEC_INT,
+  TYPE_SPEC_LONG | TYPE_SPEC_INT,
+  TYPE_SPEC_UNSIGNED | TYPE_SPEC_LONG | TYPE_SPEC_INT,
+  TYPE_SPEC_LONG_LONG | TYPE_SPEC_INT,
+  TYPE_SPEC_UNSIGNED | TYPE_SPEC_LONG_LONG | TYPE_SPEC_INT,
+  TYPE_SPEC_FLOAT,
+  TYPE_SPEC_DOUBLE,
+  TYPE_SPEC_LONG | TYPE_SPEC_DOUBLE,
+  TYPE_SPEC_NAMED,
+};
+
+bool type_specifier_is_keyword(const sv_t word)
+{
+  for (size_t i = 0; i < zdx_arr_len(type_specifier_words); i++) {
+    if (sv_eq_cstr(word, type_specifier_words[i].word)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Any word that is not a builtin type specifier is taken to be a typedef name
+const char *type_specifiers_add(uint16_t specifiers[const static 1], const sv_t word)
+{
+  uint16_t flag = TYPE_SPEC_NAMED;
+
+  for (size_t i = 0; i < zdx_arr_len(type_specifier_words); i++) {
+    if (sv_eq_cstr(word, type_specifier_words[i].word)) {
+      flag = type_specifier_words[i].flag;
+      break;
+    }
+  }
+
+  if (flag == TYPE_SPEC_LONG && (*specifiers & TYPE_SPEC_LONG)) {
+    *specifiers = (uint16_t)((*specifiers & ~TYPE_SPEC_LONG) | TYPE_SPEC_LONG_LONG);
+    return NULL;
+  }
+
+  if ((*specifiers & flag) || (flag == TYPE_SPEC_LONG && (*specifiers & TYPE_SPEC_LONG_LONG))) {
+    return "Duplicate type specifier";
+  }
+
+  *specifiers |= flag;
+  return NULL;
+}
+
+// Spells out the implied int of short, long, signed and unsigned and drops the signed
+// of anything but char so that equal types end up with equal flags
+const char *type_specifiers_normalize(uint16_t specifiers[const static 1])
+{
+  uint16_t s = *specifiers;
+
+  if ((s & (TYPE_SPEC_SHORT | TYPE_SPEC_LONG | TYPE_SPEC_LONG_LONG | TYPE_SPEC_SIGNED | TYPE_SPEC_UNSIGNED)) &&
+      !(s & (TYPE_SPEC_CHAR | TYPE_SPEC_DOUBLE))) {
+    s |= TYPE_SPEC_INT;
+  }
+
+  if (!(s & TYPE_SPEC_CHAR)) {
+    s &= (uint16_t)~TYPE_SPEC_SIGNED;
+  }
+
+  for (size_t i = 0; i < zdx_arr_len(valid_type_specifiers); i++) {
+    if (valid_type_specifiers[i] == s) {
+      *specifiers = s;
+      return NULL;
+    }
+  }
+
+  return s ? "Invalid combination of type specifiers" : "Missing type specifier";
+}
+
+uint8_t type_qualifier_from_sv(const sv_t word)
+{
+  if (sv_eq_cstr(word, "const")) return TYPE_QUALIFIER_CONST;
+  if (sv_eq_cstr(word, "restrict")) return TYPE_QUALIFIER_RESTRICT;
+  if (sv_eq_cstr(word, "volatile")) return TYPE_QUALIFIER_VOLATILE;
+  if (sv_eq_cstr(word, "_Atomic")) return TYPE_QUALIFIER_ATOMIC;
+
+  return 0;
+}
+
+uint8_t storage_class_from_sv(const sv_t word)
+{
+  if (sv_eq_cstr(word, "extern")) return STORAGE_CLASS_EXTERN;
+  if (sv_eq_cstr(word, "static")) return STORAGE_CLASS_STATIC;
+  if (sv_eq_cstr(word, "_Thread_local")) return STORAGE_CLASS_THREAD_LOCAL;
+  if (sv_eq_cstr(word, "auto")) return STORAGE_CLASS_AUTO;
+  if (sv_eq_cstr(word, "register")) return STORAGE_CLASS_REGISTER;
+
+  return 0;
+}
+
+// ------------------------------------ LAYOUT ------------------------------------
+
+// on normalized specifiers, where int is implied by the other integer words
+static type_layout_t type_layout_of(const type_t type[const static 1])
+{
+  if (type->aliased) {
+    return type->aliased->layout;
+  }
+
+  if (type->kind == TYPE_KIND_POINTER) {
+    return (type_layout_t){ .size = 8, .align = 8 };
+  }
+
+  if (!type_is_arithmetic(type)) {
+    return (type_layout_t){0};
+  }
+
+  const uint16_t specifiers = type->specifiers;
+  uint32_t size = 4; // int and float
+
+  if (specifiers & TYPE_SPEC_DOUBLE) {
+    size = specifiers & TYPE_SPEC_LONG ? 16 : 8;
+  } else if (specifiers & (TYPE_SPEC_LONG | TYPE_SPEC_LONG_LONG)) {
+    size = 8;
+  } else if (specifiers & TYPE_SPEC_SHORT) {
+    size = 2;
+  } else if (specifiers & (TYPE_SPEC_CHAR | TYPE_SPEC_BOOL)) {
+    size = 1;
+  }
+
+  return (type_layout_t){ .size = size, .align = size };
+}
+
+// ------------------------------------ INTERNING ------------------------------------
+
+static inline uint64_t type_hash(const type_t type[const static 1])
+{
+  // fnv1a over the fields that make a type, the pointee and the aliased type are already interned so their addresses
+  // identify them
+  uint64_t h = 0xcbf29ce484222325ULL;
+  const uint64_t fields[] = {
+    type->kind,
+    type->qualifiers,
+    type->storage,
+    type->specifiers,
+    (uint64_t)(uintptr_t)type->pointee,
+    (uint64_t)(uintptr_t)type->aliased,
+  };
+
+  for (size_t i = 0; i < zdx_arr_len(fields); i++) {
+    h = (h ^ fields[i]) * 0x100000001b3ULL;
+  }
+
+  for (size_t i = 0; i < type->name.length; i++) {
+    h = (h ^ (uint8_t)type->name.buf[i]) * 0x100000001b3ULL;
+  }
+
+  return h;
+}
+
+static inline bool type_eq(const type_t a[const static 1], const type_t b[const static 1])
+{
+  return a->kind == b->kind &&
+    a->qualifiers == b->qualifiers &&
+    a->storage == b->storage &&
+    a->specifiers == b->specifiers &&
+    a->pointee == b->pointee &&
+    a->aliased == b->aliased &&
+    sv_eq_sv(a->name, b->name);
+}
+
+static void type_table_grow(arena_t arena[const static 1], type_table_t table[const static 1])
+{
+  const size_t capacity = zdx_max(table->capacity * 2, TYPE_TABLE_MIN_CAP);
+  const type_t **items = arena_calloc(arena, capacity, sizeof(*items));
+  assertm(!arena->err, "Expected: type table alloc to succeed, Received: %s", arena->err);
+
+  for (size_t i = 0; i < table->capacity; i++) {
+    const type_t *type = table->items[i];
+
+    if (type == NULL) {
+      continue;
+    }
+
+    size_t slot = type_hash(type) & (capacity - 1);
+
+    while (items[slot]) {
+      slot = (slot + 1) & (capacity - 1);
+    }
+
+    items[slot] = type;
+  }
+
+  // the old items array is left to the arena
+  table->items = items;
+  table->capacity = capacity;
+}
+
+// Returns the one record of the table that is equal to type, creating it on first use
+const type_t *type_intern(arena_t arena[const static 1], type_table_t table[const static 1], const type_t type)
+{
+  if (table->length + 1 > TYPE_TABLE_MAX_LOAD(table->capacity)) {
+    type_table_grow(arena, table);
+  }
+
+  size_t slot = type_hash(&type) & (table->capacity - 1);
+
+  while (table->items[slot]) {
+    if (type_eq(table->items[slot], &type)) {
+      return table->items[slot];
+    }
+
+    slot = (slot + 1) & (table->capacity - 1);
+  }
+
+  assertm(table->length < UINT16_MAX, "Expected: less than %d types, Received: %zu", UINT16_MAX, table->length);
+
+  if (table->length == table->by_id_capacity) {
+    const size_t capacity = zdx_max(table->by_id_capacity * 2, TYPE_TABLE_MIN_CAP);
+
+    table->by_id = arena_realloc(arena, table->by_id, table->by_id_capacity * sizeof(*table->by_id), capacity * sizeof(*table->by_id));
+    assertm(!arena->err, "Expected: type ids resize to be successful, Received: %s", arena->err);
+    table->by_id_capacity = capacity;
+  }
+
+  type_t *record = arena_calloc(arena, 1, sizeof(*record));
+  assertm(!arena->err, "Expected: type alloc to succeed, Received: %s", arena->err);
+  *record = type;
+  record->id = (uint16_t)(table->length + 1);
+  record->layout = type_layout_of(record);
+
+  table->items[slot] = record;
+  table->by_id[table->length++] = record;
+
+  return record;
+}
+
+const type_t *type_by_id(const type_table_t table[const static 1], const uint16_t id)
+{
+  assertm(id != TYPE_NO_ID && id <= table->length, "Expected: a type id of the table, Received: %u", id);
+
+  return table->by_id[id - 1];
+}
+
+const type_t *type_import(arena_t arena[const static 1], type_table_t table[const static 1], const type_t type[const static 1])
+{
+  type_t t = *type;
+
+  if (t.kind == TYPE_KIND_POINTER) {
+    t.pointee = type_import(arena, table, t.pointee);
+  } else if (t.aliased) {
+    // the declared type of the typedef has its typedef storage class, the one of where the name is used counts
+    const uint8_t qualifiers = t.qualifiers;
+    const uint8_t storage = t.storage;
+
+    t = *type_import(arena, table, t.aliased);
+    t.qualifiers |= qualifiers;
+    t.storage = storage;
+  }
+
+  return type_intern(arena, table, t);
+}
+
+type_layout_t type_layout(const type_t type[const static 1])
+{
+  assertm(type->id != TYPE_NO_ID, "Expected: an interned type, Received: a type of kind %s", type_kind_name(type->kind));
+
+  return type->layout;
+}
+
+// ------------------------------------ ARITHMETIC ------------------------------------
+
+#define TYPE_SPEC_INTEGERS (TYPE_SPEC_BOOL | TYPE_SPEC_CHAR | TYPE_SPEC_SHORT | TYPE_SPEC_INT | TYPE_SPEC_LONG | TYPE_SPEC_LONG_LONG)
+#define TYPE_SPEC_FLOATING (TYPE_SPEC_FLOAT | TYPE_SPEC_DOUBLE)
+
+bool type_is_integer(const type_t type[const static 1])
+{
+  return type->kind == TYPE_KIND_BASE && (type->specifiers & TYPE_SPEC_INTEGERS) && !(type->specifiers & TYPE_SPEC_DOUBLE);
+}
+
+bool type_is_arithmetic(const type_t type[const static 1])
+{
+  return type->kind == TYPE_KIND_BASE && (type->specifiers & (TYPE_SPEC_INTEGERS | TYPE_SPEC_FLOATING));
+}
+
+bool type_is_scalar(const type_t type[const static 1])
+{
+  return type->kind == TYPE_KIND_POINTER || type_is_arithmetic(type);
+}
+
+// integer conversion rank of section 6.3.1.1, floating types rank above every integer type
+static int type_rank(const uint16_t specifiers)
+{
+  if (specifiers & TYPE_SPEC_DOUBLE) return specifiers & TYPE_SPEC_LONG ? 8 : 7;
+  if (specifiers & TYPE_SPEC_FLOAT) return 6;
+  if (specifiers & TYPE_SPEC_LONG_LONG) return 5;
+  if (specifiers & TYPE_SPEC_LONG) return 4;
+  if (specifiers & TYPE_SPEC_INT && !(specifiers & TYPE_SPEC_SHORT)) return 3;
+  if (specifiers & TYPE_SPEC_SHORT) return 2;
+  if (specifiers & TYPE_SPEC_CHAR) return 1;
+
+  return 0; // _Bool
+}
+
+// plain char is signed, as on x86-64 and unlike on arm64
+bool type_is_unsigned(const uint16_t specifiers)
+{
+  return (specifiers & TYPE_SPEC_UNSIGNED) || (specifiers & TYPE_SPEC_BOOL);
+}
+
+unsigned type_integer_width(const uint16_t specifiers)
+{
+  static const unsigned widths[] = { 1, 8, 16, 32, 64, 64 };
+  const size_t rank = (size_t)type_rank(specifiers);
+
+  assertm(rank < zdx_arr_len(widths), "Expected: an integer type, Received: specifiers %u", specifiers);
+
+  return widths[rank];
+}
+
+// every type ranked below int fits into an int, so they are all promoted to int
+uint16_t type_promote(const uint16_t specifiers)
+{
+  return type_rank(specifiers) < 3 ? TYPE_SPEC_INT : specifiers;
+}
+
+uint16_t type_common(const uint16_t a, const uint16_t b)
+{
+  if (type_rank(a) >= 6 || type_rank(b) >= 6) {
+    return type_rank(a) >= type_rank(b) ? a : b;
+  }
+
+  const uint16_t pa = type_promote(a);
+  const uint16_t pb = type_promote(b);
+
+  if (pa == pb) {
+    return pa;
+  }
+
+  if (type_is_unsigned(pa) == type_is_unsigned(pb)) {
+    return type_rank(pa) >= type_rank(pb) ? pa : pb;
+  }
+
+  const uint16_t u = type_is_unsigned(pa) ? pa : pb;
+  const uint16_t s = type_is_unsigned(pa) ? pb : pa;
+
+  if (type_rank(u) >= type_rank(s)) {
+    return u;
+  }
+
+  // a signed type that is ranked higher can represent every value of the unsigned one unless both are 64 bits,
+  // which on LP64 are unsigned long vs long long
+  if (type_rank(s) == 5 && type_rank(u) == 4) {
+    return (uint16_t)(TYPE_SPEC_UNSIGNED | TYPE_SPEC_LONG_LONG | TYPE_SPEC_INT);
+  }
+
+  return s;
+}
+
+// ------------------------------------ TYPEDEF NAMES ------------------------------------
+
+#define TYPEDEF_SLOT_EMPTY 0
+#define TYPEDEF_SLOT_TOMBSTONE UINT32_MAX
+
+static inline uint64_t name_hash(const sv_t name)
+{
+  uint64_t h = 0xcbf29ce484222325ULL;
+
+  for (size_t i = 0; i < name.length; i++) {
+    h = (h ^ (uint8_t)name.buf[i]) * 0x100000001b3ULL;
+  }
+
+  return h;
+}
+
+// slot holding the newest declaration of name or, if there is none, the slot to put one in
+static size_t typedef_slot(const typedef_names_t names[const static 1], const sv_t name)
+{
+  const size_t mask = names->slot_capacity - 1;
+  size_t slot = name_hash(name) & mask;
+  size_t free_slot = SIZE_MAX;
+
+  for (uint32_t s = names->slots[slot]; s != TYPEDEF_SLOT_EMPTY; s = names->slots[slot]) {
+    if (s == TYPEDEF_SLOT_TOMBSTONE) {
+      free_slot = free_slot == SIZE_MAX ? slot : free_slot;
+    } else if (sv_eq_sv(names->items[s - 1].name, name)) {
+      return slot;
+    }
+
+    slot = (slot + 1) & mask;
+  }
+
+  return free_slot == SIZE_MAX ? slot : free_slot;
+}
+
+static void typedef_slots_grow(arena_t arena[const static 1], typedef_names_t names[const static 1])
+{
+  const size_t capacity = zdx_max(names->slot_capacity * 2, TYPE_TABLE_MIN_CAP);
+
+  names->slots = arena_calloc(arena, capacity, sizeof(*names->slots));
+  assertm(!arena->err, "Expected: typedef name slots alloc to succeed, Received: %s", arena->err);
+  names->slot_capacity = capacity;
+  names->slot_used = 0;
+
+  // in declaration order so the newest declaration of a name ends up in its slot, tombstones are dropped
+  for (size_t i = 0; i < names->length; i++) {
+    const size_t slot = typedef_slot(names, names->items[i].name);
+
+    names->slot_used += names->slots[slot] == TYPEDEF_SLOT_EMPTY;
+    names->slots[slot] = (uint32_t)i + 1;
+  }
+}
+
+void typedef_names_declare(arena_t arena[const static 1], typedef_names_t names[const static 1], const sv_t name,
+                           const type_t *type)
+{
+  uint32_t newest = TYPEDEF_SLOT_EMPTY;
+
+  if (names->slot_capacity > 0) {
+    newest = names->slots[typedef_slot(names, name)];
+    newest = newest == TYPEDEF_SLOT_TOMBSTONE ? TYPEDEF_SLOT_EMPTY : newest;
+  }
+
+  // an ordinary identifier only matters when it hides a typedef name, which keeps variables out of the table
+  if (type == NULL && (newest == TYPEDEF_SLOT_EMPTY || names->items[newest - 1].type == NULL)) {
+    return;
+  }
+
+  if (names->slot_used + 1 > TYPE_TABLE_MAX_LOAD(names->slot_capacity)) {
+    typedef_slots_grow(arena, names);
+  }
+
+  if (names->length == names->capacity) {
+    const size_t capacity = zdx_max(names->capacity * 2, TYPE_TABLE_MIN_CAP);
+
+    names->items = arena_realloc(arena, names->items, names->capacity * sizeof(*names->items), capacity * sizeof(*names->items));
+    assertm(!arena->err, "Expected: typedef names resize to be successful, Received: %s", arena->err);
+    names->capacity = capacity;
+  }
+
+  names->items[names->length++] = (typedef_name_t){ .name = name, .type = type, .shadowed = newest };
+
+  const size_t slot = typedef_slot(names, name);
+
+  names->slot_used += names->slots[slot] == TYPEDEF_SLOT_EMPTY;
+  names->slots[slot] = (uint32_t)names->length;
+}
+
+bool typedef_names_is_type(const typedef_names_t names[const static 1], const sv_t name)
+{
+  return typedef_names_type(names, name) != NULL;
+}
+
+const type_t *typedef_names_type(const typedef_names_t names[const static 1], const sv_t name)
+{
+  if (names->length == 0) {
+    return NULL;
+  }
+
+  const uint32_t s = names->slots[typedef_slot(names, name)];
+
+  return s != TYPEDEF_SLOT_EMPTY && s != TYPEDEF_SLOT_TOMBSTONE ? names->items[s - 1].type : NULL;
+}
+
+void typedef_names_open_scope(arena_t arena[const static 1], typedef_names_t names[const static 1])
+{
+  if (names->scope_depth == names->scope_capacity) {
+    const size_t capacity = zdx_max(names->scope_capacity * 2, TYPE_TABLE_MIN_CAP);
+
+    names->scopes = arena_realloc(arena, names->scopes, names->scope_capacity * sizeof(*names->scopes), capacity * sizeof(*names->scopes));
+    assertm(!arena->err, "Expected: typedef scopes resize to be successful, Received: %s", arena->err);
+    names->scope_capacity = capacity;
+  }
+
+  names->scopes[names->scope_depth++] = names->length;
+}
+
+void typedef_names_close_scope(typedef_names_t names[const static 1])
+{
+  assertm(names->scope_depth > 0, "Expected: an open typedef name scope, Received: none");
+
+  const size_t mark = names->scopes[--names->scope_depth];
+
+  while (names->length > mark) {
+    const typedef_name_t *declaration = &names->items[names->length - 1];
+    const size_t slot = typedef_slot(names, declaration->name);
+
+    names->slots[slot] = declaration->shadowed ? declaration->shadowed : TYPEDEF_SLOT_TOMBSTONE;
+    names->length--;
+  }
+}
+
+typedef_names_t typedef_names_prefix(arena_t arena[const static 1], const typedef_names_t names[const static 1],
+                                     const size_t length)
+{
+  assertm(names->scope_depth == 0 && length <= names->length, "Expected: a prefix of the file scope names, Received: %zu "
+          "of %zu names in %zu scopes", length, names->length, names->scope_depth);
+
+  typedef_names_t prefix = {0};
+
+  for (size_t i = 0; i < length; i++) {
+    typedef_names_declare(arena, &prefix, names->items[i].name, names->items[i].type);
+  }
+
+  return prefix;
+}
+
+// ------------------------------------ SPELLING ------------------------------------
+
+static void type_writer_append(type_writer_t w[const static 1], const char *str, const size_t length)
+{
+  // like snprintf, keeps counting past the end of the buffer so the caller learns the full length
+  if (w->length < w->size) {
+    memcpy(w->buf + w->length, str, zdx_min(length, w->size - w->length));
+  }
+
+  w->length += length;
+}
+
+static void write_words(type_writer_t w[const static 1], const uint16_t flags, const char *const words[const static 1],
+                        const uint16_t word_flags[const static 1], const size_t count, bool separate[const static 1])
+{
+  for (size_t i = 0; i < count; i++) {
+    if (flags & word_flags[i]) {
+      if (*separate) {
+        type_writer_append(w, " ", 1);
+      }
+
+      type_writer_append(w, words[i], strlen(words[i]));
+      *separate = true;
+    }
+  }
+}
+
+static const char *const qualifier_words[] = { "const", "restrict", "volatile", "_Atomic" };
+static const uint16_t qualifier_flags[] = {
+  TYPE_QUALIFIER_CONST, TYPE_QUALIFIER_RESTRICT, TYPE_QUALIFIER_VOLATILE, TYPE_QUALIFIER_ATOMIC
+};
+
+void write_type_base(type_writer_t w[const static 1], const uint8_t storage, const uint8_t qualifiers,
+                     const uint16_t specifiers, const sv_t name)
+{
+  static const char *const storage_words[] = { "typedef", "extern", "static", "_Thread_local", "auto", "register" };
+  static const uint16_t storage_flags[] = {
+    STORAGE_CLASS_TYPEDEF, STORAGE_CLASS_EXTERN, STORAGE_CLASS_STATIC, STORAGE_CLASS_THREAD_LOCAL, STORAGE_CLASS_AUTO,
+    STORAGE_CLASS_REGISTER
+  };
+  // in the order they are usually spelled in
+  static const char *const specifier_words[] = {
+    "signed", "unsigned", "short", "long", "long long", "void", "_Bool", "char", "int", "float", "double"
+  };
+  static const uint16_t specifier_flags[] = {
+    TYPE_SPEC_SIGNED, TYPE_SPEC_UNSIGNED, TYPE_SPEC_SHORT, TYPE_SPEC_LONG, TYPE_SPEC_LONG_LONG,
+    TYPE_SPEC_VOID, TYPE_SPEC_BOOL, TYPE_SPEC_CHAR, TYPE_SPEC_INT, TYPE_SPEC_FLOAT, TYPE_SPEC_DOUBLE
+  };
+
+  _Static_assert(zdx_arr_len(storage_words) == zdx_arr_len(storage_flags), "Missing storage class word");
+  _Static_assert(zdx_arr_len(qualifier_words) == zdx_arr_len(qualifier_flags), "Missing qualifier word");
+  _Static_assert(zdx_arr_len(specifier_words) == zdx_arr_len(specifier_flags), "Missing specifier word");
+
+  bool separate = false;
+
+  write_words(w, storage, storage_words, storage_flags, zdx_arr_len(storage_words), &separate);
+  write_words(w, qualifiers, qualifier_words, qualifier_flags, zdx_arr_len(qualifier_words), &separate);
+  write_words(w, specifiers, specifier_words, specifier_flags, zdx_arr_len(specifier_words), &separate);
+
+  if (specifiers & TYPE_SPEC_NAMED) {
+    if (separate) {
+      type_writer_append(w, " ", 1);
+    }
+
+    type_writer_append(w, name.buf, name.length);
+  }
+}
+
+// after_word is true if the pointee was spelled ending in a word, i.e., char * vs char **
+void write_type_pointer(type_writer_t w[const static 1], const uint8_t qualifiers, const bool after_word)
+{
+  bool separate = false;
+
+  type_writer_append(w, after_word ? " *" : "*", after_word ? 2 : 1);
+  write_words(w, qualifiers, qualifier_words, qualifier_flags, zdx_arr_len(qualifier_words), &separate);
+}
+
+// returns true if the spelling ends in a word
+static bool write_type_(type_writer_t w[const static 1], const type_t type[const static 1], const uint8_t storage)
+{
+  switch(type->kind) {
+    case TYPE_KIND_BASE: write_type_base(w, storage, type->qualifiers, type->specifiers, type->name); return true;
+    case TYPE_KIND_POINTER: {
+      write_type_pointer(w, type->qualifiers, write_type_(w, type->pointee, storage));
+      return type->qualifiers != 0;
+    }
+    default: assertm(false, "Unexpected type of kind %s (%d)", type_kind_name(type->kind), type->kind);
+  }
+
+  return false;
+}
+
+void write_type(type_writer_t w[const static 1], const type_t type[const static 1])
+{
+  // the storage class of a declaration is on its outermost type but is spelled first
+  write_type_(w, type, type->storage);
+}
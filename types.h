@@ -0,0 +1,183 @@
+#ifndef TYPES_H_
+#define TYPES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "./zdx_simple_arena.h"
+#include "./zdx_string_view.h"
+
+typedef enum {
+  TYPE_KIND_UNKNOWN,
+  TYPE_KIND_BASE,
+  TYPE_KIND_POINTER,
+  TYPE_KIND_COUNT,
+} type_kind_t;
+
+// type specifiers of section 6.7.2 of the c17 standard as flags so that the same
+// type spelled differently, e.g., "unsigned short" and "short unsigned int", is one type
+typedef enum {
+  TYPE_SPEC_VOID      = 1 << 0,
+  TYPE_SPEC_BOOL      = 1 << 1,
+  TYPE_SPEC_CHAR      = 1 << 2,
+  TYPE_SPEC_SHORT     = 1 << 3,
+  TYPE_SPEC_INT       = 1 << 4,
+  TYPE_SPEC_LONG      = 1 << 5,
+  TYPE_SPEC_LONG_LONG = 1 << 6,
+  TYPE_SPEC_FLOAT     = 1 << 7,
+  TYPE_SPEC_DOUBLE    = 1 << 8,
+  TYPE_SPEC_SIGNED    = 1 << 9,
+  TYPE_SPEC_UNSIGNED  = 1 << 10,
+  TYPE_SPEC_NAMED     = 1 << 11, // typedef name, kept in type_t.name
+} type_specifier_t;
+
+typedef enum {
+  TYPE_QUALIFIER_CONST    = 1 << 0,
+  TYPE_QUALIFIER_RESTRICT = 1 << 1,
+  TYPE_QUALIFIER_VOLATILE = 1 << 2,
+  TYPE_QUALIFIER_ATOMIC   = 1 << 3,
+} type_qualifier_t;
+
+typedef enum {
+  STORAGE_CLASS_EXTERN       = 1 << 0,
+  STORAGE_CLASS_STATIC       = 1 << 1,
+  STORAGE_CLASS_THREAD_LOCAL = 1 << 2,
+  STORAGE_CLASS_AUTO         = 1 << 3,
+  STORAGE_CLASS_REGISTER     = 1 << 4,
+  STORAGE_CLASS_TYPEDEF      = 1 << 5, // listed with the storage classes by section 6.7.1, the lexer has its own token for it
+} storage_class_t;
+
+// size and alignment in bytes of the objects of a type, see type_layout()
+typedef struct {
+  uint32_t size;
+  uint32_t align; // 0 when the size isn't known
+} type_layout_t;
+
+/**
+ * Types are hash-consed by type_intern() so two structurally equal types are always the same
+ * record and can be compared by pointer. A pointer type refers to the interned type it points to.
+ * Every record also gets a small id, the order it was interned in, for places too small for a pointer,
+ * and its layout, so that it's worked out once per type instead of on every sizeof.
+ *
+ * Storage classes are not a part of a C type but are kept on the outermost type of a declaration
+ * so that the declaration node doesn't grow past the other ast nodes.
+ */
+typedef struct type_t {
+  uint8_t kind; // type_kind_t
+  uint8_t qualifiers; // type_qualifier_t flags
+  uint8_t storage; // storage_class_t flags
+  uint16_t specifiers; // type_specifier_t flags of TYPE_KIND_BASE types
+  uint16_t id; // set by type_intern(), not a part of the type
+  type_layout_t layout; // set by type_intern(), not a part of the type
+  sv_t name; // typedef name of TYPE_KIND_BASE types with TYPE_SPEC_NAMED
+  const struct type_t *pointee; // TYPE_KIND_POINTER
+  // declared type of the typedef the name of a TYPE_SPEC_NAMED type refers to where it's used, NULL if there's none
+  const struct type_t *aliased;
+} type_t;
+
+#define TYPE_NO_ID 0
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  const type_t **items;
+  const type_t **by_id; // by_id[id - 1], length entries
+  size_t by_id_capacity;
+} type_table_t;
+
+const char *type_kind_name(const type_kind_t kind);
+const type_t *type_intern(arena_t arena[const static 1], type_table_t table[const static 1], const type_t type);
+const type_t *type_by_id(const type_table_t table[const static 1], const uint16_t id);
+// interns type in table, which may be another table than the one of type, with every typedef name replaced by the
+// type it stands for, so that const T for a T of int * is int *const
+const type_t *type_import(arena_t arena[const static 1], type_table_t table[const static 1], const type_t type[const static 1]);
+
+/**
+ * Layout of an interned type on x86-64 as the System V psABI lays it out for LP64: every scalar is aligned to
+ * its size, which is 1 for _Bool and char, 2 for short, 4 for int and float, 8 for long, long long, double
+ * and pointers and 16 for long double. Qualifiers don't change it. A typedef name has the layout of the type it
+ * stands for, void and the names that aren't a typedef have no known size, i.e., an align of 0.
+ */
+type_layout_t type_layout(const type_t type[const static 1]);
+
+/**
+ * Classification of base types for the conversions of section 6.3.1 of the c17 standard on an LP64 target,
+ * done on normalized specifiers (see type_specifiers_normalize()). Typedef names are neither integer nor floating
+ * types, see type_import() for the types they stand for.
+ */
+bool type_is_integer(const type_t type[const static 1]);
+bool type_is_arithmetic(const type_t type[const static 1]);
+// arithmetic or pointer, the types a condition can have
+bool type_is_scalar(const type_t type[const static 1]);
+// specifiers of the type the integer promotions turn an integer type into
+uint16_t type_promote(const uint16_t specifiers);
+// specifiers of the common type of the usual arithmetic conversions of two arithmetic types
+uint16_t type_common(const uint16_t a, const uint16_t b);
+// unsigned integer types and _Bool, plain char is signed like on x86-64
+bool type_is_unsigned(const uint16_t specifiers);
+// bits of an integer type that take part in its value, the sign bit included
+unsigned type_integer_width(const uint16_t specifiers);
+
+// true for void, char, int, unsigned, etc., which the lexer returns as symbols
+bool type_specifier_is_keyword(const sv_t word);
+// Both return NULL on success and the reason otherwise
+const char *type_specifiers_add(uint16_t specifiers[const static 1], const sv_t word);
+const char *type_specifiers_normalize(uint16_t specifiers[const static 1]);
+
+uint8_t type_qualifier_from_sv(const sv_t word);
+uint8_t storage_class_from_sv(const sv_t word);
+
+/**
+ * Typedef names visible at a point of the source, which decides whether T * x; declares x or multiplies
+ * T by x (the "lexer hack"). Declaring an ordinary identifier in a nested scope hides a typedef name of
+ * the same name until that scope is closed.
+ */
+typedef struct {
+  sv_t name;
+  const type_t *type; // declared type of a typedef name, NULL for an ordinary identifier
+  uint32_t shadowed; // index + 1 of the declaration of the same name this one hides, 0 if none
+} typedef_name_t;
+
+typedef struct {
+  size_t capacity;
+  size_t length;
+  typedef_name_t *items; // declarations of the open scopes, the innermost last
+  size_t slot_capacity;
+  size_t slot_used; // slots holding a declaration or a tombstone
+  uint32_t *slots; // open addressing by name, index + 1 of the newest declaration of the name
+  size_t scope_capacity;
+  size_t scope_depth;
+  size_t *scopes; // length of items when each nested scope was opened
+} typedef_names_t;
+
+// type is the declared type of a typedef, NULL declares an ordinary identifier
+void typedef_names_declare(arena_t arena[const static 1], typedef_names_t names[const static 1], const sv_t name,
+                           const type_t *type);
+bool typedef_names_is_type(const typedef_names_t names[const static 1], const sv_t name);
+// declared type of the typedef name in scope, NULL if name isn't one
+const type_t *typedef_names_type(const typedef_names_t names[const static 1], const sv_t name);
+void typedef_names_open_scope(arena_t arena[const static 1], typedef_names_t names[const static 1]);
+// forgets everything declared since the matching typedef_names_open_scope()
+void typedef_names_close_scope(typedef_names_t names[const static 1]);
+// a new table with the first length declarations of names, which has no scopes open, i.e., the file scope names
+// as they were when it had length of them
+typedef_names_t typedef_names_prefix(arena_t arena[const static 1], const typedef_names_t names[const static 1],
+                                     const size_t length);
+
+/**
+ * Spells types the way they are usually written, e.g., static const char *const *, into a caller
+ * owned buffer. Like snprintf, at most size bytes are written (without a NUL) and length keeps
+ * counting past size, so a length > size means the buffer was too small.
+ */
+typedef struct {
+  char *buf;
+  size_t size;
+  size_t length;
+} type_writer_t;
+
+void write_type(type_writer_t w[const static 1], const type_t type[const static 1]);
+void write_type_base(type_writer_t w[const static 1], const uint8_t storage, const uint8_t qualifiers,
+                     const uint16_t specifiers, const sv_t name);
+void write_type_pointer(type_writer_t w[const static 1], const uint8_t qualifiers, const bool after_word);
+
+#endif // TYPES_H_
@@ -138,9 +138,11 @@ FL_API fl_content_t fl_read_file(const char *restrict path, const char *restrict
 
   size_t bytes_read = fread(contents_buf, sizeof(char), (size_t)s.st_size, f);
 
+  const int read_err = ferror(f); /* checked before closing, f can't be used after */
+
   fclose(f); /* safe to close as we have read contents into contents_buf */
 
-  if (ferror(f)) {
+  if (read_err) {
     FL_FREE(contents_buf);
     fc.err = "Reading file failed";
 
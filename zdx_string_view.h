@@ -121,7 +121,7 @@ bool sv_begins_with_word_buf(sv_t sv, const char *buf, const size_t len)
   if (len > sv.length) {
     return false;
   } else if (len == sv.length) {
-    return memcmp(sv.buf, buf, len) == 0;
+    return len == 0 || memcmp(sv.buf, buf, len) == 0;
   } else {
     return memcmp(sv.buf, buf, len) == 0 && isspace(sv.buf[len]);
   }
@@ -140,7 +140,7 @@ bool sv_eq_cstr(sv_t sv, const char *str)
 
   const size_t input_str_len = strlen(str);
 
-  if (input_str_len == sv.length && memcmp(sv.buf, str, sv.length) == 0) {
+  if (input_str_len == sv.length && (sv.length == 0 || memcmp(sv.buf, str, sv.length) == 0)) {
     return true;
   }
 
@@ -149,11 +149,12 @@ bool sv_eq_cstr(sv_t sv, const char *str)
 
 bool sv_eq_sv(const sv_t sv1, const sv_t sv2)
 {
-  if (sv1.length == sv2.length && memcmp(sv1.buf, sv2.buf, sv1.length) == 0) {
-    return true;
+  if (sv1.length != sv2.length) {
+    return false;
   }
 
-  return false;
+  // empty views may have a NULL buf, which memcmp must not be given even for 0 bytes
+  return sv1.length == 0 || memcmp(sv1.buf, sv2.buf, sv1.length) == 0;
 }
 
 bool sv_is_empty(const sv_t sv)